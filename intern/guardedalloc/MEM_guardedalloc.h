@@ -177,6 +177,39 @@ extern "C" {
 	/** Get the peak memory usage in bytes, including mmap allocations. */
 	extern size_t (*MEM_get_peak_memory)(void) ATTR_WARN_UNUSED_RESULT;
 
+	/**
+	 * Memory categories, to see which subsystem uses memory.
+	 *
+	 * Blocks allocated between #MEM_category_begin and #MEM_category_end
+	 * (on the same thread) are counted in that category until they are freed,
+	 * other blocks are counted as #MEM_CATEGORY_NONE.
+	 * Categories are only tracked on 64 bit systems. */
+	typedef enum eMEM_Category {
+		MEM_CATEGORY_NONE = 0,
+		MEM_CATEGORY_MESH,
+		MEM_CATEGORY_IMAGE,
+		MEM_CATEGORY_CACHE,
+		MEM_CATEGORY_DEPSGRAPH,
+		MEM_CATEGORY_UNDO,
+
+		MEM_CATEGORY_TOT
+	} eMEM_Category;
+
+	/** Start counting allocations of this thread in \a category, returns the previous category. */
+	int MEM_category_begin(int category);
+	/** Restore the category returned by #MEM_category_begin. */
+	void MEM_category_end(int category_prev);
+
+	const char *MEM_category_name(int category);
+	/** Get memory usage of a category (all memory for #MEM_CATEGORY_NONE is not in other categories). */
+	size_t MEM_get_category_memory_in_use(int category);
+	/** Get peak memory usage of a category. */
+	size_t MEM_get_category_peak_memory(int category);
+	/** Get amount of memory blocks of a category. */
+	unsigned int MEM_get_category_blocks_in_use(int category);
+	/** Print memory usage of all categories. */
+	void MEM_print_category_stats(void);
+
 #ifdef __GNUC__
 #define MEM_SAFE_FREE(v) do { \
 	typeof(&(v)) _v = &(v); \
@@ -206,6 +239,10 @@ extern const char *(*MEM_name_ptr)(void *vmemh);
 /* Switch allocator to slower but fully guarded mode. */
 void MEM_use_guarded_allocator(void);
 
+/* Switch allocator to mode which caches small blocks per thread,
+ * scales better when many threads allocate at once. */
+void MEM_use_threadcache_allocator(void);
+
 #ifdef __cplusplus
 /* alloc funcs for C++ only */
 #define MEM_CXX_CLASS_ALLOC_FUNCS(_id)                                        \
@@ -34,6 +34,7 @@
 #include "../../source/blender/blenlib/BLI_strict_flags.h"
 
 #include <assert.h>
+#include <stdio.h>
 
 #include "mallocn_intern.h"
 
@@ -64,6 +65,13 @@ size_t (*MEM_get_peak_memory)(void) = MEM_lockfree_get_peak_memory;
 const char *(*MEM_name_ptr)(void *vmemh) = MEM_lockfree_name_ptr;
 #endif
 
+#ifdef USE_MEM_CATEGORIES
+MEM_THREAD_LOCAL int mem_category_active = MEM_CATEGORY_NONE;
+size_t mem_category_in_use[MEM_CATEGORY_TOT] = {0};
+size_t mem_category_peak[MEM_CATEGORY_TOT] = {0};
+unsigned int mem_category_blocks[MEM_CATEGORY_TOT] = {0};
+#endif
+
 void *aligned_malloc(size_t size, size_t alignment)
 {
 #ifdef _WIN32
@@ -128,3 +136,138 @@ void MEM_use_guarded_allocator(void)
 	MEM_name_ptr = MEM_guarded_name_ptr;
 #endif
 }
+
+void MEM_use_threadcache_allocator(void)
+{
+	MEM_allocN_len = MEM_threadcache_allocN_len;
+	MEM_freeN = MEM_threadcache_freeN;
+	MEM_dupallocN = MEM_threadcache_dupallocN;
+	MEM_reallocN_id = MEM_threadcache_reallocN_id;
+	MEM_recallocN_id = MEM_threadcache_recallocN_id;
+	MEM_callocN = MEM_threadcache_callocN;
+	MEM_mallocN = MEM_threadcache_mallocN;
+	MEM_mallocN_aligned = MEM_threadcache_mallocN_aligned;
+	MEM_mapallocN = MEM_threadcache_mapallocN;
+	MEM_printmemlist_pydict = MEM_threadcache_printmemlist_pydict;
+	MEM_printmemlist = MEM_threadcache_printmemlist;
+	MEM_callbackmemlist = MEM_threadcache_callbackmemlist;
+	MEM_printmemlist_stats = MEM_threadcache_printmemlist_stats;
+	MEM_set_error_callback = MEM_threadcache_set_error_callback;
+	MEM_check_memory_integrity = MEM_threadcache_check_memory_integrity;
+	MEM_set_lock_callback = MEM_threadcache_set_lock_callback;
+	MEM_set_memory_debug = MEM_threadcache_set_memory_debug;
+	MEM_get_memory_in_use = MEM_threadcache_get_memory_in_use;
+	MEM_get_mapped_memory_in_use = MEM_threadcache_get_mapped_memory_in_use;
+	MEM_get_memory_blocks_in_use = MEM_threadcache_get_memory_blocks_in_use;
+	MEM_reset_peak_memory = MEM_threadcache_reset_peak_memory;
+	MEM_get_peak_memory = MEM_threadcache_get_peak_memory;
+
+#ifndef NDEBUG
+	MEM_name_ptr = MEM_threadcache_name_ptr;
+#endif
+}
+
+/* -------------------------------------------------------------------- */
+/* Memory Categories */
+
+int MEM_category_begin(int category)
+{
+#ifdef USE_MEM_CATEGORIES
+	const int category_prev = mem_category_active;
+	assert(category >= 0 && category < MEM_CATEGORY_TOT);
+	mem_category_active = category;
+	return category_prev;
+#else
+	(void)category;
+	return MEM_CATEGORY_NONE;
+#endif
+}
+
+void MEM_category_end(int category_prev)
+{
+#ifdef USE_MEM_CATEGORIES
+	mem_category_active = category_prev;
+#else
+	(void)category_prev;
+#endif
+}
+
+const char *MEM_category_name(int category)
+{
+	switch ((eMEM_Category)category) {
+		case MEM_CATEGORY_NONE: return "other";
+		case MEM_CATEGORY_MESH: return "mesh";
+		case MEM_CATEGORY_IMAGE: return "image";
+		case MEM_CATEGORY_CACHE: return "cache";
+		case MEM_CATEGORY_DEPSGRAPH: return "depsgraph";
+		case MEM_CATEGORY_UNDO: return "undo";
+		case MEM_CATEGORY_TOT: break;
+	}
+	return "unknown";
+}
+
+size_t MEM_get_category_memory_in_use(int category)
+{
+#ifdef USE_MEM_CATEGORIES
+	if (category == MEM_CATEGORY_NONE) {
+		size_t in_use = MEM_get_memory_in_use();
+		int i;
+		for (i = MEM_CATEGORY_NONE + 1; i < MEM_CATEGORY_TOT; i++) {
+			in_use -= mem_category_in_use[i];
+		}
+		return in_use;
+	}
+	return mem_category_in_use[category];
+#else
+	return (category == MEM_CATEGORY_NONE) ? MEM_get_memory_in_use() : 0;
+#endif
+}
+
+size_t MEM_get_category_peak_memory(int category)
+{
+#ifdef USE_MEM_CATEGORIES
+	if (category == MEM_CATEGORY_NONE) {
+		/* Not tracked separately. */
+		return MEM_get_peak_memory();
+	}
+	return mem_category_peak[category];
+#else
+	return (category == MEM_CATEGORY_NONE) ? MEM_get_peak_memory() : 0;
+#endif
+}
+
+unsigned int MEM_get_category_blocks_in_use(int category)
+{
+#ifdef USE_MEM_CATEGORIES
+	if (category == MEM_CATEGORY_NONE) {
+		unsigned int blocks = MEM_get_memory_blocks_in_use();
+		int i;
+		for (i = MEM_CATEGORY_NONE + 1; i < MEM_CATEGORY_TOT; i++) {
+			blocks -= mem_category_blocks[i];
+		}
+		return blocks;
+	}
+	return mem_category_blocks[category];
+#else
+	return (category == MEM_CATEGORY_NONE) ? MEM_get_memory_blocks_in_use() : 0;
+#endif
+}
+
+void MEM_print_category_stats(void)
+{
+	int i;
+
+	printf("Memory usage per category:\n");
+	for (i = 0; i < MEM_CATEGORY_TOT; i++) {
+		printf("  %-10s %10.3f MB in use, %10.3f MB peak, %8u blocks\n",
+		       MEM_category_name(i),
+		       (double)MEM_get_category_memory_in_use(i) / (double)(1024 * 1024),
+		       (double)MEM_get_category_peak_memory(i) / (double)(1024 * 1024),
+		       MEM_get_category_blocks_in_use(i));
+	}
+	printf("  %-10s %10.3f MB in use, %10.3f MB peak, %8u blocks\n",
+	       "total",
+	       (double)MEM_get_memory_in_use() / (double)(1024 * 1024),
+	       (double)MEM_get_peak_memory() / (double)(1024 * 1024),
+	       MEM_get_memory_blocks_in_use());
+}
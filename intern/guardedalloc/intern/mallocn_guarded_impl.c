@@ -118,6 +118,8 @@ typedef struct MemHead {
 	short alignment;  /* if non-zero aligned alloc was used
 	                   * and alignment is stored here.
 	                   */
+	short category;  /* eMEM_Category */
+	short pad;
 #ifdef DEBUG_MEMCOUNTER
 	int _count;
 #endif
@@ -492,6 +494,7 @@ static void make_memhead_header(MemHead *memh, size_t len, const char *str)
 	memh->len = len;
 	memh->mmap = 0;
 	memh->alignment = 0;
+	memh->category = (short)MEM_CATEGORY_ACTIVE;
 	memh->tag2 = MEMTAG2;
 
 #ifdef DEBUG_MEMDUPLINAME
@@ -507,6 +510,7 @@ static void make_memhead_header(MemHead *memh, size_t len, const char *str)
 
 	atomic_add_and_fetch_u(&totblock, 1);
 	atomic_add_and_fetch_z(&mem_in_use, len);
+	mem_category_add(memh->category, len);
 
 	mem_lock_thread();
 	addtail(membase, &memh->next);
@@ -1009,6 +1013,7 @@ static void rem_memblock(MemHead *memh)
 
 	atomic_sub_and_fetch_u(&totblock, 1);
 	atomic_sub_and_fetch_z(&mem_in_use, memh->len);
+	mem_category_sub(memh->category, memh->len);
 
 #ifdef DEBUG_MEMDUPLINAME
 	if (memh->need_free_name)
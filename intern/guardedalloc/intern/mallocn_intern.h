@@ -32,6 +32,8 @@
 #ifndef __MALLOCN_INTERN_H__
 #define __MALLOCN_INTERN_H__
 
+#include "atomic_ops.h"
+
 /* mmap exception */
 #if defined(WIN32)
 #  include "mmap_win.h"
@@ -106,6 +108,63 @@
 
 #define IS_POW2(a) (((a) & ((a) - 1)) == 0)
 
+#if defined(_MSC_VER)
+#  define MEM_THREAD_LOCAL __declspec(thread)
+#else
+#  define MEM_THREAD_LOCAL __thread
+#endif
+
+/* Memory categories, stored in the top bits of the block length
+ * (which leaves 2^56 bytes per block), so only on 64 bit systems. */
+#if defined(__LP64__) || defined(_WIN64)
+#  define USE_MEM_CATEGORIES
+#endif
+
+#ifdef USE_MEM_CATEGORIES
+#  define MEMHEAD_CATEGORY_SHIFT 56
+#  define MEMHEAD_CATEGORY_MASK ((size_t)0xff << MEMHEAD_CATEGORY_SHIFT)
+#  define MEMHEAD_CATEGORY_FROM_LEN(len) ((int)((len) >> MEMHEAD_CATEGORY_SHIFT))
+#  define MEMHEAD_CATEGORY_TO_LEN(category) ((size_t)(category) << MEMHEAD_CATEGORY_SHIFT)
+#  define MEM_CATEGORY_ACTIVE mem_category_active
+
+/* Category of allocations made by this thread. */
+extern MEM_THREAD_LOCAL int mem_category_active;
+/* Counters per category, MEM_CATEGORY_NONE is not counted. */
+extern size_t mem_category_in_use[MEM_CATEGORY_TOT];
+extern size_t mem_category_peak[MEM_CATEGORY_TOT];
+extern unsigned int mem_category_blocks[MEM_CATEGORY_TOT];
+
+MEM_INLINE void mem_category_add(int category, size_t len)
+{
+	if (category != MEM_CATEGORY_NONE) {
+		const size_t in_use = atomic_add_and_fetch_z(&mem_category_in_use[category], len);
+		size_t peak = mem_category_peak[category];
+		atomic_add_and_fetch_u(&mem_category_blocks[category], 1);
+		while (peak < in_use) {
+			if (atomic_cas_z(&mem_category_peak[category], peak, in_use) == peak) {
+				break;
+			}
+			peak = mem_category_peak[category];
+		}
+	}
+}
+
+MEM_INLINE void mem_category_sub(int category, size_t len)
+{
+	if (category != MEM_CATEGORY_NONE) {
+		atomic_sub_and_fetch_z(&mem_category_in_use[category], len);
+		atomic_sub_and_fetch_u(&mem_category_blocks[category], 1);
+	}
+}
+#else
+#  define MEMHEAD_CATEGORY_MASK ((size_t)0)
+#  define MEMHEAD_CATEGORY_FROM_LEN(len) ((void)(len), MEM_CATEGORY_NONE)
+#  define MEMHEAD_CATEGORY_TO_LEN(category) ((void)(category), (size_t)0)
+#  define MEM_CATEGORY_ACTIVE MEM_CATEGORY_NONE
+#  define mem_category_add(category, len) ((void)(category), (void)(len))
+#  define mem_category_sub(category, len) ((void)(category), (void)(len))
+#endif
+
 /* Extra padding which needs to be applied on MemHead to make it aligned. */
 #define MEMHEAD_ALIGN_PADDING(alignment) ((size_t)alignment - (sizeof(MemHeadAligned) % (size_t)alignment))
 
@@ -169,4 +228,32 @@ size_t MEM_guarded_get_peak_memory(void) ATTR_WARN_UNUSED_RESULT;
 const char *MEM_guarded_name_ptr(void *vmemh);
 #endif
 
+/* Prototypes for thread caching allocator functions */
+size_t MEM_threadcache_allocN_len(const void *vmemh) ATTR_WARN_UNUSED_RESULT;
+void MEM_threadcache_freeN(void *vmemh);
+void *MEM_threadcache_dupallocN(const void *vmemh) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+void *MEM_threadcache_reallocN_id(void *vmemh, size_t len, const char *UNUSED(str)) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_ALLOC_SIZE(2);
+void *MEM_threadcache_recallocN_id(void *vmemh, size_t len, const char *UNUSED(str)) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_ALLOC_SIZE(2);
+void *MEM_threadcache_callocN(size_t len, const char *UNUSED(str)) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_ALLOC_SIZE(1) ATTR_NONNULL(2);
+void *MEM_threadcache_mallocN(size_t len, const char *UNUSED(str)) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_ALLOC_SIZE(1) ATTR_NONNULL(2);
+void *MEM_threadcache_mallocN_aligned(size_t len, size_t alignment, const char *UNUSED(str)) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_ALLOC_SIZE(1) ATTR_NONNULL(3);
+void *MEM_threadcache_mapallocN(size_t len, const char *UNUSED(str)) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_ALLOC_SIZE(1) ATTR_NONNULL(2);
+void MEM_threadcache_printmemlist_pydict(void);
+void MEM_threadcache_printmemlist(void);
+void MEM_threadcache_callbackmemlist(void (*func)(void *));
+void MEM_threadcache_printmemlist_stats(void);
+void MEM_threadcache_set_error_callback(void (*func)(const char *));
+bool MEM_threadcache_check_memory_integrity(void);
+void MEM_threadcache_set_lock_callback(void (*lock)(void), void (*unlock)(void));
+void MEM_threadcache_set_memory_debug(void);
+size_t MEM_threadcache_get_memory_in_use(void);
+size_t MEM_threadcache_get_mapped_memory_in_use(void);
+size_t MEM_threadcache_get_slab_memory_in_use(void);
+unsigned int MEM_threadcache_get_memory_blocks_in_use(void);
+void MEM_threadcache_reset_peak_memory(void);
+size_t MEM_threadcache_get_peak_memory(void) ATTR_WARN_UNUSED_RESULT;
+#ifndef NDEBUG
+const char *MEM_threadcache_name_ptr(void *vmemh);
+#endif
+
 #endif  /* __MALLOCN_INTERN_H__ */
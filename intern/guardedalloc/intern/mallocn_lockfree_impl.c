@@ -122,7 +122,7 @@ static void mem_unlock_thread(void)
 size_t MEM_lockfree_allocN_len(const void *vmemh)
 {
 	if (vmemh) {
-		return MEMHEAD_FROM_PTR(vmemh)->len & ~((size_t) (MEMHEAD_MMAP_FLAG | MEMHEAD_ALIGN_FLAG));
+		return MEMHEAD_FROM_PTR(vmemh)->len & ~((size_t) (MEMHEAD_MMAP_FLAG | MEMHEAD_ALIGN_FLAG) | MEMHEAD_CATEGORY_MASK);
 	}
 	else {
 		return 0;
@@ -144,6 +144,7 @@ void MEM_lockfree_freeN(void *vmemh)
 
 	atomic_sub_and_fetch_u(&totblock, 1);
 	atomic_sub_and_fetch_z(&mem_in_use, len);
+	mem_category_sub(MEMHEAD_CATEGORY_FROM_LEN(memh->len), len);
 
 	if (MEMHEAD_IS_MMAP(memh)) {
 		atomic_sub_and_fetch_z(&mmap_in_use, len);
@@ -286,9 +287,12 @@ void *MEM_lockfree_callocN(size_t len, const char *str)
 	memh = (MemHead *)calloc(1, len + sizeof(MemHead));
 
 	if (LIKELY(memh)) {
-		memh->len = len;
+		const int category = MEM_CATEGORY_ACTIVE;
+
+		memh->len = len | MEMHEAD_CATEGORY_TO_LEN(category);
 		atomic_add_and_fetch_u(&totblock, 1);
 		atomic_add_and_fetch_z(&mem_in_use, len);
+		mem_category_add(category, len);
 		update_maximum(&peak_mem, mem_in_use);
 
 		return PTR_FROM_MEMHEAD(memh);
@@ -307,13 +311,16 @@ void *MEM_lockfree_mallocN(size_t len, const char *str)
 	memh = (MemHead *)malloc(len + sizeof(MemHead));
 
 	if (LIKELY(memh)) {
+		const int category = MEM_CATEGORY_ACTIVE;
+
 		if (UNLIKELY(malloc_debug_memset && len)) {
 			memset(memh + 1, 255, len);
 		}
 
-		memh->len = len;
+		memh->len = len | MEMHEAD_CATEGORY_TO_LEN(category);
 		atomic_add_and_fetch_u(&totblock, 1);
 		atomic_add_and_fetch_z(&mem_in_use, len);
+		mem_category_add(category, len);
 		update_maximum(&peak_mem, mem_in_use);
 
 		return PTR_FROM_MEMHEAD(memh);
@@ -349,6 +356,8 @@ void *MEM_lockfree_mallocN_aligned(size_t len, size_t alignment, const char *str
 		len + extra_padding + sizeof(MemHeadAligned), alignment);
 
 	if (LIKELY(memh)) {
+		const int category = MEM_CATEGORY_ACTIVE;
+
 		/* We keep padding in the beginning of MemHead,
 		 * this way it's always possible to get MemHead
 		 * from the data pointer.
@@ -359,10 +368,11 @@ void *MEM_lockfree_mallocN_aligned(size_t len, size_t alignment, const char *str
 			memset(memh + 1, 255, len);
 		}
 
-		memh->len = len | (size_t) MEMHEAD_ALIGN_FLAG;
+		memh->len = len | (size_t) MEMHEAD_ALIGN_FLAG | MEMHEAD_CATEGORY_TO_LEN(category);
 		memh->alignment = (short) alignment;
 		atomic_add_and_fetch_u(&totblock, 1);
 		atomic_add_and_fetch_z(&mem_in_use, len);
+		mem_category_add(category, len);
 		update_maximum(&peak_mem, mem_in_use);
 
 		return PTR_FROM_MEMHEAD(memh);
@@ -395,10 +405,13 @@ void *MEM_lockfree_mapallocN(size_t len, const char *str)
 #endif
 
 	if (memh != (MemHead *)-1) {
-		memh->len = len | (size_t) MEMHEAD_MMAP_FLAG;
+		const int category = MEM_CATEGORY_ACTIVE;
+
+		memh->len = len | (size_t) MEMHEAD_MMAP_FLAG | MEMHEAD_CATEGORY_TO_LEN(category);
 		atomic_add_and_fetch_u(&totblock, 1);
 		atomic_add_and_fetch_z(&mem_in_use, len);
 		atomic_add_and_fetch_z(&mmap_in_use, len);
+		mem_category_add(category, len);
 
 		update_maximum(&peak_mem, mem_in_use);
 		update_maximum(&peak_mem, mmap_in_use);
@@ -0,0 +1,983 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file guardedalloc/intern/mallocn_threadcache_impl.c
+ *  \ingroup MEM
+ *
+ * Memory allocation which keeps small blocks in per-thread caches.
+ *
+ * Small blocks are rounded up to a fixed set of size classes. Every thread
+ * owns a free list per size class, so the common allocation and free paths
+ * touch neither the system allocator nor any shared state. Free lists
+ * exchange blocks in batches with a central (locked) free list per class,
+ * and new blocks are carved from slabs. The central free list keeps blocks
+ * grouped by slab, a slab is returned to the system once all of its blocks
+ * are back in the central list (e.g. after the threads using it exited).
+ *
+ * Memory counters are kept per thread as well and only merged into the global
+ * counters once they drift far enough, queries sum up all threads.
+ *
+ * Blocks use the same header as the lock-free allocator, so alignment and
+ * #MEM_allocN_len behave the same.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h> /* memcpy */
+#include <stdarg.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <pthread.h>
+
+#include "MEM_guardedalloc.h"
+
+/* to ensure strict conversions */
+#include "../../source/blender/blenlib/BLI_strict_flags.h"
+
+#include "atomic_ops.h"
+#include "mallocn_intern.h"
+
+typedef struct MemHead {
+	/* Length of allocated memory block. */
+	size_t len;
+} MemHead;
+
+typedef struct MemHeadAligned {
+	short alignment;
+	size_t len;
+} MemHeadAligned;
+
+/* A free block, stored in place of the MemHead. */
+typedef struct FreeBlock {
+	struct FreeBlock *next;
+} FreeBlock;
+
+enum {
+	MEMHEAD_ALIGN_FLAG = 2,
+};
+
+#define MEMHEAD_FROM_PTR(ptr) (((MemHead*) ptr) - 1)
+#define PTR_FROM_MEMHEAD(memhead) (memhead + 1)
+#define MEMHEAD_ALIGNED_FROM_PTR(ptr) (((MemHeadAligned*) ptr) - 1)
+#define MEMHEAD_IS_ALIGNED(memhead) ((memhead)->len & (size_t) MEMHEAD_ALIGN_FLAG)
+
+/* Size classes (sizes include the MemHead):
+ * - Steps of 16 bytes up to SIZE_CLASS_SMALL_MAX.
+ * - Four steps per power of two above that, up to SIZE_CLASS_MAX.
+ * Larger blocks go directly to the system allocator. */
+#define SIZE_CLASS_SMALL_MAX 1024
+#define SIZE_CLASS_SMALL_NUM (SIZE_CLASS_SMALL_MAX / 16)
+#define SIZE_CLASS_MAX 32768
+#define SIZE_CLASS_NUM (SIZE_CLASS_SMALL_NUM + 4 * 5)
+
+/* Slabs are carved into blocks of a single size class,
+ * they are aligned to their size so a block can find its slab. */
+#define SLAB_SIZE (64 * 1024)
+#define SLAB_HEAD_SIZE 32
+/* Upper bound of blocks moved between a thread and the central free list at once. */
+#define BATCH_LEN_MAX 64
+/* Per thread memory counter drift before merging into the global counters. */
+#define STATS_MERGE_THRESHOLD (1 << 20)
+
+#define IS_BLOCK_CACHED(len) ((len) + sizeof(MemHead) <= SIZE_CLASS_MAX)
+
+typedef struct ThreadCache {
+	struct ThreadCache *next, *prev;
+	FreeBlock *free_list[SIZE_CLASS_NUM];
+	unsigned int free_len[SIZE_CLASS_NUM];
+	/* Counters not merged into the global ones yet,
+	 * negative when blocks were allocated by another thread. */
+	ptrdiff_t totblock_delta;
+	ptrdiff_t mem_in_use_delta;
+} ThreadCache;
+
+/* Stored at the start of every slab, only accessed with the central free list locked. */
+typedef struct Slab {
+	/* Slabs with blocks in the central free list. */
+	struct Slab *next, *prev;
+	/* Blocks of this slab in the central free list. */
+	FreeBlock *free;
+	unsigned int free_len;
+} Slab;
+
+typedef struct CentralFreeList {
+	pthread_mutex_t mutex;
+	Slab *first;
+	unsigned int len;
+	/* A slab with all blocks free which is kept instead of being released,
+	 * so a thread handing out and taking back a batch doesn't allocate a slab every time. */
+	Slab *spare;
+} CentralFreeList;
+
+static unsigned int totblock = 0;
+static size_t mem_in_use = 0, peak_mem = 0;
+/* Memory held by slabs, including free blocks. */
+static size_t slab_mem = 0;
+static bool malloc_debug_memset = false;
+
+static void (*error_callback)(const char *) = NULL;
+
+static CentralFreeList central_free_list[SIZE_CLASS_NUM];
+static pthread_once_t central_free_list_once = PTHREAD_ONCE_INIT;
+
+/* All thread caches, for reading statistics. */
+static ThreadCache *thread_cache_first = NULL;
+static pthread_mutex_t thread_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t thread_cache_key;
+
+static MEM_THREAD_LOCAL ThreadCache *thread_cache = NULL;
+
+#define USE_ATOMIC_MAX
+
+MEM_INLINE void update_maximum(size_t *maximum_value, size_t value)
+{
+#ifdef USE_ATOMIC_MAX
+	size_t prev_value = *maximum_value;
+	while (prev_value < value) {
+		if (atomic_cas_z(maximum_value, prev_value, value) != prev_value) {
+			break;
+		}
+	}
+#else
+	*maximum_value = value > *maximum_value ? value : *maximum_value;
+#endif
+}
+
+#ifdef __GNUC__
+__attribute__ ((format(printf, 1, 2)))
+#endif
+static void print_error(const char *str, ...)
+{
+	char buf[512];
+	va_list ap;
+
+	va_start(ap, str);
+	vsnprintf(buf, sizeof(buf), str, ap);
+	va_end(ap);
+	buf[sizeof(buf) - 1] = '\0';
+
+	if (error_callback) {
+		error_callback(buf);
+	}
+}
+
+/* -------------------------------------------------------------------- */
+/* Size Classes */
+
+MEM_INLINE unsigned int highest_bit(size_t value)
+{
+#if defined(__GNUC__)
+	return (unsigned int)(sizeof(unsigned long long) * 8 - 1) - (unsigned int)__builtin_clzll(value);
+#else
+	unsigned int bit = 0;
+	while (value >>= 1) {
+		bit++;
+	}
+	return bit;
+#endif
+}
+
+/* \a size includes the MemHead. */
+MEM_INLINE unsigned int size_class_index(size_t size)
+{
+	if (size <= SIZE_CLASS_SMALL_MAX) {
+		return (unsigned int)((size - 1) >> 4);
+	}
+	else {
+		const unsigned int bit = highest_bit(size - 1);
+		return SIZE_CLASS_SMALL_NUM + (bit - 10) * 4 + (unsigned int)(((size - 1) >> (bit - 2)) & 3);
+	}
+}
+
+MEM_INLINE size_t size_class_size(unsigned int size_class)
+{
+	if (size_class < SIZE_CLASS_SMALL_NUM) {
+		return (size_t)(size_class + 1) * 16;
+	}
+	else {
+		const unsigned int step = size_class - SIZE_CLASS_SMALL_NUM;
+		const unsigned int bit = 10 + step / 4;
+		return ((size_t)1 << bit) + (size_t)(step % 4 + 1) * ((size_t)1 << (bit - 2));
+	}
+}
+
+/* At least four blocks per slab, rounded up to a power of two. */
+MEM_INLINE size_t size_class_slab_size(unsigned int size_class)
+{
+	const size_t min_size = size_class_size(size_class) * 4 + SLAB_HEAD_SIZE;
+	size_t slab_size = SLAB_SIZE;
+	while (slab_size < min_size) {
+		slab_size <<= 1;
+	}
+	return slab_size;
+}
+
+MEM_INLINE unsigned int size_class_slab_blocks(unsigned int size_class)
+{
+	return (unsigned int)((size_class_slab_size(size_class) - SLAB_HEAD_SIZE) / size_class_size(size_class));
+}
+
+MEM_INLINE unsigned int size_class_batch_len(unsigned int size_class)
+{
+	const size_t batch_len = (SLAB_SIZE / 2) / size_class_size(size_class);
+	return (unsigned int)(batch_len < 2 ? 2 : (batch_len > BATCH_LEN_MAX ? BATCH_LEN_MAX : batch_len));
+}
+
+/* -------------------------------------------------------------------- */
+/* Slabs */
+
+static Slab *slab_alloc(unsigned int size_class)
+{
+	const size_t slab_size = size_class_slab_size(size_class);
+	void *slab;
+
+#ifdef _WIN32
+	slab = _aligned_malloc(slab_size, slab_size);
+#else
+	if (posix_memalign(&slab, slab_size, slab_size) != 0) {
+		slab = NULL;
+	}
+#endif
+	if (LIKELY(slab)) {
+		memset(slab, 0, sizeof(Slab));
+		atomic_add_and_fetch_z(&slab_mem, slab_size);
+	}
+	return slab;
+}
+
+static void slab_free(Slab *slab, unsigned int size_class)
+{
+	atomic_sub_and_fetch_z(&slab_mem, size_class_slab_size(size_class));
+#ifdef _WIN32
+	_aligned_free(slab);
+#else
+	free(slab);
+#endif
+}
+
+MEM_INLINE Slab *slab_from_block(FreeBlock *block, unsigned int size_class)
+{
+	return (Slab *)((uintptr_t)block & ~(uintptr_t)(size_class_slab_size(size_class) - 1));
+}
+
+/* -------------------------------------------------------------------- */
+/* Central Free Lists */
+
+static void thread_cache_free(void *cache_v);
+
+static void central_free_list_init(void)
+{
+	unsigned int i;
+	for (i = 0; i < SIZE_CLASS_NUM; i++) {
+		pthread_mutex_init(&central_free_list[i].mutex, NULL);
+	}
+	pthread_key_create(&thread_cache_key, thread_cache_free);
+}
+
+static void central_slab_unlink(CentralFreeList *central, Slab *slab)
+{
+	if (slab->prev) {
+		slab->prev->next = slab->next;
+	}
+	else {
+		central->first = slab->next;
+	}
+	if (slab->next) {
+		slab->next->prev = slab->prev;
+	}
+	slab->next = slab->prev = NULL;
+}
+
+/* Give \a len blocks linked from \a first back, slabs which are completely free are released. */
+static void central_free_list_push(unsigned int size_class, FreeBlock *first, unsigned int len)
+{
+	CentralFreeList *central = &central_free_list[size_class];
+	const unsigned int slab_blocks = size_class_slab_blocks(size_class);
+	Slab *slabs_release = NULL;
+
+	pthread_mutex_lock(&central->mutex);
+	while (len--) {
+		FreeBlock *block = first;
+		Slab *slab = slab_from_block(block, size_class);
+		first = block->next;
+
+		if (slab->free_len == 0) {
+			slab->next = central->first;
+			if (central->first) {
+				central->first->prev = slab;
+			}
+			central->first = slab;
+		}
+		block->next = slab->free;
+		slab->free = block;
+		slab->free_len++;
+		central->len++;
+
+		if (slab->free_len == slab_blocks) {
+			if (central->spare == NULL) {
+				central->spare = slab;
+			}
+			else {
+				/* Release outside of the lock. */
+				central_slab_unlink(central, slab);
+				central->len -= slab->free_len;
+				slab->next = slabs_release;
+				slabs_release = slab;
+			}
+		}
+	}
+	pthread_mutex_unlock(&central->mutex);
+
+	while (slabs_release) {
+		Slab *slab = slabs_release;
+		slabs_release = slab->next;
+		slab_free(slab, size_class);
+	}
+}
+
+/* Take up to \a len_max blocks, returns the number of blocks linked from \a r_first. */
+static unsigned int central_free_list_pop(unsigned int size_class, unsigned int len_max, FreeBlock **r_first)
+{
+	CentralFreeList *central = &central_free_list[size_class];
+	FreeBlock *first = NULL;
+	unsigned int len = 0;
+
+	pthread_mutex_lock(&central->mutex);
+	while (len < len_max && central->first) {
+		Slab *slab = central->first;
+		FreeBlock *block = slab->free;
+
+		slab->free = block->next;
+		slab->free_len--;
+		block->next = first;
+		first = block;
+		len++;
+
+		if (central->spare == slab) {
+			central->spare = NULL;
+		}
+		if (slab->free_len == 0) {
+			central_slab_unlink(central, slab);
+		}
+	}
+	central->len -= len;
+	pthread_mutex_unlock(&central->mutex);
+
+	*r_first = first;
+	return len;
+}
+
+/* -------------------------------------------------------------------- */
+/* Thread Caches */
+
+static void thread_cache_stats_merge(ThreadCache *cache)
+{
+	atomic_add_and_fetch_u(&totblock, (unsigned int)cache->totblock_delta);
+	update_maximum(&peak_mem, atomic_add_and_fetch_z(&mem_in_use, (size_t)cache->mem_in_use_delta));
+	cache->totblock_delta = 0;
+	cache->mem_in_use_delta = 0;
+}
+
+MEM_INLINE void thread_cache_stats_add(ThreadCache *cache, ptrdiff_t blocks, ptrdiff_t len)
+{
+	cache->totblock_delta += blocks;
+	cache->mem_in_use_delta += len;
+
+	if (UNLIKELY(cache->mem_in_use_delta > STATS_MERGE_THRESHOLD ||
+	             cache->mem_in_use_delta < -STATS_MERGE_THRESHOLD))
+	{
+		thread_cache_stats_merge(cache);
+	}
+}
+
+/* For blocks not going through a thread cache. */
+MEM_INLINE void global_stats_add(size_t len)
+{
+	atomic_add_and_fetch_u(&totblock, 1);
+	update_maximum(&peak_mem, atomic_add_and_fetch_z(&mem_in_use, len));
+}
+
+MEM_INLINE void global_stats_sub(size_t len)
+{
+	atomic_sub_and_fetch_u(&totblock, 1);
+	atomic_sub_and_fetch_z(&mem_in_use, len);
+}
+
+static ThreadCache *thread_cache_create(void)
+{
+	ThreadCache *cache;
+
+	pthread_once(&central_free_list_once, central_free_list_init);
+
+	cache = calloc(1, sizeof(ThreadCache));
+	if (UNLIKELY(cache == NULL)) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&thread_cache_mutex);
+	cache->next = thread_cache_first;
+	if (thread_cache_first) {
+		thread_cache_first->prev = cache;
+	}
+	thread_cache_first = cache;
+	pthread_mutex_unlock(&thread_cache_mutex);
+
+	/* Only used to get #thread_cache_free called on thread exit. */
+	pthread_setspecific(thread_cache_key, cache);
+	thread_cache = cache;
+
+	return cache;
+}
+
+/* Called on thread exit, hands all free blocks and counters over to the global state. */
+static void thread_cache_free(void *cache_v)
+{
+	ThreadCache *cache = cache_v;
+	unsigned int i;
+
+	for (i = 0; i < SIZE_CLASS_NUM; i++) {
+		if (cache->free_list[i]) {
+			central_free_list_push(i, cache->free_list[i], cache->free_len[i]);
+		}
+	}
+
+	pthread_mutex_lock(&thread_cache_mutex);
+	thread_cache_stats_merge(cache);
+	if (cache->prev) {
+		cache->prev->next = cache->next;
+	}
+	else {
+		thread_cache_first = cache->next;
+	}
+	if (cache->next) {
+		cache->next->prev = cache->prev;
+	}
+	pthread_mutex_unlock(&thread_cache_mutex);
+
+	if (thread_cache == cache) {
+		thread_cache = NULL;
+	}
+	free(cache);
+}
+
+MEM_INLINE ThreadCache *thread_cache_get(void)
+{
+	ThreadCache *cache = thread_cache;
+	if (UNLIKELY(cache == NULL)) {
+		cache = thread_cache_create();
+	}
+	return cache;
+}
+
+/* Fill an empty free list, from the central free list or a new slab. */
+static FreeBlock *thread_cache_refill(ThreadCache *cache, unsigned int size_class)
+{
+	FreeBlock *first;
+	unsigned int len = central_free_list_pop(size_class, size_class_batch_len(size_class), &first);
+
+	if (first == NULL) {
+		const size_t block_size = size_class_size(size_class);
+		char *slab = (char *)slab_alloc(size_class);
+		size_t ofs;
+
+		if (UNLIKELY(slab == NULL)) {
+			return NULL;
+		}
+
+		/* Link in reverse, so blocks are handed out in address order. */
+		for (ofs = SLAB_HEAD_SIZE + size_class_slab_blocks(size_class) * block_size;
+		     ofs != SLAB_HEAD_SIZE;
+		     ofs -= block_size)
+		{
+			FreeBlock *block = (FreeBlock *)(slab + ofs - block_size);
+			block->next = first;
+			first = block;
+			len++;
+		}
+	}
+
+	cache->free_list[size_class] = first;
+	cache->free_len[size_class] = len;
+	return first;
+}
+
+MEM_INLINE MemHead *thread_cache_block_alloc(ThreadCache *cache, unsigned int size_class)
+{
+	FreeBlock *block = cache->free_list[size_class];
+
+	if (UNLIKELY(block == NULL)) {
+		block = thread_cache_refill(cache, size_class);
+		if (UNLIKELY(block == NULL)) {
+			return NULL;
+		}
+	}
+
+	cache->free_list[size_class] = block->next;
+	cache->free_len[size_class]--;
+	return (MemHead *)block;
+}
+
+MEM_INLINE void thread_cache_block_free(ThreadCache *cache, MemHead *memh, unsigned int size_class)
+{
+	FreeBlock *block = (FreeBlock *)memh;
+
+	block->next = cache->free_list[size_class];
+	cache->free_list[size_class] = block;
+	cache->free_len[size_class]++;
+
+	/* Give a batch back, so memory freed on one thread can be reused by others. */
+	if (UNLIKELY(cache->free_len[size_class] > 2 * size_class_batch_len(size_class))) {
+		const unsigned int batch_len = size_class_batch_len(size_class);
+		FreeBlock *first = cache->free_list[size_class];
+		FreeBlock *last = first;
+		unsigned int i;
+
+		for (i = 1; i < batch_len; i++) {
+			last = last->next;
+		}
+		cache->free_list[size_class] = last->next;
+		cache->free_len[size_class] -= batch_len;
+		central_free_list_push(size_class, first, batch_len);
+	}
+}
+
+/* Allocate a block of \a len bytes (not including the MemHead), which must be cached. */
+MEM_INLINE MemHead *block_alloc(size_t len)
+{
+	ThreadCache *cache = thread_cache_get();
+	MemHead *memh;
+
+	if (UNLIKELY(cache == NULL)) {
+		return NULL;
+	}
+
+	memh = thread_cache_block_alloc(cache, size_class_index(len + sizeof(MemHead)));
+	if (LIKELY(memh)) {
+		thread_cache_stats_add(cache, 1, (ptrdiff_t)len);
+	}
+	return memh;
+}
+
+MEM_INLINE void block_free(MemHead *memh, size_t len)
+{
+	ThreadCache *cache = thread_cache_get();
+	const unsigned int size_class = size_class_index(len + sizeof(MemHead));
+
+	if (LIKELY(cache)) {
+		thread_cache_block_free(cache, memh, size_class);
+		thread_cache_stats_add(cache, -1, -(ptrdiff_t)len);
+	}
+	else {
+		central_free_list_push(size_class, (FreeBlock *)memh, 1);
+		global_stats_sub(len);
+	}
+}
+
+/* -------------------------------------------------------------------- */
+/* MEM API */
+
+size_t MEM_threadcache_allocN_len(const void *vmemh)
+{
+	if (vmemh) {
+		return MEMHEAD_FROM_PTR(vmemh)->len & ~((size_t) MEMHEAD_ALIGN_FLAG | MEMHEAD_CATEGORY_MASK);
+	}
+	else {
+		return 0;
+	}
+}
+
+void MEM_threadcache_freeN(void *vmemh)
+{
+	MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+	size_t len = MEM_threadcache_allocN_len(vmemh);
+
+	if (vmemh == NULL) {
+		print_error("Attempt to free NULL pointer\n");
+#ifdef WITH_ASSERT_ABORT
+		abort();
+#endif
+		return;
+	}
+
+	mem_category_sub(MEMHEAD_CATEGORY_FROM_LEN(memh->len), len);
+
+	if (UNLIKELY(malloc_debug_memset && len)) {
+		memset(memh + 1, 255, len);
+	}
+
+	if (UNLIKELY(MEMHEAD_IS_ALIGNED(memh))) {
+		MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+		global_stats_sub(len);
+		aligned_free(MEMHEAD_REAL_PTR(memh_aligned));
+	}
+	else if (LIKELY(IS_BLOCK_CACHED(len))) {
+		block_free(memh, len);
+	}
+	else {
+		global_stats_sub(len);
+		free(memh);
+	}
+}
+
+void *MEM_threadcache_dupallocN(const void *vmemh)
+{
+	void *newp = NULL;
+	if (vmemh) {
+		MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+		const size_t prev_size = MEM_threadcache_allocN_len(vmemh);
+		if (UNLIKELY(MEMHEAD_IS_ALIGNED(memh))) {
+			MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+			newp = MEM_threadcache_mallocN_aligned(
+				prev_size,
+				(size_t)memh_aligned->alignment,
+				"dupli_malloc");
+		}
+		else {
+			newp = MEM_threadcache_mallocN(prev_size, "dupli_malloc");
+		}
+		memcpy(newp, vmemh, prev_size);
+	}
+	return newp;
+}
+
+void *MEM_threadcache_reallocN_id(void *vmemh, size_t len, const char *str)
+{
+	void *newp = NULL;
+
+	if (vmemh) {
+		MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+		size_t old_len = MEM_threadcache_allocN_len(vmemh);
+
+		if (LIKELY(!MEMHEAD_IS_ALIGNED(memh))) {
+			/* Blocks of the same size class can be kept as they are. */
+			if (IS_BLOCK_CACHED(old_len) && IS_BLOCK_CACHED(SIZET_ALIGN_4(len)) &&
+			    (size_class_index(old_len + sizeof(MemHead)) ==
+			     size_class_index(SIZET_ALIGN_4(len) + sizeof(MemHead))))
+			{
+				const size_t new_len = SIZET_ALIGN_4(len);
+				ThreadCache *cache = thread_cache_get();
+				if (LIKELY(cache)) {
+					const int category = MEMHEAD_CATEGORY_FROM_LEN(memh->len);
+					thread_cache_stats_add(cache, 0, (ptrdiff_t)new_len - (ptrdiff_t)old_len);
+					mem_category_sub(category, old_len);
+					mem_category_add(category, new_len);
+					memh->len = new_len | MEMHEAD_CATEGORY_TO_LEN(category);
+					return vmemh;
+				}
+			}
+			newp = MEM_threadcache_mallocN(len, "realloc");
+		}
+		else {
+			MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+			newp = MEM_threadcache_mallocN_aligned(
+				len,
+				(size_t)memh_aligned->alignment,
+				"realloc");
+		}
+
+		if (newp) {
+			if (len < old_len) {
+				/* shrink */
+				memcpy(newp, vmemh, len);
+			}
+			else {
+				/* grow (or remain same size) */
+				memcpy(newp, vmemh, old_len);
+			}
+		}
+
+		MEM_threadcache_freeN(vmemh);
+	}
+	else {
+		newp = MEM_threadcache_mallocN(len, str);
+	}
+
+	return newp;
+}
+
+void *MEM_threadcache_recallocN_id(void *vmemh, size_t len, const char *str)
+{
+	void *newp = NULL;
+
+	if (vmemh) {
+		MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+		size_t old_len = MEM_threadcache_allocN_len(vmemh);
+
+		if (LIKELY(!MEMHEAD_IS_ALIGNED(memh))) {
+			newp = MEM_threadcache_mallocN(len, "recalloc");
+		}
+		else {
+			MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+			newp = MEM_threadcache_mallocN_aligned(len,
+			                                       (size_t)memh_aligned->alignment,
+			                                       "recalloc");
+		}
+
+		if (newp) {
+			if (len < old_len) {
+				/* shrink */
+				memcpy(newp, vmemh, len);
+			}
+			else {
+				memcpy(newp, vmemh, old_len);
+
+				if (len > old_len) {
+					/* grow */
+					/* zero new bytes */
+					memset(((char *)newp) + old_len, 0, len - old_len);
+				}
+			}
+		}
+
+		MEM_threadcache_freeN(vmemh);
+	}
+	else {
+		newp = MEM_threadcache_callocN(len, str);
+	}
+
+	return newp;
+}
+
+void *MEM_threadcache_callocN(size_t len, const char *str)
+{
+	MemHead *memh;
+
+	len = SIZET_ALIGN_4(len);
+
+	if (LIKELY(IS_BLOCK_CACHED(len))) {
+		memh = block_alloc(len);
+		if (LIKELY(memh)) {
+			memset(memh + 1, 0, len);
+		}
+	}
+	else {
+		memh = (MemHead *)calloc(1, len + sizeof(MemHead));
+		if (LIKELY(memh)) {
+			global_stats_add(len);
+		}
+	}
+
+	if (LIKELY(memh)) {
+		const int category = MEM_CATEGORY_ACTIVE;
+
+		memh->len = len | MEMHEAD_CATEGORY_TO_LEN(category);
+		mem_category_add(category, len);
+		return PTR_FROM_MEMHEAD(memh);
+	}
+	print_error("Calloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
+	            SIZET_ARG(len), str, (unsigned int) mem_in_use);
+	return NULL;
+}
+
+void *MEM_threadcache_mallocN(size_t len, const char *str)
+{
+	MemHead *memh;
+
+	len = SIZET_ALIGN_4(len);
+
+	if (LIKELY(IS_BLOCK_CACHED(len))) {
+		memh = block_alloc(len);
+	}
+	else {
+		memh = (MemHead *)malloc(len + sizeof(MemHead));
+		if (LIKELY(memh)) {
+			global_stats_add(len);
+		}
+	}
+
+	if (LIKELY(memh)) {
+		const int category = MEM_CATEGORY_ACTIVE;
+
+		if (UNLIKELY(malloc_debug_memset && len)) {
+			memset(memh + 1, 255, len);
+		}
+
+		memh->len = len | MEMHEAD_CATEGORY_TO_LEN(category);
+		mem_category_add(category, len);
+		return PTR_FROM_MEMHEAD(memh);
+	}
+	print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
+	            SIZET_ARG(len), str, (unsigned int) mem_in_use);
+	return NULL;
+}
+
+void *MEM_threadcache_mallocN_aligned(size_t len, size_t alignment, const char *str)
+{
+	MemHeadAligned *memh;
+
+	/* See MEM_lockfree_mallocN_aligned, aligned blocks are not cached. */
+	size_t extra_padding = MEMHEAD_ALIGN_PADDING(alignment);
+
+	assert(alignment < 1024);
+
+	/* We only support alignment to a power of two. */
+	assert(IS_POW2(alignment));
+
+	len = SIZET_ALIGN_4(len);
+
+	memh = (MemHeadAligned *)aligned_malloc(
+		len + extra_padding + sizeof(MemHeadAligned), alignment);
+
+	if (LIKELY(memh)) {
+		const int category = MEM_CATEGORY_ACTIVE;
+
+		memh = (MemHeadAligned *)((char *)memh + extra_padding);
+
+		if (UNLIKELY(malloc_debug_memset && len)) {
+			memset(memh + 1, 255, len);
+		}
+
+		memh->len = len | (size_t) MEMHEAD_ALIGN_FLAG | MEMHEAD_CATEGORY_TO_LEN(category);
+		memh->alignment = (short) alignment;
+		global_stats_add(len);
+		mem_category_add(category, len);
+
+		return PTR_FROM_MEMHEAD(memh);
+	}
+	print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
+	            SIZET_ARG(len), str, (unsigned int) mem_in_use);
+	return NULL;
+}
+
+void *MEM_threadcache_mapallocN(size_t len, const char *str)
+{
+	/* mmap is only used to get around 32 bit address space limitations,
+	 * see MEM_lockfree_mapallocN, this allocator targets 64 bit systems. */
+	return MEM_threadcache_callocN(len, str);
+}
+
+void MEM_threadcache_printmemlist_pydict(void)
+{
+}
+
+void MEM_threadcache_printmemlist(void)
+{
+}
+
+/* unused */
+void MEM_threadcache_callbackmemlist(void (*func)(void *))
+{
+	(void) func;  /* Ignored. */
+}
+
+void MEM_threadcache_printmemlist_stats(void)
+{
+	printf("\ntotal memory len: %.3f MB\n",
+	       (double)MEM_threadcache_get_memory_in_use() / (double)(1024 * 1024));
+	printf("peak memory len: %.3f MB\n",
+	       (double)peak_mem / (double)(1024 * 1024));
+	printf("thread cache slab len: %.3f MB\n",
+	       (double)slab_mem / (double)(1024 * 1024));
+	printf("\nFor more detailed per-block statistics run Blender with memory debugging command line argument.\n");
+
+#ifdef HAVE_MALLOC_STATS
+	printf("System Statistics:\n");
+	malloc_stats();
+#endif
+}
+
+void MEM_threadcache_set_error_callback(void (*func)(const char *))
+{
+	error_callback = func;
+}
+
+bool MEM_threadcache_check_memory_integrity(void)
+{
+	return true;
+}
+
+void MEM_threadcache_set_lock_callback(void (*lock)(void), void (*unlock)(void))
+{
+	/* Not needed, there is no mmap here. */
+	(void) lock;
+	(void) unlock;
+}
+
+void MEM_threadcache_set_memory_debug(void)
+{
+	malloc_debug_memset = true;
+}
+
+size_t MEM_threadcache_get_memory_in_use(void)
+{
+	ThreadCache *cache;
+	size_t result;
+
+	/* Counters of running threads are read without synchronization,
+	 * so the result is approximate while other threads allocate. */
+	pthread_mutex_lock(&thread_cache_mutex);
+	result = mem_in_use;
+	for (cache = thread_cache_first; cache; cache = cache->next) {
+		result += (size_t)cache->mem_in_use_delta;
+	}
+	pthread_mutex_unlock(&thread_cache_mutex);
+
+	return result;
+}
+
+size_t MEM_threadcache_get_mapped_memory_in_use(void)
+{
+	return 0;
+}
+
+/* Memory held by slabs, including blocks in use and free blocks. */
+size_t MEM_threadcache_get_slab_memory_in_use(void)
+{
+	return slab_mem;
+}
+
+unsigned int MEM_threadcache_get_memory_blocks_in_use(void)
+{
+	ThreadCache *cache;
+	unsigned int result;
+
+	pthread_mutex_lock(&thread_cache_mutex);
+	result = totblock;
+	for (cache = thread_cache_first; cache; cache = cache->next) {
+		result += (unsigned int)cache->totblock_delta;
+	}
+	pthread_mutex_unlock(&thread_cache_mutex);
+
+	return result;
+}
+
+void MEM_threadcache_reset_peak_memory(void)
+{
+	peak_mem = MEM_threadcache_get_memory_in_use();
+}
+
+size_t MEM_threadcache_get_peak_memory(void)
+{
+	/* Peak is only updated when counters are merged, account for the current use too. */
+	update_maximum(&peak_mem, MEM_threadcache_get_memory_in_use());
+	return peak_mem;
+}
+
+#ifndef NDEBUG
+const char *MEM_threadcache_name_ptr(void *vmemh)
+{
+	if (vmemh) {
+		return "unknown block name ptr";
+	}
+	else {
+		return "MEM_threadcache_name_ptr(NULL)";
+	}
+}
+#endif  /* NDEBUG */
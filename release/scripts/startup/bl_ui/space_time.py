@@ -222,6 +222,7 @@ class TIME_MT_playback(Menu):
         layout.separator()
 
         layout.prop(scene, "use_frame_drop", text="Frame Dropping")
+        layout.prop(scene, "use_playback_cache")
         layout.prop(scene, "use_audio_sync", text="AV-sync", icon='SPEAKER')
         layout.prop(scene, "use_audio")
         layout.prop(scene, "use_audio_scrub")
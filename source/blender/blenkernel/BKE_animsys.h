@@ -171,6 +171,9 @@ void BKE_animsys_evaluate_animdata(struct Scene *scene, struct ID *id, struct An
 /* Evaluation of all ID-blocks with Animation Data blocks - Animation Data Only */
 void BKE_animsys_evaluate_all_animation(struct Main *main, struct Scene *scene, float ctime);
 
+/* Drop RNA paths resolved for evaluation, when data they might point to was freed or renamed */
+void BKE_animsys_eval_cache_invalidate(void);
+
 /* TODO(sergey): This is mainly a temp public function. */
 struct FCurve;
 bool BKE_animsys_execute_fcurve(struct PointerRNA *ptr, struct AnimMapper *remap, struct FCurve *fcu, float curval);
@@ -91,6 +91,10 @@ void DAG_exit(void);
  * be rebuilt later. The graph is not rebuilt immediately to avoid slowdowns
  * when this function is call multiple times from different operators.
  *
+ * DAG_id_relations_tag_update is the same, but only relations of the given ID
+ * changed, which allows the new dependency graph to only rebuild the part of
+ * the graph around it.
+ *
  * DAG_scene_relations_rebuild forces an immediaterebuild of the dependency
  * graph, this is only needed in rare cases
  */
@@ -98,6 +102,7 @@ void DAG_exit(void);
 void DAG_scene_relations_update(struct Main *bmain, struct Scene *sce);
 void DAG_scene_relations_validate(struct Main *bmain, struct Scene *sce);
 void DAG_relations_tag_update(struct Main *bmain);
+void DAG_id_relations_tag_update(struct Main *bmain, struct ID *id);
 void DAG_scene_relations_rebuild(struct Main *bmain, struct Scene *scene);
 void DAG_scene_free(struct Scene *sce);
 
@@ -103,6 +103,8 @@ void driver_change_variable_type(struct DriverVar *dvar, int type);
 void driver_variable_name_validate(struct DriverVar *dvar);
 struct DriverVar *driver_add_new_variable(struct ChannelDriver *driver);
 
+void driver_invalidate_expression(struct ChannelDriver *driver, bool expr_changed, bool varname_changed);
+
 float driver_get_variable_value(struct ChannelDriver *driver, struct DriverVar *dvar);
 bool  driver_get_variable_property(
         struct ChannelDriver *driver, struct DriverTarget *dtar,
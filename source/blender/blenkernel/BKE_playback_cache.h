@@ -0,0 +1,70 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2017 Blender Foundation.
+ * All rights reserved.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+#ifndef __BKE_PLAYBACK_CACHE_H__
+#define __BKE_PLAYBACK_CACHE_H__
+
+/** \file BKE_playback_cache.h
+ *  \ingroup bke
+ *
+ * Cache of evaluated meshes and poses, filled while the animation is playing
+ * back and used instead of evaluating the same frame again on later loops.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "BKE_customdata.h"
+
+struct EvaluationContext;
+struct Object;
+struct Scene;
+
+/* Playback start and stop, the cache is only used in between. */
+void BKE_playback_cache_begin(struct Scene *scene);
+void BKE_playback_cache_end(void);
+bool BKE_playback_cache_is_active(void);
+
+/* Drop all cached frames, called whenever any data-block is tagged for update. */
+void BKE_playback_cache_invalidate(void);
+
+/* Wraps evaluation of a single frame, lookups and stores only happen in between. */
+void BKE_playback_cache_frame_begin(struct EvaluationContext *eval_ctx, struct Scene *scene);
+void BKE_playback_cache_frame_end(void);
+
+/* Evaluated mesh: restore sets derivedFinal and derivedDeform on success. */
+bool BKE_playback_cache_mesh_restore(struct Object *ob, CustomDataMask dataMask, bool need_mapping);
+void BKE_playback_cache_mesh_store(struct Object *ob, CustomDataMask dataMask, bool need_mapping);
+
+/* Evaluated pose: restore marks all channels as done on success. */
+bool BKE_playback_cache_pose_restore(struct Object *ob);
+void BKE_playback_cache_pose_store(struct Object *ob);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __BKE_PLAYBACK_CACHE_H__ */
@@ -62,6 +62,7 @@
 #include "BKE_object.h"
 #include "BKE_object_deform.h"
 #include "BKE_paint.h"
+#include "BKE_playback_cache.h"
 #include "BKE_texture.h"
 #include "BKE_multires.h"
 #include "BKE_bvhutils.h"
@@ -2618,6 +2619,8 @@ static void mesh_build_data(
         Scene *scene, Object *ob, CustomDataMask dataMask,
         const bool build_shapekey_layers, const bool need_mapping)
 {
+	bool use_playback_cache = true;
+
 	BLI_assert(ob->type == OB_MESH);
 
 	BKE_object_free_derived_caches(ob);
@@ -2626,13 +2629,26 @@ static void mesh_build_data(
 #ifdef WITH_OPENSUBDIV
 	if (calc_modifiers_skip_orco(scene, ob, false)) {
 		dataMask &= ~(CD_MASK_ORCO | CD_MASK_PREVIEW_MCOL);
+		/* Subdivided on the GPU, there is no CPU side mesh to copy. */
+		use_playback_cache = false;
 	}
 #endif
 
-	mesh_calc_modifiers(
-	        scene, ob, NULL, false, 1, need_mapping, dataMask, -1, true, build_shapekey_layers,
-	        true,
-	        &ob->derivedDeform, &ob->derivedFinal);
+	{
+		const int mem_category = MEM_category_begin(MEM_CATEGORY_MESH);
+		if (!use_playback_cache ||
+		    !BKE_playback_cache_mesh_restore(ob, dataMask, need_mapping))
+		{
+			mesh_calc_modifiers(
+			        scene, ob, NULL, false, 1, need_mapping, dataMask, -1, true, build_shapekey_layers,
+			        true,
+			        &ob->derivedDeform, &ob->derivedFinal);
+			if (use_playback_cache) {
+				BKE_playback_cache_mesh_store(ob, dataMask, need_mapping);
+			}
+		}
+		MEM_category_end(mem_category);
+	}
 
 	DM_set_object_boundbox(ob, ob->derivedFinal);
 
@@ -2664,9 +2680,13 @@ static void editbmesh_build_data(Scene *scene, Object *obedit, BMEditMesh *em, C
 	}
 #endif
 
-	editbmesh_calc_modifiers(
-	        scene, obedit, em, dataMask,
-	        &em->derivedCage, &em->derivedFinal);
+	{
+		const int mem_category = MEM_category_begin(MEM_CATEGORY_MESH);
+		editbmesh_calc_modifiers(
+		        scene, obedit, em, dataMask,
+		        &em->derivedCage, &em->derivedFinal);
+		MEM_category_end(mem_category);
+	}
 
 	DM_set_object_boundbox(obedit, em->derivedFinal);
 
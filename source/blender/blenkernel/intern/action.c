@@ -669,6 +669,9 @@ void BKE_pose_channels_hash_make(bPose *pose)
 
 void BKE_pose_channels_hash_free(bPose *pose) 
 {
+	/* channels were added, removed or moved to another pose */
+	BKE_animsys_eval_cache_invalidate();
+
 	if (pose->chanhash) {
 		BLI_ghash_free(pose->chanhash, NULL, NULL);
 		pose->chanhash = NULL;
@@ -748,6 +751,9 @@ void BKE_pose_channels_remove(
  */
 void BKE_pose_channel_free_ex(bPoseChannel *pchan, bool do_id_user)
 {
+	/* animation evaluation may keep pointers to the channel */
+	BKE_animsys_eval_cache_invalidate();
+
 	if (pchan->custom) {
 		if (do_id_user) {
 			id_us_min(&pchan->custom->id);
@@ -72,6 +72,8 @@
 
 #include "RNA_access.h"
 
+#include "atomic_ops.h"
+
 #include "nla_private.h"
 
 /* ***************************************** */
@@ -219,6 +221,8 @@ bool BKE_animdata_set_action(ReportList *reports, ID *id, bAction *act)
 
 /* Freeing -------------------------------------------- */
 
+static void animdata_eval_cache_free(AnimData *adt);
+
 /* Free AnimData used by the nominated ID-block, and clear ID-block's AnimData pointer */
 void BKE_animdata_free(ID *id, const bool do_id_user)
 {
@@ -249,6 +253,9 @@ void BKE_animdata_free(ID *id, const bool do_id_user)
 			/* free overrides */
 			/* TODO... */
 			
+			/* free runtime evaluation data */
+			animdata_eval_cache_free(adt);
+			
 			/* free animdata now */
 			MEM_freeN(adt);
 			iat->adt = NULL;
@@ -287,6 +294,9 @@ AnimData *BKE_animdata_copy(AnimData *adt, const bool do_action)
 	/* don't copy overrides */
 	BLI_listbase_clear(&dadt->overrides);
 	
+	/* runtime data is rebuilt on evaluation */
+	dadt->eval_cache = NULL;
+	
 	/* return */
 	return dadt;
 }
@@ -731,6 +741,8 @@ static void fcurves_path_rename_fix(ID *owner_id, const char *prefix, const char
 				if ((agrp) && STREQ(oldName, agrp->name)) {
 					BLI_strncpy(agrp->name, newName, sizeof(agrp->name));
 				}
+
+				BKE_animsys_eval_cache_invalidate();
 			}
 		}
 	}
@@ -959,6 +971,7 @@ static void fcurves_path_remove_fix(const char *prefix, ListBase *curves)
 			if (STRPREFIX(fcu->rna_path, prefix)) {
 				BLI_remlink(curves, fcu);
 				free_fcurve(fcu);
+				BKE_animsys_eval_cache_invalidate();
 			}
 		}
 	}
@@ -1757,6 +1770,198 @@ void animsys_evaluate_action(PointerRNA *ptr, bAction *act, AnimMapper *remap, f
 	animsys_evaluate_fcurves(ptr, &act->curves, remap, ctime);
 }
 
+/* ----------------------------------------- */
+
+/* Evaluation Cache
+ *
+ * Resolving the RNA path of every F-Curve on every frame dominates the evaluation
+ * time of scenes with many animated channels. The paths of the active action are
+ * therefore resolved once per AnimData and reused until the action, its F-Curves or
+ * their paths change.
+ *
+ * Only pointers which can't dangle while the ID exists are kept, see
+ * animsys_eval_cache_pointer_is_stable(), other channels are resolved on every evaluation.
+ * Freeing pose channels, relations and ID update tags, renames and the RNA functions
+ * adding or removing collection items also bump the global generation
+ * (see BKE_animsys_eval_cache_invalidate()), which resolves all paths again.
+ */
+
+typedef struct AnimEvalCacheChannel {
+	FCurve *fcu;
+	/* path the channel was resolved for, to detect changes */
+	const char *rna_path;
+	int array_index;
+	/* only set when the resolved pointer stays valid, otherwise resolved on every evaluation */
+	bool use_cache;
+	PathResolvedRNA anim_rna;
+} AnimEvalCacheChannel;
+
+typedef struct AnimEvalCache {
+	ID *id;
+	bAction *action;
+	unsigned int generation;
+	int totchannel;
+	AnimEvalCacheChannel *channels;
+} AnimEvalCache;
+
+static unsigned int animsys_eval_cache_generation = 0;
+
+void BKE_animsys_eval_cache_invalidate(void)
+{
+	atomic_add_and_fetch_u(&animsys_eval_cache_generation, 1);
+}
+
+static void animdata_eval_cache_free(AnimData *adt)
+{
+	if (adt->eval_cache) {
+		MEM_SAFE_FREE(adt->eval_cache->channels);
+		MEM_freeN(adt->eval_cache);
+		adt->eval_cache = NULL;
+	}
+}
+
+/* Whether the data a channel resolved to lives as long as the animated ID. */
+static bool animsys_eval_cache_pointer_is_stable(const PointerRNA *ptr, const PathResolvedRNA *anim_rna)
+{
+	ID *id = ptr->id.data;
+	PropertyRNA *prop = anim_rna->prop;
+	const char *data = anim_rna->ptr.data;
+
+	/* ID-properties can be removed or replaced without any update tag */
+	if (RNA_property_is_idprop(prop) || (RNA_property_flag(prop) & PROP_IDPROPERTY)) {
+		return false;
+	}
+	/* data of another ID, which can be freed or reassigned on its own */
+	if (anim_rna->ptr.id.data != id) {
+		return false;
+	}
+	/* stored in the ID itself, including its embedded structs (render settings for example) */
+	if ((data >= (const char *)id) && (data < (const char *)id + MEM_allocN_len(id))) {
+		return true;
+	}
+	/* pose channels are only freed by BKE_pose_channel_free_ex(), which invalidates the cache */
+	if (anim_rna->ptr.type == &RNA_PoseBone) {
+		return true;
+	}
+	/* anything else (modifiers, sequence strips, mesh elements...) may be freed or
+	 * reallocated by code that doesn't know about the cache */
+	return false;
+}
+
+static bool animsys_eval_cache_is_valid(AnimEvalCache *cache, PointerRNA *ptr, bAction *act)
+{
+	FCurve *fcu;
+	int i;
+
+	if ((cache->generation != animsys_eval_cache_generation) ||
+	    (cache->id != ptr->id.data) ||
+	    (cache->action != act))
+	{
+		return false;
+	}
+
+	for (fcu = act->curves.first, i = 0; fcu; fcu = fcu->next, i++) {
+		const AnimEvalCacheChannel *channel;
+
+		if (i >= cache->totchannel) {
+			return false;
+		}
+
+		channel = &cache->channels[i];
+		if ((channel->fcu != fcu) ||
+		    (channel->rna_path != fcu->rna_path) ||
+		    (channel->array_index != fcu->array_index))
+		{
+			return false;
+		}
+	}
+
+	return (i == cache->totchannel);
+}
+
+static AnimEvalCache *animsys_eval_cache_ensure(PointerRNA *ptr, AnimData *adt, bAction *act)
+{
+	AnimEvalCache *cache = adt->eval_cache;
+	FCurve *fcu;
+	int i;
+
+	if (cache && animsys_eval_cache_is_valid(cache, ptr, act)) {
+		return cache;
+	}
+
+	if (cache == NULL) {
+		cache = adt->eval_cache = MEM_callocN(sizeof(AnimEvalCache), "AnimEvalCache");
+	}
+	else {
+		MEM_SAFE_FREE(cache->channels);
+	}
+
+	/* read before resolving, so invalidation happening meanwhile is not lost */
+	cache->generation = animsys_eval_cache_generation;
+	cache->id = ptr->id.data;
+	cache->action = act;
+	cache->totchannel = BLI_listbase_count(&act->curves);
+	if (cache->totchannel == 0) {
+		return cache;
+	}
+
+	cache->channels = MEM_mallocN(sizeof(AnimEvalCacheChannel) * cache->totchannel, "AnimEvalCache channels");
+
+	for (fcu = act->curves.first, i = 0; fcu; fcu = fcu->next, i++) {
+		AnimEvalCacheChannel *channel = &cache->channels[i];
+
+		channel->fcu = fcu;
+		channel->rna_path = fcu->rna_path;
+		channel->array_index = fcu->array_index;
+		channel->use_cache = false;
+
+		if (animsys_store_rna_setting(ptr, NULL, fcu->rna_path, fcu->array_index, &channel->anim_rna)) {
+			channel->use_cache = animsys_eval_cache_pointer_is_stable(ptr, &channel->anim_rna);
+		}
+	}
+
+	return cache;
+}
+
+/* Evaluate the active action of an AnimData block, using its evaluation cache.
+ * Same as animsys_evaluate_action(), but only to be used for AnimData owned by the ID
+ * the pointer refers to, not for temporary copies.
+ */
+static void animsys_evaluate_action_cached(PointerRNA *ptr, AnimData *adt, float ctime)
+{
+	bAction *act = adt->action;
+	AnimEvalCache *cache;
+	int i;
+
+	action_idcode_patch_check(ptr->id.data, act);
+
+	cache = animsys_eval_cache_ensure(ptr, adt, act);
+
+	/* calculate then execute each curve */
+	for (i = 0; i < cache->totchannel; i++) {
+		AnimEvalCacheChannel *channel = &cache->channels[i];
+		FCurve *fcu = channel->fcu;
+
+		/* check if this F-Curve doesn't belong to a muted group */
+		if ((fcu->grp == NULL) || (fcu->grp->flag & AGRP_MUTED) == 0) {
+			/* check if this curve should be skipped */
+			if ((fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED)) == 0) {
+				if (channel->use_cache) {
+					const float curval = calculate_fcurve(&channel->anim_rna, fcu, ctime);
+					animsys_write_rna_setting(&channel->anim_rna, curval);
+				}
+				else {
+					PathResolvedRNA anim_rna;
+					if (animsys_store_rna_setting(ptr, NULL, fcu->rna_path, fcu->array_index, &anim_rna)) {
+						const float curval = calculate_fcurve(&anim_rna, fcu, ctime);
+						animsys_write_rna_setting(&anim_rna, curval);
+					}
+				}
+			}
+		}
+	}
+}
+
 /* ***************************************** */
 /* NLA System - Evaluation */
 
@@ -2644,8 +2849,12 @@ static void animsys_evaluate_overrides(PointerRNA *ptr, AnimData *adt)
  * This assumes that the animation-data provided belongs to the ID block in question,
  * and that the flags for which parts of the anim-data settings need to be recalculated 
  * have been set already by the depsgraph. Now, we use the recalc 
+ *
+ * use_eval_cache: keep resolved paths of the active action in the AnimData, only valid
+ * when the AnimData is owned by the ID (i.e. not for temporary work objects)
  */
-void BKE_animsys_evaluate_animdata(Scene *scene, ID *id, AnimData *adt, float ctime, short recalc)
+static void animsys_evaluate_animdata_ex(Scene *scene, ID *id, AnimData *adt, float ctime, short recalc,
+                                         const bool use_eval_cache)
 {
 	PointerRNA id_ptr;
 	
@@ -2670,8 +2879,12 @@ void BKE_animsys_evaluate_animdata(Scene *scene, ID *id, AnimData *adt, float ct
 			animsys_calculate_nla(&id_ptr, adt, ctime);
 		}
 		/* evaluate Active Action only */
-		else if (adt->action)
-			animsys_evaluate_action(&id_ptr, adt->action, adt->remap, ctime);
+		else if (adt->action) {
+			if (use_eval_cache && (adt->remap == NULL))
+				animsys_evaluate_action_cached(&id_ptr, adt, ctime);
+			else
+				animsys_evaluate_action(&id_ptr, adt->action, adt->remap, ctime);
+		}
 		
 		/* reset tag */
 		adt->recalc &= ~ADT_RECALC_ANIM;
@@ -2708,6 +2921,11 @@ void BKE_animsys_evaluate_animdata(Scene *scene, ID *id, AnimData *adt, float ct
 	adt->recalc = 0;
 }
 
+void BKE_animsys_evaluate_animdata(Scene *scene, ID *id, AnimData *adt, float ctime, short recalc)
+{
+	animsys_evaluate_animdata_ex(scene, id, adt, ctime, recalc, false);
+}
+
 /* Evaluation of all ID-blocks with Animation Data blocks - Animation Data Only
  *
  * This will evaluate only the animation info available in the animation data-blocks
@@ -2731,7 +2949,7 @@ void BKE_animsys_evaluate_all_animation(Main *main, Scene *scene, float ctime)
 	for (id = first; id; id = id->next) { \
 		if (ID_REAL_USERS(id) > 0) { \
 			AnimData *adt = BKE_animdata_from_id(id); \
-			BKE_animsys_evaluate_animdata(scene, id, adt, ctime, aflag); \
+			animsys_evaluate_animdata_ex(scene, id, adt, ctime, aflag, true); \
 		} \
 	} (void)0
 
@@ -2748,9 +2966,9 @@ void BKE_animsys_evaluate_all_animation(Main *main, Scene *scene, float ctime)
 			NtId_Type *ntp = (NtId_Type *)id; \
 			if (ntp->nodetree) { \
 				AnimData *adt2 = BKE_animdata_from_id((ID *)ntp->nodetree); \
-				BKE_animsys_evaluate_animdata(scene, (ID *)ntp->nodetree, adt2, ctime, ADT_RECALC_ANIM); \
+				animsys_evaluate_animdata_ex(scene, (ID *)ntp->nodetree, adt2, ctime, ADT_RECALC_ANIM, true); \
 			} \
-			BKE_animsys_evaluate_animdata(scene, id, adt, ctime, aflag); \
+			animsys_evaluate_animdata_ex(scene, id, adt, ctime, aflag, true); \
 		} \
 	} (void)0
 	
@@ -2851,7 +3069,7 @@ void BKE_animsys_eval_animdata(EvaluationContext *eval_ctx, ID *id)
 	                      * which should get handled as part of the graph instead...
 	                      */
 	DEBUG_PRINT("%s on %s, time=%f\n\n", __func__, id->name, (double)eval_ctx->ctime);
-	BKE_animsys_evaluate_animdata(scene, id, adt, eval_ctx->ctime, ADT_RECALC_ANIM);
+	animsys_evaluate_animdata_ex(scene, id, adt, eval_ctx->ctime, ADT_RECALC_ANIM, true);
 }
 
 void BKE_animsys_eval_driver(EvaluationContext *eval_ctx,
@@ -42,6 +42,7 @@
 #include "BLI_string.h"
 #include "BLI_ghash.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_anim_types.h"
@@ -72,11 +73,14 @@
 #include "BKE_lattice.h"
 #include "BKE_main.h"
 #include "BKE_object.h"
+#include "BKE_playback_cache.h"
 #include "BKE_scene.h"
 
 #include "BIK_api.h"
 #include "BKE_sketch.h"
 
+#include "atomic_ops.h"
+
 /* **************** Generic Functions, data level *************** */
 
 bArmature *BKE_armature_add(Main *bmain, const char *name)
@@ -703,6 +707,9 @@ void b_bone_spline_setup(bPoseChannel *pchan, int rest, Mat4 result_array[MAX_BB
 
 /* ************ Armature Deform ******************* */
 
+/* Meshes with fewer vertices are deformed on the calling thread. */
+#define ARMATURE_DEFORM_THREADED_LIMIT 1024
+
 typedef struct bPoseChanDeform {
 	Mat4     *b_bone_mats;
 	DualQuat *dual_quat;
@@ -955,10 +962,195 @@ static void armature_bbone_defmats_cb(void *userdata, Link *iter, int index)
 	}
 }
 
+typedef struct ArmatureUserdata {
+	Object *armOb;
+	DerivedMesh *dm;
+	float (*vertexCos)[3];
+	float (*defMats)[3][3];
+	float (*prevCos)[3];
+
+	bool use_envelope;
+	bool use_quaternion;
+	bool invert_vgroup;
+	bool use_dverts;
+
+	int armature_def_nr;
+
+	MDeformVert *dverts;
+	int target_totvert;
+
+	/* vertex group index to pose channel and its deform info */
+	int defbase_tot;
+	bPoseChannel **defnrToPC;
+	int *defnrToPCIndex;
+	bPoseChanDeform *pdef_info_array;
+
+	float premat[4][4];
+	float postmat[4][4];
+	/* rotation/scale parts of premat and postmat, for defMats */
+	float premat3[3][3];
+	float postmat3[3][3];
+} ArmatureUserdata;
+
+static void armature_vert_task(void *userdata, const int i)
+{
+	ArmatureUserdata *data = userdata;
+	float (*const vertexCos)[3] = data->vertexCos;
+	float (*const defMats)[3][3] = data->defMats;
+	float (*const prevCos)[3] = data->prevCos;
+	const bool use_envelope = data->use_envelope;
+	const bool use_quaternion = data->use_quaternion;
+	const bool use_dverts = data->use_dverts;
+	const int armature_def_nr = data->armature_def_nr;
+	bPoseChanDeform *pdef_info;
+	bPoseChannel *pchan;
+	MDeformVert *dvert;
+	DualQuat sumdq, *dq = NULL;
+	float *co, dco[3];
+	float sumvec[3], summat[3][3];
+	float *vec = NULL, (*smat)[3] = NULL;
+	float contrib = 0.0f;
+	float armature_weight = 1.0f; /* default to 1 if no overall def group */
+	float prevco_weight = 1.0f;   /* weight for optional cached vertexcos */
+
+	if (use_quaternion) {
+		memset(&sumdq, 0, sizeof(DualQuat));
+		dq = &sumdq;
+	}
+	else {
+		sumvec[0] = sumvec[1] = sumvec[2] = 0.0f;
+		vec = sumvec;
+
+		if (defMats) {
+			zero_m3(summat);
+			smat = summat;
+		}
+	}
+
+	if (use_dverts || armature_def_nr != -1) {
+		if (data->dm)
+			dvert = data->dm->getVertData(data->dm, i, CD_MDEFORMVERT);
+		else if (data->dverts && i < data->target_totvert)
+			dvert = data->dverts + i;
+		else
+			dvert = NULL;
+	}
+	else
+		dvert = NULL;
+
+	if (armature_def_nr != -1 && dvert) {
+		armature_weight = defvert_find_weight(dvert, armature_def_nr);
+
+		if (data->invert_vgroup)
+			armature_weight = 1.0f - armature_weight;
+
+		/* hackish: the blending factor can be used for blending with prevCos too */
+		if (prevCos) {
+			prevco_weight = armature_weight;
+			armature_weight = 1.0f;
+		}
+	}
+
+	/* check if there's any  point in calculating for this vert */
+	if (armature_weight == 0.0f)
+		return;
+
+	/* get the coord we work on */
+	co = prevCos ? prevCos[i] : vertexCos[i];
+
+	/* Apply the object's matrix */
+	mul_m4_v3(data->premat, co);
+
+	if (use_dverts && dvert && dvert->totweight) { /* use weight groups ? */
+		MDeformWeight *dw = dvert->dw;
+		int deformed = 0;
+		unsigned int j;
+
+		for (j = dvert->totweight; j != 0; j--, dw++) {
+			const int index = dw->def_nr;
+			if (index >= 0 && index < data->defbase_tot && (pchan = data->defnrToPC[index])) {
+				float weight = dw->weight;
+				Bone *bone = pchan->bone;
+				pdef_info = data->pdef_info_array + data->defnrToPCIndex[index];
+
+				deformed = 1;
+
+				if (bone && bone->flag & BONE_MULT_VG_ENV) {
+					weight *= distfactor_to_bone(co, bone->arm_head, bone->arm_tail,
+					                             bone->rad_head, bone->rad_tail, bone->dist);
+				}
+				pchan_bone_deform(pchan, pdef_info, weight, vec, dq, smat, co, &contrib);
+			}
+		}
+		/* if there are vertexgroups but not groups with bones
+		 * (like for softbody groups) */
+		if (deformed == 0 && use_envelope) {
+			pdef_info = data->pdef_info_array;
+			for (pchan = data->armOb->pose->chanbase.first; pchan; pchan = pchan->next, pdef_info++) {
+				if (!(pchan->bone->flag & BONE_NO_DEFORM))
+					contrib += dist_bone_deform(pchan, pdef_info, vec, dq, smat, co);
+			}
+		}
+	}
+	else if (use_envelope) {
+		pdef_info = data->pdef_info_array;
+		for (pchan = data->armOb->pose->chanbase.first; pchan; pchan = pchan->next, pdef_info++) {
+			if (!(pchan->bone->flag & BONE_NO_DEFORM))
+				contrib += dist_bone_deform(pchan, pdef_info, vec, dq, smat, co);
+		}
+	}
+
+	/* actually should be EPSILON? weight values and contrib can be like 10e-39 small */
+	if (contrib > 0.0001f) {
+		if (use_quaternion) {
+			normalize_dq(dq, contrib);
+
+			if (armature_weight != 1.0f) {
+				copy_v3_v3(dco, co);
+				mul_v3m3_dq(dco, (defMats) ? summat : NULL, dq);
+				sub_v3_v3(dco, co);
+				mul_v3_fl(dco, armature_weight);
+				add_v3_v3(co, dco);
+			}
+			else
+				mul_v3m3_dq(co, (defMats) ? summat : NULL, dq);
+
+			smat = summat;
+		}
+		else {
+			mul_v3_fl(vec, armature_weight / contrib);
+			add_v3_v3v3(co, vec, co);
+		}
+
+		if (defMats) {
+			float tmpmat[3][3];
+
+			copy_m3_m3(tmpmat, defMats[i]);
+
+			if (!use_quaternion) /* quaternion already is scale corrected */
+				mul_m3_fl(smat, armature_weight / contrib);
+
+			mul_m3_series(defMats[i], data->postmat3, smat, data->premat3, tmpmat);
+		}
+	}
+
+	/* always, check above code */
+	mul_m4_v3(data->postmat, co);
+
+	/* interpolate with previous modifier position using weight group */
+	if (prevCos) {
+		float mw = 1.0f - prevco_weight;
+		vertexCos[i][0] = prevco_weight * vertexCos[i][0] + mw * co[0];
+		vertexCos[i][1] = prevco_weight * vertexCos[i][1] + mw * co[1];
+		vertexCos[i][2] = prevco_weight * vertexCos[i][2] + mw * co[2];
+	}
+}
+
 void armature_deform_verts(Object *armOb, Object *target, DerivedMesh *dm, float (*vertexCos)[3],
                            float (*defMats)[3][3], int numVerts, int deformflag,
                            float (*prevCos)[3], const char *defgrp_name)
 {
+	ArmatureUserdata data = {NULL};
 	bPoseChanDeform *pdef_info_array;
 	bPoseChanDeform *pdef_info = NULL;
 	bArmature *arm = armOb->data;
@@ -1003,10 +1195,10 @@ void armature_deform_verts(Object *armOb, Object *target, DerivedMesh *dm, float
 
 	pdef_info_array = MEM_callocN(sizeof(bPoseChanDeform) * totchan, "bPoseChanDeform");
 
-	ArmatureBBoneDefmatsData data = {
+	ArmatureBBoneDefmatsData bbone_data = {
 	    .pdef_info_array = pdef_info_array, .dualquats = dualquats, .use_quaternion = use_quaternion
 	};
-	BLI_task_parallel_listbase(&armOb->pose->chanbase, &data, armature_bbone_defmats_cb, totchan > 512);
+	BLI_task_parallel_listbase(&armOb->pose->chanbase, &bbone_data, armature_bbone_defmats_cb, totchan > 512);
 
 	/* get the def_nr for the overall armature vertex group if present */
 	armature_def_nr = defgroup_name_index(target, defgrp_name);
@@ -1070,150 +1262,29 @@ void armature_deform_verts(Object *armOb, Object *target, DerivedMesh *dm, float
 		}
 	}
 
-	for (i = 0; i < numVerts; i++) {
-		MDeformVert *dvert;
-		DualQuat sumdq, *dq = NULL;
-		float *co, dco[3];
-		float sumvec[3], summat[3][3];
-		float *vec = NULL, (*smat)[3] = NULL;
-		float contrib = 0.0f;
-		float armature_weight = 1.0f; /* default to 1 if no overall def group */
-		float prevco_weight = 1.0f;   /* weight for optional cached vertexcos */
-
-		if (use_quaternion) {
-			memset(&sumdq, 0, sizeof(DualQuat));
-			dq = &sumdq;
-		}
-		else {
-			sumvec[0] = sumvec[1] = sumvec[2] = 0.0f;
-			vec = sumvec;
-
-			if (defMats) {
-				zero_m3(summat);
-				smat = summat;
-			}
-		}
-
-		if (use_dverts || armature_def_nr != -1) {
-			if (dm)
-				dvert = dm->getVertData(dm, i, CD_MDEFORMVERT);
-			else if (dverts && i < target_totvert)
-				dvert = dverts + i;
-			else
-				dvert = NULL;
-		}
-		else
-			dvert = NULL;
-
-		if (armature_def_nr != -1 && dvert) {
-			armature_weight = defvert_find_weight(dvert, armature_def_nr);
-
-			if (invert_vgroup)
-				armature_weight = 1.0f - armature_weight;
-
-			/* hackish: the blending factor can be used for blending with prevCos too */
-			if (prevCos) {
-				prevco_weight = armature_weight;
-				armature_weight = 1.0f;
-			}
-		}
-
-		/* check if there's any  point in calculating for this vert */
-		if (armature_weight == 0.0f)
-			continue;
-
-		/* get the coord we work on */
-		co = prevCos ? prevCos[i] : vertexCos[i];
-
-		/* Apply the object's matrix */
-		mul_m4_v3(premat, co);
-
-		if (use_dverts && dvert && dvert->totweight) { /* use weight groups ? */
-			MDeformWeight *dw = dvert->dw;
-			int deformed = 0;
-			unsigned int j;
-
-			for (j = dvert->totweight; j != 0; j--, dw++) {
-				const int index = dw->def_nr;
-				if (index >= 0 && index < defbase_tot && (pchan = defnrToPC[index])) {
-					float weight = dw->weight;
-					Bone *bone = pchan->bone;
-					pdef_info = pdef_info_array + defnrToPCIndex[index];
-
-					deformed = 1;
-
-					if (bone && bone->flag & BONE_MULT_VG_ENV) {
-						weight *= distfactor_to_bone(co, bone->arm_head, bone->arm_tail,
-						                             bone->rad_head, bone->rad_tail, bone->dist);
-					}
-					pchan_bone_deform(pchan, pdef_info, weight, vec, dq, smat, co, &contrib);
-				}
-			}
-			/* if there are vertexgroups but not groups with bones
-			 * (like for softbody groups) */
-			if (deformed == 0 && use_envelope) {
-				pdef_info = pdef_info_array;
-				for (pchan = armOb->pose->chanbase.first; pchan; pchan = pchan->next, pdef_info++) {
-					if (!(pchan->bone->flag & BONE_NO_DEFORM))
-						contrib += dist_bone_deform(pchan, pdef_info, vec, dq, smat, co);
-				}
-			}
-		}
-		else if (use_envelope) {
-			pdef_info = pdef_info_array;
-			for (pchan = armOb->pose->chanbase.first; pchan; pchan = pchan->next, pdef_info++) {
-				if (!(pchan->bone->flag & BONE_NO_DEFORM))
-					contrib += dist_bone_deform(pchan, pdef_info, vec, dq, smat, co);
-			}
-		}
-
-		/* actually should be EPSILON? weight values and contrib can be like 10e-39 small */
-		if (contrib > 0.0001f) {
-			if (use_quaternion) {
-				normalize_dq(dq, contrib);
-
-				if (armature_weight != 1.0f) {
-					copy_v3_v3(dco, co);
-					mul_v3m3_dq(dco, (defMats) ? summat : NULL, dq);
-					sub_v3_v3(dco, co);
-					mul_v3_fl(dco, armature_weight);
-					add_v3_v3(co, dco);
-				}
-				else
-					mul_v3m3_dq(co, (defMats) ? summat : NULL, dq);
-
-				smat = summat;
-			}
-			else {
-				mul_v3_fl(vec, armature_weight / contrib);
-				add_v3_v3v3(co, vec, co);
-			}
-
-			if (defMats) {
-				float pre[3][3], post[3][3], tmpmat[3][3];
-
-				copy_m3_m4(pre, premat);
-				copy_m3_m4(post, postmat);
-				copy_m3_m3(tmpmat, defMats[i]);
-
-				if (!use_quaternion) /* quaternion already is scale corrected */
-					mul_m3_fl(smat, armature_weight / contrib);
-
-				mul_m3_series(defMats[i], post, smat, pre, tmpmat);
-			}
-		}
-
-		/* always, check above code */
-		mul_m4_v3(postmat, co);
-
-		/* interpolate with previous modifier position using weight group */
-		if (prevCos) {
-			float mw = 1.0f - prevco_weight;
-			vertexCos[i][0] = prevco_weight * vertexCos[i][0] + mw * co[0];
-			vertexCos[i][1] = prevco_weight * vertexCos[i][1] + mw * co[1];
-			vertexCos[i][2] = prevco_weight * vertexCos[i][2] + mw * co[2];
-		}
-	}
+	data.armOb = armOb;
+	data.dm = dm;
+	data.vertexCos = vertexCos;
+	data.defMats = defMats;
+	data.prevCos = prevCos;
+	data.use_envelope = use_envelope;
+	data.use_quaternion = use_quaternion;
+	data.invert_vgroup = invert_vgroup;
+	data.use_dverts = use_dverts;
+	data.armature_def_nr = armature_def_nr;
+	data.dverts = dverts;
+	data.target_totvert = target_totvert;
+	data.defbase_tot = defbase_tot;
+	data.defnrToPC = defnrToPC;
+	data.defnrToPCIndex = defnrToPCIndex;
+	data.pdef_info_array = pdef_info_array;
+	copy_m4_m4(data.premat, premat);
+	copy_m4_m4(data.postmat, postmat);
+	copy_m3_m4(data.premat3, premat);
+	copy_m3_m4(data.postmat3, postmat);
+
+	/* every vertex only writes to its own coordinate and deform matrix */
+	BLI_task_parallel_range(0, numVerts, &data, armature_vert_task, numVerts > ARMATURE_DEFORM_THREADED_LIMIT);
 
 	if (dualquats)
 		MEM_freeN(dualquats);
@@ -1952,6 +2023,9 @@ void BKE_pose_rebuild_ex(Object *ob, bArmature *arm, const bool sort_bones)
 	}
 	pose = ob->pose;
 
+	/* channels might be freed, animation paths have to be resolved again */
+	BKE_animsys_eval_cache_invalidate();
+
 	/* clear */
 	BKE_pose_clear_pointers(pose);
 
@@ -2253,6 +2327,330 @@ void BKE_pose_where_is_bone(Scene *scene, Object *ob, bPoseChannel *pchan, float
 	BKE_pose_where_is_bone_tail(pchan);
 }
 
+/* ********************** Threaded pose solving ******************* */
+
+/* Poses with fewer channels are always solved on the calling thread. */
+#define POSE_THREADED_LIMIT 64
+
+/* Channels are split in groups which are solved in parallel. Channels of an IK chain
+ * and channels used as constraint target by another channel of the same armature
+ * share a group, so the only result a group reads from other groups is the pose matrix
+ * of a parent channel. A group is solved once the groups of all these parents are done,
+ * channels of a group are solved in the same order as the single threaded loop.
+ */
+typedef struct PoseSolveGroups {
+	int totgroup;
+	/* channels of each group, in hierarchical order */
+	int *chan_start;                /* totgroup + 1 */
+	bPoseChannel **chans;
+	/* groups containing children of channels of each group */
+	int *child_start;               /* totgroup + 1 */
+	int *children;
+	/* number of parent groups still to be solved */
+	unsigned int *num_pending;
+} PoseSolveGroups;
+
+typedef struct PoseSolveData {
+	Scene *scene;
+	Object *ob;
+	float ctime;
+	PoseSolveGroups *groups;
+} PoseSolveData;
+
+/* solve a single channel, IK roots solve their whole tree */
+static void pose_solve_channel(Scene *scene, Object *ob, bPoseChannel *pchan, float ctime)
+{
+	/* 4a. if we find an IK root, we handle it separated */
+	if (pchan->flag & POSE_IKTREE) {
+		BIK_execute_tree(scene, ob, pchan, ctime);
+	}
+	/* 4b. if we find a Spline IK root, we handle it separated too */
+	else if (pchan->flag & POSE_IKSPLINE) {
+		BKE_splineik_execute_tree(scene, ob, pchan, ctime);
+	}
+	/* 5. otherwise just call the normal solver */
+	else if (!(pchan->flag & POSE_DONE)) {
+		BKE_pose_where_is_bone(scene, ob, pchan, ctime, 1);
+	}
+}
+
+static int pose_solve_group_find(int *group_parent, int index)
+{
+	while (group_parent[index] != index) {
+		group_parent[index] = group_parent[group_parent[index]];
+		index = group_parent[index];
+	}
+	return index;
+}
+
+static void pose_solve_group_join(int *group_parent, int a, int b)
+{
+	a = pose_solve_group_find(group_parent, a);
+	b = pose_solve_group_find(group_parent, b);
+
+	/* the first channel in hierarchical order represents the group */
+	if (a < b) {
+		group_parent[b] = a;
+	}
+	else if (b < a) {
+		group_parent[a] = b;
+	}
+}
+
+static void pose_solve_group_join_constraints(Object *ob, bPoseChannel *pchan, GHash *chan_index, int *group_parent)
+{
+	const int index = GET_INT_FROM_POINTER(BLI_ghash_lookup(chan_index, pchan));
+	bConstraint *con;
+
+	for (con = pchan->constraints.first; con; con = con->next) {
+		const bConstraintTypeInfo *cti = BKE_constraint_typeinfo_get(con);
+		ListBase targets = {NULL, NULL};
+		bConstraintTarget *ct;
+		bPoseChannel *rootchan = NULL, *parchan;
+
+		/* IK chains are solved at once from their root */
+		if (con->type == CONSTRAINT_TYPE_KINEMATIC) {
+			rootchan = BKE_armature_ik_solver_find_root(pchan, con->data);
+		}
+		else if (con->type == CONSTRAINT_TYPE_SPLINEIK) {
+			rootchan = BKE_armature_splineik_solver_find_root(pchan, con->data);
+		}
+		if (rootchan && rootchan != pchan) {
+			for (parchan = pchan->parent; parchan; parchan = parchan->parent) {
+				pose_solve_group_join(group_parent, index, GET_INT_FROM_POINTER(BLI_ghash_lookup(chan_index, parchan)));
+				if (parchan == rootchan) {
+					break;
+				}
+			}
+		}
+
+		/* channels of this armature used as target */
+		if (cti && cti->get_constraint_targets) {
+			cti->get_constraint_targets(con, &targets);
+
+			for (ct = targets.first; ct; ct = ct->next) {
+				if (ct->tar == ob && ct->subtarget[0]) {
+					bPoseChannel *tarchan = BKE_pose_channel_find_name(ob->pose, ct->subtarget);
+					if (tarchan) {
+						pose_solve_group_join(group_parent, index, GET_INT_FROM_POINTER(BLI_ghash_lookup(chan_index, tarchan)));
+					}
+				}
+			}
+
+			if (cti->flush_constraint_targets)
+				cti->flush_constraint_targets(con, &targets, 1);
+		}
+	}
+}
+
+static void pose_solve_groups_free(PoseSolveGroups *groups)
+{
+	MEM_SAFE_FREE(groups->chan_start);
+	MEM_SAFE_FREE(groups->chans);
+	MEM_SAFE_FREE(groups->child_start);
+	MEM_SAFE_FREE(groups->children);
+	MEM_SAFE_FREE(groups->num_pending);
+	MEM_freeN(groups);
+}
+
+/* Returns NULL when the pose is to be solved on the calling thread. */
+static PoseSolveGroups *pose_solve_groups_create(Object *ob)
+{
+	bPose *pose = ob->pose;
+	PoseSolveGroups *groups;
+	bPoseChannel *pchan, **chans;
+	GHash *chan_index;
+	int *group_parent, *group_index, *num_children, *queue;
+	unsigned int *num_pending;
+	int totchan, totgroup, totchildren, queue_len, i, g;
+
+	/* iTaSC builds a single scene for all chains of the armature */
+	if (pose->iksolver == IKSOLVER_ITASC) {
+		return NULL;
+	}
+
+	totchan = BLI_listbase_count(&pose->chanbase);
+	if (totchan < POSE_THREADED_LIMIT || BLI_system_thread_count() < 2) {
+		return NULL;
+	}
+
+	chans = MEM_mallocN(sizeof(*chans) * totchan, __func__);
+	chan_index = BLI_ghash_ptr_new_ex(__func__, (unsigned int)totchan);
+	group_parent = MEM_mallocN(sizeof(*group_parent) * totchan, __func__);
+
+	for (pchan = pose->chanbase.first, i = 0; pchan; pchan = pchan->next, i++) {
+		chans[i] = pchan;
+		group_parent[i] = i;
+		BLI_ghash_insert(chan_index, pchan, SET_INT_IN_POINTER(i));
+	}
+
+	for (i = 0; i < totchan; i++) {
+		pose_solve_group_join_constraints(ob, chans[i], chan_index, group_parent);
+	}
+
+	/* Linear chains of channels are solved as a single group. Only a channel without other
+	 * channels in its group is joined to the group of its parent, which can't form a cycle. */
+	group_index = MEM_callocN(sizeof(*group_index) * totchan, __func__);
+	num_children = MEM_callocN(sizeof(*num_children) * totchan, __func__);
+	for (i = 0; i < totchan; i++) {
+		group_index[pose_solve_group_find(group_parent, i)]++;
+		if (chans[i]->parent) {
+			num_children[GET_INT_FROM_POINTER(BLI_ghash_lookup(chan_index, chans[i]->parent))]++;
+		}
+	}
+	for (i = 0; i < totchan; i++) {
+		if (chans[i]->parent && group_index[i] == 1) {
+			const int parent = GET_INT_FROM_POINTER(BLI_ghash_lookup(chan_index, chans[i]->parent));
+			if (num_children[parent] == 1) {
+				pose_solve_group_join(group_parent, i, parent);
+			}
+		}
+	}
+	MEM_freeN(num_children);
+
+	/* compact group indices, representatives come first in hierarchical order */
+	totgroup = 0;
+	for (i = 0; i < totchan; i++) {
+		const int root = pose_solve_group_find(group_parent, i);
+		group_index[i] = (root == i) ? totgroup++ : group_index[root];
+	}
+
+	if (totgroup < 2) {
+		MEM_freeN(group_index);
+		MEM_freeN(group_parent);
+		BLI_ghash_free(chan_index, NULL, NULL);
+		MEM_freeN(chans);
+		return NULL;
+	}
+
+	groups = MEM_callocN(sizeof(*groups), __func__);
+	groups->totgroup = totgroup;
+	groups->chan_start = MEM_callocN(sizeof(int) * (totgroup + 1), __func__);
+	groups->chans = MEM_mallocN(sizeof(*groups->chans) * totchan, __func__);
+	groups->child_start = MEM_callocN(sizeof(int) * (totgroup + 1), __func__);
+	groups->num_pending = MEM_callocN(sizeof(unsigned int) * totgroup, __func__);
+
+	/* channels per group, in the order of the channel list */
+	for (i = 0; i < totchan; i++) {
+		groups->chan_start[group_index[i] + 1]++;
+	}
+	for (g = 0; g < totgroup; g++) {
+		groups->chan_start[g + 1] += groups->chan_start[g];
+	}
+	for (i = 0; i < totchan; i++) {
+		/* group_parent is no longer needed, reuse it as fill position */
+		group_parent[i] = 0;
+	}
+	for (i = 0; i < totchan; i++) {
+		g = group_index[i];
+		groups->chans[groups->chan_start[g] + group_parent[g]++] = chans[i];
+	}
+
+	/* parent links crossing groups */
+	totchildren = 0;
+	for (i = 0; i < totchan; i++) {
+		if (chans[i]->parent) {
+			const int parent_group = group_index[GET_INT_FROM_POINTER(BLI_ghash_lookup(chan_index, chans[i]->parent))];
+			if (parent_group != group_index[i]) {
+				groups->child_start[parent_group + 1]++;
+				groups->num_pending[group_index[i]]++;
+				totchildren++;
+			}
+		}
+	}
+	for (g = 0; g < totgroup; g++) {
+		groups->child_start[g + 1] += groups->child_start[g];
+		group_parent[g] = 0;
+	}
+	groups->children = MEM_mallocN(sizeof(int) * max_ii(totchildren, 1), __func__);
+	for (i = 0; i < totchan; i++) {
+		if (chans[i]->parent) {
+			const int parent_group = group_index[GET_INT_FROM_POINTER(BLI_ghash_lookup(chan_index, chans[i]->parent))];
+			if (parent_group != group_index[i]) {
+				groups->children[groups->child_start[parent_group] + group_parent[parent_group]++] = group_index[i];
+			}
+		}
+	}
+
+	/* Groups depending on each other in a cycle can't be solved in parallel, this happens
+	 * when a constraint target is a child of a channel in another group. */
+	num_pending = MEM_dupallocN(groups->num_pending);
+	queue = group_parent;
+	queue_len = 0;
+	for (g = 0; g < totgroup; g++) {
+		if (num_pending[g] == 0) {
+			queue[queue_len++] = g;
+		}
+	}
+	for (i = 0; i < queue_len; i++) {
+		const int group = queue[i];
+		int c;
+		for (c = groups->child_start[group]; c < groups->child_start[group + 1]; c++) {
+			if (--num_pending[groups->children[c]] == 0) {
+				queue[queue_len++] = groups->children[c];
+			}
+		}
+	}
+	MEM_freeN(num_pending);
+
+	if (queue_len != totgroup) {
+		pose_solve_groups_free(groups);
+		groups = NULL;
+	}
+
+	MEM_freeN(group_index);
+	MEM_freeN(group_parent);
+	BLI_ghash_free(chan_index, NULL, NULL);
+	MEM_freeN(chans);
+
+	return groups;
+}
+
+static void pose_solve_group_task(TaskPool *__restrict pool, void *taskdata, int threadid)
+{
+	PoseSolveData *data = BLI_task_pool_userdata(pool);
+	PoseSolveGroups *groups = data->groups;
+	const int group = GET_INT_FROM_POINTER(taskdata);
+	int i;
+
+	for (i = groups->chan_start[group]; i < groups->chan_start[group + 1]; i++) {
+		pose_solve_channel(data->scene, data->ob, groups->chans[i], data->ctime);
+	}
+
+	/* schedule groups of which all parents are solved now */
+	for (i = groups->child_start[group]; i < groups->child_start[group + 1]; i++) {
+		const int child = groups->children[i];
+		if (atomic_sub_and_fetch_uint32(&groups->num_pending[child], 1) == 0) {
+			BLI_task_pool_push_from_thread(pool, pose_solve_group_task, SET_INT_IN_POINTER(child),
+			                               false, TASK_PRIORITY_HIGH, threadid);
+		}
+	}
+}
+
+static void pose_solve_groups_evaluate(Scene *scene, Object *ob, float ctime, PoseSolveGroups *groups)
+{
+	TaskScheduler *task_scheduler = BLI_task_scheduler_get();
+	TaskPool *task_pool;
+	PoseSolveData data;
+	int g;
+
+	data.scene = scene;
+	data.ob = ob;
+	data.ctime = ctime;
+	data.groups = groups;
+
+	task_pool = BLI_task_pool_create(task_scheduler, &data);
+
+	for (g = 0; g < groups->totgroup; g++) {
+		if (groups->num_pending[g] == 0) {
+			BLI_task_pool_push(task_pool, pose_solve_group_task, SET_INT_IN_POINTER(g), false, TASK_PRIORITY_HIGH);
+		}
+	}
+
+	BLI_task_pool_work_and_wait(task_pool);
+	BLI_task_pool_free(task_pool);
+}
+
 /* This only reads anim data from channels, and writes to channels */
 /* This is the only function adding poses */
 void BKE_pose_where_is(Scene *scene, Object *ob)
@@ -2260,6 +2658,7 @@ void BKE_pose_where_is(Scene *scene, Object *ob)
 	bArmature *arm;
 	Bone *bone;
 	bPoseChannel *pchan;
+	PoseSolveGroups *groups;
 	float imat[4][4];
 	float ctime;
 
@@ -2288,37 +2687,42 @@ void BKE_pose_where_is(Scene *scene, Object *ob)
 	else {
 		invert_m4_m4(ob->imat, ob->obmat); /* imat is needed */
 
-		/* 1. clear flags */
-		for (pchan = ob->pose->chanbase.first; pchan; pchan = pchan->next) {
-			pchan->flag &= ~(POSE_DONE | POSE_CHAIN | POSE_IKTREE | POSE_IKSPLINE);
+		/* pose from the playback cache, all channels are marked as done */
+		if (BKE_playback_cache_pose_restore(ob)) {
+			/* pass */
 		}
+		else {
+			/* 1. clear flags */
+			for (pchan = ob->pose->chanbase.first; pchan; pchan = pchan->next) {
+				pchan->flag &= ~(POSE_DONE | POSE_CHAIN | POSE_IKTREE | POSE_IKSPLINE);
+			}
 
-		/* 2a. construct the IK tree (standard IK) */
-		BIK_initialize_tree(scene, ob, ctime);
+			/* 2a. construct the IK tree (standard IK) */
+			BIK_initialize_tree(scene, ob, ctime);
 
-		/* 2b. construct the Spline IK trees
-		 *  - this is not integrated as an IK plugin, since it should be able
-		 *	  to function in conjunction with standard IK
-		 */
-		BKE_pose_splineik_init_tree(scene, ob, ctime);
-
-		/* 3. the main loop, channels are already hierarchical sorted from root to children */
-		for (pchan = ob->pose->chanbase.first; pchan; pchan = pchan->next) {
-			/* 4a. if we find an IK root, we handle it separated */
-			if (pchan->flag & POSE_IKTREE) {
-				BIK_execute_tree(scene, ob, pchan, ctime);
-			}
-			/* 4b. if we find a Spline IK root, we handle it separated too */
-			else if (pchan->flag & POSE_IKSPLINE) {
-				BKE_splineik_execute_tree(scene, ob, pchan, ctime);
+			/* 2b. construct the Spline IK trees
+			 *  - this is not integrated as an IK plugin, since it should be able
+			 *	  to function in conjunction with standard IK
+			 */
+			BKE_pose_splineik_init_tree(scene, ob, ctime);
+
+			/* 3. the main loop, channels are already hierarchical sorted from root to children,
+			 *    independent groups of channels of large poses are solved in parallel */
+			groups = pose_solve_groups_create(ob);
+			if (groups) {
+				pose_solve_groups_evaluate(scene, ob, ctime, groups);
+				pose_solve_groups_free(groups);
 			}
-			/* 5. otherwise just call the normal solver */
-			else if (!(pchan->flag & POSE_DONE)) {
-				BKE_pose_where_is_bone(scene, ob, pchan, ctime, 1);
+			else {
+				for (pchan = ob->pose->chanbase.first; pchan; pchan = pchan->next) {
+					pose_solve_channel(scene, ob, pchan, ctime);
+				}
 			}
+			/* 6. release the IK tree */
+			BIK_release_tree(scene, ob, ctime);
+
+			BKE_playback_cache_pose_store(ob);
 		}
-		/* 6. release the IK tree */
-		BIK_release_tree(scene, ob, ctime);
 	}
 
 	/* calculating deform matrices */
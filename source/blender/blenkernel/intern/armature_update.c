@@ -44,6 +44,7 @@
 #include "BKE_depsgraph.h"
 #include "BKE_displist.h"
 #include "BKE_fcurve.h"
+#include "BKE_playback_cache.h"
 #include "BKE_scene.h"
 
 #include "BIK_api.h"
@@ -577,6 +578,11 @@ void BKE_pose_eval_init(EvaluationContext *UNUSED(eval_ctx),
 	/* imat is needed for solvers. */
 	invert_m4_m4(ob->imat, ob->obmat);
 
+	/* Pose from the playback cache, all channels are marked as done. */
+	if (BKE_playback_cache_pose_restore(ob)) {
+		return;
+	}
+
 	/* 1. clear flags */
 	for (pchan = pose->chanbase.first; pchan != NULL; pchan = pchan->next) {
 		pchan->flag &= ~(POSE_DONE | POSE_CHAIN | POSE_IKTREE | POSE_IKSPLINE);
@@ -691,6 +697,8 @@ void BKE_pose_eval_flush(EvaluationContext *UNUSED(eval_ctx),
 	/* 6. release the IK tree */
 	BIK_release_tree(scene, ob, ctime);
 
+	BKE_playback_cache_pose_store(ob);
+
 	ob->recalc &= ~OB_RECALC_ALL;
 }
 
@@ -57,6 +57,7 @@
 #include "BKE_image.h"
 #include "BKE_library.h"
 #include "BKE_node.h"
+#include "BKE_playback_cache.h"
 #include "BKE_report.h"
 #include "BKE_scene.h"
 #include "BKE_screen.h"
@@ -95,6 +96,7 @@ void BKE_blender_free(void)
 	BLI_callback_global_finalize();
 
 	BKE_sequencer_cache_destruct();
+	BKE_playback_cache_end();
 	IMB_moviecache_destruct();
 	
 	free_nodesystem();
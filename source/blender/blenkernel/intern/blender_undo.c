@@ -84,6 +84,15 @@ typedef struct UndoElem {
 static ListBase undobase = {NULL, NULL};
 static UndoElem *curundo = NULL;
 
+/* steps older than this (counting back from the newest) are compressed */
+#define UNDO_STEPS_UNCOMPRESSED 4
+
+/* restore a compressed step before reading it, it counts at its full size again */
+static void undo_memfile_uncompress(UndoElem *uel)
+{
+	uel->undosize += BLO_memfile_uncompress(&uel->memfile);
+}
+
 /**
  * Avoid bad-level call to #WM_jobs_kill_all_except()
  */
@@ -107,10 +116,13 @@ static int read_undosave(bContext *C, UndoElem *uel)
 	fileflags = G.fileflags;
 	G.fileflags |= G_FILE_NO_UI;
 
-	if (UNDO_DISK)
+	if (UNDO_DISK) {
 		success = (BKE_blendfile_read(C, uel->str, NULL, 0) != BKE_BLENDFILE_READ_FAIL);
-	else
+	}
+	else {
+		undo_memfile_uncompress(uel);
 		success = BKE_blendfile_read_from_memfile(C, &uel->memfile, NULL, 0);
+	}
 
 	/* restore */
 	BLI_strncpy(G.main->name, mainstr, sizeof(G.main->name)); /* restore */
@@ -191,12 +203,25 @@ void BKE_undo_write(bContext *C, const char *name)
 	}
 	else {
 		MemFile *prevfile = NULL;
+		int mem_category;
 
 		if (curundo->prev) prevfile = &(curundo->prev->memfile);
 
+		mem_category = MEM_category_begin(MEM_CATEGORY_UNDO);
 		memused = MEM_get_memory_in_use();
 		/* success = */ /* UNUSED */ BLO_write_file_mem(CTX_data_main(C), prevfile, &curundo->memfile, G.fileflags);
 		curundo->undosize = MEM_get_memory_in_use() - memused;
+
+		/* compress the step which just went out of reach of quick undo steps */
+		uel = curundo;
+		for (nr = 0; uel && nr < UNDO_STEPS_UNCOMPRESSED; nr++) {
+			uel = uel->prev;
+		}
+		if (uel) {
+			const size_t saved = BLO_memfile_compress(&uel->memfile);
+			uel->undosize -= MIN2(saved, uel->undosize);
+		}
+		MEM_category_end(mem_category);
 	}
 
 	if (U.undomemory != 0) {
@@ -369,6 +394,8 @@ bool BKE_undo_save_file(const char *filename)
 		return false;
 	}
 
+	undo_memfile_uncompress(uel);
+
 	for (chunk = uel->memfile.chunks.first; chunk; chunk = chunk->next) {
 		if (write(file, chunk->buf, chunk->size) != chunk->size) {
 			break;
@@ -385,11 +412,26 @@ bool BKE_undo_save_file(const char *filename)
 	return true;
 }
 
+/**
+ * \return the memfile of the current undo step, or NULL when global undo isn't used.
+ */
+const MemFile *BKE_undo_memfile_get(void)
+{
+	if ((U.uiflag & USER_GLOBALUNDO) == 0 || curundo == NULL) {
+		return NULL;
+	}
+	undo_memfile_uncompress(curundo);
+	return &curundo->memfile;
+}
+
 /* sets curscene */
 Main *BKE_undo_get_main(Scene **r_scene)
 {
 	Main *mainp = NULL;
-	BlendFileData *bfd = BLO_read_from_memfile(G.main, G.main->name, &curundo->memfile, NULL, BLO_READ_SKIP_NONE);
+	BlendFileData *bfd;
+
+	undo_memfile_uncompress(curundo);
+	bfd = BLO_read_from_memfile(G.main, G.main->name, &curundo->memfile, NULL, BLO_READ_SKIP_NONE);
 
 	if (bfd) {
 		mainp = bfd->main;
@@ -2068,6 +2068,8 @@ DerivedMesh *CDDM_from_mesh(Mesh *mesh)
 	CustomDataMask mask = CD_MASK_MESH & (~CD_MASK_MDISPS);
 	int alloctype;
 
+	BKE_mesh_lazy_data_ensure(G.main, mesh);
+
 	/* this does a referenced copy, with an exception for fluidsim */
 
 	DM_init(dm, DM_TYPE_CDDM, mesh->totvert, mesh->totedge, 0 /* mesh->totface */,
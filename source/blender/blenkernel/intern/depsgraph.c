@@ -82,6 +82,7 @@
 #include "BKE_object.h"
 #include "BKE_paint.h"
 #include "BKE_particle.h"
+#include "BKE_playback_cache.h"
 #include "BKE_pointcache.h"
 #include "BKE_scene.h"
 #include "BKE_screen.h"
@@ -1720,6 +1721,8 @@ void DAG_relations_tag_update(Main *bmain)
 		for (sce = bmain->scene.first; sce; sce = sce->id.next) {
 			dag_scene_tag_rebuild(sce);
 		}
+		BKE_animsys_eval_cache_invalidate();
+		BKE_playback_cache_invalidate();
 	}
 	else {
 		/* New dependency graph. */
@@ -1727,6 +1730,17 @@ void DAG_relations_tag_update(Main *bmain)
 	}
 }
 
+/* tag relations of a single ID for update */
+void DAG_id_relations_tag_update(Main *bmain, ID *id)
+{
+	if (DEG_depsgraph_use_legacy()) {
+		DAG_relations_tag_update(bmain);
+	}
+	else {
+		DEG_id_relations_tag_update(bmain, id);
+	}
+}
+
 /* rebuild dependency graph only for a given scene */
 void DAG_scene_relations_rebuild(Main *bmain, Scene *sce)
 {
@@ -2963,6 +2977,9 @@ void DAG_id_tag_update_ex(Main *bmain, ID *id, short flag)
 
 	if (id == NULL) return;
 
+	BKE_animsys_eval_cache_invalidate();
+	BKE_playback_cache_invalidate();
+
 	if (G.debug & G_DEBUG_DEPSGRAPH) {
 		printf("%s: id=%s flag=%d\n", __func__, id->name, flag);
 	}
@@ -3621,6 +3638,12 @@ void DAG_relations_tag_update(Main *bmain)
 	DEG_relations_tag_update(bmain);
 }
 
+/* Tag relations of a single ID for update. */
+void DAG_id_relations_tag_update(Main *bmain, ID *id)
+{
+	DEG_id_relations_tag_update(bmain, id);
+}
+
 /* Rebuild dependency graph only for a given scene. */
 void DAG_scene_relations_rebuild(Main *bmain, Scene *scene)
 {
@@ -3694,7 +3717,7 @@ void DAG_print_dependencies(Main *UNUSED(bmain),
                             Scene *scene,
                             Object *UNUSED(ob))
 {
-	DEG_debug_graphviz(scene->depsgraph, stdout, "Depsgraph", false);
+	DEG_debug_graphviz(scene->depsgraph, stdout, "Depsgraph", false, false);
 }
 
 #endif
@@ -45,7 +45,9 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
+#include "BLI_alloca.h"
 #include "BLI_easing.h"
+#include "BLI_expr_pylike_eval.h"
 #include "BLI_threads.h"
 #include "BLI_string_utils.h"
 #include "BLI_utildefines.h"
@@ -75,6 +77,8 @@
 static ThreadMutex python_driver_lock = BLI_MUTEX_INITIALIZER;
 #endif
 
+static ThreadMutex simple_driver_lock = BLI_MUTEX_INITIALIZER;
+
 /* ************************** Data-Level Functions ************************* */
 
 /* ---------------------- Freeing --------------------------- */
@@ -1625,11 +1629,8 @@ void driver_free_variable_ex(ChannelDriver *driver, DriverVar *dvar)
 	/* remove and free the driver variable */
 	driver_free_variable(&driver->variables, dvar);
 	
-#ifdef WITH_PYTHON
 	/* since driver variables are cached, the expression needs re-compiling too */
-	if (driver->type == DRIVER_TYPE_PYTHON)
-		driver->flag |= DRIVER_FLAG_RENAMEVAR;
-#endif
+	driver_invalidate_expression(driver, false, true);
 }
 
 /* Copy driver variables from src_vars list to dst_vars list */
@@ -1766,11 +1767,8 @@ DriverVar *driver_add_new_variable(ChannelDriver *driver)
 	/* set the default type to 'single prop' */
 	driver_change_variable_type(dvar, DVAR_TYPE_SINGLE_PROP);
 	
-#ifdef WITH_PYTHON
 	/* since driver variables are cached, the expression needs re-compiling too */
-	if (driver->type == DRIVER_TYPE_PYTHON)
-		driver->flag |= DRIVER_FLAG_RENAMEVAR;
-#endif
+	driver_invalidate_expression(driver, false, true);
 	
 	/* return the target */
 	return dvar;
@@ -1799,6 +1797,8 @@ void fcurve_free_driver(FCurve *fcu)
 		BPY_DECREF(driver->expr_comp);
 #endif
 
+	BLI_expr_pylike_free(driver->expr_simple);
+
 	/* free driver itself, then set F-Curve's point to this to NULL (as the curve may still be used) */
 	MEM_freeN(driver);
 	fcu->driver = NULL;
@@ -1816,6 +1816,7 @@ ChannelDriver *fcurve_copy_driver(const ChannelDriver *driver)
 	/* copy all data */
 	ndriver = MEM_dupallocN(driver);
 	ndriver->expr_comp = NULL;
+	ndriver->expr_simple = NULL;
 	
 	/* copy variables */
 	BLI_listbase_clear(&ndriver->variables); /* to get rid of refs to non-copied data (that's still used on original) */ 
@@ -1825,6 +1826,110 @@ ChannelDriver *fcurve_copy_driver(const ChannelDriver *driver)
 	return ndriver;
 }
 
+/* Driver Expression Evaluation --------------- */
+
+/* Compile the expression for evaluation without Python on first use.
+ * "frame" comes first, so variables with the same name override it like Python locals. */
+static ExprPyLike_Parsed *driver_get_simple_expr(ChannelDriver *driver)
+{
+	ExprPyLike_Parsed *expr;
+
+	BLI_mutex_lock(&simple_driver_lock);
+
+	if (driver->expr_simple == NULL) {
+		const int names_len = 1 + BLI_listbase_count(&driver->variables);
+		const char **names = BLI_array_alloca(names, (size_t)names_len);
+		DriverVar *dvar;
+		int i = 0;
+
+		names[i++] = "frame";
+		for (dvar = driver->variables.first; dvar; dvar = dvar->next) {
+			names[i++] = dvar->name;
+		}
+
+		driver->expr_simple = BLI_expr_pylike_parse(driver->expression, names, names_len);
+	}
+	expr = driver->expr_simple;
+
+	BLI_mutex_unlock(&simple_driver_lock);
+
+	return expr;
+}
+
+/* Evaluate the expression without Python (or its lock), when it only uses the simple
+ * subset of Python. Returns false when Python has to be used instead. */
+static bool driver_evaluate_simple_expr(ChannelDriver *driver, const float evaltime, float *r_value)
+{
+	ExprPyLike_Parsed *expr = driver_get_simple_expr(driver);
+	eExprPyLike_EvalStatus status;
+	DriverVar *dvar;
+	double *vars, result;
+	int vars_len, i = 0;
+
+	if (!BLI_expr_pylike_is_valid(expr)) {
+		return false;
+	}
+
+	vars_len = 1 + BLI_listbase_count(&driver->variables);
+	vars = BLI_array_alloca(vars, (size_t)vars_len);
+
+	vars[i++] = evaltime;
+	for (dvar = driver->variables.first; dvar; dvar = dvar->next) {
+		vars[i++] = driver_get_variable_value(driver, dvar);
+	}
+
+	status = BLI_expr_pylike_eval(expr, vars, vars_len, &result);
+
+	switch (status) {
+		case EXPR_PYLIKE_SUCCESS:
+			if (isfinite(result)) {
+				*r_value = (float)result;
+			}
+			else {
+				fprintf(stderr, "\t%s: driver '%s' evaluates to '%f'\n", __func__, driver->expression, result);
+				*r_value = 0.0f;
+			}
+			break;
+		case EXPR_PYLIKE_DIV_BY_ZERO:
+		case EXPR_PYLIKE_MATH_ERROR:
+		{
+			const char *message = (status == EXPR_PYLIKE_DIV_BY_ZERO) ? "Division by Zero" : "Math Domain Error";
+
+			fprintf(stderr, "\n%s in Driver: '%s'\n\n", message, driver->expression);
+			driver->flag |= DRIVER_FLAG_INVALID;
+			*r_value = 0.0f;
+			break;
+		}
+		default:
+			/* the variables changed without invalidating the expression */
+			BLI_assert(0);
+			driver->flag |= DRIVER_FLAG_INVALID;
+			*r_value = 0.0f;
+			break;
+	}
+
+	return true;
+}
+
+/* Clear the compiled forms of the expression after it or the variable names changed. */
+void driver_invalidate_expression(ChannelDriver *driver, bool expr_changed, bool varname_changed)
+{
+	if (expr_changed || varname_changed) {
+		BLI_expr_pylike_free(driver->expr_simple);
+		driver->expr_simple = NULL;
+	}
+
+#ifdef WITH_PYTHON
+	if (expr_changed) {
+		driver->flag |= DRIVER_FLAG_RECOMPILE;
+	}
+
+	if (varname_changed) {
+		driver->flag |= DRIVER_FLAG_RENAMEVAR;
+	}
+#endif
+}
+
 /* Driver Evaluation -------------------------- */
 
 /* Evaluate a Driver Variable to get a value that contributes to the final */
@@ -1927,14 +2032,14 @@ float evaluate_driver(PathResolvedRNA *anim_rna, ChannelDriver *driver, const fl
 		}
 		case DRIVER_TYPE_PYTHON: /* expression */
 		{
-#ifdef WITH_PYTHON
 			/* check for empty or invalid expression */
 			if ( (driver->expression[0] == '\0') ||
 			     (driver->flag & DRIVER_FLAG_INVALID) )
 			{
 				driver->curval = 0.0f;
 			}
-			else {
+			else if (!driver_evaluate_simple_expr(driver, evaltime, &driver->curval)) {
+#ifdef WITH_PYTHON
 				/* this evaluates the expression using Python, and returns its result:
 				 *  - on errors it reports, then returns 0.0f
 				 */
@@ -1943,10 +2048,10 @@ float evaluate_driver(PathResolvedRNA *anim_rna, ChannelDriver *driver, const fl
 				driver->curval = BPY_driver_exec(anim_rna, driver, evaltime);
 
 				BLI_mutex_unlock(&python_driver_lock);
-			}
 #else /* WITH_PYTHON*/
-			UNUSED_VARS(anim_rna, evaltime);
+				UNUSED_VARS(anim_rna);
 #endif /* WITH_PYTHON*/
+			}
 			break;
 		}
 		default:
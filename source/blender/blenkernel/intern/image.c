@@ -4068,10 +4068,14 @@ static ImBuf *image_acquire_ibuf(Image *ima, ImageUser *iuser, void **r_lock)
 ImBuf *BKE_image_acquire_ibuf(Image *ima, ImageUser *iuser, void **r_lock)
 {
 	ImBuf *ibuf;
+	int mem_category;
 
 	BLI_spin_lock(&image_spin);
 
+	/* images which are not loaded yet are read here */
+	mem_category = MEM_category_begin(MEM_CATEGORY_IMAGE);
 	ibuf = image_acquire_ibuf(ima, iuser, r_lock);
+	MEM_category_end(mem_category);
 
 	BLI_spin_unlock(&image_spin);
 
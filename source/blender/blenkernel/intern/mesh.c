@@ -68,6 +68,8 @@
 
 #include "DEG_depsgraph.h"
 
+#include "BLO_readfile.h"
+
 /* Define for cases when you want extra validation of mesh
  * after certain modifications.
  */
@@ -287,6 +289,9 @@ const char *BKE_mesh_cmp(Mesh *me1, Mesh *me2, float thresh)
 	
 	if (!me1 || !me2)
 		return "Requires two input meshes";
+
+	BKE_mesh_lazy_data_ensure(G.main, me1);
+	BKE_mesh_lazy_data_ensure(G.main, me2);
 	
 	if (me1->totvert != me2->totvert) 
 		return "Number of verts don't match";
@@ -501,11 +506,25 @@ Mesh *BKE_mesh_add(Main *bmain, const char *name)
 	return me;
 }
 
+/**
+ * Read the geometry of a mesh linked from a library when it has been deferred
+ * (see #BLO_library_lazy_data_ensure). Call before accessing the custom-data or element counts.
+ */
+void BKE_mesh_lazy_data_ensure(Main *bmain, Mesh *me)
+{
+	BLO_library_lazy_data_ensure(bmain, &me->id, NULL);
+}
+
 Mesh *BKE_mesh_copy(Main *bmain, const Mesh *me)
 {
 	Mesh *men;
 	int a;
-	const int do_tessface = ((me->totface != 0) && (me->totpoly == 0)); /* only do tessface if we have no polys */
+	int do_tessface;
+
+	/* linked geometry may not have been read yet */
+	BKE_mesh_lazy_data_ensure(bmain, (Mesh *)me);
+
+	do_tessface = ((me->totface != 0) && (me->totpoly == 0)); /* only do tessface if we have no polys */
 	
 	men = BKE_libblock_copy(bmain, &me->id);
 	
@@ -562,6 +581,9 @@ BMesh *BKE_mesh_to_bmesh(
 
 void BKE_mesh_make_local(Main *bmain, Mesh *me, const bool lib_local)
 {
+	/* local data can't be read from the library later */
+	BKE_mesh_lazy_data_ensure(bmain, me);
+
 	BKE_id_make_local_generic(bmain, &me->id, true, lib_local);
 }
 
@@ -740,6 +762,7 @@ BoundBox *BKE_mesh_boundbox_get(Object *ob)
 		return ob->bb;
 
 	if (me->bb == NULL || (me->bb->flag & BOUNDBOX_DIRTY)) {
+		BKE_mesh_lazy_data_ensure(G.main, me);
 		BKE_mesh_texspace_calc(me);
 	}
 
@@ -1632,6 +1655,8 @@ void BKE_mesh_material_index_remove(Mesh *me, short index)
 	MFace *mf;
 	int i;
 
+	BKE_mesh_lazy_data_ensure(G.main, me);
+
 	for (mp = me->mpoly, i = 0; i < me->totpoly; i++, mp++) {
 		if (mp->mat_nr && mp->mat_nr >= index) {
 			mp->mat_nr--;
@@ -1651,6 +1676,8 @@ void BKE_mesh_material_index_clear(Mesh *me)
 	MFace *mf;
 	int i;
 
+	BKE_mesh_lazy_data_ensure(G.main, me);
+
 	for (mp = me->mpoly, i = 0; i < me->totpoly; i++, mp++) {
 		mp->mat_nr = 0;
 	}
@@ -1670,6 +1697,8 @@ void BKE_mesh_material_remap(Mesh *me, const unsigned int *remap, unsigned int r
 		n = remap[n]; \
 	} ((void)0)
 
+	BKE_mesh_lazy_data_ensure(G.main, me);
+
 	if (me->edit_btmesh) {
 		BMEditMesh *em = me->edit_btmesh;
 		BMIter iter;
@@ -1724,8 +1753,13 @@ void BKE_mesh_smooth_flag_set(Object *meshOb, int enableSmooth)
  */
 float (*BKE_mesh_vertexCos_get(const Mesh *me, int *r_numVerts))[3]
 {
-	int i, numVerts = me->totvert;
-	float (*cos)[3] = MEM_mallocN(sizeof(*cos) * numVerts, "vertexcos1");
+	int i, numVerts;
+	float (*cos)[3];
+
+	BKE_mesh_lazy_data_ensure(G.main, (Mesh *)me);
+
+	numVerts = me->totvert;
+	cos = MEM_mallocN(sizeof(*cos) * numVerts, "vertexcos1");
 
 	if (r_numVerts) *r_numVerts = numVerts;
 	for (i = 0; i < numVerts; i++)
@@ -1795,8 +1829,12 @@ int BKE_mesh_edge_other_vert(const MEdge *e, int v)
 /* basic vertex data functions */
 bool BKE_mesh_minmax(const Mesh *me, float r_min[3], float r_max[3])
 {
-	int i = me->totvert;
+	int i;
 	MVert *mvert;
+
+	BKE_mesh_lazy_data_ensure(G.main, (Mesh *)me);
+
+	i = me->totvert;
 	for (mvert = me->mvert; i--; mvert++) {
 		minmax_v3v3_v3(r_min, r_max, mvert->co);
 	}
@@ -1807,8 +1845,13 @@ bool BKE_mesh_minmax(const Mesh *me, float r_min[3], float r_max[3])
 void BKE_mesh_transform(Mesh *me, float mat[4][4], bool do_keys)
 {
 	int i;
-	MVert *mvert = me->mvert;
-	float (*lnors)[3] = CustomData_get_layer(&me->ldata, CD_NORMAL);
+	MVert *mvert;
+	float (*lnors)[3];
+
+	BKE_mesh_lazy_data_ensure(G.main, me);
+
+	mvert = me->mvert;
+	lnors = CustomData_get_layer(&me->ldata, CD_NORMAL);
 
 	for (i = 0; i < me->totvert; i++, mvert++)
 		mul_m4_v3(mat, mvert->co);
@@ -1838,8 +1881,12 @@ void BKE_mesh_transform(Mesh *me, float mat[4][4], bool do_keys)
 
 void BKE_mesh_translate(Mesh *me, const float offset[3], const bool do_keys)
 {
-	int i = me->totvert;
+	int i;
 	MVert *mvert;
+
+	BKE_mesh_lazy_data_ensure(G.main, me);
+
+	i = me->totvert;
 	for (mvert = me->mvert; i--; mvert++) {
 		add_v3_v3(mvert->co, offset);
 	}
@@ -1871,6 +1918,8 @@ void BKE_mesh_ensure_navmesh(Mesh *me)
 
 void BKE_mesh_tessface_calc(Mesh *mesh)
 {
+	BKE_mesh_lazy_data_ensure(G.main, mesh);
+
 	mesh->totface = BKE_mesh_recalc_tessellation(&mesh->fdata, &mesh->ldata, &mesh->pdata,
 	                                             mesh->mvert,
 	                                             mesh->totface, mesh->totloop, mesh->totpoly,
@@ -1882,6 +1931,8 @@ void BKE_mesh_tessface_calc(Mesh *mesh)
 
 void BKE_mesh_tessface_ensure(Mesh *mesh)
 {
+	BKE_mesh_lazy_data_ensure(G.main, mesh);
+
 	if (mesh->totpoly && mesh->totface == 0) {
 		BKE_mesh_tessface_calc(mesh);
 	}
@@ -2063,6 +2114,8 @@ void BKE_mesh_calc_normals_split_ex(Mesh *mesh, MLoopNorSpaceArray *r_lnors_spac
 	short (*clnors)[2] = NULL;
 	bool free_polynors = false;
 
+	BKE_mesh_lazy_data_ensure(G.main, mesh);
+
 	if (CustomData_has_layer(&mesh->ldata, CD_NORMAL)) {
 		r_loopnors = CustomData_get_layer(&mesh->ldata, CD_NORMAL);
 		memset(r_loopnors, 0, sizeof(float[3]) * mesh->totloop);
@@ -2346,6 +2399,8 @@ static void split_faces_split_new_edges(
  */
 void BKE_mesh_split_faces(Mesh *mesh, bool free_loop_normals)
 {
+	BKE_mesh_lazy_data_ensure(G.main, mesh);
+
 	const int num_polys = mesh->totpoly;
 
 	if (num_polys == 0) {
@@ -2553,6 +2608,9 @@ Mesh *BKE_mesh_new_from_object(
 
 		}
 		case OB_MESH:
+			/* linked geometry may not have been read yet */
+			BKE_mesh_lazy_data_ensure(bmain, ob->data);
+
 			/* copies object and modifiers (but not the data) */
 			if (cage) {
 				/* copies the data */
@@ -306,6 +306,7 @@ void BKE_mesh_calc_normals(Mesh *mesh)
 #ifdef DEBUG_TIME
 	TIMEIT_START_AVERAGED(BKE_mesh_calc_normals);
 #endif
+	BKE_mesh_lazy_data_ensure(G.main, mesh);
 	BKE_mesh_calc_normals_poly(mesh->mvert, NULL, mesh->totvert,
 	                           mesh->mloop, mesh->mpoly, mesh->totloop, mesh->totpoly,
 	                           NULL, false);
@@ -1784,6 +1785,8 @@ void BKE_mesh_loop_tangents(Mesh *mesh, const char *uvmap, float (*r_looptangent
 	MLoopUV *loopuvs;
 	float (*loopnors)[3];
 
+	BKE_mesh_lazy_data_ensure(G.main, mesh);
+
 	/* Check we have valid texture coordinates first! */
 	if (uvmap) {
 		loopuvs = CustomData_get_layer_named(&mesh->ldata, CD_MLOOPUV, uvmap);
@@ -2131,8 +2134,12 @@ void BKE_mesh_poly_edgebitmap_insert(unsigned int *edge_bitmap, const MPoly *mp,
 
 bool BKE_mesh_center_median(const Mesh *me, float r_cent[3])
 {
-	int i = me->totvert;
+	int i;
 	const MVert *mvert;
+
+	BKE_mesh_lazy_data_ensure(G.main, (Mesh *)me);
+
+	i = me->totvert;
 	zero_v3(r_cent);
 	for (mvert = me->mvert; i--; mvert++) {
 		add_v3_v3(r_cent, mvert->co);
@@ -2159,12 +2166,15 @@ bool BKE_mesh_center_bounds(const Mesh *me, float r_cent[3])
 
 bool BKE_mesh_center_centroid(const Mesh *me, float r_cent[3])
 {
-	int i = me->totpoly;
+	int i;
 	MPoly *mpoly;
 	float poly_volume;
 	float total_volume = 0.0f;
 	float poly_cent[3];
 
+	BKE_mesh_lazy_data_ensure(G.main, (Mesh *)me);
+
+	i = me->totpoly;
 	zero_v3(r_cent);
 
 	/* calculate a weighted average of polyhedron centroids */
@@ -45,6 +45,7 @@
 #include "BKE_deform.h"
 #include "BKE_depsgraph.h"
 #include "BKE_DerivedMesh.h"
+#include "BKE_global.h"
 #include "BKE_mesh.h"
 
 #include "MEM_guardedalloc.h"
@@ -997,6 +998,8 @@ int BKE_mesh_validate(Mesh *me, const int do_verbose, const int cddata_check_mas
 	bool is_valid = true;
 	bool changed;
 
+	BKE_mesh_lazy_data_ensure(G.main, me);
+
 	if (do_verbose) {
 		printf("MESH: %s\n", me->id.name + 2);
 	}
@@ -1452,11 +1455,14 @@ void BKE_mesh_calc_edges(Mesh *mesh, bool update, const bool select)
 	MEdge *med, *med_orig;
 	EdgeHash *eh;
 	unsigned int eh_reserve;
-	int i, totedge, totpoly = mesh->totpoly;
+	int i, totedge, totpoly;
 	int med_index;
 	/* select for newly created meshes which are selected [#25595] */
 	const short ed_flag = (ME_EDGEDRAW | ME_EDGERENDER) | (select ? SELECT : 0);
 
+	BKE_mesh_lazy_data_ensure(G.main, mesh);
+
+	totpoly = mesh->totpoly;
 	if (mesh->totedge == 0)
 		update = false;
 
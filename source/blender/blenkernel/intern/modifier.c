@@ -54,6 +54,7 @@
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_string_utils.h"
+#include "BLI_trace.h"
 
 #include "BLT_translation.h"
 
@@ -742,7 +743,10 @@ struct DerivedMesh *modwrap_applyModifier(
 	if (mti->dependsOnNormals && mti->dependsOnNormals(md)) {
 		DM_ensure_normals(dm);
 	}
-	return mti->applyModifier(md, ob, dm, flag);
+	BLI_trace_zone_begin(md->name);
+	dm = mti->applyModifier(md, ob, dm, flag);
+	BLI_trace_zone_end();
+	return dm;
 }
 
 struct DerivedMesh *modwrap_applyModifierEM(
@@ -757,7 +761,10 @@ struct DerivedMesh *modwrap_applyModifierEM(
 	if (mti->dependsOnNormals && mti->dependsOnNormals(md)) {
 		DM_ensure_normals(dm);
 	}
-	return mti->applyModifierEM(md, ob, em, dm, flag);
+	BLI_trace_zone_begin(md->name);
+	dm = mti->applyModifierEM(md, ob, em, dm, flag);
+	BLI_trace_zone_end();
+	return dm;
 }
 
 void modwrap_deformVerts(
@@ -772,7 +779,9 @@ void modwrap_deformVerts(
 	if (dm && mti->dependsOnNormals && mti->dependsOnNormals(md)) {
 		DM_ensure_normals(dm);
 	}
+	BLI_trace_zone_begin(md->name);
 	mti->deformVerts(md, ob, dm, vertexCos, numVerts, flag);
+	BLI_trace_zone_end();
 }
 
 void modwrap_deformVertsEM(
@@ -786,6 +795,8 @@ void modwrap_deformVertsEM(
 	if (dm && mti->dependsOnNormals && mti->dependsOnNormals(md)) {
 		DM_ensure_normals(dm);
 	}
+	BLI_trace_zone_begin(md->name);
 	mti->deformVertsEM(md, ob, em, dm, vertexCos, numVerts);
+	BLI_trace_zone_end();
 }
 /* end modifier callback wrappers */
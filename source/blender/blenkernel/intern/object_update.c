@@ -61,6 +61,8 @@
 
 #include "DEG_depsgraph.h"
 
+#include "BLO_readfile.h"
+
 #ifdef WITH_LEGACY_DEPSGRAPH
 #  define DEBUG_PRINT if (!DEG_depsgraph_use_legacy() && G.debug & G_DEBUG_DEPSGRAPH) printf
 #else
@@ -157,6 +159,11 @@ void BKE_object_handle_data_update(EvaluationContext *eval_ctx,
 	if (G.debug & G_DEBUG_DEPSGRAPH)
 		printf("recalcdata %s\n", ob->id.name + 2);
 
+	/* data linked from a library may be read on first evaluation */
+	if (data_id) {
+		BLO_library_lazy_data_ensure(G.main, data_id, NULL);
+	}
+
 	/* TODO(sergey): Only used by legacy depsgraph. */
 	if (adt) {
 		/* evaluate drivers - datalevel */
@@ -0,0 +1,421 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2017 Blender Foundation.
+ * All rights reserved.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenkernel/intern/playback_cache.c
+ *  \ingroup bke
+ *
+ * While the animation plays back, evaluated meshes and poses are stored per
+ * object and frame. Once playback loops over the frame range again, a copy
+ * of the stored result is used and the modifier stack or pose solver is
+ * skipped for that object.
+ *
+ * Any update tag drops the whole cache, and memory is bounded by the memory
+ * cache limit from the user preferences.
+ */
+
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_ghash.h"
+#include "BLI_listbase.h"
+#include "BLI_math.h"
+#include "BLI_threads.h"
+
+#include "DNA_action_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BKE_cdderivedmesh.h"
+#include "BKE_depsgraph.h"
+#include "BKE_DerivedMesh.h"
+#include "BKE_global.h"
+#include "BKE_playback_cache.h"
+#include "BKE_pointcache.h"
+
+typedef struct PlaybackCachePoseChannel {
+	bPoseChannel *pchan;
+	float pose_mat[4][4];
+	float pose_head[3];
+	float pose_tail[3];
+} PlaybackCachePoseChannel;
+
+typedef struct PlaybackCacheEntry {
+	/* Mesh objects. */
+	DerivedMesh *final_dm;
+	DerivedMesh *deform_dm;
+	CustomDataMask data_mask;
+	bool need_mapping;
+
+	/* Armature objects. */
+	PlaybackCachePoseChannel *channels;
+	int totchannel;
+
+	size_t mem_size;
+} PlaybackCacheEntry;
+
+static struct {
+	/* GHashPair(object, frame) -> PlaybackCacheEntry, NULL when not playing. */
+	GHash *entries;
+	Scene *scene;
+	size_t mem_in_use;
+	size_t mem_limit;
+	int frame;
+	/* Only set while a frame of the playing scene is evaluated. */
+	bool is_evaluating;
+} playback_cache = {NULL};
+
+/* Objects are evaluated from multiple threads, the lock protects the hash
+ * and the memory counter. Entries are never freed during evaluation, so their
+ * contents can be read without holding it.
+ */
+static ThreadMutex playback_cache_lock = BLI_MUTEX_INITIALIZER;
+
+/* ************************************************************************** */
+/* Entries */
+
+static void playback_cache_entry_free(void *entry_v)
+{
+	PlaybackCacheEntry *entry = entry_v;
+
+	if (entry->final_dm) {
+		entry->final_dm->release(entry->final_dm);
+	}
+	if (entry->deform_dm) {
+		entry->deform_dm->release(entry->deform_dm);
+	}
+	MEM_SAFE_FREE(entry->channels);
+	MEM_freeN(entry);
+}
+
+static PlaybackCacheEntry *playback_cache_lookup(Object *ob)
+{
+	GHashPair key = {ob, SET_INT_IN_POINTER(playback_cache.frame)};
+	return BLI_ghash_lookup(playback_cache.entries, &key);
+}
+
+static bool playback_cache_has_room(void)
+{
+	return playback_cache.mem_in_use < playback_cache.mem_limit;
+}
+
+/* Takes ownership of the entry, replacing an existing one for the same frame. */
+static void playback_cache_insert(Object *ob, PlaybackCacheEntry *entry)
+{
+	GHashPair key = {ob, SET_INT_IN_POINTER(playback_cache.frame)};
+	PlaybackCacheEntry *old_entry;
+
+	BLI_mutex_lock(&playback_cache_lock);
+	old_entry = BLI_ghash_popkey(playback_cache.entries, &key, BLI_ghashutil_pairfree);
+	if (old_entry) {
+		playback_cache.mem_in_use -= old_entry->mem_size;
+	}
+	if (playback_cache.mem_in_use + entry->mem_size <= playback_cache.mem_limit) {
+		BLI_ghash_insert(playback_cache.entries,
+		                 BLI_ghashutil_pairalloc(ob, SET_INT_IN_POINTER(playback_cache.frame)),
+		                 entry);
+		playback_cache.mem_in_use += entry->mem_size;
+		entry = NULL;
+	}
+	BLI_mutex_unlock(&playback_cache_lock);
+
+	if (old_entry) {
+		playback_cache_entry_free(old_entry);
+	}
+	if (entry) {
+		playback_cache_entry_free(entry);
+	}
+}
+
+static bool playback_cache_use_object(Object *ob)
+{
+	ListBase pidlist;
+	bool has_point_cache;
+
+	if (!playback_cache.is_evaluating) {
+		return false;
+	}
+
+	/* Painting and sculpting modes keep their own data in sync with the mesh. */
+	if (ob->mode & ~OB_MODE_POSE) {
+		return false;
+	}
+
+	if (ob->type == OB_ARMATURE) {
+		bArmature *arm = ob->data;
+		if (arm->edbo || (arm->flag & ARM_RESTPOS)) {
+			return false;
+		}
+	}
+
+	/* Simulations step from the previous frame, skipping their evaluation
+	 * would leave them out of sync with the point cache.
+	 */
+	BKE_ptcache_ids_from_object(&pidlist, ob, playback_cache.scene, 0);
+	has_point_cache = !BLI_listbase_is_empty(&pidlist);
+	BLI_freelistN(&pidlist);
+
+	return !has_point_cache;
+}
+
+/* ************************************************************************** */
+/* Playback */
+
+void BKE_playback_cache_begin(Scene *scene)
+{
+	BKE_playback_cache_end();
+
+	if ((scene->flag & SCE_PLAYBACK_CACHE) == 0) {
+		return;
+	}
+
+	playback_cache.entries = BLI_ghash_pair_new(__func__);
+	playback_cache.scene = scene;
+	playback_cache.mem_in_use = 0;
+	/* Zero means no limit, same as for the sequencer cache. */
+	playback_cache.mem_limit = (U.memcachelimit > 0) ?
+	                           (size_t)U.memcachelimit * 1024 * 1024 :
+	                           (size_t)-1;
+}
+
+void BKE_playback_cache_end(void)
+{
+	if (playback_cache.entries) {
+		BLI_ghash_free(playback_cache.entries, BLI_ghashutil_pairfree, playback_cache_entry_free);
+		playback_cache.entries = NULL;
+	}
+	playback_cache.scene = NULL;
+	playback_cache.mem_in_use = 0;
+	playback_cache.is_evaluating = false;
+}
+
+bool BKE_playback_cache_is_active(void)
+{
+	return playback_cache.entries != NULL;
+}
+
+void BKE_playback_cache_invalidate(void)
+{
+	/* Tags coming from the evaluation itself do not change its input. */
+	if (playback_cache.entries == NULL || playback_cache.is_evaluating) {
+		return;
+	}
+	if (BLI_ghash_size(playback_cache.entries) == 0) {
+		return;
+	}
+
+	BLI_mutex_lock(&playback_cache_lock);
+	BLI_ghash_clear(playback_cache.entries, BLI_ghashutil_pairfree, playback_cache_entry_free);
+	playback_cache.mem_in_use = 0;
+	BLI_mutex_unlock(&playback_cache_lock);
+}
+
+void BKE_playback_cache_frame_begin(EvaluationContext *eval_ctx, Scene *scene)
+{
+	if (playback_cache.entries == NULL ||
+	    playback_cache.scene != scene ||
+	    eval_ctx->mode != DAG_EVAL_VIEWPORT ||
+	    scene->r.subframe != 0.0f ||
+	    G.is_rendering)
+	{
+		return;
+	}
+
+	playback_cache.frame = scene->r.cfra;
+	playback_cache.is_evaluating = true;
+}
+
+void BKE_playback_cache_frame_end(void)
+{
+	playback_cache.is_evaluating = false;
+}
+
+/* ************************************************************************** */
+/* Mesh */
+
+static size_t playback_cache_customdata_size(const CustomData *data, int totelem)
+{
+	size_t size = 0;
+	int i;
+
+	for (i = 0; i < data->totlayer; i++) {
+		size += (size_t)CustomData_sizeof(data->layers[i].type) * totelem;
+	}
+
+	return size;
+}
+
+static size_t playback_cache_dm_size(DerivedMesh *dm)
+{
+	return playback_cache_customdata_size(&dm->vertData, dm->numVertData) +
+	       playback_cache_customdata_size(&dm->edgeData, dm->numEdgeData) +
+	       playback_cache_customdata_size(&dm->faceData, dm->numTessFaceData) +
+	       playback_cache_customdata_size(&dm->loopData, dm->numLoopData) +
+	       playback_cache_customdata_size(&dm->polyData, dm->numPolyData);
+}
+
+static DerivedMesh *playback_cache_dm_copy(DerivedMesh *dm)
+{
+	DerivedMesh *dm_copy;
+
+	if (dm->getNumTessFaces(dm) > 0) {
+		dm_copy = CDDM_copy_with_tessface(dm);
+	}
+	else {
+		dm_copy = CDDM_copy(dm);
+	}
+	DM_ensure_looptri(dm_copy);
+
+	return dm_copy;
+}
+
+bool BKE_playback_cache_mesh_restore(Object *ob, CustomDataMask dataMask, bool need_mapping)
+{
+	PlaybackCacheEntry *entry;
+
+	if (!playback_cache_use_object(ob)) {
+		return false;
+	}
+
+	BLI_mutex_lock(&playback_cache_lock);
+	entry = playback_cache_lookup(ob);
+	BLI_mutex_unlock(&playback_cache_lock);
+
+	if (entry == NULL ||
+	    entry->final_dm == NULL ||
+	    (entry->data_mask & dataMask) != dataMask ||
+	    entry->need_mapping != need_mapping)
+	{
+		return false;
+	}
+
+	ob->derivedFinal = playback_cache_dm_copy(entry->final_dm);
+	ob->derivedDeform = playback_cache_dm_copy(entry->deform_dm);
+
+	return true;
+}
+
+void BKE_playback_cache_mesh_store(Object *ob, CustomDataMask dataMask, bool need_mapping)
+{
+	PlaybackCacheEntry *entry;
+
+	if (!playback_cache_use_object(ob) || !playback_cache_has_room()) {
+		return;
+	}
+
+	entry = MEM_callocN(sizeof(PlaybackCacheEntry), "playback cache mesh");
+	entry->final_dm = playback_cache_dm_copy(ob->derivedFinal);
+	entry->deform_dm = playback_cache_dm_copy(ob->derivedDeform);
+	entry->data_mask = dataMask;
+	entry->need_mapping = need_mapping;
+	entry->mem_size = playback_cache_dm_size(entry->final_dm) +
+	                  playback_cache_dm_size(entry->deform_dm);
+
+	playback_cache_insert(ob, entry);
+}
+
+/* ************************************************************************** */
+/* Pose */
+
+bool BKE_playback_cache_pose_restore(Object *ob)
+{
+	PlaybackCacheEntry *entry;
+	bPoseChannel *pchan;
+	int i;
+
+	if (!playback_cache_use_object(ob)) {
+		return false;
+	}
+
+	BLI_mutex_lock(&playback_cache_lock);
+	entry = playback_cache_lookup(ob);
+	BLI_mutex_unlock(&playback_cache_lock);
+
+	if (entry == NULL || entry->channels == NULL) {
+		return false;
+	}
+
+	/* Channels might have been rebuilt since the pose was stored. */
+	for (pchan = ob->pose->chanbase.first, i = 0; pchan; pchan = pchan->next, i++) {
+		if (i >= entry->totchannel || entry->channels[i].pchan != pchan) {
+			return false;
+		}
+	}
+	if (i != entry->totchannel) {
+		return false;
+	}
+
+	for (pchan = ob->pose->chanbase.first, i = 0; pchan; pchan = pchan->next, i++) {
+		PlaybackCachePoseChannel *channel = &entry->channels[i];
+		copy_m4_m4(pchan->pose_mat, channel->pose_mat);
+		copy_v3_v3(pchan->pose_head, channel->pose_head);
+		copy_v3_v3(pchan->pose_tail, channel->pose_tail);
+		pchan->flag &= ~(POSE_CHAIN | POSE_IKTREE | POSE_IKSPLINE);
+		pchan->flag |= POSE_DONE;
+	}
+
+	return true;
+}
+
+void BKE_playback_cache_pose_store(Object *ob)
+{
+	PlaybackCacheEntry *entry;
+	bPoseChannel *pchan;
+	int i;
+
+	if (!playback_cache_use_object(ob) ||
+	    !playback_cache_has_room() ||
+	    BLI_listbase_is_empty(&ob->pose->chanbase))
+	{
+		return;
+	}
+
+	/* Already stored when the pose was restored for this frame. */
+	BLI_mutex_lock(&playback_cache_lock);
+	entry = playback_cache_lookup(ob);
+	BLI_mutex_unlock(&playback_cache_lock);
+	if (entry != NULL) {
+		return;
+	}
+
+	entry = MEM_callocN(sizeof(PlaybackCacheEntry), "playback cache pose");
+	entry->totchannel = BLI_listbase_count(&ob->pose->chanbase);
+	entry->channels = MEM_mallocN(sizeof(PlaybackCachePoseChannel) * entry->totchannel,
+	                              "playback cache pose channels");
+	entry->mem_size = sizeof(PlaybackCachePoseChannel) * entry->totchannel;
+
+	for (pchan = ob->pose->chanbase.first, i = 0; pchan; pchan = pchan->next, i++) {
+		PlaybackCachePoseChannel *channel = &entry->channels[i];
+		channel->pchan = pchan;
+		copy_m4_m4(channel->pose_mat, pchan->pose_mat);
+		copy_v3_v3(channel->pose_head, pchan->pose_head);
+		copy_v3_v3(channel->pose_tail, pchan->pose_tail);
+	}
+
+	playback_cache_insert(ob, entry);
+}
@@ -2902,6 +2902,7 @@ int BKE_ptcache_write(PTCacheID *pid, unsigned int cfra)
 	PointCache *cache = pid->cache;
 	int totpoint = pid->totpoint(pid->calldata, cfra);
 	int overwrite = 0, error = 0;
+	int mem_category;
 
 	if (totpoint == 0 || (cfra ? pid->data_types == 0 : pid->info_types == 0))
 		return 0;
@@ -2909,6 +2910,9 @@ int BKE_ptcache_write(PTCacheID *pid, unsigned int cfra)
 	if (ptcache_write_needed(pid, cfra, &overwrite)==0)
 		return 0;
 
+	/* frames cached in memory stay allocated */
+	mem_category = MEM_category_begin(MEM_CATEGORY_CACHE);
+
 	if (pid->file_type == PTCACHE_FILE_OPENVDB && pid->write_openvdb_stream) {
 		ptcache_write_openvdb_stream(pid, cfra);
 	}
@@ -2919,6 +2923,8 @@ int BKE_ptcache_write(PTCacheID *pid, unsigned int cfra)
 		error += ptcache_write(pid, cfra, overwrite);
 	}
 
+	MEM_category_end(mem_category);
+
 	/* Mark frames skipped if more than 1 frame forwards since last non-skipped frame. */
 	if (cfra - cache->last_exact == 1 || cfra == cache->startframe) {
 		cache->last_exact = cfra;
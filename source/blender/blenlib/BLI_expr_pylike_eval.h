@@ -0,0 +1,71 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+#ifndef __BLI_EXPR_PYLIKE_EVAL_H__
+#define __BLI_EXPR_PYLIKE_EVAL_H__
+
+/** \file BLI_expr_pylike_eval.h
+ *  \ingroup bli
+ *
+ * Parser and evaluator for a small subset of Python expressions over named
+ * double parameters: numbers, arithmetic and comparison operators, 'and',
+ * 'or', 'not', conditional expressions, min/max and the common functions of
+ * the math module.
+ *
+ * Results and errors match what Python gives for the same expression, so it
+ * can be used instead of Python whenever an expression parses. Evaluation
+ * doesn't allocate memory or modify the parsed expression, it can run from
+ * any number of threads at once.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ExprPyLike_Parsed ExprPyLike_Parsed;
+
+typedef enum eExprPyLike_EvalStatus {
+	EXPR_PYLIKE_SUCCESS = 0,
+	/* The expression failed to parse, or uses anything outside the supported subset. */
+	EXPR_PYLIKE_INVALID,
+	/* Wrong number of parameter values. */
+	EXPR_PYLIKE_FATAL_ERROR,
+	/* Python would raise ZeroDivisionError. */
+	EXPR_PYLIKE_DIV_BY_ZERO,
+	/* Python would raise ValueError or OverflowError. */
+	EXPR_PYLIKE_MATH_ERROR,
+} eExprPyLike_EvalStatus;
+
+/* Never returns NULL, expressions which failed to parse are kept as invalid. When a name is
+ * given more than once, the last one is used (like the dictionary of Python locals). */
+ExprPyLike_Parsed *BLI_expr_pylike_parse(const char *expression, const char **param_names, int param_names_len);
+void BLI_expr_pylike_free(ExprPyLike_Parsed *expr);
+
+bool BLI_expr_pylike_is_valid(const ExprPyLike_Parsed *expr);
+
+eExprPyLike_EvalStatus BLI_expr_pylike_eval(
+        const ExprPyLike_Parsed *expr, const double *param_values, int param_values_len,
+        double *r_result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __BLI_EXPR_PYLIKE_EVAL_H__ */
@@ -66,6 +66,20 @@ void BLI_kdtree_range_search_cb(
         const KDTree *tree, const float co[3], float range,
         bool (*search_cb)(void *user_data, int index, const float co[3], float dist_sq), void *user_data);
 
+/* Bulk queries, may run threaded. */
+void BLI_kdtree_find_nearest_n_array(
+        const KDTree *tree, const float (*co_array)[3], unsigned int co_array_len,
+        KDTreeNearest *r_nearest, int *r_nearest_len,
+        unsigned int n) ATTR_NONNULL(1, 2, 4);
+void BLI_kdtree_range_search_array_cb(
+        const KDTree *tree, const float (*co_array)[3], unsigned int co_array_len, float range,
+        bool (*search_cb)(void *user_data, int co_index, int index, const float co[3], float dist_sq),
+        void *user_data) ATTR_NONNULL(1, 2, 5);
+
+int BLI_kdtree_calc_duplicates_fast(
+        const KDTree *tree, const float range, bool use_index_order,
+        int *duplicates) ATTR_NONNULL(1, 4);
+
 /* Normal use is deprecated */
 /* remove __normal functions when last users drop */
 int BLI_kdtree_find_nearest_n__normal(
@@ -181,6 +181,25 @@ bool BLI_thread_queue_is_empty(ThreadQueue *queue);
 void BLI_thread_queue_wait_finish(ThreadQueue *queue);
 void BLI_thread_queue_nowait(ThreadQueue *queue);
 
+/* ThreadRingQueue
+ *
+ * Bounded lock-free multi-producer/multi-consumer queue, push never blocks,
+ * pop can either fail right away or wait for work. Use over ThreadQueue when
+ * an upper bound on queued items is known and many threads push/pop. */
+
+typedef struct ThreadRingQueue ThreadRingQueue;
+
+ThreadRingQueue *BLI_thread_ring_queue_init(unsigned int size);
+void BLI_thread_ring_queue_free(ThreadRingQueue *queue);
+
+bool BLI_thread_ring_queue_push(ThreadRingQueue *queue, void *work);
+bool BLI_thread_ring_queue_try_pop(ThreadRingQueue *queue, void **r_work);
+void *BLI_thread_ring_queue_pop(ThreadRingQueue *queue);
+int BLI_thread_ring_queue_size(ThreadRingQueue *queue);
+bool BLI_thread_ring_queue_is_empty(ThreadRingQueue *queue);
+
+void BLI_thread_ring_queue_nowait(ThreadRingQueue *queue);
+
 
 /* Thread local storage */
 
@@ -0,0 +1,56 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+#ifndef __BLI_TRACE_H__
+#define __BLI_TRACE_H__
+
+/** \file BLI_trace.h
+ *  \ingroup bli
+ *
+ * Lightweight tracing of hot code paths.
+ *
+ * Zones are recorded into a ring buffer per thread, so recording never
+ * locks, and can be exported to the Chrome trace-event format
+ * (open with chrome://tracing).
+ *
+ * When tracing is disabled, begin/end only check a flag.
+ */
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void BLI_trace_enable(void);
+bool BLI_trace_is_enabled(void);
+
+/* Zones must be properly nested per thread, name must stay valid until the zone ends. */
+void BLI_trace_zone_begin(const char *name);
+void BLI_trace_zone_end(void);
+
+bool BLI_trace_write_chrome_json(FILE *fp);
+void BLI_trace_free(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __BLI_TRACE_H__ */
@@ -29,6 +29,7 @@
 
 #include "BLI_math.h"
 #include "BLI_kdtree.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "BLI_strict_flags.h"
 
@@ -59,6 +60,11 @@ struct KDTree {
 #define KD_NEAR_ALLOC_INC 100  /* alloc increment for collecting nearest */
 #define KD_FOUND_ALLOC_INC 50  /* alloc increment for collecting nearest */
 
+/* sub-trees smaller than this are balanced on the calling thread */
+#define KD_BALANCE_THREADED_MIN 10000
+/* minimum number of lookups before bulk queries use threads */
+#define KD_BULK_THREADED_MIN 1000
+
 #define KD_NODE_UNSET ((unsigned int)-1)
 
 /**
@@ -113,18 +119,15 @@ void BLI_kdtree_insert(KDTree *tree, int index, const float co[3])
 #endif
 }
 
-static unsigned int kdtree_balance(KDTreeNode *nodes, unsigned int totnode, unsigned int axis, const unsigned int ofs)
+/**
+ * Quicksort style partitioning around the median along \a axis,
+ * returns the index of the median node (relative to \a nodes).
+ */
+static unsigned int kdtree_balance_partition(KDTreeNode *nodes, unsigned int totnode, unsigned int axis)
 {
-	KDTreeNode *node;
 	float co;
 	unsigned int left, right, median, i, j;
 
-	if (totnode <= 0)
-		return KD_NODE_UNSET;
-	else if (totnode == 1)
-		return 0 + ofs;
-	
-	/* quicksort style sorting around median */
 	left = 0;
 	right = totnode - 1;
 	median = totnode / 2;
@@ -151,6 +154,21 @@ static unsigned int kdtree_balance(KDTreeNode *nodes, unsigned int totnode, unsi
 			left = i + 1;
 	}
 
+	return median;
+}
+
+static unsigned int kdtree_balance(KDTreeNode *nodes, unsigned int totnode, unsigned int axis, const unsigned int ofs)
+{
+	KDTreeNode *node;
+	unsigned int median;
+
+	if (totnode <= 0)
+		return KD_NODE_UNSET;
+	else if (totnode == 1)
+		return 0 + ofs;
+
+	median = kdtree_balance_partition(nodes, totnode, axis);
+
 	/* set node and sort subnodes */
 	node = &nodes[median];
 	node->d = axis;
@@ -161,9 +179,77 @@ static unsigned int kdtree_balance(KDTreeNode *nodes, unsigned int totnode, unsi
 	return median + ofs;
 }
 
+/* -------------------------------------------------------------------- */
+/* Threaded balancing
+ *
+ * Both halves of a partitioned range are disjoint, so once the median is found
+ * the left sub-tree is handed over to the task pool while the current thread
+ * continues with the right one. Small ranges use the regular recursive function. */
+
+typedef struct KDTreeBalanceTask {
+	KDTreeNode *nodes;
+	unsigned int totnode;
+	unsigned int axis;
+	unsigned int ofs;
+	/* Where to store the index of the root of this sub-tree. */
+	unsigned int *r_root;
+} KDTreeBalanceTask;
+
+static unsigned int kdtree_balance_threaded(
+        TaskPool *pool, KDTreeNode *nodes, unsigned int totnode, unsigned int axis, const unsigned int ofs);
+
+static void kdtree_balance_task_run(TaskPool *__restrict pool, void *taskdata, int UNUSED(threadid))
+{
+	const KDTreeBalanceTask *task = taskdata;
+
+	*task->r_root = kdtree_balance_threaded(pool, task->nodes, task->totnode, task->axis, task->ofs);
+}
+
+static unsigned int kdtree_balance_threaded(
+        TaskPool *pool, KDTreeNode *nodes, unsigned int totnode, unsigned int axis, const unsigned int ofs)
+{
+	KDTreeBalanceTask *task;
+	KDTreeNode *node;
+	unsigned int median;
+
+	if (totnode < KD_BALANCE_THREADED_MIN) {
+		return kdtree_balance(nodes, totnode, axis, ofs);
+	}
+
+	median = kdtree_balance_partition(nodes, totnode, axis);
+
+	node = &nodes[median];
+	node->d = axis;
+	axis = (axis + 1) % 3;
+
+	task = MEM_mallocN(sizeof(*task), __func__);
+	task->nodes = nodes;
+	task->totnode = median;
+	task->axis = axis;
+	task->ofs = ofs;
+	task->r_root = &node->left;
+	BLI_task_pool_push(pool, kdtree_balance_task_run, task, true, TASK_PRIORITY_HIGH);
+
+	node->right = kdtree_balance_threaded(
+	        pool, nodes + median + 1, (totnode - (median + 1)), axis, (median + 1) + ofs);
+
+	return median + ofs;
+}
+
 void BLI_kdtree_balance(KDTree *tree)
 {
-	tree->root = kdtree_balance(tree->nodes, tree->totnode, 0, 0);
+	if (tree->totnode >= KD_BALANCE_THREADED_MIN) {
+		TaskScheduler *scheduler = BLI_task_scheduler_get();
+		TaskPool *pool = BLI_task_pool_create(scheduler, NULL);
+
+		tree->root = kdtree_balance_threaded(pool, tree->nodes, tree->totnode, 0, 0);
+
+		BLI_task_pool_work_and_wait(pool);
+		BLI_task_pool_free(pool);
+	}
+	else {
+		tree->root = kdtree_balance(tree->nodes, tree->totnode, 0, 0);
+	}
 
 #ifdef DEBUG
 	tree->is_balanced = true;
@@ -674,3 +760,237 @@ finally:
 	if (stack != defaultstack)
 		MEM_freeN(stack);
 }
+
+
+/* -------------------------------------------------------------------- */
+/* Bulk Queries
+ *
+ * Run many lookups at once, results are written into caller owned arrays
+ * so no allocations are done per lookup. */
+
+typedef struct KDTreeNearestArrayData {
+	const KDTree *tree;
+	const float (*co_array)[3];
+	KDTreeNearest *r_nearest;
+	int *r_nearest_len;
+	unsigned int n;
+} KDTreeNearestArrayData;
+
+static void kdtree_find_nearest_n_array_cb(void *userdata, const int iter)
+{
+	KDTreeNearestArrayData *data = userdata;
+	const int found = BLI_kdtree_find_nearest_n(
+	        data->tree, data->co_array[iter], &data->r_nearest[(size_t)iter * data->n], data->n);
+
+	if (data->r_nearest_len) {
+		data->r_nearest_len[iter] = found;
+	}
+}
+
+/**
+ * Find the \a n nearest points for every coordinate in \a co_array, using threads for large arrays.
+ *
+ * \param r_nearest: An array sized at least \a co_array_len * \a n,
+ * results for `co_array[i]` start at `r_nearest[i * n]`.
+ * \param r_nearest_len: Optional array sized \a co_array_len, filled with the number of points found.
+ */
+void BLI_kdtree_find_nearest_n_array(
+        const KDTree *tree, const float (*co_array)[3], unsigned int co_array_len,
+        KDTreeNearest *r_nearest, int *r_nearest_len, unsigned int n)
+{
+	KDTreeNearestArrayData data = {
+		.tree = tree,
+		.co_array = co_array,
+		.r_nearest = r_nearest,
+		.r_nearest_len = r_nearest_len,
+		.n = n,
+	};
+
+	BLI_task_parallel_range(
+	        0, (int)co_array_len, &data, kdtree_find_nearest_n_array_cb,
+	        co_array_len >= KD_BULK_THREADED_MIN);
+}
+
+typedef struct KDTreeRangeArrayData {
+	const KDTree *tree;
+	const float (*co_array)[3];
+	float range;
+	bool (*search_cb)(void *user_data, int co_index, int index, const float co[3], float dist_sq);
+	void *user_data;
+} KDTreeRangeArrayData;
+
+typedef struct KDTreeRangeArrayIter {
+	const KDTreeRangeArrayData *data;
+	int co_index;
+} KDTreeRangeArrayIter;
+
+static bool kdtree_range_search_array_search_cb(void *user_data, int index, const float co[3], float dist_sq)
+{
+	const KDTreeRangeArrayIter *iter = user_data;
+	return iter->data->search_cb(iter->data->user_data, iter->co_index, index, co, dist_sq);
+}
+
+static void kdtree_range_search_array_cb(void *userdata, const int iter)
+{
+	const KDTreeRangeArrayData *data = userdata;
+	KDTreeRangeArrayIter range_iter = {
+		.data = data,
+		.co_index = iter,
+	};
+
+	BLI_kdtree_range_search_cb(
+	        data->tree, data->co_array[iter], data->range,
+	        kdtree_range_search_array_search_cb, &range_iter);
+}
+
+/**
+ * A version of #BLI_kdtree_range_search_cb which searches around every coordinate in \a co_array,
+ * using threads for large arrays.
+ *
+ * \param search_cb: Called for every node found in \a range of `co_array[co_index]`,
+ * false return value stops the search for that coordinate.
+ *
+ * \note \a search_cb may be called from multiple threads at once.
+ */
+void BLI_kdtree_range_search_array_cb(
+        const KDTree *tree, const float (*co_array)[3], unsigned int co_array_len, float range,
+        bool (*search_cb)(void *user_data, int co_index, int index, const float co[3], float dist_sq),
+        void *user_data)
+{
+	KDTreeRangeArrayData data = {
+		.tree = tree,
+		.co_array = co_array,
+		.range = range,
+		.search_cb = search_cb,
+		.user_data = user_data,
+	};
+
+	BLI_task_parallel_range(
+	        0, (int)co_array_len, &data, kdtree_range_search_array_cb,
+	        co_array_len >= KD_BULK_THREADED_MIN);
+}
+
+
+/* -------------------------------------------------------------------- */
+/* Merge by Distance */
+
+/**
+ * Map every point which isn't yet a target or a duplicate, found within \a range of \a search_co,
+ * to \a search_index. Returns the number of newly found duplicates.
+ */
+static int kdtree_deduplicate_search(
+        const KDTree *tree, const float search_co[3], const int search_index,
+        const float range, int *duplicates)
+{
+	const KDTreeNode *nodes = tree->nodes;
+	unsigned int *stack, defaultstack[KD_STACK_INIT];
+	const float range_sq = range * range;
+	unsigned int totstack, cur = 0;
+	int found = 0;
+
+	stack = defaultstack;
+	totstack = KD_STACK_INIT;
+
+	stack[cur++] = tree->root;
+
+	while (cur--) {
+		const KDTreeNode *node = &nodes[stack[cur]];
+
+		if (search_co[node->d] + range < node->co[node->d]) {
+			if (node->left != KD_NODE_UNSET)
+				stack[cur++] = node->left;
+		}
+		else if (search_co[node->d] - range > node->co[node->d]) {
+			if (node->right != KD_NODE_UNSET)
+				stack[cur++] = node->right;
+		}
+		else {
+			if ((duplicates[node->index] == -1) && (node->index != search_index)) {
+				if (len_squared_v3v3(node->co, search_co) <= range_sq) {
+					duplicates[node->index] = search_index;
+					found++;
+				}
+			}
+
+			if (node->left != KD_NODE_UNSET)
+				stack[cur++] = node->left;
+			if (node->right != KD_NODE_UNSET)
+				stack[cur++] = node->right;
+		}
+
+		if (UNLIKELY(cur + 3 > totstack)) {
+			stack = realloc_nodes(stack, &totstack, defaultstack != stack);
+		}
+	}
+
+	if (stack != defaultstack)
+		MEM_freeN(stack);
+
+	return found;
+}
+
+/**
+ * Find duplicate points within \a range, this is the basis of "merge by distance" operations.
+ *
+ * Points are visited in order, each point that isn't already a duplicate claims all
+ * unclaimed points in range, so duplicates never chain onto other duplicates.
+ *
+ * \param use_index_order: Visit points in order of their index (as passed to #BLI_kdtree_insert),
+ * otherwise the (faster) tree order is used. Indices must be in `[0 .. totnode)` in this case.
+ * \param duplicates: An array sized by the largest index + 1, filled with -1 by the caller
+ * (values other than -1 can be used to exclude points from merging).
+ * On return, each duplicate stores the index of the point it merges into,
+ * points which are merge targets store their own index.
+ * \return The number of duplicates found.
+ */
+int BLI_kdtree_calc_duplicates_fast(
+        const KDTree *tree, const float range, bool use_index_order,
+        int *duplicates)
+{
+	const KDTreeNode *nodes = tree->nodes;
+	unsigned int i;
+	int found = 0;
+
+#ifdef DEBUG
+	BLI_assert(tree->is_balanced == true);
+#endif
+
+	if (UNLIKELY(tree->root == KD_NODE_UNSET))
+		return 0;
+
+	if (use_index_order) {
+		unsigned int *order = MEM_mallocN(sizeof(*order) * tree->totnode, __func__);
+
+		for (i = 0; i < tree->totnode; i++) {
+			BLI_assert((unsigned int)nodes[i].index < tree->totnode);
+			order[nodes[i].index] = i;
+		}
+
+		for (i = 0; i < tree->totnode; i++) {
+			const KDTreeNode *node = &nodes[order[i]];
+			if (ELEM(duplicates[node->index], -1, node->index)) {
+				const int found_step = kdtree_deduplicate_search(tree, node->co, node->index, range, duplicates);
+				if (found_step) {
+					duplicates[node->index] = node->index;
+					found += found_step;
+				}
+			}
+		}
+
+		MEM_freeN(order);
+	}
+	else {
+		for (i = 0; i < tree->totnode; i++) {
+			const KDTreeNode *node = &nodes[i];
+			if (ELEM(duplicates[node->index], -1, node->index)) {
+				const int found_step = kdtree_deduplicate_search(tree, node->co, node->index, range, duplicates);
+				if (found_step) {
+					duplicates[node->index] = node->index;
+					found += found_step;
+				}
+			}
+		}
+	}
+
+	return found;
+}
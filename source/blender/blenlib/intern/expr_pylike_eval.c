@@ -0,0 +1,994 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenlib/intern/expr_pylike_eval.c
+ *  \ingroup bli
+ *
+ * The expression is compiled into a flat list of operations on a stack of doubles,
+ * conditional parts ('and', 'or', 'if' / 'else') use relative jumps so only the branch
+ * Python would evaluate is evaluated, including its errors.
+ *
+ * Anything outside the supported subset fails to parse, callers then fall back to Python.
+ */
+
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_alloca.h"
+#include "BLI_expr_pylike_eval.h"
+#include "BLI_math_base.h"
+
+#include "BLI_strict_flags.h"
+
+/* -------------------------------------------------------------------- */
+/** \name Parsed Expression
+ * \{ */
+
+typedef enum eOpCode {
+	/* push constant (dval) */
+	OPCODE_CONST,
+	/* push parameter value (ival) */
+	OPCODE_PARAMETER,
+	/* replace the top value(s) by the result of a math module function (func1 / func2) */
+	OPCODE_FUNC1,
+	OPCODE_FUNC2,
+	/* replace the top (ival) values by the smallest / largest one */
+	OPCODE_MIN,
+	OPCODE_MAX,
+
+	/* unary operators */
+	OPCODE_NEG,
+	OPCODE_NOT,
+
+	/* binary operators */
+	OPCODE_ADD,
+	OPCODE_SUB,
+	OPCODE_MUL,
+	OPCODE_DIV,
+	OPCODE_FLOORDIV,
+	OPCODE_MOD,
+	OPCODE_POW,
+	OPCODE_LT,
+	OPCODE_LE,
+	OPCODE_GT,
+	OPCODE_GE,
+	OPCODE_EQ,
+	OPCODE_NE,
+
+	/* jump by (jmp_offset) */
+	OPCODE_JMP,
+	/* pop the top value, jump when it is false */
+	OPCODE_JMP_ELSE,
+	/* jump when the top value is true, otherwise pop it */
+	OPCODE_JMP_OR,
+	/* jump when the top value is false, otherwise pop it */
+	OPCODE_JMP_AND,
+} eOpCode;
+
+typedef double (*UnaryOpFunc)(double);
+typedef double (*BinaryOpFunc)(double, double);
+
+typedef struct ExprOp {
+	eOpCode opcode;
+
+	/* for jumps, relative to the next operation */
+	int jmp_offset;
+
+	union {
+		int ival;
+		double dval;
+		UnaryOpFunc func1;
+		BinaryOpFunc func2;
+	} arg;
+} ExprOp;
+
+struct ExprPyLike_Parsed {
+	int ops_count;
+	int max_stack;
+	int param_count;
+
+	ExprOp *ops;
+};
+
+void BLI_expr_pylike_free(ExprPyLike_Parsed *expr)
+{
+	if (expr != NULL) {
+		MEM_SAFE_FREE(expr->ops);
+		MEM_freeN(expr);
+	}
+}
+
+bool BLI_expr_pylike_is_valid(const ExprPyLike_Parsed *expr)
+{
+	return expr != NULL && expr->ops_count > 0;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Builtin Constants and Functions
+ * \{ */
+
+typedef struct BuiltinConstDef {
+	const char *name;
+	double value;
+} BuiltinConstDef;
+
+static const BuiltinConstDef builtin_consts[] = {
+	{"pi", M_PI},
+	{"e", M_E},
+	{"True", 1.0},
+	{"False", 0.0},
+	{NULL, 0.0},
+};
+
+/* math.floor and math.ceil raise an error for infinity and NaN */
+static double op_floor(double x)
+{
+	return isfinite(x) ? floor(x) : NAN;
+}
+
+static double op_ceil(double x)
+{
+	return isfinite(x) ? ceil(x) : NAN;
+}
+
+typedef struct BuiltinFuncDef {
+	const char *name;
+	eOpCode opcode;
+	UnaryOpFunc func1;
+	BinaryOpFunc func2;
+	/* for OPCODE_MUL: constant factor, same as the math module uses */
+	double factor;
+} BuiltinFuncDef;
+
+static const BuiltinFuncDef builtin_funcs[] = {
+	{"radians", OPCODE_MUL, NULL, NULL, M_PI / 180.0},
+	{"degrees", OPCODE_MUL, NULL, NULL, 180.0 / M_PI},
+	{"abs", OPCODE_FUNC1, fabs, NULL, 0.0},
+	{"fabs", OPCODE_FUNC1, fabs, NULL, 0.0},
+	{"floor", OPCODE_FUNC1, op_floor, NULL, 0.0},
+	{"ceil", OPCODE_FUNC1, op_ceil, NULL, 0.0},
+	{"sqrt", OPCODE_FUNC1, sqrt, NULL, 0.0},
+	{"exp", OPCODE_FUNC1, exp, NULL, 0.0},
+	{"log", OPCODE_FUNC1, log, NULL, 0.0},
+	{"log10", OPCODE_FUNC1, log10, NULL, 0.0},
+	{"sin", OPCODE_FUNC1, sin, NULL, 0.0},
+	{"cos", OPCODE_FUNC1, cos, NULL, 0.0},
+	{"tan", OPCODE_FUNC1, tan, NULL, 0.0},
+	{"asin", OPCODE_FUNC1, asin, NULL, 0.0},
+	{"acos", OPCODE_FUNC1, acos, NULL, 0.0},
+	{"atan", OPCODE_FUNC1, atan, NULL, 0.0},
+	{"atan2", OPCODE_FUNC2, NULL, atan2, 0.0},
+	{"pow", OPCODE_FUNC2, NULL, pow, 0.0},
+	{"min", OPCODE_MIN, NULL, NULL, 0.0},
+	{"max", OPCODE_MAX, NULL, NULL, 0.0},
+	{NULL, OPCODE_CONST, NULL, NULL, 0.0},
+};
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Evaluation
+ * \{ */
+
+/* The math module raises ValueError or OverflowError when a function gives NaN for
+ * arguments which aren't NaN, or infinity for finite arguments. */
+static bool func_result_is_valid(double result, double a, double b)
+{
+	if (isnan(result)) {
+		return isnan(a) || isnan(b);
+	}
+	else if (isinf(result)) {
+		return !isfinite(a) || !isfinite(b);
+	}
+	return true;
+}
+
+/* float % float, see float_rem() in Python */
+static double op_mod(double a, double b)
+{
+	double mod = fmod(a, b);
+
+	if (mod) {
+		if ((b < 0.0) != (mod < 0.0)) {
+			mod += b;
+		}
+	}
+	else {
+		mod = copysign(0.0, b);
+	}
+	return mod;
+}
+
+/* float // float, see float_floor_div() in Python */
+static double op_floordiv(double a, double b)
+{
+	double mod = fmod(a, b);
+	double div = (a - mod) / b;
+	double floordiv;
+
+	if (mod) {
+		if ((b < 0.0) != (mod < 0.0)) {
+			div -= 1.0;
+		}
+	}
+
+	if (div) {
+		floordiv = floor(div);
+		if (div - floordiv > 0.5) {
+			floordiv += 1.0;
+		}
+	}
+	else {
+		floordiv = copysign(0.0, a / b);
+	}
+	return floordiv;
+}
+
+/* float ** float, see float_pow() in Python */
+static eExprPyLike_EvalStatus op_pow(double a, double b, double *r_result)
+{
+	if (a == 0.0 && b < 0.0 && isfinite(b)) {
+		return EXPR_PYLIKE_DIV_BY_ZERO;
+	}
+	/* Python gives a complex number */
+	if (a < 0.0 && isfinite(a) && isfinite(b) && b != floor(b)) {
+		return EXPR_PYLIKE_MATH_ERROR;
+	}
+
+	*r_result = pow(a, b);
+
+	if (isinf(*r_result) && isfinite(a) && isfinite(b)) {
+		return EXPR_PYLIKE_MATH_ERROR;
+	}
+	return EXPR_PYLIKE_SUCCESS;
+}
+
+eExprPyLike_EvalStatus BLI_expr_pylike_eval(
+        const ExprPyLike_Parsed *expr, const double *param_values, int param_values_len,
+        double *r_result)
+{
+	double *stack;
+	int sp = 0, pc;
+
+	*r_result = 0.0;
+
+	if (!BLI_expr_pylike_is_valid(expr)) {
+		return EXPR_PYLIKE_INVALID;
+	}
+	if (param_values_len != expr->param_count) {
+		return EXPR_PYLIKE_FATAL_ERROR;
+	}
+
+	stack = BLI_array_alloca(stack, (size_t)expr->max_stack);
+
+	for (pc = 0; pc >= 0 && pc < expr->ops_count; pc++) {
+		const ExprOp *op = &expr->ops[pc];
+
+		switch (op->opcode) {
+			case OPCODE_CONST:
+				stack[sp++] = op->arg.dval;
+				break;
+			case OPCODE_PARAMETER:
+				stack[sp++] = param_values[op->arg.ival];
+				break;
+			case OPCODE_FUNC1:
+			{
+				const double a = stack[sp - 1];
+				stack[sp - 1] = op->arg.func1(a);
+				if (!func_result_is_valid(stack[sp - 1], a, 0.0)) {
+					return EXPR_PYLIKE_MATH_ERROR;
+				}
+				break;
+			}
+			case OPCODE_FUNC2:
+			{
+				const double a = stack[sp - 2], b = stack[sp - 1];
+				stack[sp - 2] = op->arg.func2(a, b);
+				sp--;
+				if (!func_result_is_valid(stack[sp - 1], a, b)) {
+					return EXPR_PYLIKE_MATH_ERROR;
+				}
+				break;
+			}
+			case OPCODE_MIN:
+			case OPCODE_MAX:
+			{
+				/* like Python, the first of equal values is kept */
+				double value = stack[sp - op->arg.ival];
+				int i;
+				for (i = op->arg.ival - 1; i > 0; i--) {
+					const double item = stack[sp - i];
+					if ((op->opcode == OPCODE_MIN) ? (item < value) : (item > value)) {
+						value = item;
+					}
+				}
+				sp -= op->arg.ival - 1;
+				stack[sp - 1] = value;
+				break;
+			}
+			case OPCODE_NEG:
+				stack[sp - 1] = -stack[sp - 1];
+				break;
+			case OPCODE_NOT:
+				stack[sp - 1] = (stack[sp - 1] == 0.0) ? 1.0 : 0.0;
+				break;
+			case OPCODE_ADD:
+				stack[sp - 2] = stack[sp - 2] + stack[sp - 1];
+				sp--;
+				break;
+			case OPCODE_SUB:
+				stack[sp - 2] = stack[sp - 2] - stack[sp - 1];
+				sp--;
+				break;
+			case OPCODE_MUL:
+				stack[sp - 2] = stack[sp - 2] * stack[sp - 1];
+				sp--;
+				break;
+			case OPCODE_DIV:
+			case OPCODE_FLOORDIV:
+			case OPCODE_MOD:
+			{
+				const double a = stack[sp - 2], b = stack[sp - 1];
+				if (b == 0.0) {
+					return EXPR_PYLIKE_DIV_BY_ZERO;
+				}
+				if (op->opcode == OPCODE_DIV) {
+					stack[sp - 2] = a / b;
+				}
+				else if (op->opcode == OPCODE_FLOORDIV) {
+					stack[sp - 2] = op_floordiv(a, b);
+				}
+				else {
+					stack[sp - 2] = op_mod(a, b);
+				}
+				sp--;
+				break;
+			}
+			case OPCODE_POW:
+			{
+				const eExprPyLike_EvalStatus status = op_pow(stack[sp - 2], stack[sp - 1], &stack[sp - 2]);
+				if (status != EXPR_PYLIKE_SUCCESS) {
+					return status;
+				}
+				sp--;
+				break;
+			}
+			case OPCODE_LT:
+				stack[sp - 2] = (stack[sp - 2] < stack[sp - 1]) ? 1.0 : 0.0;
+				sp--;
+				break;
+			case OPCODE_LE:
+				stack[sp - 2] = (stack[sp - 2] <= stack[sp - 1]) ? 1.0 : 0.0;
+				sp--;
+				break;
+			case OPCODE_GT:
+				stack[sp - 2] = (stack[sp - 2] > stack[sp - 1]) ? 1.0 : 0.0;
+				sp--;
+				break;
+			case OPCODE_GE:
+				stack[sp - 2] = (stack[sp - 2] >= stack[sp - 1]) ? 1.0 : 0.0;
+				sp--;
+				break;
+			case OPCODE_EQ:
+				stack[sp - 2] = (stack[sp - 2] == stack[sp - 1]) ? 1.0 : 0.0;
+				sp--;
+				break;
+			case OPCODE_NE:
+				stack[sp - 2] = (stack[sp - 2] != stack[sp - 1]) ? 1.0 : 0.0;
+				sp--;
+				break;
+			case OPCODE_JMP:
+				pc += op->jmp_offset;
+				break;
+			case OPCODE_JMP_ELSE:
+				if (stack[--sp] == 0.0) {
+					pc += op->jmp_offset;
+				}
+				break;
+			case OPCODE_JMP_OR:
+			case OPCODE_JMP_AND:
+				if ((stack[sp - 1] != 0.0) == (op->opcode == OPCODE_JMP_OR)) {
+					pc += op->jmp_offset;
+				}
+				else {
+					sp--;
+				}
+				break;
+			default:
+				return EXPR_PYLIKE_FATAL_ERROR;
+		}
+	}
+
+	if (sp != 1 || pc != expr->ops_count) {
+		return EXPR_PYLIKE_FATAL_ERROR;
+	}
+
+	*r_result = stack[0];
+	return EXPR_PYLIKE_SUCCESS;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Parsing
+ *
+ * Recursive descent following the Python grammar:
+ *
+ * expr:  or ['if' or 'else' expr]
+ * or:    and ('or' and)*
+ * and:   not ('and' not)*
+ * not:   'not' not | cmp
+ * cmp:   add [cmp_op add]     (chained comparisons aren't supported)
+ * add:   mul (('+' | '-') mul)*
+ * mul:   unary (('*' | '/' | '//' | '%') unary)*
+ * unary: ('+' | '-') unary | power
+ * power: atom ['**' unary]
+ * atom:  number | name | name '(' expr (',' expr)* ')' | '(' expr ')'
+ * \{ */
+
+enum {
+	TOKEN_END = 0,
+	/* single character tokens use their character */
+	TOKEN_ID = 256,
+	TOKEN_NUMBER,
+	TOKEN_POW,
+	TOKEN_FLOORDIV,
+	TOKEN_LE,
+	TOKEN_GE,
+	TOKEN_EQ,
+	TOKEN_NE,
+	TOKEN_AND,
+	TOKEN_OR,
+	TOKEN_NOT,
+	TOKEN_IF,
+	TOKEN_ELSE,
+};
+
+typedef struct KeywordTokenDef {
+	const char *name;
+	int token;
+} KeywordTokenDef;
+
+static const KeywordTokenDef keyword_tokens[] = {
+	{"and", TOKEN_AND},
+	{"or", TOKEN_OR},
+	{"not", TOKEN_NOT},
+	{"if", TOKEN_IF},
+	{"else", TOKEN_ELSE},
+	{NULL, TOKEN_END},
+};
+
+typedef struct ExprParseState {
+	const char **param_names;
+	int param_names_len;
+
+	const char *cur;
+
+	/* current token */
+	int token;
+	char *tokenbuf;
+	double tokenval;
+
+	ExprOp *ops;
+	int ops_count, max_ops;
+
+	int stack_ptr, max_stack;
+} ExprParseState;
+
+static ExprOp *parse_add_op(ExprParseState *state, eOpCode code, int stack_delta)
+{
+	ExprOp *op;
+
+	if (state->ops_count >= state->max_ops) {
+		state->max_ops = max_ii(state->max_ops * 2, 16);
+		state->ops = MEM_reallocN(state->ops, sizeof(ExprOp) * (size_t)state->max_ops);
+	}
+
+	state->stack_ptr += stack_delta;
+	state->max_stack = max_ii(state->max_stack, state->stack_ptr);
+
+	op = &state->ops[state->ops_count++];
+	memset(op, 0, sizeof(*op));
+	op->opcode = code;
+	return op;
+}
+
+/* Returns the index of the jump, to be passed to parse_set_jump(). */
+static int parse_add_jump(ExprParseState *state, eOpCode code)
+{
+	parse_add_op(state, code, (code == OPCODE_JMP) ? 0 : -1);
+	return state->ops_count - 1;
+}
+
+/* Make the jump continue after the last added operation. */
+static void parse_set_jump(ExprParseState *state, int jump)
+{
+	state->ops[jump].jmp_offset = state->ops_count - jump - 1;
+}
+
+static bool parse_next_token(ExprParseState *state)
+{
+	const char *cur;
+	int i;
+
+	while (ELEM(*state->cur, ' ', '\t')) {
+		state->cur++;
+	}
+	cur = state->cur;
+
+	if (*cur == '\0') {
+		state->token = TOKEN_END;
+		return true;
+	}
+
+	/* number, with Python syntax checked before conversion */
+	if (isdigit(*cur) || (*cur == '.' && isdigit(cur[1]))) {
+		const char *p = cur;
+		bool is_int = true;
+
+		while (isdigit(*p)) {
+			p++;
+		}
+		if (*p == '.') {
+			is_int = false;
+			p++;
+			while (isdigit(*p)) {
+				p++;
+			}
+		}
+		if (ELEM(*p, 'e', 'E')) {
+			is_int = false;
+			p++;
+			if (ELEM(*p, '+', '-')) {
+				p++;
+			}
+			if (!isdigit(*p)) {
+				return false;
+			}
+			while (isdigit(*p)) {
+				p++;
+			}
+		}
+		/* complex, hexadecimal and underscore separated numbers, or a syntax error */
+		if (isalnum(*p) || ELEM(*p, '_', '.')) {
+			return false;
+		}
+		/* leading zeros are a syntax error for integers other than zero */
+		if (is_int && cur[0] == '0') {
+			const char *z;
+			for (z = cur; z < p; z++) {
+				if (*z != '0') {
+					return false;
+				}
+			}
+		}
+
+		state->tokenval = strtod(cur, NULL);
+		state->token = TOKEN_NUMBER;
+		state->cur = p;
+		return true;
+	}
+
+	/* name or keyword */
+	if (isalpha(*cur) || *cur == '_') {
+		const char *p = cur;
+		size_t len;
+
+		while (isalnum(*p) || *p == '_') {
+			p++;
+		}
+		/* non ASCII names */
+		if ((unsigned char)*p >= 0x80) {
+			return false;
+		}
+
+		len = (size_t)(p - cur);
+		memcpy(state->tokenbuf, cur, len);
+		state->tokenbuf[len] = '\0';
+		state->cur = p;
+
+		state->token = TOKEN_ID;
+		for (i = 0; keyword_tokens[i].name; i++) {
+			if (STREQ(state->tokenbuf, keyword_tokens[i].name)) {
+				state->token = keyword_tokens[i].token;
+				break;
+			}
+		}
+		return true;
+	}
+
+	/* two character operators */
+	if (cur[0] != '\0' && cur[1] != '\0') {
+		static const struct { char str[3]; int token; } operators[] = {
+			{"**", TOKEN_POW}, {"//", TOKEN_FLOORDIV},
+			{"<=", TOKEN_LE}, {">=", TOKEN_GE}, {"==", TOKEN_EQ}, {"!=", TOKEN_NE},
+		};
+		for (i = 0; i < (int)ARRAY_SIZE(operators); i++) {
+			if (cur[0] == operators[i].str[0] && cur[1] == operators[i].str[1]) {
+				state->token = operators[i].token;
+				state->cur += 2;
+				return true;
+			}
+		}
+	}
+
+	if (strchr("+-*/%(),<>", *cur)) {
+		state->token = *cur;
+		state->cur++;
+		return true;
+	}
+
+	return false;
+}
+
+static bool parse_expr(ExprParseState *state);
+static bool parse_unary(ExprParseState *state);
+
+static int parse_find_param(ExprParseState *state, const char *name)
+{
+	int i;
+
+	/* the last parameter with a name wins, like in a dictionary */
+	for (i = state->param_names_len - 1; i >= 0; i--) {
+		if (state->param_names[i] && STREQ(state->param_names[i], name)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+static bool parse_call(ExprParseState *state, const BuiltinFuncDef *func)
+{
+	int args = 0;
+
+	if (!parse_next_token(state)) {
+		return false;
+	}
+
+	for (;;) {
+		if (!parse_expr(state)) {
+			return false;
+		}
+		args++;
+
+		if (state->token == ')') {
+			break;
+		}
+		if (state->token != ',' || !parse_next_token(state)) {
+			return false;
+		}
+	}
+
+	switch (func->opcode) {
+		case OPCODE_MUL:
+			if (args != 1) {
+				return false;
+			}
+			parse_add_op(state, OPCODE_CONST, 1)->arg.dval = func->factor;
+			parse_add_op(state, OPCODE_MUL, -1);
+			break;
+		case OPCODE_FUNC1:
+			if (args != 1) {
+				return false;
+			}
+			parse_add_op(state, OPCODE_FUNC1, 0)->arg.func1 = func->func1;
+			break;
+		case OPCODE_FUNC2:
+			if (args != 2) {
+				return false;
+			}
+			parse_add_op(state, OPCODE_FUNC2, -1)->arg.func2 = func->func2;
+			break;
+		case OPCODE_MIN:
+		case OPCODE_MAX:
+			/* a single number isn't iterable */
+			if (args < 2) {
+				return false;
+			}
+			parse_add_op(state, func->opcode, 1 - args)->arg.ival = args;
+			break;
+		default:
+			return false;
+	}
+
+	return parse_next_token(state);
+}
+
+static bool parse_atom(ExprParseState *state)
+{
+	int i;
+
+	if (state->token == TOKEN_NUMBER) {
+		parse_add_op(state, OPCODE_CONST, 1)->arg.dval = state->tokenval;
+		return parse_next_token(state);
+	}
+
+	if (state->token == TOKEN_ID) {
+		const int param = parse_find_param(state, state->tokenbuf);
+
+		if (param != -1) {
+			parse_add_op(state, OPCODE_PARAMETER, 1)->arg.ival = param;
+			/* calling a parameter fails in Python */
+			return parse_next_token(state) && state->token != '(';
+		}
+
+		for (i = 0; builtin_consts[i].name; i++) {
+			if (STREQ(state->tokenbuf, builtin_consts[i].name)) {
+				parse_add_op(state, OPCODE_CONST, 1)->arg.dval = builtin_consts[i].value;
+				return parse_next_token(state) && state->token != '(';
+			}
+		}
+
+		for (i = 0; builtin_funcs[i].name; i++) {
+			if (STREQ(state->tokenbuf, builtin_funcs[i].name)) {
+				return parse_next_token(state) && state->token == '(' && parse_call(state, &builtin_funcs[i]);
+			}
+		}
+
+		return false;
+	}
+
+	if (state->token == '(') {
+		return parse_next_token(state) && parse_expr(state) &&
+		       state->token == ')' && parse_next_token(state);
+	}
+
+	return false;
+}
+
+static bool parse_power(ExprParseState *state)
+{
+	if (!parse_atom(state)) {
+		return false;
+	}
+
+	if (state->token == TOKEN_POW) {
+		if (!parse_next_token(state) || !parse_unary(state)) {
+			return false;
+		}
+		parse_add_op(state, OPCODE_POW, -1);
+	}
+	return true;
+}
+
+static bool parse_unary(ExprParseState *state)
+{
+	if (state->token == '-') {
+		if (!parse_next_token(state) || !parse_unary(state)) {
+			return false;
+		}
+		parse_add_op(state, OPCODE_NEG, 0);
+		return true;
+	}
+	if (state->token == '+') {
+		return parse_next_token(state) && parse_unary(state);
+	}
+	return parse_power(state);
+}
+
+static bool parse_mul(ExprParseState *state)
+{
+	if (!parse_unary(state)) {
+		return false;
+	}
+
+	for (;;) {
+		eOpCode opcode;
+
+		switch (state->token) {
+			case '*': opcode = OPCODE_MUL; break;
+			case '/': opcode = OPCODE_DIV; break;
+			case TOKEN_FLOORDIV: opcode = OPCODE_FLOORDIV; break;
+			case '%': opcode = OPCODE_MOD; break;
+			default: return true;
+		}
+
+		if (!parse_next_token(state) || !parse_unary(state)) {
+			return false;
+		}
+		parse_add_op(state, opcode, -1);
+	}
+}
+
+static bool parse_add(ExprParseState *state)
+{
+	if (!parse_mul(state)) {
+		return false;
+	}
+
+	while (ELEM(state->token, '+', '-')) {
+		const eOpCode opcode = (state->token == '+') ? OPCODE_ADD : OPCODE_SUB;
+
+		if (!parse_next_token(state) || !parse_mul(state)) {
+			return false;
+		}
+		parse_add_op(state, opcode, -1);
+	}
+	return true;
+}
+
+static bool parse_cmp_token(int token, eOpCode *r_opcode)
+{
+	switch (token) {
+		case '<': *r_opcode = OPCODE_LT; return true;
+		case TOKEN_LE: *r_opcode = OPCODE_LE; return true;
+		case '>': *r_opcode = OPCODE_GT; return true;
+		case TOKEN_GE: *r_opcode = OPCODE_GE; return true;
+		case TOKEN_EQ: *r_opcode = OPCODE_EQ; return true;
+		case TOKEN_NE: *r_opcode = OPCODE_NE; return true;
+		default: return false;
+	}
+}
+
+static bool parse_cmp(ExprParseState *state)
+{
+	eOpCode opcode;
+
+	if (!parse_add(state)) {
+		return false;
+	}
+
+	if (parse_cmp_token(state->token, &opcode)) {
+		if (!parse_next_token(state) || !parse_add(state)) {
+			return false;
+		}
+		parse_add_op(state, opcode, -1);
+
+		/* Python chains comparisons: 'a < b < c' is 'a < b and b < c' */
+		if (parse_cmp_token(state->token, &opcode)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool parse_not(ExprParseState *state)
+{
+	if (state->token == TOKEN_NOT) {
+		if (!parse_next_token(state) || !parse_not(state)) {
+			return false;
+		}
+		parse_add_op(state, OPCODE_NOT, 0);
+		return true;
+	}
+	return parse_cmp(state);
+}
+
+static bool parse_and(ExprParseState *state)
+{
+	int jump;
+
+	if (!parse_not(state)) {
+		return false;
+	}
+
+	if (state->token == TOKEN_AND) {
+		jump = parse_add_jump(state, OPCODE_JMP_AND);
+
+		if (!parse_next_token(state) || !parse_and(state)) {
+			return false;
+		}
+		parse_set_jump(state, jump);
+	}
+	return true;
+}
+
+static bool parse_or(ExprParseState *state)
+{
+	int jump;
+
+	if (!parse_and(state)) {
+		return false;
+	}
+
+	if (state->token == TOKEN_OR) {
+		jump = parse_add_jump(state, OPCODE_JMP_OR);
+
+		if (!parse_next_token(state) || !parse_or(state)) {
+			return false;
+		}
+		parse_set_jump(state, jump);
+	}
+	return true;
+}
+
+static bool parse_expr(ExprParseState *state)
+{
+	const int start = state->ops_count;
+	ExprOp *body;
+	int body_count, jump_else, jump_end, i;
+
+	if (!parse_or(state)) {
+		return false;
+	}
+
+	if (state->token != TOKEN_IF) {
+		return true;
+	}
+
+	/* 'body if cond else other': the condition is evaluated first, so the body is moved
+	 * after it. Jumps are relative, the body operations don't change when moved. */
+	body_count = state->ops_count - start;
+	body = MEM_mallocN(sizeof(ExprOp) * (size_t)body_count, __func__);
+	memcpy(body, state->ops + start, sizeof(ExprOp) * (size_t)body_count);
+	state->ops_count = start;
+	state->stack_ptr--;
+
+	if (!parse_next_token(state) || !parse_or(state) ||
+	    state->token != TOKEN_ELSE || !parse_next_token(state))
+	{
+		MEM_freeN(body);
+		return false;
+	}
+
+	jump_else = parse_add_jump(state, OPCODE_JMP_ELSE);
+
+	for (i = 0; i < body_count; i++) {
+		*parse_add_op(state, body[i].opcode, 0) = body[i];
+	}
+	MEM_freeN(body);
+	state->stack_ptr++;
+
+	/* the body result isn't on the stack in the other branch */
+	jump_end = parse_add_jump(state, OPCODE_JMP);
+	state->stack_ptr--;
+	parse_set_jump(state, jump_else);
+
+	if (!parse_expr(state)) {
+		return false;
+	}
+	parse_set_jump(state, jump_end);
+	return true;
+}
+
+ExprPyLike_Parsed *BLI_expr_pylike_parse(const char *expression, const char **param_names, int param_names_len)
+{
+	ExprPyLike_Parsed *expr = MEM_callocN(sizeof(*expr), __func__);
+	ExprParseState state = {NULL};
+
+	expr->param_count = param_names_len;
+
+	state.param_names = param_names;
+	state.param_names_len = param_names_len;
+	state.cur = expression;
+	state.tokenbuf = MEM_mallocN(strlen(expression) + 1, __func__);
+
+	if (parse_next_token(&state) && parse_expr(&state) && state.token == TOKEN_END) {
+		BLI_assert(state.stack_ptr == 1);
+		expr->ops_count = state.ops_count;
+		expr->max_stack = state.max_stack;
+		expr->ops = state.ops;
+	}
+	else {
+		MEM_SAFE_FREE(state.ops);
+	}
+
+	MEM_freeN(state.tokenbuf);
+	return expr;
+}
+
+/** \} */
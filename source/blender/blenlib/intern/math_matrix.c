@@ -31,6 +31,10 @@
 #include <assert.h>
 #include "BLI_math.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 #include "BLI_strict_flags.h"
 
 /********************************* Init **************************************/
@@ -179,6 +183,29 @@ void swap_m4m4(float m1[4][4], float m2[4][4])
 
 void mul_m4_m4m4(float m1[4][4], float m3_[4][4], float m2_[4][4])
 {
+#ifdef __SSE2__
+	/* Same products and order of additions as the scalar code below, so results are identical.
+	 * All input is loaded before the first store, so m1 may be the same pointer as m2 or m3. */
+	const __m128 m3_r0 = _mm_loadu_ps(m3_[0]);
+	const __m128 m3_r1 = _mm_loadu_ps(m3_[1]);
+	const __m128 m3_r2 = _mm_loadu_ps(m3_[2]);
+	const __m128 m3_r3 = _mm_loadu_ps(m3_[3]);
+	__m128 r[4];
+	int j;
+
+	for (j = 0; j < 4; j++) {
+		__m128 sum = _mm_mul_ps(_mm_set1_ps(m2_[j][0]), m3_r0);
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(m2_[j][1]), m3_r1));
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(m2_[j][2]), m3_r2));
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(m2_[j][3]), m3_r3));
+		r[j] = sum;
+	}
+
+	_mm_storeu_ps(m1[0], r[0]);
+	_mm_storeu_ps(m1[1], r[1]);
+	_mm_storeu_ps(m1[2], r[2]);
+	_mm_storeu_ps(m1[3], r[3]);
+#else
 	float m2[4][4], m3[4][4];
 
 	/* copy so it works when m1 is the same pointer as m2 or m3 */
@@ -205,7 +232,7 @@ void mul_m4_m4m4(float m1[4][4], float m3_[4][4], float m2_[4][4])
 	m1[3][1] = m2[3][0] * m3[0][1] + m2[3][1] * m3[1][1] + m2[3][2] * m3[2][1] + m2[3][3] * m3[3][1];
 	m1[3][2] = m2[3][0] * m3[0][2] + m2[3][1] * m3[1][2] + m2[3][2] * m3[2][2] + m2[3][3] * m3[3][2];
 	m1[3][3] = m2[3][0] * m3[0][3] + m2[3][1] * m3[1][3] + m2[3][2] * m3[2][3] + m2[3][3] * m3[3][3];
-
+#endif  /* __SSE2__ */
 }
 
 void mul_m3_m3m3(float m1[3][3], float m3_[3][3], float m2_[3][3])
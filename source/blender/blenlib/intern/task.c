@@ -34,6 +34,7 @@
 #include "BLI_math.h"
 #include "BLI_task.h"
 #include "BLI_threads.h"
+#include "BLI_trace.h"
 
 #include "atomic_ops.h"
 
@@ -415,7 +416,9 @@ BLI_INLINE void handle_local_queue(TaskThreadLocalStorage *tls,
 		 * pool tasks.
 		 */
 		TaskPool *local_pool = local_task->pool;
+		BLI_trace_zone_begin("Task");
 		local_task->run(local_pool, local_task->taskdata, thread_id);
+		BLI_trace_zone_end();
 		task_free(local_pool, local_task, thread_id);
 	}
 	BLI_assert(!tls->do_delayed_push);
@@ -437,7 +440,9 @@ static void *task_scheduler_thread_run(void *thread_p)
 
 		/* run task */
 		BLI_assert(!tls->do_delayed_push);
+		BLI_trace_zone_begin("Task");
 		task->run(pool, task->taskdata, thread_id);
+		BLI_trace_zone_end();
 		BLI_assert(!tls->do_delayed_push);
 
 		/* delete task */
@@ -889,7 +894,9 @@ void BLI_task_pool_work_and_wait(TaskPool *pool)
 		if (found_task) {
 			/* run task */
 			BLI_assert(!tls->do_delayed_push);
+			BLI_trace_zone_begin("Task");
 			work_task->run(pool, work_task->taskdata, pool->thread_id);
+			BLI_trace_zone_end();
 			BLI_assert(!tls->do_delayed_push);
 
 			/* delete task */
@@ -808,6 +808,241 @@ void BLI_thread_queue_wait_finish(ThreadQueue *queue)
 
 /* ************************************************ */
 
+/* Bounded MPMC ring buffer (Vyukov), each cell carries a sequence number that
+ * tells whether it is ready to be written (sequence == pos) or read
+ * (sequence == pos + 1) for the position a thread claimed with a CAS.
+ * Consumers only fall back to the mutex/condition once spinning failed. */
+
+/* Number of attempts a blocking pop spins before going to sleep. */
+#define RING_QUEUE_SPIN_COUNT 128
+
+/* Avoid false sharing between producer and consumer positions. */
+#define RING_QUEUE_CACHELINE_SIZE 64
+
+typedef struct ThreadRingQueueCell {
+	size_t sequence;
+	void *work;
+} ThreadRingQueueCell;
+
+struct ThreadRingQueue {
+	size_t push_pos;
+	char pad_push[RING_QUEUE_CACHELINE_SIZE - sizeof(size_t)];
+	size_t pop_pos;
+	char pad_pop[RING_QUEUE_CACHELINE_SIZE - sizeof(size_t)];
+
+	ThreadRingQueueCell *cells;
+	size_t mask;
+
+	/* Only used by consumers waiting for work. */
+	pthread_mutex_t mutex;
+	pthread_cond_t push_cond;
+	unsigned int num_waiting;
+	volatile int nowait;
+};
+
+/* Full barrier load, so the work stored in the cell is visible once its
+ * sequence number is. */
+static size_t ring_queue_load(size_t *p)
+{
+	return atomic_fetch_and_add_z(p, 0);
+}
+
+ThreadRingQueue *BLI_thread_ring_queue_init(unsigned int size)
+{
+	ThreadRingQueue *queue;
+	size_t i, tot = 2;
+
+	/* power of two, so positions can wrap with a mask */
+	while (tot < size) {
+		tot <<= 1;
+	}
+
+	queue = MEM_callocN(sizeof(ThreadRingQueue), "ThreadRingQueue");
+	queue->cells = MEM_mallocN(sizeof(*queue->cells) * tot, "ThreadRingQueue cells");
+	queue->mask = tot - 1;
+
+	for (i = 0; i < tot; i++) {
+		queue->cells[i].sequence = i;
+		queue->cells[i].work = NULL;
+	}
+
+	pthread_mutex_init(&queue->mutex, NULL);
+	pthread_cond_init(&queue->push_cond, NULL);
+
+	return queue;
+}
+
+void BLI_thread_ring_queue_free(ThreadRingQueue *queue)
+{
+	/* destroy everything, assumes no one is using queue anymore */
+	pthread_cond_destroy(&queue->push_cond);
+	pthread_mutex_destroy(&queue->mutex);
+
+	MEM_freeN(queue->cells);
+	MEM_freeN(queue);
+}
+
+/**
+ * Push \a work, returns false without blocking when the queue is full.
+ */
+bool BLI_thread_ring_queue_push(ThreadRingQueue *queue, void *work)
+{
+	ThreadRingQueueCell *cell;
+	size_t pos = *(volatile size_t *)&queue->push_pos;
+
+	for (;;) {
+		size_t seq;
+		intptr_t diff;
+
+		cell = &queue->cells[pos & queue->mask];
+		seq = ring_queue_load(&cell->sequence);
+		diff = (intptr_t)seq - (intptr_t)pos;
+
+		if (diff == 0) {
+			/* cell is free, try to claim it */
+			size_t pos_prev = atomic_cas_z(&queue->push_pos, pos, pos + 1);
+			if (pos_prev == pos) {
+				break;
+			}
+			pos = pos_prev;
+		}
+		else if (diff < 0) {
+			/* cell still holds work from the previous lap, full */
+			return false;
+		}
+		else {
+			pos = *(volatile size_t *)&queue->push_pos;
+		}
+	}
+
+	cell->work = work;
+	/* publish, sequence becomes pos + 1 */
+	atomic_add_and_fetch_z(&cell->sequence, 1);
+
+	/* wake up a consumer if any went to sleep, see ring_queue_pop_wait */
+	if (*(volatile unsigned int *)&queue->num_waiting != 0) {
+		pthread_mutex_lock(&queue->mutex);
+		pthread_cond_signal(&queue->push_cond);
+		pthread_mutex_unlock(&queue->mutex);
+	}
+
+	return true;
+}
+
+/**
+ * Pop into \a r_work, returns false without blocking when the queue is empty.
+ */
+bool BLI_thread_ring_queue_try_pop(ThreadRingQueue *queue, void **r_work)
+{
+	ThreadRingQueueCell *cell;
+	size_t pos = *(volatile size_t *)&queue->pop_pos;
+
+	for (;;) {
+		size_t seq;
+		intptr_t diff;
+
+		cell = &queue->cells[pos & queue->mask];
+		seq = ring_queue_load(&cell->sequence);
+		diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+		if (diff == 0) {
+			/* cell has work, try to claim it */
+			size_t pos_prev = atomic_cas_z(&queue->pop_pos, pos, pos + 1);
+			if (pos_prev == pos) {
+				break;
+			}
+			pos = pos_prev;
+		}
+		else if (diff < 0) {
+			/* nothing pushed here yet, empty */
+			return false;
+		}
+		else {
+			pos = *(volatile size_t *)&queue->pop_pos;
+		}
+	}
+
+	*r_work = cell->work;
+	/* release the cell for the next lap, sequence becomes pos + mask + 1 */
+	atomic_add_and_fetch_z(&cell->sequence, queue->mask);
+
+	return true;
+}
+
+static bool ring_queue_pop_wait(ThreadRingQueue *queue, void **r_work)
+{
+	bool found;
+
+	/* Register before checking the queue again, a producer pushing after
+	 * this point sees the waiter and signals under the mutex, which we hold
+	 * between the check and the wait so the wakeup can't be missed. */
+	atomic_add_and_fetch_u(&queue->num_waiting, 1);
+
+	pthread_mutex_lock(&queue->mutex);
+	while (!(found = BLI_thread_ring_queue_try_pop(queue, r_work)) && !queue->nowait) {
+		pthread_cond_wait(&queue->push_cond, &queue->mutex);
+	}
+	pthread_mutex_unlock(&queue->mutex);
+
+	atomic_sub_and_fetch_u(&queue->num_waiting, 1);
+
+	return found;
+}
+
+/**
+ * Pop work, waiting until there is some.
+ * Returns NULL once the queue is empty and #BLI_thread_ring_queue_nowait was called.
+ */
+void *BLI_thread_ring_queue_pop(ThreadRingQueue *queue)
+{
+	void *work = NULL;
+	int i;
+
+	for (i = 0; i < RING_QUEUE_SPIN_COUNT; i++) {
+		if (BLI_thread_ring_queue_try_pop(queue, &work)) {
+			return work;
+		}
+		if (queue->nowait) {
+			break;
+		}
+	}
+
+	if (!ring_queue_pop_wait(queue, &work)) {
+		work = NULL;
+	}
+
+	return work;
+}
+
+/**
+ * Number of queued items, only a snapshot when other threads are using the queue.
+ */
+int BLI_thread_ring_queue_size(ThreadRingQueue *queue)
+{
+	size_t pop_pos = ring_queue_load(&queue->pop_pos);
+	size_t push_pos = ring_queue_load(&queue->push_pos);
+
+	return (push_pos > pop_pos) ? (int)(push_pos - pop_pos) : 0;
+}
+
+bool BLI_thread_ring_queue_is_empty(ThreadRingQueue *queue)
+{
+	return BLI_thread_ring_queue_size(queue) == 0;
+}
+
+void BLI_thread_ring_queue_nowait(ThreadRingQueue *queue)
+{
+	pthread_mutex_lock(&queue->mutex);
+
+	queue->nowait = 1;
+
+	/* signal threads waiting to pop */
+	pthread_cond_broadcast(&queue->push_cond);
+	pthread_mutex_unlock(&queue->mutex);
+}
+
+/* ************************************************ */
+
 void BLI_begin_threaded_malloc(void)
 {
 	unsigned int level = atomic_fetch_and_add_u(&thread_levels, 1);
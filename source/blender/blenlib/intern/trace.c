@@ -0,0 +1,252 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenlib/intern/trace.c
+ *  \ingroup bli
+ *
+ * Each thread records finished zones into its own ring buffer, the oldest
+ * zones get overwritten once it is full. Buffers are only registered in
+ * the global list (under a spin lock) the first time a thread records.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+#include "BLI_trace.h"
+
+#include "PIL_time.h"
+
+#include "BLI_strict_flags.h"
+
+/* Zones kept per thread, power of two. */
+#define TRACE_EVENTS_NUM (1 << 14)
+/* Maximum depth of nested zones per thread, deeper ones are ignored. */
+#define TRACE_STACK_DEPTH 64
+#define TRACE_NAME_LEN 40
+
+typedef struct TraceEvent {
+	char name[TRACE_NAME_LEN];
+	double time_start;
+	double duration;
+} TraceEvent;
+
+typedef struct TraceZone {
+	const char *name;
+	double time_start;
+} TraceZone;
+
+typedef struct TraceThread {
+	struct TraceThread *next, *prev;
+
+	int thread_index;
+	bool is_main;
+
+	TraceEvent *events;
+	/* Total number of events recorded, wraps around the buffer. */
+	size_t events_num;
+
+	TraceZone stack[TRACE_STACK_DEPTH];
+	int stack_depth;
+} TraceThread;
+
+static struct {
+	bool enabled;
+	double time_start;
+
+	ListBase threads;
+	int threads_num;
+	SpinLock lock;
+} g_trace = {false};
+
+static ThreadLocal(TraceThread *) trace_thread_tls;
+
+void BLI_trace_enable(void)
+{
+	if (g_trace.enabled) {
+		return;
+	}
+
+	BLI_thread_local_create(trace_thread_tls);
+	BLI_spin_init(&g_trace.lock);
+	g_trace.time_start = PIL_check_seconds_timer();
+	g_trace.enabled = true;
+}
+
+bool BLI_trace_is_enabled(void)
+{
+	return g_trace.enabled;
+}
+
+static TraceThread *trace_thread_get(void)
+{
+	TraceThread *thread = BLI_thread_local_get(trace_thread_tls);
+
+	if (UNLIKELY(thread == NULL)) {
+		thread = MEM_callocN(sizeof(*thread), "TraceThread");
+		thread->events = MEM_mallocN(sizeof(*thread->events) * TRACE_EVENTS_NUM, "TraceThread events");
+		thread->is_main = BLI_thread_is_main();
+
+		BLI_spin_lock(&g_trace.lock);
+		thread->thread_index = g_trace.threads_num++;
+		BLI_addtail(&g_trace.threads, thread);
+		BLI_spin_unlock(&g_trace.lock);
+
+		BLI_thread_local_set(trace_thread_tls, thread);
+	}
+
+	return thread;
+}
+
+void BLI_trace_zone_begin(const char *name)
+{
+	TraceThread *thread;
+
+	if (LIKELY(!g_trace.enabled)) {
+		return;
+	}
+
+	thread = trace_thread_get();
+	if (thread->stack_depth < TRACE_STACK_DEPTH) {
+		TraceZone *zone = &thread->stack[thread->stack_depth];
+		zone->name = name;
+		zone->time_start = PIL_check_seconds_timer();
+	}
+	thread->stack_depth++;
+}
+
+void BLI_trace_zone_end(void)
+{
+	TraceThread *thread;
+
+	if (LIKELY(!g_trace.enabled)) {
+		return;
+	}
+
+	thread = trace_thread_get();
+	/* tracing may have been enabled inside of a zone */
+	if (thread->stack_depth == 0) {
+		return;
+	}
+
+	thread->stack_depth--;
+	if (thread->stack_depth < TRACE_STACK_DEPTH) {
+		const TraceZone *zone = &thread->stack[thread->stack_depth];
+		TraceEvent *event = &thread->events[thread->events_num & (TRACE_EVENTS_NUM - 1)];
+
+		BLI_strncpy(event->name, zone->name, sizeof(event->name));
+		event->time_start = zone->time_start;
+		event->duration = PIL_check_seconds_timer() - zone->time_start;
+		thread->events_num++;
+	}
+}
+
+static void trace_write_string(FILE *fp, const char *str)
+{
+	fputc('"', fp);
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\') {
+			fputc('\\', fp);
+			fputc(*str, fp);
+		}
+		else if ((unsigned char)*str < 0x20) {
+			fputc(' ', fp);
+		}
+		else {
+			fputc(*str, fp);
+		}
+	}
+	fputc('"', fp);
+}
+
+/**
+ * Write all recorded zones as Chrome trace-event JSON,
+ * should only be called when no other thread is recording.
+ */
+bool BLI_trace_write_chrome_json(FILE *fp)
+{
+	TraceThread *thread;
+	bool first = true;
+
+	if (!g_trace.enabled) {
+		return false;
+	}
+
+	fprintf(fp, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+	BLI_spin_lock(&g_trace.lock);
+	for (thread = g_trace.threads.first; thread; thread = thread->next) {
+		size_t i = (thread->events_num > TRACE_EVENTS_NUM) ? thread->events_num - TRACE_EVENTS_NUM : 0;
+
+		fprintf(fp, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+		        "\"args\": {\"name\": \"%s %d\"}}",
+		        first ? "" : ",\n", thread->thread_index,
+		        thread->is_main ? "Main" : "Thread", thread->thread_index);
+		first = false;
+
+		for (; i < thread->events_num; i++) {
+			const TraceEvent *event = &thread->events[i & (TRACE_EVENTS_NUM - 1)];
+
+			fprintf(fp, ",\n{\"name\": ");
+			trace_write_string(fp, event->name);
+			/* timestamps are in microseconds */
+			fprintf(fp, ", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+			        thread->thread_index,
+			        (event->time_start - g_trace.time_start) * 1e6,
+			        event->duration * 1e6);
+		}
+	}
+	BLI_spin_unlock(&g_trace.lock);
+
+	fprintf(fp, "\n]}\n");
+
+	return !ferror(fp);
+}
+
+/**
+ * Free all buffers and disable tracing, no thread may be recording.
+ */
+void BLI_trace_free(void)
+{
+	TraceThread *thread, *thread_next;
+
+	if (!g_trace.enabled) {
+		return;
+	}
+
+	g_trace.enabled = false;
+
+	for (thread = g_trace.threads.first; thread; thread = thread_next) {
+		thread_next = thread->next;
+		MEM_freeN(thread->events);
+		MEM_freeN(thread);
+	}
+	BLI_listbase_clear(&g_trace.threads);
+	g_trace.threads_num = 0;
+
+	BLI_thread_local_set(trace_thread_tls, NULL);
+	BLI_thread_local_delete(trace_thread_tls);
+	BLI_spin_end(&g_trace.lock);
+}
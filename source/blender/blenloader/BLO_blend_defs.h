@@ -75,6 +75,23 @@ enum {
 	ENDB = BLEND_MAKE_ID('E', 'N', 'D', 'B'),
 };
 
+/**
+ * Chunked LZO container, written when saving with #G_FILE_COMPRESS and #G_FILE_COMPRESS_FAST.
+ *
+ * Chunks are compressed independently so they can be (de)compressed in parallel.
+ * All integers are little endian.
+ *
+ * - Header: #BLEND_LZO_MAGIC.
+ * - Chunks: compressed size, uncompressed size (uint32 each) followed by the data,
+ *   which is stored as-is when compressing doesn't make it any smaller.
+ * - Footer: file offset of every chunk header (uint64 each), number of chunks (uint32)
+ *   then #BLEND_LZO_MAGIC again, so any chunk can be found without walking the file.
+ */
+#define BLEND_LZO_MAGIC "BLENDLZO"
+#define BLEND_LZO_MAGIC_LEN 8
+/* uncompressed size of a full chunk */
+#define BLEND_LZO_CHUNK_SIZE (1 << 20)
+
 #define BLEN_THUMB_MEMSIZE_FILE(_x, _y) (sizeof(int) * (size_t)(2 + (_x) * (_y)))
 
 #endif  /* __BLO_BLEND_DEFS_H__ */
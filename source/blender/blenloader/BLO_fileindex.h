@@ -0,0 +1,84 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2017 Blender Foundation.
+ * All rights reserved.
+ *
+ * The Original Code is: all of this file.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+#ifndef __BLO_FILEINDEX_H__
+#define __BLO_FILEINDEX_H__
+
+/** \file BLO_fileindex.h
+ *  \ingroup blenloader
+ *
+ * Index of the data-blocks of a blend file, stored in a #DATA block between #DNA1 and #ENDB.
+ * Not following an ID block, it isn't direct data of any data-block and readers
+ * (including older versions) skip it.
+ * Data-blocks can be listed and checked for corruption without reading the whole file.
+ *
+ * Layout of the index block data (native byte order, like the rest of the file):
+ * - A #BlendFileIndexEntry for each ID block, in file order.
+ * - #BlendFileIndexFooter, so the index can be found from the end of the file,
+ *   since only the #ENDB block follows it.
+ *
+ * Offsets are positions in the uncompressed file, so the index is only read from uncompressed files.
+ */
+
+#include "BLI_sys_types.h"
+
+struct LinkNode;
+struct ReportList;
+
+#define BLEND_INDEX_MAGIC "BLENDIDX"
+#define BLEND_INDEX_MAGIC_LEN 8
+
+typedef struct BlendFileIndexEntry {
+	uint64_t offset;    /* of the ID's #BHead */
+	uint64_t size;      /* of the ID block and the #DATA blocks following it, including their #BHead */
+	uint32_t checksum;  /* #BLI_hash_mm2a of these bytes */
+	int code;           /* #BHead.code */
+	char name[66];      /* MAX_ID_NAME */
+	char _pad[6];
+} BlendFileIndexEntry;
+
+typedef struct BlendFileIndexFooter {
+	uint64_t entries_offset;
+	uint32_t entries_len;
+	uint32_t entries_checksum;
+	char magic[BLEND_INDEX_MAGIC_LEN];
+} BlendFileIndexFooter;
+
+typedef struct BlendFileIndex {
+	BlendFileIndexEntry *entries;
+	int entries_len;
+} BlendFileIndex;
+
+BlendFileIndex *BLO_fileindex_read(const char *filepath);
+void BLO_fileindex_free(BlendFileIndex *index);
+
+struct LinkNode *BLO_fileindex_get_datablock_names(const BlendFileIndex *index, int ofblocktype, int *r_tot_names);
+struct LinkNode *BLO_fileindex_get_linkable_groups(const BlendFileIndex *index);
+
+int BLO_fileindex_verify(const BlendFileIndex *index, const char *filepath, struct ReportList *reports);
+
+#endif  /* __BLO_FILEINDEX_H__ */
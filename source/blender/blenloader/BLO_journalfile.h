@@ -0,0 +1,70 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2017 Blender Foundation.
+ * All rights reserved.
+ *
+ * The Original Code is: all of this file.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ * append-only journal of blend file snapshots
+ */
+
+#ifndef __BLO_JOURNALFILE_H__
+#define __BLO_JOURNALFILE_H__
+
+/** \file BLO_journalfile.h
+ *  \ingroup blenloader
+ *
+ * A journal stores successive saves of the same file, where each save only appends the chunks
+ * written by #mywrite which weren't in the journal yet (compared by hash),
+ * followed by a table listing all chunks of that save in order.
+ *
+ * Layout (native byte order, journals are not meant to be moved between machines):
+ * - Header: #BLEND_JOURNAL_MAGIC followed by the file offset of the latest table (uint64),
+ *   which is only updated once a save has been fully appended, so a save interrupted
+ *   half way keeps the previous one readable.
+ * - Chunk data, then for each save: the number of chunks (uint32, padded to 8 bytes)
+ *   and a #BlendJournalChunk for each.
+ */
+
+#include "BLI_sys_types.h"
+
+#define BLEND_JOURNAL_MAGIC "BLENDJNL"
+#define BLEND_JOURNAL_MAGIC_LEN 8
+
+typedef struct BlendJournalChunk {
+	uint64_t offset;
+	uint64_t hash;
+	uint32_t size;
+	uint32_t _pad;
+} BlendJournalChunk;
+
+typedef struct BlendJournalWriter BlendJournalWriter;
+
+bool BLO_journal_is_journal(int file);
+BlendJournalChunk *BLO_journal_snapshot_read(int file, int *r_chunks_len, uint64_t *r_size);
+
+BlendJournalWriter *BLO_journal_writer_open(const char *filepath);
+bool BLO_journal_writer_add(BlendJournalWriter *jw, const void *buf, size_t buf_len);
+bool BLO_journal_writer_close(BlendJournalWriter *jw, const bool commit);
+
+bool BLO_journal_compact(const char *journal_filepath, const char *filepath);
+
+#endif  /* __BLO_JOURNALFILE_H__ */
@@ -0,0 +1,64 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2017 Blender Foundation.
+ * All rights reserved.
+ *
+ * The Original Code is: all of this file.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ * chunked LZO container for blend files
+ */
+
+#ifndef __BLO_LZOFILE_H__
+#define __BLO_LZOFILE_H__
+
+/** \file BLO_lzofile.h
+ *  \ingroup blenloader
+ *
+ * Reading and writing of the chunked LZO container, see #BLEND_LZO_MAGIC for the layout.
+ * Chunks are (de)compressed in batches, one chunk per thread.
+ */
+
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct BlendLZOWriter BlendLZOWriter;
+typedef struct BlendLZOReader BlendLZOReader;
+
+bool BLO_lzo_is_file(int file);
+
+#ifdef WITH_LZO
+BlendLZOWriter *BLO_lzo_writer_open(const char *filepath);
+bool BLO_lzo_writer_write(BlendLZOWriter *lw, const void *buf, size_t buf_len);
+bool BLO_lzo_writer_close(BlendLZOWriter *lw);
+
+BlendLZOReader *BLO_lzo_reader_open(int file);
+size_t BLO_lzo_reader_read(BlendLZOReader *lr, void *buf, size_t buf_len);
+void BLO_lzo_reader_free(BlendLZOReader *lr);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __BLO_LZOFILE_H__ */
@@ -120,6 +120,8 @@ void BLO_library_link_end(struct Main *mainl, BlendHandle **bh, short flag, stru
 
 void BLO_library_link_copypaste(struct Main *mainl, BlendHandle *bh);
 
+bool BLO_library_lazy_data_ensure(struct Main *bmain, struct ID *id, struct ReportList *reports);
+
 void *BLO_library_read_struct(struct FileData *fd, struct BHead *bh, const char *blockname);
 
 BlendFileData *blo_read_blendafterruntime(int file, const char *name, int actualsize, struct ReportList *reports);
@@ -36,7 +36,7 @@
 typedef struct {
 	void *next, *prev;
 	
-	char *buf;
+	char *buf;  /* shared between chunks with the same content, see undofile.c */
 	unsigned int ident, size;
 	
 } MemFileChunk;
@@ -52,6 +52,10 @@ extern void memfile_chunk_add(MemFile *compare, MemFile *current, const char *bu
 /* exports */
 extern void BLO_memfile_free(MemFile *memfile);
 extern void BLO_memfile_merge(MemFile *first, MemFile *second);
+extern void BLO_memfile_share(MemFile *dst, const MemFile *src);
+extern size_t BLO_memfile_compress(MemFile *memfile);
+extern size_t BLO_memfile_uncompress(MemFile *memfile);
+extern bool BLO_memfile_write_journal(MemFile *memfile, const char *filename);
 
 #endif
 
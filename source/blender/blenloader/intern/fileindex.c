@@ -0,0 +1,232 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2017 Blender Foundation.
+ * All rights reserved.
+ *
+ * The Original Code is: all of this file.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ * index of the data-blocks of a blend file, see BLO_fileindex.h
+ */
+
+/** \file blender/blenloader/intern/fileindex.c
+ *  \ingroup blenloader
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+
+#ifndef WIN32
+#  include <unistd.h>
+#else
+#  include <io.h>
+#  include "BLI_winstuff.h"
+#endif
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_fileops.h"
+#include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_linklist.h"
+
+#include "DNA_sdna_types.h"
+
+#include "BLT_translation.h"
+
+#include "BKE_global.h"  /* for ENDIAN_ORDER */
+#include "BKE_idcode.h"
+#include "BKE_report.h"
+
+#include "BLO_blend_defs.h"
+#include "BLO_fileindex.h"
+
+/* checked before reading the entries, a damaged footer shouldn't make us allocate gigabytes */
+#define INDEX_ENTRIES_MAX (1 << 24)
+
+static bool fileindex_read_at(int file, uint64_t offset, void *buf, size_t len)
+{
+	return ((lseek(file, (off_t)offset, SEEK_SET) == (off_t)offset) &&
+	        (read(file, buf, len) == (ssize_t)len));
+}
+
+/**
+ * Read the index of an uncompressed blend file written with the same endianness.
+ *
+ * \return NULL when the file has no (valid) index, callers should fall back to reading the file.
+ */
+BlendFileIndex *BLO_fileindex_read(const char *filepath)
+{
+	BlendFileIndex *index = NULL;
+	BlendFileIndexFooter footer;
+	char header[12];  /* SIZEOFBLENDERHEADER */
+	off_t file_size;
+	uint64_t footer_end;
+	int endb_code, endb_size;
+	int file;
+
+	file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+	if (file == -1) {
+		return NULL;
+	}
+
+	if (!fileindex_read_at(file, 0, header, sizeof(header)) ||
+	    !STREQLEN(header, "BLENDER", 7) ||
+	    (header[8] != ((ENDIAN_ORDER == B_ENDIAN) ? 'V' : 'v')))
+	{
+		goto finally;
+	}
+
+	/* the footer ends the index block, only the #ENDB block follows it */
+	endb_size = (header[7] == '_') ? (int)sizeof(BHead4) : (int)sizeof(BHead8);
+	file_size = lseek(file, 0, SEEK_END);
+	if (file_size < (off_t)(sizeof(header) + sizeof(footer) + endb_size)) {
+		goto finally;
+	}
+	footer_end = (uint64_t)file_size - (uint64_t)endb_size;
+
+	if (!fileindex_read_at(file, footer_end, &endb_code, sizeof(endb_code)) ||
+	    (endb_code != ENDB) ||
+	    !fileindex_read_at(file, footer_end - sizeof(footer), &footer, sizeof(footer)) ||
+	    memcmp(footer.magic, BLEND_INDEX_MAGIC, BLEND_INDEX_MAGIC_LEN) != 0 ||
+	    footer.entries_len > INDEX_ENTRIES_MAX ||
+	    (footer.entries_offset + footer.entries_len * sizeof(BlendFileIndexEntry) + sizeof(footer) != footer_end))
+	{
+		goto finally;
+	}
+
+	index = MEM_mallocN(sizeof(*index), __func__);
+	index->entries_len = (int)footer.entries_len;
+	index->entries = MEM_mallocN(sizeof(*index->entries) * MAX2(footer.entries_len, 1), __func__);
+
+	if (!fileindex_read_at(file, footer.entries_offset, index->entries,
+	                       sizeof(*index->entries) * footer.entries_len) ||
+	    (BLI_hash_mm2((const unsigned char *)index->entries,
+	                  sizeof(*index->entries) * footer.entries_len, 0) != footer.entries_checksum))
+	{
+		BLO_fileindex_free(index);
+		index = NULL;
+	}
+
+finally:
+	close(file);
+	return index;
+}
+
+void BLO_fileindex_free(BlendFileIndex *index)
+{
+	MEM_freeN(index->entries);
+	MEM_freeN(index);
+}
+
+/**
+ * Same as #BLO_blendhandle_get_datablock_names.
+ */
+LinkNode *BLO_fileindex_get_datablock_names(const BlendFileIndex *index, int ofblocktype, int *r_tot_names)
+{
+	LinkNode *names = NULL;
+	int tot = 0;
+	int i;
+
+	for (i = 0; i < index->entries_len; i++) {
+		const BlendFileIndexEntry *entry = &index->entries[i];
+
+		if (entry->code == ofblocktype) {
+			BLI_linklist_prepend(&names, strdup(entry->name + 2));
+			tot++;
+		}
+	}
+
+	*r_tot_names = tot;
+	return names;
+}
+
+/**
+ * Same as #BLO_blendhandle_get_linkable_groups.
+ */
+LinkNode *BLO_fileindex_get_linkable_groups(const BlendFileIndex *index)
+{
+	GSet *gathered = BLI_gset_ptr_new(__func__);
+	LinkNode *names = NULL;
+	int i;
+
+	for (i = 0; i < index->entries_len; i++) {
+		const int code = index->entries[i].code;
+
+		if (BKE_idcode_is_valid(code) && BKE_idcode_is_linkable(code)) {
+			const char *str = BKE_idcode_to_name(code);
+
+			if (BLI_gset_add(gathered, (void *)str)) {
+				BLI_linklist_prepend(&names, strdup(str));
+			}
+		}
+	}
+
+	BLI_gset_free(gathered, NULL);
+
+	return names;
+}
+
+/**
+ * Compare the data-blocks in the file against their checksums, reporting damaged ones.
+ *
+ * \return the number of damaged data-blocks, -1 when the file couldn't be read.
+ */
+int BLO_fileindex_verify(const BlendFileIndex *index, const char *filepath, ReportList *reports)
+{
+	unsigned char *buf = NULL;
+	size_t buf_len = 0;
+	int tot_damaged = 0;
+	int file;
+	int i;
+
+	file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+	if (file == -1) {
+		return -1;
+	}
+
+	for (i = 0; i < index->entries_len; i++) {
+		const BlendFileIndexEntry *entry = &index->entries[i];
+		BLI_HashMurmur2A mm2;
+
+		if (entry->size > buf_len) {
+			buf_len = (size_t)entry->size;
+			MEM_SAFE_FREE(buf);
+			buf = MEM_mallocN(buf_len, __func__);
+		}
+
+		BLI_hash_mm2a_init(&mm2, 0);
+		if (fileindex_read_at(file, entry->offset, buf, (size_t)entry->size)) {
+			BLI_hash_mm2a_add(&mm2, buf, (size_t)entry->size);
+		}
+
+		if (BLI_hash_mm2a_end(&mm2) != entry->checksum) {
+			BKE_reportf(reports, RPT_WARNING, TIP_("Data-block '%s' is damaged"), entry->name + 2);
+			tot_damaged++;
+		}
+	}
+
+	MEM_SAFE_FREE(buf);
+	close(file);
+
+	return tot_damaged;
+}
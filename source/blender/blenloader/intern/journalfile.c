@@ -0,0 +1,373 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2017 Blender Foundation.
+ * All rights reserved.
+ *
+ * The Original Code is: all of this file.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ * append-only journal of blend file snapshots, see BLO_journalfile.h
+ */
+
+/** \file blender/blenloader/intern/journalfile.c
+ *  \ingroup blenloader
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+
+#ifndef WIN32
+#  include <unistd.h>
+#else
+#  include <io.h>
+#  include "BLI_winstuff.h"
+#endif
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_fileops.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_math_base.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+
+#include "BLO_journalfile.h"
+
+/* start over when the journal is this many times larger than the latest save it holds */
+#define JOURNAL_COMPACT_FACTOR 4
+
+typedef struct BlendJournalHeader {
+	char magic[BLEND_JOURNAL_MAGIC_LEN];
+	uint64_t table_offset;
+} BlendJournalHeader;
+
+/* journals are written to temporary locations, avoid writing through symlinks (CVE-2008-1103) */
+#ifdef O_NOFOLLOW
+#  define JOURNAL_O_NOFOLLOW O_NOFOLLOW
+#else
+#  define JOURNAL_O_NOFOLLOW 0
+#endif
+
+struct BlendJournalWriter {
+	int file;
+	uint64_t file_offset;
+	bool error;
+
+	/* the journal is written from scratch to a temporary file */
+	bool is_new;
+	char filepath[FILE_MAX];
+	char filepath_tmp[FILE_MAX + 1];
+
+	/* chunks of the previous save, sorted by hash */
+	BlendJournalChunk *chunks_prev;
+	int chunks_prev_len;
+
+	BlendJournalChunk *chunks;
+	int chunks_len, chunks_alloc;
+};
+
+static bool journal_read_at(int file, uint64_t offset, void *buf, size_t len)
+{
+	return ((lseek(file, (off_t)offset, SEEK_SET) == (off_t)offset) &&
+	        (read(file, buf, len) == (ssize_t)len));
+}
+
+static bool journal_write_at(int file, uint64_t offset, const void *buf, size_t len)
+{
+	return ((lseek(file, (off_t)offset, SEEK_SET) == (off_t)offset) &&
+	        (write(file, buf, len) == (ssize_t)len));
+}
+
+/* make sure everything written so far is on disk before continuing */
+static bool journal_sync(int file)
+{
+#ifdef WIN32
+	return (_commit(file) == 0);
+#else
+	return (fsync(file) == 0);
+#endif
+}
+
+static uint64_t journal_hash(const void *buf, size_t len)
+{
+	/* two seeds, a false match would silently corrupt the file */
+	return (((uint64_t)BLI_hash_mm2(buf, len, 0) << 32) |
+	        (uint64_t)BLI_hash_mm2(buf, len, 0x9e3779b9));
+}
+
+static int journal_chunk_cmp(const void *a, const void *b)
+{
+	const BlendJournalChunk *chunk_a = a, *chunk_b = b;
+
+	if (chunk_a->hash != chunk_b->hash) {
+		return (chunk_a->hash < chunk_b->hash) ? -1 : 1;
+	}
+	if (chunk_a->size != chunk_b->size) {
+		return (chunk_a->size < chunk_b->size) ? -1 : 1;
+	}
+	return 0;
+}
+
+bool BLO_journal_is_journal(int file)
+{
+	BlendJournalHeader header;
+
+	return (journal_read_at(file, 0, &header, sizeof(header)) &&
+	        (memcmp(header.magic, BLEND_JOURNAL_MAGIC, BLEND_JOURNAL_MAGIC_LEN) == 0));
+}
+
+/**
+ * Read the chunk table of the latest save in the journal.
+ *
+ * \param r_size: Size of the save (the sum of all chunk sizes).
+ * \return the chunks in file order, or NULL when the journal is invalid.
+ */
+BlendJournalChunk *BLO_journal_snapshot_read(int file, int *r_chunks_len, uint64_t *r_size)
+{
+	const size_t file_size = BLI_file_descriptor_size(file);
+	BlendJournalHeader header;
+	BlendJournalChunk *chunks;
+	uint32_t chunks_len[2];
+	uint64_t size = 0;
+	uint32_t i;
+
+	if (!journal_read_at(file, 0, &header, sizeof(header)) ||
+	    (memcmp(header.magic, BLEND_JOURNAL_MAGIC, BLEND_JOURNAL_MAGIC_LEN) != 0) ||
+	    (header.table_offset < sizeof(header)) ||
+	    !journal_read_at(file, header.table_offset, chunks_len, sizeof(chunks_len)) ||
+	    (chunks_len[0] > (file_size - header.table_offset) / sizeof(BlendJournalChunk)))
+	{
+		return NULL;
+	}
+
+	chunks = MEM_mallocN(sizeof(*chunks) * (size_t)max_ii((int)chunks_len[0], 1), __func__);
+	if (!journal_read_at(file, header.table_offset + sizeof(chunks_len), chunks, sizeof(*chunks) * chunks_len[0])) {
+		MEM_freeN(chunks);
+		return NULL;
+	}
+
+	for (i = 0; i < chunks_len[0]; i++) {
+		if (chunks[i].offset + chunks[i].size > header.table_offset) {
+			MEM_freeN(chunks);
+			return NULL;
+		}
+		size += chunks[i].size;
+	}
+
+	*r_chunks_len = (int)chunks_len[0];
+	*r_size = size;
+	return chunks;
+}
+
+/**
+ * Start a new save, the journal is created when it doesn't exist or is invalid.
+ */
+BlendJournalWriter *BLO_journal_writer_open(const char *filepath)
+{
+	BlendJournalWriter *jw = MEM_callocN(sizeof(*jw), __func__);
+	int file;
+
+	BLI_strncpy(jw->filepath, filepath, sizeof(jw->filepath));
+	BLI_snprintf(jw->filepath_tmp, sizeof(jw->filepath_tmp), "%s@", filepath);
+
+	file = BLI_open(filepath, O_BINARY | O_RDWR | JOURNAL_O_NOFOLLOW, 0);
+	if (file != -1) {
+		uint64_t size;
+		jw->chunks_prev = BLO_journal_snapshot_read(file, &jw->chunks_prev_len, &size);
+		if (jw->chunks_prev &&
+		    (BLI_file_descriptor_size(file) <= (size + (1 << 20)) * JOURNAL_COMPACT_FACTOR))
+		{
+			jw->file = file;
+			jw->file_offset = BLI_file_descriptor_size(file);
+		}
+		else {
+			/* most of the journal is unused by now (or it's invalid), start over */
+			MEM_SAFE_FREE(jw->chunks_prev);
+			jw->chunks_prev_len = 0;
+			close(file);
+			file = -1;
+		}
+	}
+
+	if (file == -1) {
+		const BlendJournalHeader header = {BLEND_JOURNAL_MAGIC, 0};
+
+		file = BLI_open(jw->filepath_tmp, O_BINARY | O_RDWR | O_CREAT | O_TRUNC | JOURNAL_O_NOFOLLOW, 0666);
+		if (file == -1) {
+			MEM_freeN(jw);
+			return NULL;
+		}
+		jw->file = file;
+		jw->is_new = true;
+		jw->error = !journal_write_at(file, 0, &header, sizeof(header));
+		jw->file_offset = sizeof(header);
+	}
+
+	if (jw->chunks_prev) {
+		qsort(jw->chunks_prev, (size_t)jw->chunks_prev_len, sizeof(*jw->chunks_prev), journal_chunk_cmp);
+	}
+
+	return jw;
+}
+
+/**
+ * Add the next chunk of the file, its data is only written when the previous save didn't have it.
+ */
+bool BLO_journal_writer_add(BlendJournalWriter *jw, const void *buf, size_t buf_len)
+{
+	BlendJournalChunk chunk = {0};
+	const BlendJournalChunk *chunk_prev = NULL;
+
+	if (jw->error) {
+		return false;
+	}
+
+	chunk.hash = journal_hash(buf, buf_len);
+	chunk.size = (uint32_t)buf_len;
+
+	if (jw->chunks_prev) {
+		chunk_prev = bsearch(&chunk, jw->chunks_prev, (size_t)jw->chunks_prev_len,
+		                     sizeof(*jw->chunks_prev), journal_chunk_cmp);
+	}
+
+	if (chunk_prev) {
+		chunk.offset = chunk_prev->offset;
+	}
+	else {
+		chunk.offset = jw->file_offset;
+		if (!journal_write_at(jw->file, jw->file_offset, buf, buf_len)) {
+			jw->error = true;
+			return false;
+		}
+		jw->file_offset += buf_len;
+	}
+
+	if (jw->chunks_len == jw->chunks_alloc) {
+		jw->chunks_alloc = max_ii(256, jw->chunks_alloc * 2);
+		jw->chunks = MEM_reallocN(jw->chunks, sizeof(*jw->chunks) * (size_t)jw->chunks_alloc);
+	}
+	jw->chunks[jw->chunks_len++] = chunk;
+
+	return true;
+}
+
+/**
+ * Finish the save, only when \a commit is set it replaces the previous one.
+ */
+bool BLO_journal_writer_close(BlendJournalWriter *jw, const bool commit)
+{
+	const uint32_t chunks_len[2] = {(uint32_t)jw->chunks_len, 0};
+	const uint64_t table_offset = jw->file_offset;
+	bool ok = commit && !jw->error;
+
+	if (ok) {
+		ok = (journal_write_at(jw->file, table_offset, chunks_len, sizeof(chunks_len)) &&
+		      journal_write_at(jw->file, table_offset + sizeof(chunks_len),
+		                       jw->chunks, sizeof(*jw->chunks) * (size_t)jw->chunks_len) &&
+		      /* only point the header to the new table once the table and the chunks are on disk,
+		       * otherwise a crash could leave a header pointing to data that was never written */
+		      journal_sync(jw->file) &&
+		      journal_write_at(jw->file, offsetof(BlendJournalHeader, table_offset),
+		                       &table_offset, sizeof(table_offset)) &&
+		      journal_sync(jw->file));
+	}
+
+	if (close(jw->file) == -1) {
+		ok = false;
+	}
+
+	if (jw->is_new) {
+		if (ok) {
+			ok = (BLI_rename(jw->filepath_tmp, jw->filepath) == 0);
+		}
+		else {
+			BLI_delete(jw->filepath_tmp, false, false);
+		}
+	}
+
+	MEM_SAFE_FREE(jw->chunks_prev);
+	MEM_SAFE_FREE(jw->chunks);
+	MEM_freeN(jw);
+
+	return ok;
+}
+
+/**
+ * Write the latest save in the journal as a regular blend file.
+ */
+bool BLO_journal_compact(const char *journal_filepath, const char *filepath)
+{
+	char filepath_tmp[FILE_MAX + 1];
+	BlendJournalChunk *chunks;
+	int chunks_len, i;
+	uint64_t size;
+	char *buf = NULL;
+	uint32_t buf_len = 0;
+	int file, file_out;
+	bool ok = true;
+
+	file = BLI_open(journal_filepath, O_BINARY | O_RDONLY, 0);
+	if (file == -1) {
+		return false;
+	}
+
+	chunks = BLO_journal_snapshot_read(file, &chunks_len, &size);
+	if (chunks == NULL) {
+		close(file);
+		return false;
+	}
+
+	BLI_snprintf(filepath_tmp, sizeof(filepath_tmp), "%s@", filepath);
+	file_out = BLI_open(filepath_tmp, O_BINARY | O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (file_out == -1) {
+		MEM_freeN(chunks);
+		close(file);
+		return false;
+	}
+
+	for (i = 0; ok && (i < chunks_len); i++) {
+		if (chunks[i].size > buf_len) {
+			buf_len = chunks[i].size;
+			MEM_SAFE_FREE(buf);
+			buf = MEM_mallocN(buf_len, __func__);
+		}
+		ok = (journal_read_at(file, chunks[i].offset, buf, chunks[i].size) &&
+		      (write(file_out, buf, chunks[i].size) == (ssize_t)chunks[i].size));
+	}
+
+	MEM_SAFE_FREE(buf);
+	MEM_freeN(chunks);
+	close(file);
+
+	if (close(file_out) == -1) {
+		ok = false;
+	}
+
+	if (ok) {
+		ok = (BLI_rename(filepath_tmp, filepath) == 0);
+	}
+	else {
+		BLI_delete(filepath_tmp, false, false);
+	}
+
+	return ok;
+}
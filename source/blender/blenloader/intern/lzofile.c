@@ -0,0 +1,458 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2017 Blender Foundation.
+ * All rights reserved.
+ *
+ * The Original Code is: all of this file.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ * chunked LZO container for blend files, see BLO_lzofile.h
+ */
+
+/** \file blender/blenloader/intern/lzofile.c
+ *  \ingroup blenloader
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+
+#ifndef WIN32
+#  include <unistd.h>
+#else
+#  include <io.h>
+#  include "BLI_winstuff.h"
+#endif
+
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#  define LZO_OUT_LEN(size)     ((size) + (size) / 16 + 64 + 3)
+#endif
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_fileops.h"
+#include "BLI_math_base.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "BLO_blend_defs.h"
+#include "BLO_lzofile.h"
+
+bool BLO_lzo_is_file(int file)
+{
+	char magic[BLEND_LZO_MAGIC_LEN];
+
+	return ((lseek(file, 0, SEEK_SET) == 0) &&
+	        (read(file, magic, sizeof(magic)) == sizeof(magic)) &&
+	        (memcmp(magic, BLEND_LZO_MAGIC, sizeof(magic)) == 0));
+}
+
+#ifdef WITH_LZO
+
+typedef struct BlendLZOChunk {
+	unsigned char *in, *out;
+	size_t in_len, out_len;
+	bool ok;
+} BlendLZOChunk;
+
+static BlendLZOChunk *lzo_chunks_alloc(int chunks_num, size_t in_size, size_t out_size)
+{
+	BlendLZOChunk *chunks = MEM_callocN(sizeof(*chunks) * (size_t)chunks_num, __func__);
+	int i;
+
+	for (i = 0; i < chunks_num; i++) {
+		chunks[i].in = MEM_mallocN(in_size, "BlendLZOChunk.in");
+		chunks[i].out = MEM_mallocN(out_size, "BlendLZOChunk.out");
+	}
+	return chunks;
+}
+
+static void lzo_chunks_free(BlendLZOChunk *chunks, int chunks_num)
+{
+	int i;
+
+	for (i = 0; i < chunks_num; i++) {
+		MEM_freeN(chunks[i].in);
+		MEM_freeN(chunks[i].out);
+	}
+	MEM_freeN(chunks);
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Writing
+ * \{ */
+
+struct BlendLZOWriter {
+	int file;
+	bool error;
+
+	/* chunks filled before compressing them all at once, one per thread */
+	BlendLZOChunk *chunks;
+	int chunks_len, chunks_num;
+
+	/* file offsets of the written chunks, for the footer */
+	uint64_t *offsets;
+	int offsets_len, offsets_alloc;
+	uint64_t file_offset;
+};
+
+static bool lzo_write_raw(BlendLZOWriter *lw, const void *data, size_t data_len)
+{
+	if (lw->error == false) {
+		if (write(lw->file, data, data_len) == (ssize_t)data_len) {
+			lw->file_offset += data_len;
+		}
+		else {
+			lw->error = true;
+		}
+	}
+	return (lw->error == false);
+}
+
+static bool lzo_write_uint(BlendLZOWriter *lw, uint64_t value, int size)
+{
+	unsigned char buf[8];
+	int i;
+
+	/* little endian on all platforms */
+	for (i = 0; i < size; i++) {
+		buf[i] = (unsigned char)(value >> (i * 8));
+	}
+	return lzo_write_raw(lw, buf, (size_t)size);
+}
+
+static void lzo_compress_chunk(void *userdata, int index)
+{
+	BlendLZOChunk *chunk = &((BlendLZOWriter *)userdata)->chunks[index];
+	lzo_align_t *wrkmem = MEM_mallocN(LZO1X_1_MEM_COMPRESS, __func__);
+	lzo_uint out_len = LZO_OUT_LEN(chunk->in_len);
+
+	if ((lzo1x_1_compress(chunk->in, (lzo_uint)chunk->in_len, chunk->out, &out_len, wrkmem) == LZO_E_OK) &&
+	    (out_len < chunk->in_len))
+	{
+		chunk->out_len = out_len;
+	}
+	else {
+		/* stored as-is */
+		chunk->out_len = chunk->in_len;
+	}
+
+	MEM_freeN(wrkmem);
+}
+
+/* compress all filled chunks in parallel and write them in order */
+static void lzo_writer_flush(BlendLZOWriter *lw)
+{
+	int i;
+
+	if (lw->chunks_len == 0) {
+		return;
+	}
+
+	BLI_task_parallel_range(0, lw->chunks_len, lw, lzo_compress_chunk, lw->chunks_len > 1);
+
+	for (i = 0; i < lw->chunks_len; i++) {
+		BlendLZOChunk *chunk = &lw->chunks[i];
+		const bool is_stored = (chunk->out_len == chunk->in_len);
+
+		if (lw->offsets_len == lw->offsets_alloc) {
+			lw->offsets_alloc = max_ii(64, lw->offsets_alloc * 2);
+			lw->offsets = MEM_reallocN(lw->offsets, sizeof(*lw->offsets) * (size_t)lw->offsets_alloc);
+		}
+		lw->offsets[lw->offsets_len++] = lw->file_offset;
+
+		lzo_write_uint(lw, chunk->out_len, 4);
+		lzo_write_uint(lw, chunk->in_len, 4);
+		lzo_write_raw(lw, is_stored ? chunk->in : chunk->out, chunk->out_len);
+
+		chunk->in_len = 0;
+	}
+
+	lw->chunks_len = 0;
+}
+
+BlendLZOWriter *BLO_lzo_writer_open(const char *filepath)
+{
+	BlendLZOWriter *lw;
+	int file;
+
+	file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
+
+	if (file == -1) {
+		return NULL;
+	}
+
+	lw = MEM_callocN(sizeof(*lw), __func__);
+	lw->file = file;
+	lw->chunks_num = BLI_system_thread_count();
+	lw->chunks = lzo_chunks_alloc(lw->chunks_num, BLEND_LZO_CHUNK_SIZE, LZO_OUT_LEN(BLEND_LZO_CHUNK_SIZE));
+
+	lzo_write_raw(lw, BLEND_LZO_MAGIC, BLEND_LZO_MAGIC_LEN);
+
+	return lw;
+}
+
+bool BLO_lzo_writer_write(BlendLZOWriter *lw, const void *buf, size_t buf_len)
+{
+	size_t written = 0;
+
+	while (written != buf_len) {
+		BlendLZOChunk *chunk = &lw->chunks[lw->chunks_len];
+		const size_t len = MIN2(buf_len - written, BLEND_LZO_CHUNK_SIZE - chunk->in_len);
+
+		memcpy(chunk->in + chunk->in_len, (const char *)buf + written, len);
+		chunk->in_len += len;
+		written += len;
+
+		if (chunk->in_len == BLEND_LZO_CHUNK_SIZE) {
+			if (++lw->chunks_len == lw->chunks_num) {
+				lzo_writer_flush(lw);
+			}
+		}
+	}
+
+	return (lw->error == false);
+}
+
+/**
+ * Write the remaining chunks and the footer, then close the file.
+ */
+bool BLO_lzo_writer_close(BlendLZOWriter *lw)
+{
+	bool ok;
+	int i;
+
+	/* the last chunk is partially filled */
+	if (lw->chunks[lw->chunks_len].in_len != 0) {
+		lw->chunks_len++;
+	}
+	lzo_writer_flush(lw);
+
+	for (i = 0; i < lw->offsets_len; i++) {
+		lzo_write_uint(lw, lw->offsets[i], 8);
+	}
+	lzo_write_uint(lw, (uint64_t)lw->offsets_len, 4);
+	lzo_write_raw(lw, BLEND_LZO_MAGIC, BLEND_LZO_MAGIC_LEN);
+
+	ok = (close(lw->file) != -1) && (lw->error == false);
+
+	lzo_chunks_free(lw->chunks, lw->chunks_num);
+	MEM_SAFE_FREE(lw->offsets);
+	MEM_freeN(lw);
+
+	return ok;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Reading
+ * \{ */
+
+struct BlendLZOReader {
+	int file;
+
+	/* file offset of every chunk, from the footer */
+	uint64_t *offsets;
+	int chunks_len;
+
+	/* the chunks currently decompressed, starting at chunk index #batch_first */
+	BlendLZOChunk *batch;
+	int batch_len, batch_num, batch_first;
+	/* position in the batch */
+	int batch_index;
+	size_t batch_offset;
+};
+
+static uint64_t lzo_read_uint(const unsigned char *buf, int size)
+{
+	uint64_t value = 0;
+	int i;
+
+	for (i = size - 1; i >= 0; i--) {
+		value = (value << 8) | buf[i];
+	}
+	return value;
+}
+
+static bool lzo_read_at(int file, uint64_t offset, void *buf, size_t len)
+{
+	return ((lseek(file, (off_t)offset, SEEK_SET) == (off_t)offset) &&
+	        (read(file, buf, len) == (ssize_t)len));
+}
+
+static void lzo_decompress_chunk(void *userdata, int index)
+{
+	BlendLZOChunk *chunk = &((BlendLZOReader *)userdata)->batch[index];
+
+	if (chunk->in_len == chunk->out_len) {
+		/* stored as-is */
+		memcpy(chunk->out, chunk->in, chunk->in_len);
+		chunk->ok = true;
+	}
+	else {
+		lzo_uint out_len = chunk->out_len;
+		chunk->ok = ((lzo1x_decompress_safe(chunk->in, chunk->in_len, chunk->out, &out_len, NULL) == LZO_E_OK) &&
+		             (out_len == chunk->out_len));
+	}
+}
+
+/**
+ * Decompress the chunks starting at \a chunk_first, this also allows random access into the file.
+ * On failure the batch stays empty, so no data of partially loaded chunks is read.
+ */
+static bool lzo_batch_load(BlendLZOReader *lr, int chunk_first)
+{
+	const int batch_len = min_ii(lr->batch_num, lr->chunks_len - chunk_first);
+	int i;
+
+	lr->batch_first = chunk_first;
+	lr->batch_len = 0;
+	lr->batch_index = 0;
+	lr->batch_offset = 0;
+
+	/* reading is serial, decompressing isn't */
+	for (i = 0; i < batch_len; i++) {
+		BlendLZOChunk *chunk = &lr->batch[i];
+		unsigned char chunk_header[8];
+
+		if (!lzo_read_at(lr->file, lr->offsets[chunk_first + i], chunk_header, sizeof(chunk_header))) {
+			return false;
+		}
+		chunk->in_len = (size_t)lzo_read_uint(chunk_header, 4);
+		chunk->out_len = (size_t)lzo_read_uint(chunk_header + 4, 4);
+		if ((chunk->out_len > BLEND_LZO_CHUNK_SIZE) || (chunk->in_len > chunk->out_len) ||
+		    (read(lr->file, chunk->in, chunk->in_len) != (ssize_t)chunk->in_len))
+		{
+			return false;
+		}
+	}
+
+	BLI_task_parallel_range(0, batch_len, lr, lzo_decompress_chunk, batch_len > 1);
+
+	for (i = 0; i < batch_len; i++) {
+		if (!lr->batch[i].ok) {
+			return false;
+		}
+	}
+
+	lr->batch_len = batch_len;
+	return true;
+}
+
+/**
+ * Read the chunk table from the footer, the file is known to start with #BLEND_LZO_MAGIC.
+ * The file stays owned by the caller, it must be kept open until #BLO_lzo_reader_free.
+ *
+ * \return NULL when the file is corrupt.
+ */
+BlendLZOReader *BLO_lzo_reader_open(int file)
+{
+	const size_t file_size = BLI_file_descriptor_size(file);
+	const size_t footer_size = 4 + BLEND_LZO_MAGIC_LEN;
+	unsigned char footer[4 + BLEND_LZO_MAGIC_LEN];
+	unsigned char *offsets_buf;
+	BlendLZOReader *lr;
+	int chunks_len, i;
+
+	if ((file_size == (size_t)-1) || (file_size < BLEND_LZO_MAGIC_LEN + footer_size) ||
+	    !lzo_read_at(file, file_size - footer_size, footer, footer_size) ||
+	    (memcmp(footer + 4, BLEND_LZO_MAGIC, BLEND_LZO_MAGIC_LEN) != 0))
+	{
+		return NULL;
+	}
+
+	chunks_len = (int)lzo_read_uint(footer, 4);
+	if ((chunks_len < 0) || ((size_t)chunks_len * 8 > file_size - footer_size - BLEND_LZO_MAGIC_LEN)) {
+		return NULL;
+	}
+
+	lr = MEM_callocN(sizeof(*lr), __func__);
+	lr->file = file;
+	lr->chunks_len = chunks_len;
+	lr->offsets = MEM_mallocN(sizeof(*lr->offsets) * (size_t)max_ii(chunks_len, 1), __func__);
+
+	offsets_buf = MEM_mallocN((size_t)chunks_len * 8 + 1, __func__);
+	if (!lzo_read_at(file, file_size - footer_size - (size_t)chunks_len * 8, offsets_buf, (size_t)chunks_len * 8)) {
+		MEM_freeN(offsets_buf);
+		MEM_freeN(lr->offsets);
+		MEM_freeN(lr);
+		return NULL;
+	}
+	for (i = 0; i < chunks_len; i++) {
+		lr->offsets[i] = lzo_read_uint(offsets_buf + i * 8, 8);
+	}
+	MEM_freeN(offsets_buf);
+
+	lr->batch_num = BLI_system_thread_count();
+	lr->batch = lzo_chunks_alloc(lr->batch_num, BLEND_LZO_CHUNK_SIZE, BLEND_LZO_CHUNK_SIZE);
+
+	return lr;
+}
+
+/**
+ * \return The number of bytes read, less than \a buf_len at the end of the file or on error.
+ */
+size_t BLO_lzo_reader_read(BlendLZOReader *lr, void *buf, size_t buf_len)
+{
+	size_t totread = 0;
+
+	while (totread < buf_len) {
+		BlendLZOChunk *chunk;
+		size_t readsize;
+
+		if (lr->batch_index == lr->batch_len) {
+			const int chunk_next = lr->batch_first + lr->batch_len;
+			if ((chunk_next == lr->chunks_len) || !lzo_batch_load(lr, chunk_next)) {
+				break;
+			}
+		}
+
+		chunk = &lr->batch[lr->batch_index];
+		readsize = MIN2(buf_len - totread, chunk->out_len - lr->batch_offset);
+		memcpy((char *)buf + totread, chunk->out + lr->batch_offset, readsize);
+		totread += readsize;
+		lr->batch_offset += readsize;
+
+		if (lr->batch_offset == chunk->out_len) {
+			lr->batch_index++;
+			lr->batch_offset = 0;
+		}
+	}
+
+	return totread;
+}
+
+void BLO_lzo_reader_free(BlendLZOReader *lr)
+{
+	lzo_chunks_free(lr->batch, lr->batch_num);
+	MEM_SAFE_FREE(lr->offsets);
+	MEM_freeN(lr);
+}
+
+/** \} */
+
+#endif  /* WITH_LZO */
@@ -58,6 +58,7 @@
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
 #include "BLO_blend_defs.h"
+#include "BLO_fileindex.h"
 
 #include "readfile.h"
 
@@ -332,6 +333,15 @@ BlendFileData *BLO_read_from_file(
 		blo_freefiledata(fd);
 	}
 
+	if (bfd == NULL) {
+		/* point out damaged data-blocks when the file has an index */
+		BlendFileIndex *index = BLO_fileindex_read(filepath);
+		if (index) {
+			BLO_fileindex_verify(index, filepath, reports);
+			BLO_fileindex_free(index);
+		}
+	}
+
 	return bfd;
 }
 
@@ -45,6 +45,7 @@
 #include "BLI_utildefines.h"
 #ifndef WIN32
 #  include <unistd.h> // for read close
+#  include <sys/mman.h> // for mmap
 #else
 #  include <io.h> // for open close read
 #  include "winsock2.h"
@@ -109,16 +110,20 @@
 #include "BLI_math.h"
 #include "BLI_threads.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
+#include "BLI_trace.h"
 
 #include "BLT_translation.h"
 
 #include "BKE_action.h"
 #include "BKE_armature.h"
+#include "BKE_blender_version.h"
 #include "BKE_brush.h"
 #include "BKE_cachefile.h"
 #include "BKE_cloth.h"
 #include "BKE_constraint.h"
 #include "BKE_context.h"
+#include "BKE_customdata.h"
 #include "BKE_curve.h"
 #include "BKE_depsgraph.h"
 #include "BKE_effect.h"
@@ -155,11 +160,15 @@
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
 #include "BLO_blend_defs.h"
+#include "BLO_journalfile.h"
+#include "BLO_lzofile.h"
 
 #include "RE_engine.h"
 
 #include "readfile.h"
 
+#include "atomic_ops.h"
+
 
 #include <errno.h>
 
@@ -219,6 +228,21 @@
 /* Use GHash for restoring pointers by name */
 #define USE_GHASH_RESTORE_POINTER
 
+/* Memory map uncompressed files written with the same endianness and pointer size,
+ * blocks are then used in place instead of being read into a copy first.
+ * Blocks are only 4 byte aligned in the file, those not aligned for BHead are still copied. */
+#ifndef WIN32
+#  define USE_BHEAD_MMAP
+#endif
+
+/* Read and link the direct data of data-blocks which don't depend on any shared state
+ * from multiple threads, once all blocks of the file have been gone over. */
+#define USE_PARALLEL_DIRECT_LINK
+
+/* Only read the ID part of heavy meshes linked from libraries,
+ * their geometry is read on first use (see BLO_library_lazy_data_ensure). */
+#define USE_LAZY_LIBRARY_DATA
+
 /***/
 
 typedef struct OldNew {
@@ -230,8 +254,11 @@ typedef struct OldNew {
 typedef struct OldNewMap {
 	OldNew *entries;
 	int nentries, entriessize;
-	bool sorted;
 	int lasthit;
+	/* open addressing hash of the old address, storing indices into \a entries (-1 when unused),
+	 * with a load factor of at most a half so probe sequences stay short */
+	int *map;
+	int map_size_exp;
 } OldNewMap;
 
 
@@ -274,31 +301,60 @@ static const char *library_parent_filepath(Library *lib)
 	return lib->parent ? lib->parent->filepath : "<direct>";
 }
 
-static OldNewMap *oldnewmap_new(void) 
+#define OLDNEWMAP_SIZE_EXP_DEFAULT 10
+
+#define OLDNEWMAP_MAP_SIZE(onm) (1 << ((onm)->map_size_exp + 1))
+
+BLI_INLINE unsigned int oldnewmap_hash(const void *addr, const int bits)
 {
-	OldNewMap *onm= MEM_callocN(sizeof(*onm), "OldNewMap");
-	
-	onm->entriessize = 1024;
-	onm->entries = MEM_mallocN(sizeof(*onm->entries)*onm->entriessize, "OldNewMap.entries");
-	
-	return onm;
+	/* allocations are at least 8 byte aligned, mix the upper bits into the lower ones */
+	uintptr_t x = (uintptr_t)addr >> 3;
+	x ^= x >> 16;
+	/* multiplicative hashing, the high bits of the product depend on all bits of the key */
+	return ((unsigned int)x * 2654435761u) >> (32 - bits);
 }
 
-static int verg_oldnewmap(const void *v1, const void *v2)
+/**
+ * \return the slot of \a addr in the map, or the first unused slot of its probe sequence.
+ */
+BLI_INLINE unsigned int oldnewmap_lookup_slot(const OldNewMap *onm, const void *addr)
 {
-	const struct OldNew *x1=v1, *x2=v2;
-	
-	if (x1->old > x2->old) return 1;
-	else if (x1->old < x2->old) return -1;
-	return 0;
+	const unsigned int mask = (unsigned int)OLDNEWMAP_MAP_SIZE(onm) - 1;
+	unsigned int slot = oldnewmap_hash(addr, onm->map_size_exp + 1);
+	int index;
+
+	while ((index = onm->map[slot]) != -1) {
+		if (onm->entries[index].old == addr) {
+			break;
+		}
+		slot = (slot + 1) & mask;
+	}
+	return slot;
 }
 
+static void oldnewmap_map_rebuild(OldNewMap *onm)
+{
+	int i;
+
+	MEM_SAFE_FREE(onm->map);
+	onm->map = MEM_mallocN(sizeof(*onm->map) * (size_t)OLDNEWMAP_MAP_SIZE(onm), "OldNewMap.map");
+	memset(onm->map, -1, sizeof(*onm->map) * (size_t)OLDNEWMAP_MAP_SIZE(onm));
+
+	for (i = 0; i < onm->nentries; i++) {
+		onm->map[oldnewmap_lookup_slot(onm, onm->entries[i].old)] = i;
+	}
+}
 
-static void oldnewmap_sort(FileData *fd) 
+static OldNewMap *oldnewmap_new(void) 
 {
-	BLI_assert(fd->libmap->sorted == false);
-	qsort(fd->libmap->entries, fd->libmap->nentries, sizeof(OldNew), verg_oldnewmap);
-	fd->libmap->sorted = 1;
+	OldNewMap *onm= MEM_callocN(sizeof(*onm), "OldNewMap");
+	
+	onm->map_size_exp = OLDNEWMAP_SIZE_EXP_DEFAULT;
+	onm->entriessize = 1 << onm->map_size_exp;
+	onm->entries = MEM_mallocN(sizeof(*onm->entries)*onm->entriessize, "OldNewMap.entries");
+	oldnewmap_map_rebuild(onm);
+	
+	return onm;
 }
 
 /* nr is zero for data, and ID code for libdata */
@@ -311,8 +367,13 @@ static void oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr,
 	if (UNLIKELY(onm->nentries == onm->entriessize)) {
 		onm->entriessize *= 2;
 		onm->entries = MEM_reallocN(onm->entries, sizeof(*onm->entries) * onm->entriessize);
+		onm->map_size_exp++;
+		oldnewmap_map_rebuild(onm);
 	}
 
+	/* when an address is inserted twice, lookups find the last one */
+	onm->map[oldnewmap_lookup_slot(onm, oldaddr)] = onm->nentries;
+
 	entry = &onm->entries[onm->nentries++];
 	entry->old = oldaddr;
 	entry->newp = newaddr;
@@ -325,53 +386,11 @@ void blo_do_versions_oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void
 }
 
 /**
- * Do a full search (no state).
- *
- * \param lasthit: Use as a reference position to avoid a full search
- * from either end of the array, giving more efficient lookups.
- *
- * \note This would seem an ideal case for hash or btree lookups.
- * However the data is written in-order, using the \a lasthit will normally avoid calling this function.
- * Creating a btree/hash structure adds overhead for the common-case to optimize the corner-case
- * (since most entries will never be retrieved).
- * So just keep full lookups as a fall-back.
+ * \return the index of the entry for \a addr, or -1.
  */
-static int oldnewmap_lookup_entry_full(const OldNewMap *onm, const void *addr, int lasthit)
+static int oldnewmap_lookup_entry(const OldNewMap *onm, const void *addr)
 {
-	const int nentries = onm->nentries;
-	const OldNew *entries = onm->entries;
-	int i;
-
-	/* search relative to lasthit where possible */
-	if (lasthit >= 0 && lasthit < nentries) {
-
-		/* search forwards */
-		i = lasthit;
-		while (++i != nentries) {
-			if (entries[i].old == addr) {
-				return i;
-			}
-		}
-
-		/* search backwards */
-		i = lasthit + 1;
-		while (i--) {
-			if (entries[i].old == addr) {
-				return i;
-			}
-		}
-	}
-	else {
-		/* search backwards (full) */
-		i = nentries;
-		while (i--) {
-			if (entries[i].old == addr) {
-				return i;
-			}
-		}
-	}
-
-	return -1;
+	return onm->map[oldnewmap_lookup_slot(onm, addr)];
 }
 
 static void *oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool increase_users)
@@ -380,6 +399,7 @@ static void *oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool inc
 	
 	if (addr == NULL) return NULL;
 	
+	/* data is written in-order, so the next entry is the common case and avoids hashing */
 	if (onm->lasthit < onm->nentries-1) {
 		OldNew *entry = &onm->entries[++onm->lasthit];
 		
@@ -390,7 +410,7 @@ static void *oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool inc
 		}
 	}
 	
-	i = oldnewmap_lookup_entry_full(onm, addr, onm->lasthit);
+	i = oldnewmap_lookup_entry(onm, addr);
 	if (i != -1) {
 		OldNew *entry = &onm->entries[i];
 		BLI_assert(entry->old == addr);
@@ -410,21 +430,10 @@ static void *oldnewmap_liblookup(OldNewMap *onm, const void *addr, const void *l
 		return NULL;
 	}
 
-	/* lasthit works fine for non-libdata, linking there is done in same sequence as writing */
-	if (onm->sorted) {
-		const OldNew entry_s = {.old = addr};
-		OldNew *entry = bsearch(&entry_s, onm->entries, onm->nentries, sizeof(OldNew), verg_oldnewmap);
-		if (entry) {
-			ID *id = entry->newp;
-
-			if (id && (!lib || id->lib)) {
-				return id;
-			}
-		}
-	}
-	else {
-		/* note, this can be a bottle neck when loading some files */
-		const int i = oldnewmap_lookup_entry_full(onm, addr, -1);
+	/* lasthit works fine for non-libdata, linking there is done in same sequence as writing,
+	 * libdata is looked up in any order so always use the hash */
+	{
+		const int i = oldnewmap_lookup_entry(onm, addr);
 		if (i != -1) {
 			OldNew *entry = &onm->entries[i];
 			ID *id = entry->newp;
@@ -453,6 +462,24 @@ static void oldnewmap_free_unused(OldNewMap *onm)
 
 static void oldnewmap_clear(OldNewMap *onm) 
 {
+	int i;
+
+	/* The map is cleared for every data-block read, only reset the used slots when there are few.
+	 * Slots can't be reset while looking them up: an address inserted twice shares its slot, so
+	 * entries probing past it would not be found anymore. Find all slots first (stored in the
+	 * user count, entries aren't used after clearing), then reset them. */
+	if ((onm->nentries * 8) < OLDNEWMAP_MAP_SIZE(onm)) {
+		for (i = 0; i < onm->nentries; i++) {
+			onm->entries[i].nr = (int)oldnewmap_lookup_slot(onm, onm->entries[i].old);
+		}
+		for (i = 0; i < onm->nentries; i++) {
+			onm->map[onm->entries[i].nr] = -1;
+		}
+	}
+	else {
+		memset(onm->map, -1, sizeof(*onm->map) * (size_t)OLDNEWMAP_MAP_SIZE(onm));
+	}
+
 	onm->nentries = 0;
 	onm->lasthit = 0;
 }
@@ -460,9 +487,45 @@ static void oldnewmap_clear(OldNewMap *onm)
 static void oldnewmap_free(OldNewMap *onm) 
 {
 	MEM_freeN(onm->entries);
+	MEM_freeN(onm->map);
 	MEM_freeN(onm);
 }
 
+/* only used by tests */
+OldNewMap *blo_oldnewmap_new(void)
+{
+	return oldnewmap_new();
+}
+
+/* only the hash, without the sequential lookup of oldnewmap_lookup_and_inc() */
+void *blo_oldnewmap_lookup(OldNewMap *onm, const void *addr)
+{
+	const int i = oldnewmap_lookup_entry(onm, addr);
+	return (i != -1) ? onm->entries[i].newp : NULL;
+}
+
+void blo_oldnewmap_clear(OldNewMap *onm)
+{
+	oldnewmap_clear(onm);
+}
+
+int blo_oldnewmap_map_used(const OldNewMap *onm)
+{
+	int i, used = 0;
+
+	for (i = 0; i < OLDNEWMAP_MAP_SIZE(onm); i++) {
+		if (onm->map[i] != -1) {
+			used++;
+		}
+	}
+	return used;
+}
+
+void blo_oldnewmap_free(OldNewMap *onm)
+{
+	oldnewmap_free(onm);
+}
+
 /***/
 
 static void read_libraries(FileData *basefd, ListBase *mainlist);
@@ -800,6 +863,10 @@ static BHeadN *get_bhead(FileData *fd)
 						MEM_freeN(new_bhead);
 						new_bhead = NULL;
 					}
+					else if (bhead.code == ENDB) {
+						/* nothing is read past the last block */
+						fd->eof = 1;
+					}
 				}
 				else {
 					fd->eof = 1;
@@ -818,11 +885,128 @@ static BHeadN *get_bhead(FileData *fd)
 	return(new_bhead);
 }
 
+#ifdef USE_BHEAD_MMAP
+
+/**
+ * Block at \a offset in the mapped file,
+ * NULL past the end of the file or when the block is truncated.
+ *
+ * Blocks aligned for #BHead (its pointer) are used in place. The others are copied together with
+ * their data once, so the same block is returned every time. Copies are made while going over the
+ * blocks the first time, which happens before the parallel direct linking only looks them up.
+ */
+static BHead *mmap_bhead_at(FileData *fd, size_t offset)
+{
+	BHeadN *new_bhead;
+	BHead bhead;
+
+	if (offset + sizeof(BHead) > fd->mmap_size) {
+		return NULL;
+	}
+
+	if ((offset % sizeof(void *)) == 0) {
+		BHead *bhead_map = (BHead *)(fd->mmap_data + offset);
+
+		/* make sure people are not trying to pass bad blend files */
+		if (bhead_map->len < 0 || offset + sizeof(BHead) + (size_t)bhead_map->len > fd->mmap_size) {
+			return NULL;
+		}
+		return bhead_map;
+	}
+
+	if (fd->mmap_bheads_copied == NULL) {
+		fd->mmap_bheads_copied = BLI_ghash_ptr_new(__func__);
+	}
+	else if ((new_bhead = BLI_ghash_lookup(fd->mmap_bheads_copied, (void *)(uintptr_t)offset))) {
+		return &new_bhead->bhead;
+	}
+
+	memcpy(&bhead, fd->mmap_data + offset, sizeof(bhead));
+	if (bhead.len < 0 || offset + sizeof(BHead) + (size_t)bhead.len > fd->mmap_size) {
+		return NULL;
+	}
+
+	new_bhead = MEM_mallocN(sizeof(BHeadN) + (size_t)bhead.len, "new_bhead");
+	new_bhead->next = new_bhead->prev = NULL;
+	new_bhead->file_offset = offset;
+	new_bhead->bhead = bhead;
+	memcpy(new_bhead + 1, fd->mmap_data + offset + sizeof(BHead), (size_t)bhead.len);
+	BLI_ghash_insert(fd->mmap_bheads_copied, (void *)(uintptr_t)offset, new_bhead);
+
+	return &new_bhead->bhead;
+}
+
+/* offset of the block in the mapped file, also for copied blocks */
+static size_t mmap_bhead_offset(const FileData *fd, const BHead *bhead)
+{
+	if (((const char *)bhead >= fd->mmap_data) && ((const char *)bhead < fd->mmap_data + fd->mmap_size)) {
+		return (size_t)((const char *)bhead - fd->mmap_data);
+	}
+	return ((const BHeadN *)POINTER_OFFSET(bhead, -offsetof(BHeadN, bhead)))->file_offset;
+}
+
+static void mmap_bheads_ensure(FileData *fd)
+{
+	BHead *bhead;
+	int i = 0;
+
+	if (fd->mmap_bheads) {
+		return;
+	}
+
+	for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
+		i++;
+	}
+
+	fd->mmap_bheads = MEM_mallocN(sizeof(*fd->mmap_bheads) * (size_t)max_ii(i, 1), __func__);
+	fd->mmap_bheads_len = i;
+
+	i = 0;
+	for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
+		fd->mmap_bheads[i++] = bhead;
+	}
+}
+
+static BHead *mmap_prevbhead(FileData *fd, BHead *thisblock)
+{
+	const size_t offset = mmap_bhead_offset(fd, thisblock);
+	int low = 0, high;
+
+	mmap_bheads_ensure(fd);
+
+	/* blocks are in file order */
+	high = fd->mmap_bheads_len - 1;
+	while (low <= high) {
+		const int mid = (low + high) / 2;
+		const size_t mid_offset = mmap_bhead_offset(fd, fd->mmap_bheads[mid]);
+		if (mid_offset < offset) {
+			low = mid + 1;
+		}
+		else if (mid_offset > offset) {
+			high = mid - 1;
+		}
+		else {
+			return (mid > 0) ? fd->mmap_bheads[mid - 1] : NULL;
+		}
+	}
+
+	BLI_assert(0);
+	return NULL;
+}
+
+#endif  /* USE_BHEAD_MMAP */
+
 BHead *blo_firstbhead(FileData *fd)
 {
 	BHeadN *new_bhead;
 	BHead *bhead = NULL;
 	
+#ifdef USE_BHEAD_MMAP
+	if (fd->flags & FD_FLAGS_USE_MMAP) {
+		return mmap_bhead_at(fd, SIZEOFBLENDERHEADER);
+	}
+#endif
+
 	/* Rewind the file
 	 * Read in a new block if necessary
 	 */
@@ -838,10 +1022,20 @@ BHead *blo_firstbhead(FileData *fd)
 	return(bhead);
 }
 
-BHead *blo_prevbhead(FileData *UNUSED(fd), BHead *thisblock)
+BHead *blo_prevbhead(FileData *fd, BHead *thisblock)
 {
-	BHeadN *bheadn = (BHeadN *)POINTER_OFFSET(thisblock, -offsetof(BHeadN, bhead));
-	BHeadN *prev = bheadn->prev;
+	BHeadN *bheadn, *prev;
+
+#ifdef USE_BHEAD_MMAP
+	if (fd->flags & FD_FLAGS_USE_MMAP) {
+		return mmap_prevbhead(fd, thisblock);
+	}
+#else
+	UNUSED_VARS(fd);
+#endif
+
+	bheadn = (BHeadN *)POINTER_OFFSET(thisblock, -offsetof(BHeadN, bhead));
+	prev = bheadn->prev;
 	
 	return (prev) ? &prev->bhead : NULL;
 }
@@ -851,6 +1045,16 @@ BHead *blo_nextbhead(FileData *fd, BHead *thisblock)
 	BHeadN *new_bhead = NULL;
 	BHead *bhead = NULL;
 	
+#ifdef USE_BHEAD_MMAP
+	if (fd->flags & FD_FLAGS_USE_MMAP) {
+		if (thisblock && thisblock->code != ENDB) {
+			/* data directly follows the block header in the file */
+			return mmap_bhead_at(fd, mmap_bhead_offset(fd, thisblock) + sizeof(BHead) + (size_t)thisblock->len);
+		}
+		return NULL;
+	}
+#endif
+
 	if (thisblock) {
 		/* bhead is actually a sub part of BHeadN
 		 * We calculate the BHeadN pointer from the BHead pointer below */
@@ -932,6 +1136,7 @@ static bool read_file_dna(FileData *fd, const char **r_error_message)
 			fd->filesdna = DNA_sdna_from_data(&bhead[1], bhead->len, do_endian_swap, true, r_error_message);
 			if (fd->filesdna) {
 				fd->compflags = DNA_struct_get_compareflags(fd->filesdna, fd->memsdna);
+				fd->reconstruct_info = DNA_reconstruct_info_create(fd->filesdna, fd->memsdna, fd->compflags);
 				/* used to retrieve ID names from (bhead+1) */
 				fd->id_name_offs = DNA_elem_offset(fd->filesdna, "ID", "char", "name[]");
 
@@ -1122,11 +1327,259 @@ static FileData *blo_decode_and_check(FileData *fd, ReportList *reports)
 	return fd;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Chunked LZO Files
+ *
+ * Reading is done by BLO_lzofile.h, see #BLEND_LZO_MAGIC for the layout.
+ * \{ */
+
+#ifdef WITH_LZO
+
+static int fd_read_lzo_from_file(FileData *filedata, void *buffer, unsigned int size)
+{
+	const unsigned int totread = (unsigned int)BLO_lzo_reader_read(filedata->lzo, buffer, size);
+
+	filedata->seek += totread;
+
+	return totread;
+}
+
+#endif  /* WITH_LZO */
+
+/**
+ * Open chunked LZO files, \a r_is_lzo is set when the file is one,
+ * even when it couldn't be read.
+ */
+static FileData *blo_openblenderfile_lzo_check(const char *filepath, ReportList *reports, bool *r_is_lzo)
+{
+	FileData *fd = NULL;
+	int file;
+
+	*r_is_lzo = false;
+
+	file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+	if (file == -1) {
+		return NULL;
+	}
+
+	if (!BLO_lzo_is_file(file)) {
+		close(file);
+		return NULL;
+	}
+
+	*r_is_lzo = true;
+
+#ifdef WITH_LZO
+	{
+		BlendLZOReader *lzo = BLO_lzo_reader_open(file);
+		if (lzo) {
+			fd = filedata_new();
+			fd->filedes = file;
+			fd->lzo = lzo;
+			fd->read = fd_read_lzo_from_file;
+		}
+	}
+	if (fd == NULL) {
+		BKE_reportf(reports, RPT_ERROR, "Failed to read blend file '%s', compressed data is corrupt", filepath);
+	}
+#else
+	BKE_reportf(reports, RPT_ERROR, "Failed to read blend file '%s', built without LZO support", filepath);
+#endif
+
+	if (fd == NULL) {
+		close(file);
+	}
+
+	return fd;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Journal Files
+ *
+ * Read the latest save of a journal, see BLO_journalfile.h.
+ * \{ */
+
+static int fd_read_journal_from_file(FileData *filedata, void *buffer, unsigned int size)
+{
+	unsigned int totread = 0;
+
+	while ((totread < size) && (filedata->journal_chunk_index < filedata->journal_chunks_len)) {
+		const BlendJournalChunk *chunk = &filedata->journal_chunks[filedata->journal_chunk_index];
+		const uint64_t offset = chunk->offset + filedata->journal_chunk_offset;
+		const unsigned int readsize = MIN2(size - totread, chunk->size - filedata->journal_chunk_offset);
+
+		if ((lseek(filedata->filedes, (off_t)offset, SEEK_SET) != (off_t)offset) ||
+		    (read(filedata->filedes, (char *)buffer + totread, readsize) != (ssize_t)readsize))
+		{
+			break;
+		}
+
+		totread += readsize;
+		filedata->journal_chunk_offset += readsize;
+		if (filedata->journal_chunk_offset == chunk->size) {
+			filedata->journal_chunk_index++;
+			filedata->journal_chunk_offset = 0;
+		}
+	}
+
+	filedata->seek += totread;
+
+	return totread;
+}
+
+/**
+ * Open journals, \a r_is_journal is set when the file is one, even when it couldn't be read.
+ */
+static FileData *blo_openblenderfile_journal_check(const char *filepath, ReportList *reports, bool *r_is_journal)
+{
+	BlendJournalChunk *chunks;
+	FileData *fd;
+	int file, chunks_len;
+	uint64_t size;
+
+	*r_is_journal = false;
+
+	file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+	if (file == -1) {
+		return NULL;
+	}
+
+	if (!BLO_journal_is_journal(file)) {
+		close(file);
+		return NULL;
+	}
+
+	*r_is_journal = true;
+
+	chunks = BLO_journal_snapshot_read(file, &chunks_len, &size);
+	if (chunks == NULL) {
+		BKE_reportf(reports, RPT_ERROR, "Failed to read blend file '%s', journal is corrupt", filepath);
+		close(file);
+		return NULL;
+	}
+
+	fd = filedata_new();
+	fd->filedes = file;
+	fd->journal_chunks = chunks;
+	fd->journal_chunks_len = chunks_len;
+	fd->read = fd_read_journal_from_file;
+
+	return fd;
+}
+
+/**
+ * Open files stored in one of the formats above,
+ * \a r_is_container is set when the file is one, even when it couldn't be read.
+ */
+static FileData *blo_openblenderfile_container(const char *filepath, ReportList *reports, bool *r_is_container)
+{
+	FileData *fd = blo_openblenderfile_lzo_check(filepath, reports, r_is_container);
+
+	if (*r_is_container == false) {
+		fd = blo_openblenderfile_journal_check(filepath, reports, r_is_container);
+	}
+
+	return fd;
+}
+
+/** \} */
+
+#ifdef USE_BHEAD_MMAP
+/**
+ * Map the file when its blocks can be used as they are,
+ * returns NULL when the regular reading code should be used instead (compressed files,
+ * different endianness or pointer size, mapping failure).
+ */
+static FileData *blo_openblenderfile_mmap(const char *filepath)
+{
+	FileData *fd;
+	char *data;
+	size_t size;
+	int file;
+
+	file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+	if (file == -1) {
+		return NULL;
+	}
+
+	size = BLI_file_descriptor_size(file);
+	if (size == (size_t)-1 || size < SIZEOFBLENDERHEADER + sizeof(BHead)) {
+		close(file);
+		return NULL;
+	}
+
+	/* private mapping, the few blocks patched in place (see ID_SCRN) are copied on write */
+	data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+	close(file);
+
+	if (data == MAP_FAILED) {
+		return NULL;
+	}
+
+	fd = filedata_new();
+	fd->mmap_data = data;
+	fd->mmap_size = size;
+
+	/* header is read through the memory reader */
+	fd->buffer = data;
+	fd->buffersize = SIZEOFBLENDERHEADER;
+	fd->read = fd_read_from_memory;
+	fd->flags |= FD_FLAGS_NOT_MY_BUFFER;
+
+	decode_blender_header(fd);
+
+	/* gzip files fail here as well */
+	if (!(fd->flags & FD_FLAGS_FILE_OK) ||
+	    (fd->flags & (FD_FLAGS_SWITCH_ENDIAN | FD_FLAGS_POINTSIZE_DIFFERS)))
+	{
+		blo_freefiledata(fd);
+		return NULL;
+	}
+
+	fd->flags |= FD_FLAGS_USE_MMAP;
+	fd->seek = 0;
+
+	/* all of the file gets read anyway, start reading ahead */
+	madvise(data, size, MADV_WILLNEED);
+
+	return fd;
+}
+#endif  /* USE_BHEAD_MMAP */
+
 /* cannot be called with relative paths anymore! */
 /* on each new library added, it now checks for the current FileData and expands relativeness */
 FileData *blo_openblenderfile(const char *filepath, ReportList *reports)
 {
 	gzFile gzfile;
+
+#ifdef USE_BHEAD_MMAP
+	{
+		FileData *fd = blo_openblenderfile_mmap(filepath);
+		if (fd) {
+			/* needed for library_append and read_libraries */
+			BLI_strncpy(fd->relabase, filepath, sizeof(fd->relabase));
+
+			return blo_decode_and_check(fd, reports);
+		}
+	}
+#endif
+
+	{
+		bool is_container;
+		FileData *fd = blo_openblenderfile_container(filepath, reports, &is_container);
+		if (is_container) {
+			if (fd) {
+				/* needed for library_append and read_libraries */
+				BLI_strncpy(fd->relabase, filepath, sizeof(fd->relabase));
+
+				fd = blo_decode_and_check(fd, reports);
+			}
+			return fd;
+		}
+	}
+
 	errno = 0;
 	gzfile = BLI_gzopen(filepath, "rb");
 	
@@ -1154,6 +1607,22 @@ FileData *blo_openblenderfile(const char *filepath, ReportList *reports)
 static FileData *blo_openblenderfile_minimal(const char *filepath)
 {
 	gzFile gzfile;
+	bool is_container;
+	FileData *fd_container = blo_openblenderfile_container(filepath, NULL, &is_container);
+
+	if (is_container) {
+		if (fd_container) {
+			decode_blender_header(fd_container);
+
+			if (fd_container->flags & FD_FLAGS_FILE_OK) {
+				return fd_container;
+			}
+
+			blo_freefiledata(fd_container);
+		}
+		return NULL;
+	}
+
 	errno = 0;
 	gzfile = BLI_gzopen(filepath, "rb");
 
@@ -1271,6 +1740,16 @@ void blo_freefiledata(FileData *fd)
 		if (fd->gzfiledes != NULL) {
 			gzclose(fd->gzfiledes);
 		}
+
+#ifdef WITH_LZO
+		if (fd->lzo) {
+			BLO_lzo_reader_free(fd->lzo);
+		}
+#endif
+
+		if (fd->journal_chunks) {
+			MEM_freeN(fd->journal_chunks);
+		}
 		
 		if (fd->strm.next_in) {
 			if (inflateEnd(&fd->strm) != Z_OK) {
@@ -1282,12 +1761,26 @@ void blo_freefiledata(FileData *fd)
 			MEM_freeN((void *)fd->buffer);
 			fd->buffer = NULL;
 		}
+
+#ifdef USE_BHEAD_MMAP
+		if (fd->mmap_data) {
+			munmap((void *)fd->mmap_data, fd->mmap_size);
+		}
+		if (fd->mmap_bheads) {
+			MEM_freeN(fd->mmap_bheads);
+		}
+		if (fd->mmap_bheads_copied) {
+			BLI_ghash_free(fd->mmap_bheads_copied, NULL, MEM_freeN);
+		}
+#endif
 		
 		// Free all BHeadN data blocks
 		BLI_freelistN(&fd->listbase);
 
 		if (fd->filesdna)
 			DNA_sdna_free(fd->filesdna);
+		if (fd->reconstruct_info)
+			DNA_reconstruct_info_free(fd->reconstruct_info);
 		if (fd->compflags)
 			MEM_freeN((void *)fd->compflags);
 		
@@ -1541,9 +2034,6 @@ static void change_idid_adr_fd(FileData *fd, const void *old, void *new)
 {
 	int i;
 	
-	/* use a binary search if we have a sorted libmap, for now it's not needed. */
-	BLI_assert(fd->libmap->sorted == false);
-
 	for (i = 0; i < fd->libmap->nentries; i++) {
 		OldNew *entry = &fd->libmap->entries[i];
 		
@@ -1885,7 +2375,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 		
 		if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
 			if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
-				temp = DNA_struct_reconstruct(fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, (bh+1));
+				temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh+1));
 			}
 			else {
 				/* SDNA_CMP_EQUAL */
@@ -2514,6 +3004,7 @@ static void direct_link_fcurves(FileData *fd, ListBase *list)
 			
 			/* compiled expression data will need to be regenerated (old pointer may still be set here) */
 			driver->expr_comp = NULL;
+			driver->expr_simple = NULL;
 			
 			/* give the driver a fresh chance - the operating environment may be different now 
 			 * (addons, etc. may be different) so the driver namespace may be sane now [#32155]
@@ -2744,6 +3235,8 @@ static void direct_link_animdata(FileData *fd, AnimData *adt)
 	//		state, but it's going to be too hard to enforce this single case...
 	adt->act_track = newdataadr(fd, adt->act_track);
 	adt->actstrip = newdataadr(fd, adt->actstrip);
+
+	adt->eval_cache = NULL;
 }	
 
 /* ************ READ CACHEFILES *************** */
@@ -4696,6 +5189,56 @@ static void direct_link_mesh(FileData *fd, Mesh *mesh)
 	}
 }
 
+#ifdef USE_LAZY_LIBRARY_DATA
+
+/* Meshes smaller than this are read right away, deferring them isn't worth a second file access. */
+#define LAZY_DATA_MESH_TOTVERT_MIN 4096
+
+static void mesh_geometry_clear(Mesh *mesh)
+{
+	mesh->mvert = NULL;
+	mesh->medge = NULL;
+	mesh->mface = NULL;
+	mesh->mloop = NULL;
+	mesh->mpoly = NULL;
+	mesh->tface = NULL;
+	mesh->mtface = NULL;
+	mesh->mcol = NULL;
+	mesh->dvert = NULL;
+	mesh->mloopcol = NULL;
+	mesh->mloopuv = NULL;
+	mesh->mtpoly = NULL;
+	mesh->mselect = NULL;
+
+	CustomData_reset(&mesh->vdata);
+	CustomData_reset(&mesh->edata);
+	CustomData_reset(&mesh->fdata);
+	CustomData_reset(&mesh->ldata);
+	CustomData_reset(&mesh->pdata);
+
+	mesh->totvert = mesh->totedge = mesh->totface = mesh->totloop = mesh->totpoly = 0;
+	mesh->totselect = 0;
+}
+
+/* Like direct_link_mesh(), for a mesh whose geometry blocks have been skipped. */
+static void direct_link_mesh_lazy(FileData *fd, Mesh *mesh)
+{
+	mesh->mat = newdataadr(fd, mesh->mat);
+	test_pointer_array(fd, (void **)&mesh->mat);
+
+	/* Never deferred, see read_libblock_is_lazy(). */
+	BLI_assert(mesh->adt == NULL && mesh->mr == NULL);
+	mesh->adt = NULL;
+	mesh->mr = NULL;
+
+	mesh_geometry_clear(mesh);
+
+	mesh->bb = NULL;
+	mesh->edit_btmesh = NULL;
+}
+
+#endif  /* USE_LAZY_LIBRARY_DATA */
+
 /* ************ READ LATTICE ***************** */
 
 static void lib_link_latt(FileData *fd, Main *main)
@@ -8089,37 +8632,320 @@ static const char *dataname(short id_code)
 		case ID_LS: return "Data from LS";
 		case ID_CF: return "Data from CF";
 	}
-	return "Data from Lib Block";
-	
+	return "Data from Lib Block";
+	
+}
+
+static BHead *read_data_into_oldnewmap(FileData *fd, BHead *bhead, const char *allocname)
+{
+	bhead = blo_nextbhead(fd, bhead);
+	
+	while (bhead && bhead->code==DATA) {
+		void *data;
+#if 0
+		/* XXX DUMB DEBUGGING OPTION TO GIVE NAMES for guarded malloc errors */
+		short *sp = fd->filesdna->structs[bhead->SDNAnr];
+		char *tmp = malloc(100);
+		allocname = fd->filesdna->types[ sp[0] ];
+		strcpy(tmp, allocname);
+		data = read_struct(fd, bhead, tmp);
+#else
+		data = read_struct(fd, bhead, allocname);
+#endif
+		
+		if (data) {
+			oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+		}
+		
+		bhead = blo_nextbhead(fd, bhead);
+	}
+	
+	return bhead;
+}
+
+/**
+ * Link the direct data of \a id, which has been read into fd->datamap.
+ * \return true when the ID turned out to be invalid and should be freed.
+ */
+static bool direct_link_libblock(FileData *fd, Main *main, ID *id)
+{
+	bool wrong_id = false;
+
+	/* init pointers direct data */
+	direct_link_id(fd, id);
+	
+	switch (GS(id->name)) {
+		case ID_WM:
+			direct_link_windowmanager(fd, (wmWindowManager *)id);
+			break;
+		case ID_SCR:
+			wrong_id = direct_link_screen(fd, (bScreen *)id);
+			break;
+		case ID_SCE:
+			direct_link_scene(fd, (Scene *)id);
+			break;
+		case ID_OB:
+			direct_link_object(fd, (Object *)id);
+			break;
+		case ID_ME:
+			direct_link_mesh(fd, (Mesh *)id);
+			break;
+		case ID_CU:
+			direct_link_curve(fd, (Curve *)id);
+			break;
+		case ID_MB:
+			direct_link_mball(fd, (MetaBall *)id);
+			break;
+		case ID_MA:
+			direct_link_material(fd, (Material *)id);
+			break;
+		case ID_TE:
+			direct_link_texture(fd, (Tex *)id);
+			break;
+		case ID_IM:
+			direct_link_image(fd, (Image *)id);
+			break;
+		case ID_LA:
+			direct_link_lamp(fd, (Lamp *)id);
+			break;
+		case ID_VF:
+			direct_link_vfont(fd, (VFont *)id);
+			break;
+		case ID_TXT:
+			direct_link_text(fd, (Text *)id);
+			break;
+		case ID_IP:
+			direct_link_ipo(fd, (Ipo *)id);
+			break;
+		case ID_KE:
+			direct_link_key(fd, (Key *)id);
+			break;
+		case ID_LT:
+			direct_link_latt(fd, (Lattice *)id);
+			break;
+		case ID_WO:
+			direct_link_world(fd, (World *)id);
+			break;
+		case ID_LI:
+			direct_link_library(fd, (Library *)id, main);
+			break;
+		case ID_CA:
+			direct_link_camera(fd, (Camera *)id);
+			break;
+		case ID_SPK:
+			direct_link_speaker(fd, (Speaker *)id);
+			break;
+		case ID_SO:
+			direct_link_sound(fd, (bSound *)id);
+			break;
+		case ID_GR:
+			direct_link_group(fd, (Group *)id);
+			break;
+		case ID_AR:
+			direct_link_armature(fd, (bArmature*)id);
+			break;
+		case ID_AC:
+			direct_link_action(fd, (bAction*)id);
+			break;
+		case ID_NT:
+			direct_link_nodetree(fd, (bNodeTree*)id);
+			break;
+		case ID_BR:
+			direct_link_brush(fd, (Brush*)id);
+			break;
+		case ID_PA:
+			direct_link_particlesettings(fd, (ParticleSettings*)id);
+			break;
+		case ID_GD:
+			direct_link_gpencil(fd, (bGPdata *)id);
+			break;
+		case ID_MC:
+			direct_link_movieclip(fd, (MovieClip *)id);
+			break;
+		case ID_MSK:
+			direct_link_mask(fd, (Mask *)id);
+			break;
+		case ID_LS:
+			direct_link_linestyle(fd, (FreestyleLineStyle *)id);
+			break;
+		case ID_PAL:
+			direct_link_palette(fd, (Palette *)id);
+			break;
+		case ID_PC:
+			direct_link_paint_curve(fd, (PaintCurve *)id);
+			break;
+		case ID_CF:
+			direct_link_cachefile(fd, (CacheFile *)id);
+			break;
+	}
+
+	return wrong_id;
+}
+
+#ifdef USE_PARALLEL_DIRECT_LINK
+
+typedef struct DirectLinkTask {
+	Main *main;
+	ID *id;
+	BHead *bhead;  /* first DATA block of the ID */
+	int bhead_len;
+} DirectLinkTask;
+
+typedef struct DirectLinkTasks {
+	DirectLinkTask *tasks;
+	int tasks_len, tasks_alloc;
+} DirectLinkTasks;
+
+/**
+ * ID types whose direct_link function only touches the ID and its own data
+ * (no global maps, reports or other IDs), so it can run in a thread.
+ */
+static bool direct_link_libblock_is_threadsafe(const short idcode)
+{
+	return ELEM(idcode, ID_ME, ID_CU, ID_MB, ID_LT, ID_KE, ID_AC, ID_CF);
+}
+
+/**
+ * Defer reading the direct data of \a id, only the blocks are counted here.
+ * \return the block following the ID's data.
+ */
+static BHead *direct_link_task_add(FileData *fd, Main *main, ID *id, BHead *bhead)
+{
+	DirectLinkTasks *tasks = fd->direct_link_tasks;
+	DirectLinkTask *task;
+
+	if (tasks->tasks_len == tasks->tasks_alloc) {
+		tasks->tasks_alloc = max_ii(64, tasks->tasks_alloc * 2);
+		tasks->tasks = MEM_reallocN(tasks->tasks, sizeof(*tasks->tasks) * (size_t)tasks->tasks_alloc);
+	}
+
+	task = &tasks->tasks[tasks->tasks_len++];
+	task->main = main;
+	task->id = id;
+	task->bhead = NULL;
+	task->bhead_len = 0;
+
+	for (bhead = blo_nextbhead(fd, bhead); bhead && bhead->code == DATA; bhead = blo_nextbhead(fd, bhead)) {
+		if (task->bhead == NULL) {
+			task->bhead = bhead;
+		}
+		task->bhead_len++;
+	}
+
+	return bhead;
+}
+
+static void direct_link_task_run(void *userdata, int index)
+{
+	FileData *fd = userdata;
+	const DirectLinkTask *task = &fd->direct_link_tasks->tasks[index];
+	const char *allocname = dataname(GS(task->id->name));
+	BHead *bhead = task->bhead;
+	FileData fd_task;
+	bool wrong_id;
+	int i;
+
+	/* own map of direct data, everything else is only read */
+	fd_task = *fd;
+	fd_task.datamap = oldnewmap_new();
+
+	/* all blocks have been read already, so getting the next one doesn't touch the file */
+	for (i = 0; i < task->bhead_len; i++) {
+		void *data = read_struct(&fd_task, bhead, allocname);
+		if (data) {
+			oldnewmap_insert(fd_task.datamap, bhead->old, data, 0);
+		}
+		if (i + 1 < task->bhead_len) {
+			bhead = blo_nextbhead(&fd_task, bhead);
+		}
+	}
+
+	wrong_id = direct_link_libblock(&fd_task, task->main, task->id);
+	/* none of the threadsafe types can be invalid */
+	BLI_assert(wrong_id == false);
+	UNUSED_VARS_NDEBUG(wrong_id);
+
+	oldnewmap_free_unused(fd_task.datamap);
+	oldnewmap_free(fd_task.datamap);
 }
 
-static BHead *read_data_into_oldnewmap(FileData *fd, BHead *bhead, const char *allocname)
+static void direct_link_tasks_run(FileData *fd)
 {
-	bhead = blo_nextbhead(fd, bhead);
-	
-	while (bhead && bhead->code==DATA) {
-		void *data;
-#if 0
-		/* XXX DUMB DEBUGGING OPTION TO GIVE NAMES for guarded malloc errors */
-		short *sp = fd->filesdna->structs[bhead->SDNAnr];
-		char *tmp = malloc(100);
-		allocname = fd->filesdna->types[ sp[0] ];
-		strcpy(tmp, allocname);
-		data = read_struct(fd, bhead, tmp);
-#else
-		data = read_struct(fd, bhead, allocname);
-#endif
-		
-		if (data) {
-			oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+	DirectLinkTasks *tasks = fd->direct_link_tasks;
+
+	BLI_trace_zone_begin("Direct link");
+	BLI_task_parallel_range(0, tasks->tasks_len, fd, direct_link_task_run, tasks->tasks_len > 1);
+	BLI_trace_zone_end();
+
+	MEM_SAFE_FREE(tasks->tasks);
+	tasks->tasks_len = tasks->tasks_alloc = 0;
+}
+
+#endif  /* USE_PARALLEL_DIRECT_LINK */
+
+#ifdef USE_LAZY_LIBRARY_DATA
+
+/**
+ * Only meshes from files which need no versioning are deferred, since do_versions() can't run
+ * on their geometry later. Animation data and legacy multires are linked with the rest of the ID.
+ */
+static bool read_libblock_is_lazy(FileData *fd, Main *main, BHead *bhead, ID *id)
+{
+	const Mesh *me = (const Mesh *)id;
+
+	if (bhead->code != ID_ME || main->curlib == NULL || main->curlib->packedfile || fd->memfile) {
+		return false;
+	}
+	if (main->versionfile != BLENDER_VERSION || main->subversionfile != BLENDER_SUBVERSION) {
+		return false;
+	}
+	return (me->totvert >= LAZY_DATA_MESH_TOTVERT_MIN) && (me->adt == NULL) && (me->mr == NULL);
+}
+
+/**
+ * Read the direct data of a mesh up to its geometry, which write_mesh() writes last:
+ * the selection history followed by the custom-data layers.
+ */
+static BHead *read_libblock_lazy(FileData *fd, BHead *bhead, ID *id)
+{
+	Mesh *me = (Mesh *)id;
+	const void *geometry_old[] = {
+	    me->mselect,
+	    me->vdata.layers, me->edata.layers, me->fdata.layers, me->ldata.layers, me->pdata.layers,
+	};
+	bool is_geometry = false;
+
+	for (bhead = blo_nextbhead(fd, bhead); bhead && bhead->code == DATA; bhead = blo_nextbhead(fd, bhead)) {
+		if (!is_geometry) {
+			int i;
+			for (i = 0; i < ARRAY_SIZE(geometry_old); i++) {
+				if (geometry_old[i] && (geometry_old[i] == bhead->old)) {
+					is_geometry = true;
+					break;
+				}
+			}
+		}
+
+		if (!is_geometry) {
+			void *data = read_struct(fd, bhead, "Mesh");
+			if (data) {
+				oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+			}
 		}
-		
-		bhead = blo_nextbhead(fd, bhead);
 	}
-	
+
+	direct_link_id(fd, id);
+	direct_link_mesh_lazy(fd, me);
+	id->tag |= LIB_TAG_LAZY_DATA;
+
+	oldnewmap_free_unused(fd->datamap);
+	oldnewmap_clear(fd->datamap);
+
 	return bhead;
 }
 
+#endif  /* USE_LAZY_LIBRARY_DATA */
+
 static BHead *read_libblock(FileData *fd, Main *main, BHead *bhead, const short tag, ID **r_id)
 {
 	/* this routine reads a libblock and its direct data. Use link functions to connect it all
@@ -8234,6 +9060,18 @@ static BHead *read_libblock(FileData *fd, Main *main, BHead *bhead, const short
 	/* That way, we know which datablock needs do_versions (required currently for linking). */
 	id->tag |= LIB_TAG_NEW;
 
+#ifdef USE_LAZY_LIBRARY_DATA
+	if (read_libblock_is_lazy(fd, main, bhead, id)) {
+		return read_libblock_lazy(fd, bhead, id);
+	}
+#endif
+
+#ifdef USE_PARALLEL_DIRECT_LINK
+	if (fd->direct_link_tasks && direct_link_libblock_is_threadsafe(GS(id->name))) {
+		return direct_link_task_add(fd, main, id, bhead);
+	}
+#endif
+
 	/* need a name for the mallocN, just for debugging and sane prints on leaks */
 	allocname = dataname(GS(id->name));
 	
@@ -8241,112 +9079,7 @@ static BHead *read_libblock(FileData *fd, Main *main, BHead *bhead, const short
 	bhead = read_data_into_oldnewmap(fd, bhead, allocname);
 	
 	/* init pointers direct data */
-	direct_link_id(fd, id);
-	
-	switch (GS(id->name)) {
-		case ID_WM:
-			direct_link_windowmanager(fd, (wmWindowManager *)id);
-			break;
-		case ID_SCR:
-			wrong_id = direct_link_screen(fd, (bScreen *)id);
-			break;
-		case ID_SCE:
-			direct_link_scene(fd, (Scene *)id);
-			break;
-		case ID_OB:
-			direct_link_object(fd, (Object *)id);
-			break;
-		case ID_ME:
-			direct_link_mesh(fd, (Mesh *)id);
-			break;
-		case ID_CU:
-			direct_link_curve(fd, (Curve *)id);
-			break;
-		case ID_MB:
-			direct_link_mball(fd, (MetaBall *)id);
-			break;
-		case ID_MA:
-			direct_link_material(fd, (Material *)id);
-			break;
-		case ID_TE:
-			direct_link_texture(fd, (Tex *)id);
-			break;
-		case ID_IM:
-			direct_link_image(fd, (Image *)id);
-			break;
-		case ID_LA:
-			direct_link_lamp(fd, (Lamp *)id);
-			break;
-		case ID_VF:
-			direct_link_vfont(fd, (VFont *)id);
-			break;
-		case ID_TXT:
-			direct_link_text(fd, (Text *)id);
-			break;
-		case ID_IP:
-			direct_link_ipo(fd, (Ipo *)id);
-			break;
-		case ID_KE:
-			direct_link_key(fd, (Key *)id);
-			break;
-		case ID_LT:
-			direct_link_latt(fd, (Lattice *)id);
-			break;
-		case ID_WO:
-			direct_link_world(fd, (World *)id);
-			break;
-		case ID_LI:
-			direct_link_library(fd, (Library *)id, main);
-			break;
-		case ID_CA:
-			direct_link_camera(fd, (Camera *)id);
-			break;
-		case ID_SPK:
-			direct_link_speaker(fd, (Speaker *)id);
-			break;
-		case ID_SO:
-			direct_link_sound(fd, (bSound *)id);
-			break;
-		case ID_GR:
-			direct_link_group(fd, (Group *)id);
-			break;
-		case ID_AR:
-			direct_link_armature(fd, (bArmature*)id);
-			break;
-		case ID_AC:
-			direct_link_action(fd, (bAction*)id);
-			break;
-		case ID_NT:
-			direct_link_nodetree(fd, (bNodeTree*)id);
-			break;
-		case ID_BR:
-			direct_link_brush(fd, (Brush*)id);
-			break;
-		case ID_PA:
-			direct_link_particlesettings(fd, (ParticleSettings*)id);
-			break;
-		case ID_GD:
-			direct_link_gpencil(fd, (bGPdata *)id);
-			break;
-		case ID_MC:
-			direct_link_movieclip(fd, (MovieClip *)id);
-			break;
-		case ID_MSK:
-			direct_link_mask(fd, (Mask *)id);
-			break;
-		case ID_LS:
-			direct_link_linestyle(fd, (FreestyleLineStyle *)id);
-			break;
-		case ID_PAL:
-			direct_link_palette(fd, (Palette *)id);
-			break;
-		case ID_PC:
-			direct_link_paint_curve(fd, (PaintCurve *)id);
-			break;
-		case ID_CF:
-			direct_link_cachefile(fd, (CacheFile *)id);
-			break;
-	}
+	wrong_id = direct_link_libblock(fd, main, id);
 	
 	oldnewmap_free_unused(fd->datamap);
 	oldnewmap_clear(fd->datamap);
@@ -8501,8 +9234,6 @@ static void do_versions_after_linking(Main *main)
 
 static void lib_link_all(FileData *fd, Main *main)
 {
-	oldnewmap_sort(fd);
-	
 	/* No load UI for undo memfiles */
 	if (fd->memfile == NULL) {
 		lib_link_windowmanager(fd, main);
@@ -8624,7 +9355,12 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 	BHead *bhead = blo_firstbhead(fd);
 	BlendFileData *bfd;
 	ListBase mainlist = {NULL, NULL};
+#ifdef USE_PARALLEL_DIRECT_LINK
+	DirectLinkTasks direct_link_tasks = {NULL};
+#endif
 	
+	BLI_trace_zone_begin("Read file");
+
 	bfd = MEM_callocN(sizeof(BlendFileData), "blendfiledata");
 	bfd->main = BKE_main_new();
 	BLI_addtail(&mainlist, bfd->main);
@@ -8653,6 +9389,14 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 		}
 	}
 
+#ifdef USE_PARALLEL_DIRECT_LINK
+	/* not for undo, which may reuse data-blocks of the current main */
+	if (fd->memfile == NULL) {
+		fd->direct_link_tasks = &direct_link_tasks;
+	}
+#endif
+
+	BLI_trace_zone_begin("Read blocks");
 	while (bhead) {
 		switch (bhead->code) {
 		case DATA:
@@ -8700,18 +9444,32 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 			}
 		}
 	}
+	BLI_trace_zone_end();
+
+#ifdef USE_PARALLEL_DIRECT_LINK
+	if (fd->direct_link_tasks) {
+		direct_link_tasks_run(fd);
+		fd->direct_link_tasks = NULL;
+	}
+#endif
 	
 	/* do before read_libraries, but skip undo case */
 	if (fd->memfile == NULL) {
+		BLI_trace_zone_begin("Versioning");
 		do_versions(fd, NULL, bfd->main);
 		do_versions_userdef(fd, bfd);
+		BLI_trace_zone_end();
 	}
 	
+	BLI_trace_zone_begin("Read libraries");
 	read_libraries(fd, &mainlist);
+	BLI_trace_zone_end();
 	
 	blo_join_main(&mainlist);
 	
+	BLI_trace_zone_begin("Link data");
 	lib_link_all(fd, bfd->main);
+	BLI_trace_zone_end();
 
 	/* Skip in undo case. */
 	if (fd->memfile == NULL) {
@@ -8733,6 +9491,8 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 	
 	fd->mainlist = NULL;  /* Safety, this is local variable, shall not be used afterward. */
 
+	BLI_trace_zone_end();
+
 	return bfd;
 }
 
@@ -10640,6 +11400,164 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
 }
 
 
+/* ************* LAZY LIBRARY DATA ************** */
+
+#ifdef USE_LAZY_LIBRARY_DATA
+
+static ThreadMutex lazy_data_lock = BLI_MUTEX_INITIALIZER;
+
+static bool lazy_data_file_version_is_current(FileData *fd)
+{
+	BHead *bhead;
+
+	if (fd->fileversion != BLENDER_VERSION) {
+		return false;
+	}
+
+	for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
+		if (bhead->code == GLOB) {
+			FileGlobal *fg = read_struct(fd, bhead, "Global");
+			const bool is_current = (fg && fg->subversion == BLENDER_SUBVERSION);
+			MEM_SAFE_FREE(fg);
+			return is_current;
+		}
+		else if (bhead->code == ENDB) {
+			break;
+		}
+	}
+	return false;
+}
+
+/* Texture face images can only be linked when they have been read from the library already. */
+static void lazy_data_libmap_images(FileData *fd, Main *bmain, Library *lib)
+{
+	Image *ima;
+
+	for (ima = bmain->image.first; ima; ima = ima->id.next) {
+		if (ima->id.lib == lib) {
+			BHead *bhead = find_bhead_from_code_name(fd, ID_IM, ima->id.name + 2);
+			if (bhead) {
+				oldnewmap_insert(fd->libmap, bhead->old, ima, ID_IM);
+			}
+		}
+	}
+}
+
+static bool lazy_data_read_mesh(FileData *fd, Main *bmain, Mesh *me)
+{
+	BHead *bhead = find_bhead_from_code_name(fd, ID_ME, me->id.name + 2);
+	Mesh *me_file;
+
+	if (bhead == NULL || (me_file = read_struct(fd, bhead, "lib block")) == NULL) {
+		return false;
+	}
+
+	/* The library changed since the mesh was linked. */
+	if (me_file->totcol != me->totcol || me_file->adt || me_file->mr) {
+		MEM_freeN(me_file);
+		return false;
+	}
+
+	read_data_into_oldnewmap(fd, bhead, "Mesh");
+	me_file->id.tag = 0;
+	direct_link_id(fd, &me_file->id);
+	direct_link_mesh(fd, me_file);
+
+	if (me_file->mtpoly || me_file->mtface) {
+		lazy_data_libmap_images(fd, bmain, me->id.lib);
+		lib_link_customdata_mtface(fd, me, &me_file->fdata, me_file->totface);
+		lib_link_customdata_mtpoly(fd, me, &me_file->pdata, me_file->totpoly);
+	}
+
+	/* Same as lib_link_mesh(). Done on the mesh read from the file: the mesh being filled is still
+	 * tagged, mesh functions ensuring its data is read would wait for this thread. */
+#ifdef USE_TESSFACE_DEFAULT
+	BKE_mesh_tessface_calc(me_file);
+#else
+	BKE_mesh_tessface_clear(me_file);
+#endif
+
+	/* Only take the geometry, everything else has been linked with the mesh already. */
+	me->vdata = me_file->vdata;
+	me->edata = me_file->edata;
+	me->fdata = me_file->fdata;
+	me->ldata = me_file->ldata;
+	me->pdata = me_file->pdata;
+	me->totvert = me_file->totvert;
+	me->totedge = me_file->totedge;
+	me->totface = me_file->totface;
+	me->totloop = me_file->totloop;
+	me->totpoly = me_file->totpoly;
+	me->mselect = me_file->mselect;
+	me->totselect = me_file->totselect;
+	BKE_mesh_update_customdata_pointers(me, false);
+
+	mesh_geometry_clear(me_file);
+	if (me_file->id.properties) {
+		IDP_FreeProperty(me_file->id.properties);
+		MEM_freeN(me_file->id.properties);
+	}
+	MEM_SAFE_FREE(me_file->mat);
+	MEM_freeN(me_file);
+
+	oldnewmap_free_unused(fd->datamap);
+	oldnewmap_clear(fd->datamap);
+
+	return true;
+}
+
+#endif  /* USE_LAZY_LIBRARY_DATA */
+
+/**
+ * Read the data of \a id which has been deferred when linking it (tagged #LIB_TAG_LAZY_DATA),
+ * called before evaluating or copying the ID. Safe to call from multiple threads.
+ *
+ * \return false when the data could not be read, the ID then stays empty.
+ */
+bool BLO_library_lazy_data_ensure(Main *bmain, ID *id, ReportList *reports)
+{
+	bool ok = true;
+
+	/* Atomic read, the tag is cleared by another thread once the data has been read. */
+	if ((atomic_fetch_and_add_uint32((uint32_t *)&id->tag, 0) & LIB_TAG_LAZY_DATA) == 0) {
+		return ok;
+	}
+
+#ifdef USE_LAZY_LIBRARY_DATA
+	BLI_mutex_lock(&lazy_data_lock);
+	if (id->tag & LIB_TAG_LAZY_DATA) {
+		FileData *fd = blo_openblenderfile(id->lib->filepath, reports);
+
+		ok = false;
+		if (fd) {
+			if (lazy_data_file_version_is_current(fd)) {
+#ifdef USE_GHASH_BHEAD
+				read_file_bhead_idname_map_create(fd);
+#endif
+				BLI_assert(GS(id->name) == ID_ME);
+				ok = lazy_data_read_mesh(fd, bmain, (Mesh *)id);
+			}
+			blo_freefiledata(fd);
+		}
+
+		if (!ok) {
+			blo_reportf_wrap(reports, RPT_WARNING, TIP_("Cannot read data of '%s' from library '%s'"),
+			                 id->name + 2, id->lib->filepath);
+		}
+
+		/* Don't retry on every access when the library can't be read.
+		 * Atomic so tags set by other threads meanwhile aren't lost. */
+		atomic_fetch_and_and_uint32((uint32_t *)&id->tag, ~(uint32_t)LIB_TAG_LAZY_DATA);
+	}
+	BLI_mutex_unlock(&lazy_data_lock);
+#else
+	UNUSED_VARS(bmain, reports);
+#endif
+
+	return ok;
+}
+
+
 /* reading runtime */
 
 BlendFileData *blo_read_blendafterruntime(int file, const char *name, int actualsize, ReportList *reports)
@@ -43,6 +43,7 @@ struct Object;
 struct PartEff;
 struct View3D;
 struct Key;
+struct DNA_ReconstructInfo;
 
 typedef struct FileData {
 	// linked list of BHeadN's
@@ -62,6 +63,21 @@ typedef struct FileData {
 	int filedes;
 	gzFile gzfiledes;
 
+	// variables needed for reading from a chunked lzo file (see BLEND_LZO_MAGIC)
+	struct BlendLZOReader *lzo;
+
+	// variables needed for reading the latest save of a journal (see BLO_journalfile.h)
+	struct BlendJournalChunk *journal_chunks;
+	int journal_chunks_len, journal_chunk_index;
+	unsigned int journal_chunk_offset;
+
+	// variables needed for reading from a memory mapped file (FD_FLAGS_USE_MMAP)
+	const char *mmap_data;
+	size_t mmap_size;
+	struct BHead **mmap_bheads;  /* all blocks in file order, created on demand for blo_prevbhead */
+	int mmap_bheads_len;
+	struct GHash *mmap_bheads_copied;  /* file offset -> BHeadN, for blocks not aligned for BHead */
+
 	// now only in use for library appending
 	char relabase[FILE_MAX];
 	
@@ -76,6 +92,7 @@ typedef struct FileData {
 	struct SDNA *filesdna;
 	const struct SDNA *memsdna;
 	const char *compflags;  /* array of eSDNA_StructCompare */
+	struct DNA_ReconstructInfo *reconstruct_info;  /* conversion of structs from filesdna to memsdna */
 	
 	int fileversion;
 	int id_name_offs;       /* used to retrieve ID names from (bhead+1) */
@@ -94,6 +111,9 @@ typedef struct FileData {
 	struct BHeadSort *bheadmap;
 	int tot_bheadmap;
 
+	/* when set, direct data of some ID types is linked in parallel after reading all blocks */
+	struct DirectLinkTasks *direct_link_tasks;
+
 	/* see: USE_GHASH_BHEAD */
 	struct GHash *bhead_idname_hash;
 	
@@ -109,6 +129,7 @@ typedef struct FileData {
 
 typedef struct BHeadN {
 	struct BHeadN *next, *prev;
+	size_t file_offset;  /* only for copies of blocks of a mapped file */
 	struct BHead bhead;
 } BHeadN;
 
@@ -120,6 +141,7 @@ enum {
 	FD_FLAGS_FILE_OK               = 1 << 3,
 	FD_FLAGS_NOT_MY_BUFFER         = 1 << 4,
 	FD_FLAGS_NOT_MY_LIBMAP         = 1 << 5,  /* XXX Unused in practice (checked once but never set). */
+	FD_FLAGS_USE_MMAP              = 1 << 6,  /* BHeads point into the mapped file, or to copies of unaligned ones. */
 };
 
 #define SIZEOFBLENDERHEADER 12
@@ -159,6 +181,13 @@ const char *bhead_id_name(const FileData *fd, const BHead *bhead);
 void blo_reportf_wrap(struct ReportList *reports, ReportType type, const char *format, ...) ATTR_PRINTF_FORMAT(3, 4);
 
 void blo_do_versions_oldnewmap_insert(struct OldNewMap *onm, const void *oldaddr, void *newaddr, int nr);
+
+/* only used by tests, insert with blo_do_versions_oldnewmap_insert() */
+struct OldNewMap *blo_oldnewmap_new(void);
+void *blo_oldnewmap_lookup(struct OldNewMap *onm, const void *addr);
+void blo_oldnewmap_clear(struct OldNewMap *onm);
+int blo_oldnewmap_map_used(const struct OldNewMap *onm);
+void blo_oldnewmap_free(struct OldNewMap *onm);
 void *blo_do_versions_newlibadr(struct FileData *fd, const void *lib, const void *adr);
 void *blo_do_versions_newlibadr_us(struct FileData *fd, const void *lib, const void *adr);
 
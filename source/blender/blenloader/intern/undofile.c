@@ -40,19 +40,128 @@
 #include "DNA_listBase.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
 
+#include "BLO_journalfile.h"
 #include "BLO_undofile.h"
 
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#  define LZO_OUT_LEN(size)     ((size) + (size) / 16 + 64 + 3)
+#endif
+
 /* **************** support for memory-write, for undo buffers *************** */
 
+/**
+ * Chunk data is shared between all chunks with the same content over the whole undo stack,
+ * each #MemFileChunk.buf points directly after one of these headers.
+ */
+typedef struct MemFileBuf {
+	unsigned int users;
+	/* uncompressed size */
+	unsigned int size;
+	/* compressed size, zero when the data isn't compressed */
+	unsigned int size_compressed;
+	/* in #memfile_bufs, so other chunks can share it */
+	bool is_registered;
+	uint64_t hash;
+} MemFileBuf;
+
+#define MEMFILE_BUF(chunk_buf) ((MemFileBuf *)(chunk_buf) - 1)
+
+/* don't bother compressing tiny chunks, the header would eat the gain */
+#define MEMFILE_COMPRESS_SIZE_MIN 256
+
+/* all uncompressed buffers by content, only accessed from the main thread */
+static GSet *memfile_bufs = NULL;
+
+static unsigned int memfile_buf_hash(const void *key)
+{
+	return (unsigned int)((const MemFileBuf *)key)->hash;
+}
+
+static bool memfile_buf_cmp(const void *a, const void *b)
+{
+	const MemFileBuf *buf_a = a, *buf_b = b;
+
+	return ((buf_a->hash != buf_b->hash) ||
+	        (buf_a->size != buf_b->size) ||
+	        (memcmp(buf_a + 1, buf_b + 1, buf_a->size) != 0));
+}
+
+static uint64_t memfile_buf_hash_data(const char *data, unsigned int size)
+{
+	return (((uint64_t)BLI_hash_mm2((const unsigned char *)data, size, 0) << 32) |
+	        (uint64_t)BLI_hash_mm2((const unsigned char *)data, size, 0x9e3779b9));
+}
+
+static char *memfile_buf_new(const char *data, unsigned int size)
+{
+	MemFileBuf *buf = MEM_mallocN(sizeof(MemFileBuf) + size, "Chunk buffer");
+
+	buf->users = 1;
+	buf->size = size;
+	buf->size_compressed = 0;
+	buf->is_registered = false;
+	buf->hash = 0;
+	memcpy(buf + 1, data, size);
+
+	return (char *)(buf + 1);
+}
+
+static void memfile_buf_register(MemFileBuf *buf)
+{
+	void **key_p;
+
+	BLI_assert(buf->size_compressed == 0);
+
+	if (memfile_bufs == NULL) {
+		memfile_bufs = BLI_gset_new(memfile_buf_hash, memfile_buf_cmp, __func__);
+	}
+
+	/* an equal buffer may exist already when this one was compressed before */
+	if (!BLI_gset_ensure_p_ex(memfile_bufs, buf, &key_p)) {
+		*key_p = buf;
+		buf->is_registered = true;
+	}
+}
+
+static void memfile_buf_unregister(MemFileBuf *buf)
+{
+	if (buf->is_registered) {
+		BLI_gset_remove(memfile_bufs, buf, NULL);
+		buf->is_registered = false;
+
+		if (BLI_gset_size(memfile_bufs) == 0) {
+			BLI_gset_free(memfile_bufs, NULL);
+			memfile_bufs = NULL;
+		}
+	}
+}
+
+static void memfile_buf_release(char *chunk_buf)
+{
+	MemFileBuf *buf = MEMFILE_BUF(chunk_buf);
+
+	BLI_assert(buf->users > 0);
+	if (--buf->users == 0) {
+		memfile_buf_unregister(buf);
+		MEM_freeN(buf);
+	}
+}
+
 /* not memfile itself */
 void BLO_memfile_free(MemFile *memfile)
 {
 	MemFileChunk *chunk;
 	
 	while ((chunk = BLI_pophead(&memfile->chunks))) {
-		if (chunk->ident == 0)
-			MEM_freeN(chunk->buf);
+		memfile_buf_release(chunk->buf);
 		MEM_freeN(chunk);
 	}
 	memfile->size = 0;
@@ -60,26 +169,41 @@ void BLO_memfile_free(MemFile *memfile)
 
 /* to keep list of memfiles consistent, 'first' is always first in list */
 /* result is that 'first' is being freed */
-void BLO_memfile_merge(MemFile *first, MemFile *second)
+void BLO_memfile_merge(MemFile *first, MemFile *UNUSED(second))
 {
-	MemFileChunk *fc, *sc;
-	
-	fc = first->chunks.first;
-	sc = second->chunks.first;
-	while (fc || sc) {
-		if (fc && sc) {
-			if (sc->ident) {
-				sc->ident = 0;
-				fc->ident = 1;
-			}
-		}
-		if (fc) fc = fc->next;
-		if (sc) sc = sc->next;
-	}
-	
+	/* buffers are reference counted, the chunks 'second' shares stay valid */
 	BLO_memfile_free(first);
 }
 
+/**
+ * Make \a dst use the same chunk data as \a src, which stays valid when \a src is freed.
+ *
+ * Shared data is never changed or compressed, so \a dst can be read from another thread
+ * while the undo stack changes, it must be freed from the main thread though.
+ */
+void BLO_memfile_share(MemFile *dst, const MemFile *src)
+{
+	const MemFileChunk *chunk;
+
+	BLI_listbase_clear(&dst->chunks);
+	dst->size = 0;
+
+	for (chunk = src->chunks.first; chunk; chunk = chunk->next) {
+		MemFileChunk *chunk_share = MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk");
+		BLI_assert(MEMFILE_BUF(chunk->buf)->size_compressed == 0);
+		chunk_share->size = chunk->size;
+		chunk_share->ident = 1;
+		chunk_share->buf = chunk->buf;
+		MEMFILE_BUF(chunk->buf)->users++;
+		BLI_addtail(&dst->chunks, chunk_share);
+	}
+}
+
+/**
+ * Add a chunk to \a current, sharing the data of an identical chunk anywhere in the undo stack.
+ * The chunk at the same position in \a compare is checked first,
+ * since that is the common case and doesn't need hashing.
+ */
 void memfile_chunk_add(MemFile *compare, MemFile *current, const char *buf, unsigned int size)
 {
 	static MemFileChunk *compchunk = NULL;
@@ -103,20 +227,175 @@ void memfile_chunk_add(MemFile *compare, MemFile *current, const char *buf, unsi
 	
 	/* we compare compchunk with buf */
 	if (compchunk) {
-		if (compchunk->size == curchunk->size) {
+		if ((compchunk->size == curchunk->size) &&
+		    (MEMFILE_BUF(compchunk->buf)->size_compressed == 0))
+		{
 			if (memcmp(compchunk->buf, buf, size) == 0) {
 				curchunk->buf = compchunk->buf;
 				curchunk->ident = 1;
+				MEMFILE_BUF(curchunk->buf)->users++;
 			}
 		}
 		compchunk = compchunk->next;
 	}
 	
-	/* not equal... */
+	/* not at the same position, look for the same content elsewhere */
 	if (curchunk->buf == NULL) {
-		curchunk->buf = MEM_mallocN(size, "Chunk buffer");
-		memcpy(curchunk->buf, buf, size);
-		current->size += size;
+		MemFileBuf *buf_new = (MemFileBuf *)memfile_buf_new(buf, size) - 1;
+		MemFileBuf *buf_found = NULL;
+		void **key_p;
+
+		buf_new->hash = memfile_buf_hash_data(buf, size);
+
+		if (memfile_bufs == NULL) {
+			memfile_bufs = BLI_gset_new(memfile_buf_hash, memfile_buf_cmp, __func__);
+		}
+
+		if (BLI_gset_ensure_p_ex(memfile_bufs, buf_new, &key_p)) {
+			buf_found = *key_p;
+		}
+		else {
+			*key_p = buf_new;
+			buf_new->is_registered = true;
+		}
+
+		if (buf_found) {
+			MEM_freeN(buf_new);
+			buf_found->users++;
+			curchunk->buf = (char *)(buf_found + 1);
+			curchunk->ident = 1;
+		}
+		else {
+			curchunk->buf = (char *)(buf_new + 1);
+			current->size += size;
+		}
+	}
+}
+
+/**
+ * Compress the data only used by \a memfile, for undo steps which aren't likely to be read soon.
+ * Call #BLO_memfile_uncompress before reading it again.
+ *
+ * \return the number of bytes saved.
+ */
+size_t BLO_memfile_compress(MemFile *memfile)
+{
+	size_t saved = 0;
+#ifdef WITH_LZO
+	MemFileChunk *chunk;
+	lzo_align_t *wrkmem = NULL;
+	unsigned char *out = NULL;
+	unsigned int out_size = 0;
+
+	for (chunk = memfile->chunks.first; chunk; chunk = chunk->next) {
+		MemFileBuf *buf = MEMFILE_BUF(chunk->buf);
+		MemFileBuf *buf_compressed;
+		lzo_uint out_len;
+
+		/* shared data may be read through other steps */
+		if ((buf->users != 1) || (buf->size_compressed != 0) || (buf->size < MEMFILE_COMPRESS_SIZE_MIN)) {
+			continue;
+		}
+
+		if (wrkmem == NULL) {
+			wrkmem = MEM_mallocN(LZO1X_1_MEM_COMPRESS, __func__);
+		}
+		if (out_size < LZO_OUT_LEN(buf->size)) {
+			out_size = LZO_OUT_LEN(buf->size);
+			MEM_SAFE_FREE(out);
+			out = MEM_mallocN(out_size, __func__);
+		}
+
+		out_len = out_size;
+		if ((lzo1x_1_compress((unsigned char *)chunk->buf, buf->size, out, &out_len, wrkmem) != LZO_E_OK) ||
+		    (out_len >= buf->size))
+		{
+			continue;
+		}
+
+		memfile_buf_unregister(buf);
+
+		buf_compressed = MEM_mallocN(sizeof(MemFileBuf) + out_len, "Chunk buffer compressed");
+		*buf_compressed = *buf;
+		buf_compressed->size_compressed = (unsigned int)out_len;
+		memcpy(buf_compressed + 1, out, out_len);
+		MEM_freeN(buf);
+
+		chunk->buf = (char *)(buf_compressed + 1);
+		saved += buf_compressed->size - buf_compressed->size_compressed;
+	}
+
+	MEM_SAFE_FREE(wrkmem);
+	MEM_SAFE_FREE(out);
+#else
+	UNUSED_VARS(memfile);
+#endif
+	return saved;
+}
+
+/**
+ * Restore chunks compressed by #BLO_memfile_compress.
+ *
+ * \return the number of bytes this adds, the opposite of #BLO_memfile_compress.
+ */
+size_t BLO_memfile_uncompress(MemFile *memfile)
+{
+	size_t restored = 0;
+#ifdef WITH_LZO
+	MemFileChunk *chunk;
+
+	for (chunk = memfile->chunks.first; chunk; chunk = chunk->next) {
+		MemFileBuf *buf = MEMFILE_BUF(chunk->buf);
+		MemFileBuf *buf_uncompressed;
+		lzo_uint out_len;
+
+		if (buf->size_compressed == 0) {
+			continue;
+		}
+
+		/* only compressed when not shared */
+		BLI_assert(buf->users == 1);
+
+		buf_uncompressed = MEM_mallocN(sizeof(MemFileBuf) + buf->size, "Chunk buffer");
+		*buf_uncompressed = *buf;
+		buf_uncompressed->size_compressed = 0;
+		out_len = buf->size;
+		if ((lzo1x_decompress_safe((unsigned char *)(buf + 1), buf->size_compressed,
+		                           (unsigned char *)(buf_uncompressed + 1), &out_len, NULL) != LZO_E_OK) ||
+		    (out_len != buf->size))
+		{
+			/* should never happen, the data is only in memory */
+			BLI_assert(0);
+			memset(buf_uncompressed + 1, 0, buf->size);
+		}
+		restored += buf->size - buf->size_compressed;
+		MEM_freeN(buf);
+
+		chunk->buf = (char *)(buf_uncompressed + 1);
+		memfile_buf_register(buf_uncompressed);
 	}
+#else
+	UNUSED_VARS(memfile);
+#endif
+	return restored;
 }
 
+/**
+ * Save the memfile into a journal, only the chunks which changed since its previous save are written.
+ */
+bool BLO_memfile_write_journal(MemFile *memfile, const char *filename)
+{
+	BlendJournalWriter *journal = BLO_journal_writer_open(filename);
+	MemFileChunk *chunk;
+	bool ok = (journal != NULL);
+
+	for (chunk = memfile->chunks.first; ok && chunk; chunk = chunk->next) {
+		ok = BLO_journal_writer_add(journal, chunk->buf, chunk->size);
+	}
+
+	if (journal) {
+		ok = BLO_journal_writer_close(journal, ok) && ok;
+	}
+
+	return ok;
+}
@@ -152,8 +152,11 @@
 #include "MEM_guardedalloc.h" // MEM_freeN
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_linklist.h"
+#include "BLI_math_base.h"
 #include "BLI_mempool.h"
+#include "BLI_trace.h"
 
 #include "BKE_action.h"
 #include "BKE_blender_version.h"
@@ -182,6 +185,8 @@
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
 #include "BLO_blend_defs.h"
+#include "BLO_fileindex.h"
+#include "BLO_lzofile.h"
 
 #include "readfile.h"
 
@@ -203,6 +208,9 @@
 typedef enum {
 	WW_WRAP_NONE = 1,
 	WW_WRAP_ZLIB,
+#ifdef WITH_LZO
+	WW_WRAP_LZO,
+#endif
 } eWriteWrapType;
 
 typedef struct WriteWrap WriteWrap;
@@ -216,6 +224,9 @@ struct WriteWrap {
 	union {
 		int file_handle;
 		gzFile gz_handle;
+#ifdef WITH_LZO
+		BlendLZOWriter *lzo;
+#endif
 	} _user_data;
 };
 
@@ -275,6 +286,36 @@ static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
+#ifdef WITH_LZO
+
+/* chunked lzo, see: BLEND_LZO_MAGIC */
+#define FILE_HANDLE(ww) \
+	(ww)->_user_data.lzo
+
+static bool ww_open_lzo(WriteWrap *ww, const char *filepath)
+{
+	BlendLZOWriter *lzo = BLO_lzo_writer_open(filepath);
+
+	if (lzo) {
+		FILE_HANDLE(ww) = lzo;
+		return true;
+	}
+	else {
+		return false;
+	}
+}
+static bool ww_close_lzo(WriteWrap *ww)
+{
+	return BLO_lzo_writer_close(FILE_HANDLE(ww));
+}
+static size_t ww_write_lzo(WriteWrap *ww, const char *buf, size_t buf_len)
+{
+	return BLO_lzo_writer_write(FILE_HANDLE(ww), buf, buf_len) ? buf_len : 0;
+}
+#undef FILE_HANDLE
+
+#endif  /* WITH_LZO */
+
 /* --- end compression types --- */
 
 static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
@@ -289,6 +330,15 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
 			r_ww->write = ww_write_zlib;
 			break;
 		}
+#ifdef WITH_LZO
+		case WW_WRAP_LZO:
+		{
+			r_ww->open  = ww_open_lzo;
+			r_ww->close = ww_close_lzo;
+			r_ww->write = ww_write_lzo;
+			break;
+		}
+#endif
 		default:
 		{
 			r_ww->open  = ww_open_none;
@@ -303,13 +353,24 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
 
 
 
+/* Index of the written data-blocks, see BLO_fileindex.h */
+typedef struct WriteIndex {
+	BlendFileIndexEntry *entries;
+	int entries_len, entries_alloc;
+
+	/* checksum of the entry being written, the last one */
+	BLI_HashMurmur2A mm2;
+	bool is_entry_open;
+} WriteIndex;
+
 typedef struct {
 	const struct SDNA *sdna;
 
 	unsigned char *buf;
 	MemFile *compare, *current;
 
-	int tot, count;
+	uint64_t tot;
+	int count;
 	bool error;
 
 	/* Wrap writing, so we can use zlib or
@@ -317,6 +378,13 @@ typedef struct {
 	 * Will be NULL for UNDO. */
 	WriteWrap *ww;
 
+	/* Will be NULL for UNDO. */
+	WriteIndex *index;
+
+	/* Flush after every data-block, so a change in one doesn't change
+	 * how the data-blocks after it are split into chunks. Set for UNDO. */
+	bool use_flush_per_id;
+
 #ifdef USE_BMESH_SAVE_AS_COMPAT
 	bool use_mesh_compat; /* option to save with older mesh format */
 #endif
@@ -358,6 +426,10 @@ static void writedata_do_write(WriteData *wd, const void *mem, int memlen)
 
 static void writedata_free(WriteData *wd)
 {
+	if (wd->index) {
+		MEM_SAFE_FREE(wd->index->entries);
+		MEM_freeN(wd->index);
+	}
 	MEM_freeN(wd->buf);
 	MEM_freeN(wd);
 }
@@ -441,6 +513,7 @@ static WriteData *bgnwrite(WriteWrap *ww, MemFile *compare, MemFile *current)
 
 	wd->compare = compare;
 	wd->current = current;
+	wd->use_flush_per_id = (current != NULL);
 	/* this inits comparing */
 	memfile_chunk_add(compare, NULL, NULL, 0);
 
@@ -466,6 +539,90 @@ static bool endwrite(WriteData *wd)
 	return err;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name File Index
+ * \{ */
+
+static void write_index_entry_close(WriteIndex *index)
+{
+	if (index->is_entry_open) {
+		index->entries[index->entries_len - 1].checksum = BLI_hash_mm2a_end(&index->mm2);
+		index->is_entry_open = false;
+	}
+}
+
+/**
+ * Add a block to the index, called before writing it. ID blocks start a new entry,
+ * which the #DATA blocks following them are added to.
+ */
+static void write_index_block(WriteData *wd, const BHead *bh, const void *data)
+{
+	WriteIndex *index = wd->index;
+
+	if (index == NULL) {
+		return;
+	}
+
+	if (bh->code != DATA) {
+		write_index_entry_close(index);
+
+		if (BKE_idcode_is_valid(bh->code)) {
+			BlendFileIndexEntry *entry;
+
+			if (index->entries_len == index->entries_alloc) {
+				index->entries_alloc = max_ii(256, index->entries_alloc * 2);
+				index->entries = MEM_reallocN(index->entries, sizeof(*index->entries) * (size_t)index->entries_alloc);
+			}
+
+			entry = &index->entries[index->entries_len++];
+			memset(entry, 0, sizeof(*entry));
+			entry->offset = wd->tot;
+			entry->code = bh->code;
+			BLI_strncpy(entry->name, ((const ID *)data)->name, sizeof(entry->name));
+
+			BLI_hash_mm2a_init(&index->mm2, 0);
+			index->is_entry_open = true;
+		}
+	}
+
+	if (index->is_entry_open) {
+		index->entries[index->entries_len - 1].size += sizeof(*bh) + (uint64_t)bh->len;
+		BLI_hash_mm2a_add(&index->mm2, (const unsigned char *)bh, sizeof(*bh));
+		BLI_hash_mm2a_add(&index->mm2, data, (size_t)bh->len);
+	}
+}
+
+/* Written as a DATA block between DNA1 and ENDB. Readers (older versions too) skip DATA blocks
+ * which don't follow an ID block, a new block code would be reported as an unknown ID. */
+static void write_index(WriteData *wd)
+{
+	WriteIndex *index = wd->index;
+	BlendFileIndexFooter footer = {0};
+	BHead bh;
+
+	write_index_entry_close(index);
+
+	bh.code = DATA;
+	bh.old = index;
+	bh.SDNAnr = 0;
+	bh.nr = 1;
+	bh.len = (int)(sizeof(*index->entries) * (size_t)index->entries_len + sizeof(footer));
+	mywrite(wd, &bh, sizeof(bh));
+
+	footer.entries_offset = wd->tot;
+	footer.entries_len = (uint32_t)index->entries_len;
+	footer.entries_checksum = BLI_hash_mm2(
+	        (const unsigned char *)index->entries, sizeof(*index->entries) * (size_t)index->entries_len, 0);
+	memcpy(footer.magic, BLEND_INDEX_MAGIC, BLEND_INDEX_MAGIC_LEN);
+
+	if (index->entries_len) {
+		mywrite(wd, index->entries, (int)(sizeof(*index->entries) * (size_t)index->entries_len));
+	}
+	mywrite(wd, &footer, sizeof(footer));
+}
+
+/** \} */
+
 /* ********** WRITE FILE ****************** */
 
 static void writestruct_at_address_nr(
@@ -495,6 +652,7 @@ static void writestruct_at_address_nr(
 		return;
 	}
 
+	write_index_block(wd, &bh, data);
 	mywrite(wd, &bh, sizeof(BHead));
 	mywrite(wd, data, bh.len);
 }
@@ -548,6 +706,7 @@ static void writedata(WriteData *wd, int filecode, int len, const void *adr)  /*
 	bh.SDNAnr = 0;
 	bh.len    = len;
 
+	write_index_block(wd, &bh, adr);
 	mywrite(wd, &bh, sizeof(BHead));
 	mywrite(wd, adr, len);
 }
@@ -3804,6 +3963,11 @@ static bool write_file_handle(
 
 	wd = bgnwrite(ww, compare, current);
 
+	/* not needed for undo */
+	if (current == NULL) {
+		wd->index = MEM_callocN(sizeof(*wd->index), "WriteIndex");
+	}
+
 #ifdef USE_BMESH_SAVE_AS_COMPAT
 	wd->use_mesh_compat = (write_flags & G_FILE_MESH_COMPAT) != 0;
 #endif
@@ -3950,6 +4114,10 @@ static bool write_file_handle(
 					BLI_assert(0);
 					break;
 			}
+
+			if (wd->use_flush_per_id) {
+				mywrite_flush(wd);
+			}
 		}
 
 		mywrite_flush(wd);
@@ -3982,6 +4150,10 @@ static bool write_file_handle(
 	}
 #endif
 
+	if (wd->index) {
+		write_index(wd);
+	}
+
 	/* end of file */
 	memset(&bhead, 0, sizeof(BHead));
 	bhead.code = ENDB;
@@ -4053,7 +4225,11 @@ bool BLO_write_file(
 	BLI_snprintf(tempname, sizeof(tempname), "%s@", filepath);
 
 	if (write_flags & G_FILE_COMPRESS) {
+#ifdef WITH_LZO
+		ww_type = (write_flags & G_FILE_COMPRESS_FAST) ? WW_WRAP_LZO : WW_WRAP_ZLIB;
+#else
 		ww_type = WW_WRAP_ZLIB;
+#endif
 	}
 	else {
 		ww_type = WW_WRAP_NONE;
@@ -4102,7 +4278,9 @@ bool BLO_write_file(
 	}
 
 	/* actual file writing */
+	BLI_trace_zone_begin("Write file");
 	const bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, thumb);
+	BLI_trace_zone_end();
 
 	ww.close(&ww);
 
@@ -4143,7 +4321,9 @@ bool BLO_write_file_mem(Main *mainvar, MemFile *compare, MemFile *current, int w
 {
 	write_flags &= ~G_FILE_USERPREFS;
 
+	BLI_trace_zone_begin("Write undo");
 	const bool err = write_file_handle(mainvar, NULL, compare, current, write_flags, NULL);
+	BLI_trace_zone_end();
 
 	return (err == 0);
 }
@@ -237,6 +237,10 @@ void BM_mesh_bm_from_me(
 	float (*keyco)[3] = NULL;
 	int totuv, totloops, i, j;
 
+	if (me) {
+		BKE_mesh_lazy_data_ensure(G.main, me);
+	}
+
 	/* free custom data */
 	/* this isnt needed in most cases but do just incase */
 	CustomData_free(&bm->vdata, bm->totvert);
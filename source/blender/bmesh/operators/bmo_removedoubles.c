@@ -32,6 +32,7 @@
 #include "BLI_alloca.h"
 #include "BLI_stackdefines.h"
 #include "BLI_stack.h"
+#include "BLI_kdtree.h"
 
 #include "BKE_customdata.h"
 
@@ -605,6 +606,41 @@ static void bmesh_find_doubles_common(
 	/* sort by vertex coordinates added together */
 	qsort(verts, verts_len, sizeof(BMVert *), vergaverco);
 
+	if (keepvert == false) {
+		/* without keep-verts every vertex may merge into any other,
+		 * a (threaded) kd-tree avoids the quadratic worst case of the sorted search.
+		 * Points are visited in index order, using the sorted order as index
+		 * gives the same merge targets as the search below. */
+		KDTree *tree = BLI_kdtree_new((unsigned int)verts_len);
+		int *duplicates = MEM_mallocN(sizeof(int) * (size_t)verts_len, __func__);
+
+		for (i = 0; i < verts_len; i++) {
+			BLI_kdtree_insert(tree, i, verts[i]->co);
+			duplicates[i] = -1;
+		}
+		BLI_kdtree_balance(tree);
+
+		if (BLI_kdtree_calc_duplicates_fast(tree, dist, true, duplicates)) {
+			for (i = 0; i < verts_len; i++) {
+				j = duplicates[i];
+				if ((j != -1) && (j != i)) {
+					BMVert *v_other = verts[i];
+					BMVert *v_check = verts[j];
+
+					BMO_vert_flag_enable(bm, v_other, VERT_DOUBLE);
+					BMO_vert_flag_enable(bm, v_check, VERT_TARGET);
+
+					BMO_slot_map_elem_insert(optarget, optarget_slot, v_other, v_check);
+				}
+			}
+		}
+
+		MEM_freeN(duplicates);
+		BLI_kdtree_free(tree);
+		MEM_freeN(verts);
+		return;
+	}
+
 	/* Flag keep_verts */
 	if (keepvert) {
 		BMO_slot_buffer_flag_enable(bm, op->slots_in, "keep_verts", BM_VERT, VERT_KEEP);
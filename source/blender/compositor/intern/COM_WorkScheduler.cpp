@@ -35,6 +35,7 @@
 
 #include "PIL_time.h"
 #include "BLI_threads.h"
+#include "BLI_trace.h"
 
 #include "BKE_global.h"
 
@@ -82,7 +83,9 @@ void *WorkScheduler::thread_execute_cpu(void *data)
 	WorkPackage *work;
 	BLI_thread_local_set(g_thread_device, device);
 	while ((work = (WorkPackage *)BLI_thread_queue_pop(g_cpuqueue))) {
+		BLI_trace_zone_begin("Compositor work package");
 		device->execute(work);
+		BLI_trace_zone_end();
 		delete work;
 	}
 	
@@ -95,7 +98,9 @@ void *WorkScheduler::thread_execute_gpu(void *data)
 	WorkPackage *work;
 	
 	while ((work = (WorkPackage *)BLI_thread_queue_pop(g_gpuqueue))) {
+		BLI_trace_zone_begin("Compositor work package (OpenCL)");
 		device->execute(work);
+		BLI_trace_zone_end();
 		delete work;
 	}
 	
@@ -64,6 +64,14 @@ void DEG_graph_tag_relations_update(struct Depsgraph *graph);
 /* Tag all relations in the database for update.*/
 void DEG_relations_tag_update(struct Main *bmain);
 
+/* Tag relations of the given ID for update, only nodes and relations around
+ * this ID will be rebuilt when possible.
+ */
+void DEG_graph_tag_relations_update_id(struct Depsgraph *graph, struct ID *id);
+
+/* Tag relations of the given ID for update in all graphs of the database. */
+void DEG_id_relations_tag_update(struct Main *bmain, struct ID *id);
+
 /* Create new graph if didn't exist yet,
  * or update relations if graph was tagged for update.
  */
@@ -48,7 +48,12 @@ struct Depsgraph;
 /* Statistics */
 
 typedef struct DepsgraphStatsTimes {
+	/* Time spent evaluating operations during the last update (seconds). */
 	float duration_last;
+	/* Time operations were ready but waiting for a thread (seconds). */
+	float wait_last;
+	/* Number of operations evaluated during the last update. */
+	int num_operations_last;
 } DepsgraphStatsTimes;
 
 typedef struct DepsgraphStatsComponent {
@@ -67,6 +72,12 @@ typedef struct DepsgraphStatsID {
 
 typedef struct DepsgraphStats {
 	struct GHash *id_stats;
+
+	/* Wall time of the whole last update, and the time of all its
+	 * operations summed up.
+	 */
+	float duration_last;
+	DepsgraphStatsTimes times;
 } DepsgraphStats;
 
 struct DepsgraphStats *DEG_stats(void);
@@ -85,7 +96,16 @@ void DEG_stats_simple(const struct Depsgraph *graph,
 /* ************************************************ */
 /* Diagram-Based Graph Debugging */
 
-void DEG_debug_graphviz(const struct Depsgraph *graph, FILE *stream, const char *label, bool show_eval);
+void DEG_debug_graphviz(const struct Depsgraph *graph, FILE *stream, const char *label,
+                        bool show_eval, bool show_timings);
+
+/* ************************************************ */
+/* Evaluation Timings */
+
+/* Write timings of the last evaluation, as recorded with
+ * G_DEBUG_DEPSGRAPH_TIME, either as a readable table or as JSON.
+ */
+void DEG_debug_timings(const struct Depsgraph *graph, FILE *stream, bool use_json);
 
 /* ************************************************ */
 
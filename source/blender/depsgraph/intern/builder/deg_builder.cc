@@ -37,6 +37,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
 #include "BLI_stack.h"
+#include "BLI_task.h"
 
 #include "intern/depsgraph.h"
 #include "intern/depsgraph_types.h"
@@ -117,6 +118,45 @@ void deg_graph_build_flush_layers(Depsgraph *graph)
 	BLI_stack_free(stack);
 }
 
+/* Find runs of operations which can only be evaluated one after another,
+ * so evaluation can go through them in a single task instead of scheduling
+ * every one of them separately.
+ */
+static void deg_graph_build_chains_func(void *data_v, int i)
+{
+	Depsgraph *graph = (Depsgraph *)data_v;
+	OperationDepsNode *node = graph->operations[i];
+	node->chain_next = NULL;
+	if (node->outlinks.size() != 1) {
+		return;
+	}
+	DepsRelation *rel = node->outlinks[0];
+	OperationDepsNode *to = (OperationDepsNode *)rel->to;
+	BLI_assert(to->type == DEG_NODE_TYPE_OPERATION);
+	if ((rel->flag & DEPSREL_FLAG_CYCLIC) == 0 &&
+	    to->inlinks.size() == 1)
+	{
+		node->chain_next = to;
+	}
+}
+
+static void deg_graph_build_chains(Depsgraph *graph)
+{
+	const int num_operations = graph->operations.size();
+	const bool do_threads = num_operations > 256;
+	BLI_task_parallel_range(0,
+	                        num_operations,
+	                        graph,
+	                        deg_graph_build_chains_func,
+	                        do_threads);
+}
+
+static void deg_graph_build_finalize_id_func(void *data_v, int i)
+{
+	vector<IDDepsNode *> *id_nodes = (vector<IDDepsNode *> *)data_v;
+	(*id_nodes)[i]->finalize_build();
+}
+
 void deg_graph_build_finalize(Depsgraph *graph)
 {
 	/* STEP 1: Make sure new invisible dependencies are ready for use.
@@ -143,6 +183,8 @@ void deg_graph_build_finalize(Depsgraph *graph)
 	/* STEP 3: Re-tag IDs for update if it was tagged before the relations
 	 * update tag.
 	 */
+	vector<IDDepsNode *> id_nodes;
+	id_nodes.reserve(BLI_ghash_size(graph->id_hash));
 	GHASH_FOREACH_BEGIN(IDDepsNode *, id_node, graph->id_hash)
 	{
 		GHASH_FOREACH_BEGIN(ComponentDepsNode *, comp, id_node->components)
@@ -167,9 +209,18 @@ void deg_graph_build_finalize(Depsgraph *graph)
 				}
 			}
 		}
-		id_node->finalize_build();
+		id_nodes.push_back(id_node);
 	}
 	GHASH_FOREACH_END();
+	/* STEP 4: Finalize components, they are independent from each other. */
+	const int num_id_nodes = id_nodes.size();
+	BLI_task_parallel_range(0,
+	                        num_id_nodes,
+	                        &id_nodes,
+	                        deg_graph_build_finalize_id_func,
+	                        num_id_nodes > 64);
+	/* STEP 5: Collapse linear chains of operations. */
+	deg_graph_build_chains(graph);
 }
 
 }  // namespace DEG
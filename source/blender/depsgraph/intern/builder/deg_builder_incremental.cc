@@ -0,0 +1,287 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2017 Blender Foundation.
+ * All rights reserved.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/depsgraph/intern/builder/deg_builder_incremental.cc
+ *  \ingroup depsgraph
+ *
+ * Partial rebuild of the graph, for when relations of a few objects changed.
+ *
+ * Every relation remembers the object which relations were being built when
+ * it was added. Nodes of tagged objects are rebuilt, and relations are rebuilt
+ * for the tagged objects and all objects which added relations to them.
+ *
+ * This relies on the graph still having all relations of the objects which
+ * are not rebuilt, so relations removed by the transitive reduction are put
+ * back first.
+ */
+
+#include "intern/builder/deg_builder_incremental.h"
+
+#include <algorithm>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_ghash.h"
+
+extern "C" {
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_scene.h"
+} /* extern "C" */
+
+#include "intern/builder/deg_builder.h"
+#include "intern/builder/deg_builder_cycle.h"
+#include "intern/builder/deg_builder_nodes.h"
+#include "intern/builder/deg_builder_relations.h"
+#include "intern/builder/deg_builder_transitive.h"
+
+#include "intern/nodes/deg_node.h"
+#include "intern/nodes/deg_node_component.h"
+#include "intern/nodes/deg_node_operation.h"
+
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_intern.h"
+
+#include "util/deg_util_foreach.h"
+
+namespace DEG {
+
+/* Settings of the ID node which are set by builders of other IDs, these
+ * are to be preserved when the node is re-created.
+ */
+typedef struct TaggedIDNode {
+	ID *id;
+	unsigned int layers;
+	int eval_flags;
+} TaggedIDNode;
+
+static void relations_remove(DepsNode::Relations *relations, DepsRelation *rel)
+{
+	relations->erase(std::remove(relations->begin(), relations->end(), rel),
+	                 relations->end());
+}
+
+static bool relation_owner_is_valid(Depsgraph *graph, const DepsRelation *rel)
+{
+	/* Relations added by scene level builders, or outside of builders, can
+	 * only be restored with a full build.
+	 */
+	return (rel->owner_id != NULL &&
+	        GS(rel->owner_id->name) == ID_OB &&
+	        graph->find_id_node(rel->owner_id) != NULL);
+}
+
+/* Collect objects which added relations to or from the ID node. */
+static bool id_node_relation_owners(Depsgraph *graph,
+                                    IDDepsNode *id_node,
+                                    GSet *owner_ids)
+{
+	GHASH_FOREACH_BEGIN(ComponentDepsNode *, comp_node, id_node->components)
+	{
+		foreach (OperationDepsNode *op_node, comp_node->operations) {
+			foreach (DepsRelation *rel, op_node->inlinks) {
+				if (!relation_owner_is_valid(graph, rel)) {
+					return false;
+				}
+				BLI_gset_add(owner_ids, rel->owner_id);
+			}
+			foreach (DepsRelation *rel, op_node->outlinks) {
+				if (!relation_owner_is_valid(graph, rel)) {
+					return false;
+				}
+				BLI_gset_add(owner_ids, rel->owner_id);
+			}
+		}
+	}
+	GHASH_FOREACH_END();
+	return true;
+}
+
+/* Remove all relations added by the given objects, IDs which these relations
+ * lead to are added to built_ids.
+ */
+static void remove_owned_relations(Depsgraph *graph,
+                                   GSet *owner_ids,
+                                   GSet *built_ids)
+{
+	vector<DepsRelation *> relations;
+	foreach (OperationDepsNode *op_node, graph->operations) {
+		foreach (DepsRelation *rel, op_node->inlinks) {
+			if (rel->owner_id != NULL &&
+			    BLI_gset_haskey(owner_ids, rel->owner_id))
+			{
+				relations.push_back(rel);
+			}
+		}
+	}
+	foreach (DepsRelation *rel, relations) {
+		OperationDepsNode *op_to = (OperationDepsNode *)rel->to;
+		BLI_gset_add(built_ids, op_to->owner->owner->id);
+		relations_remove(&rel->from->outlinks, rel);
+		relations_remove(&rel->to->inlinks, rel);
+		OBJECT_GUARDED_DELETE(rel, DepsRelation);
+	}
+}
+
+/* Remove nodes of the tagged IDs, all their relations are to be removed
+ * already.
+ */
+static void remove_tagged_id_nodes(Depsgraph *graph,
+                                   const vector<TaggedIDNode> &tagged_nodes)
+{
+	size_t num_operations = 0;
+	for (size_t i = 0; i < graph->operations.size(); ++i) {
+		OperationDepsNode *op_node = graph->operations[i];
+		if (BLI_gset_haskey(graph->relations_tagged_ids, op_node->owner->owner->id)) {
+			BLI_assert(op_node->inlinks.empty() && op_node->outlinks.empty());
+			BLI_gset_remove(graph->entry_tags, op_node, NULL);
+		}
+		else {
+			graph->operations[num_operations++] = op_node;
+		}
+	}
+	graph->operations.resize(num_operations);
+
+	foreach (const TaggedIDNode &tagged_node, tagged_nodes) {
+		graph->remove_id_node(tagged_node.id);
+	}
+}
+
+bool deg_graph_build_incremental(Depsgraph *graph, Main *bmain, Scene *scene)
+{
+	vector<TaggedIDNode> tagged_nodes;
+	vector<ID *> built_before;
+	GSet *owner_ids = BLI_gset_ptr_new(__func__);
+	GSet *built_ids = BLI_gset_ptr_new(__func__);
+	bool is_supported = true;
+
+	/* Relations are rebuilt only by the builders of some objects, relations
+	 * of all others have to stay in the graph. The reduction removed some of
+	 * them, bring them back so the graph is the same as before the reduction.
+	 * It runs again on the whole graph once relations are rebuilt.
+	 */
+	deg_graph_transitive_reduction_restore(graph);
+
+	/* Only objects which already have nodes are supported, anything else
+	 * might change relations of the scene itself.
+	 */
+	GSET_FOREACH_BEGIN(ID *, id, graph->relations_tagged_ids)
+	{
+		IDDepsNode *id_node = graph->find_id_node(id);
+		if (id_node == NULL || GS(id->name) != ID_OB ||
+		    !id_node_relation_owners(graph, id_node, owner_ids))
+		{
+			is_supported = false;
+			break;
+		}
+		TaggedIDNode tagged_node;
+		tagged_node.id = id;
+		tagged_node.layers = id_node->layers;
+		tagged_node.eval_flags = id_node->eval_flags;
+		tagged_nodes.push_back(tagged_node);
+		BLI_gset_add(owner_ids, id);
+	}
+	GSET_FOREACH_END();
+
+	if (!is_supported) {
+		BLI_gset_free(owner_ids, NULL);
+		BLI_gset_free(built_ids, NULL);
+		return false;
+	}
+
+	const int mem_category = MEM_category_begin(MEM_CATEGORY_DEPSGRAPH);
+
+	GHASH_FOREACH_BEGIN(IDDepsNode *, id_node, graph->id_hash)
+	{
+		if (!BLI_gset_haskey(graph->relations_tagged_ids, id_node->id)) {
+			built_before.push_back(id_node->id);
+		}
+	}
+	GHASH_FOREACH_END();
+
+	/* 1) Remove relations which are to be rebuilt, this leaves tagged nodes
+	 *    without any relations.
+	 */
+	remove_owned_relations(graph, owner_ids, built_ids);
+	remove_tagged_id_nodes(graph, tagged_nodes);
+
+	/* 2) Re-create nodes of the tagged objects, nodes of everything else
+	 *    which was already built are kept.
+	 */
+	DepsgraphNodeBuilder node_builder(bmain, graph);
+	node_builder.begin_build(bmain);
+	foreach (ID *id, built_before) {
+		id->tag |= LIB_TAG_DOIT;
+	}
+	foreach (const TaggedIDNode &tagged_node, tagged_nodes) {
+		Object *ob = (Object *)tagged_node.id;
+		node_builder.build_object(scene, BKE_scene_base_find(scene, ob), ob);
+		IDDepsNode *id_node = graph->find_id_node(tagged_node.id);
+		id_node->layers |= tagged_node.layers;
+		id_node->eval_flags |= tagged_node.eval_flags;
+	}
+
+	/* 3) Rebuild relations of the objects which relations were removed,
+	 *    including data they own. Nodes which are new to the graph get
+	 *    their relations built as well.
+	 */
+	DepsgraphRelationBuilder relation_builder(graph);
+	relation_builder.begin_build(bmain);
+	relation_builder.set_check_unique_relations(true);
+	foreach (ID *id, built_before) {
+		id->tag |= LIB_TAG_DOIT;
+	}
+	GSET_FOREACH_BEGIN(ID *, id, built_ids)
+	{
+		id->tag &= ~LIB_TAG_DOIT;
+	}
+	GSET_FOREACH_END();
+	GSET_FOREACH_BEGIN(ID *, id, owner_ids)
+	{
+		id->tag &= ~LIB_TAG_DOIT;
+	}
+	GSET_FOREACH_END();
+	GSET_FOREACH_BEGIN(ID *, id, owner_ids)
+	{
+		relation_builder.build_object(bmain, scene, (Object *)id);
+	}
+	GSET_FOREACH_END();
+	relation_builder.build_object_customdata_masks();
+
+	/* 4) Same post-processing as for the full build. */
+	deg_graph_detect_cycles(graph);
+	deg_graph_transitive_reduction(graph);
+	deg_graph_build_finalize(graph);
+
+	MEM_category_end(mem_category);
+
+	BLI_gset_free(owner_ids, NULL);
+	BLI_gset_free(built_ids, NULL);
+	return true;
+}
+
+}  // namespace DEG
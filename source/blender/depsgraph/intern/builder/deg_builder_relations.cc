@@ -194,10 +194,29 @@ RNAPathKey::RNAPathKey(ID *id, const char *path) :
 }
 
 DepsgraphRelationBuilder::DepsgraphRelationBuilder(Depsgraph *graph) :
-    m_graph(graph)
+    m_graph(graph),
+    m_owner_id(NULL),
+    m_check_unique_relations(false)
 {
 }
 
+void DepsgraphRelationBuilder::set_check_unique_relations(bool check_unique_relations)
+{
+	m_check_unique_relations = check_unique_relations;
+}
+
+static bool relation_exists(DepsNode *node_from,
+                            DepsNode *node_to,
+                            const char *description)
+{
+	foreach (DepsRelation *rel, node_from->outlinks) {
+		if (rel->to == node_to && STREQ(rel->name, description)) {
+			return true;
+		}
+	}
+	return false;
+}
+
 TimeSourceDepsNode *DepsgraphRelationBuilder::find_node(
         const TimeSourceKey &key) const
 {
@@ -275,7 +294,13 @@ void DepsgraphRelationBuilder::add_time_relation(TimeSourceDepsNode *timesrc,
                                                  const char *description)
 {
 	if (timesrc && node_to) {
-		m_graph->add_new_relation(timesrc, node_to, description);
+		if (m_check_unique_relations &&
+		    relation_exists(timesrc, node_to, description))
+		{
+			return;
+		}
+		DepsRelation *rel = m_graph->add_new_relation(timesrc, node_to, description);
+		rel->owner_id = m_owner_id;
 	}
 	else {
 		DEG_DEBUG_PRINTF("add_time_relation(%p = %s, %p = %s, %s) Failed\n",
@@ -291,7 +316,13 @@ void DepsgraphRelationBuilder::add_operation_relation(
         const char *description)
 {
 	if (node_from && node_to) {
-		m_graph->add_new_relation(node_from, node_to, description);
+		if (m_check_unique_relations &&
+		    relation_exists(node_from, node_to, description))
+		{
+			return;
+		}
+		DepsRelation *rel = m_graph->add_new_relation(node_from, node_to, description);
+		rel->owner_id = m_owner_id;
 	}
 	else {
 		DEG_DEBUG_PRINTF("add_operation_relation(%p = %s, %p = %s, %s) Failed\n",
@@ -414,6 +445,9 @@ void DepsgraphRelationBuilder::build_object(Main *bmain, Scene *scene, Object *o
 	}
 	ob->id.tag |= LIB_TAG_DOIT;
 
+	ID *owner_id_prev = m_owner_id;
+	m_owner_id = &ob->id;
+
 	/* Object Transforms */
 	eDepsOperation_Code base_op = (ob->parent) ? DEG_OPCODE_TRANSFORM_PARENT : DEG_OPCODE_TRANSFORM_LOCAL;
 	OperationKey base_op_key(&ob->id, DEG_NODE_TYPE_TRANSFORM, base_op);
@@ -567,6 +601,8 @@ void DepsgraphRelationBuilder::build_object(Main *bmain, Scene *scene, Object *o
 	if (ob->dup_group != NULL) {
 		build_group(bmain, scene, ob, ob->dup_group);
 	}
+
+	m_owner_id = owner_id_prev;
 }
 
 void DepsgraphRelationBuilder::build_object_parent(Object *ob)
@@ -184,6 +184,11 @@ struct DepsgraphRelationBuilder
 	                              const DepsNodeHandle *handle,
 	                              const char *description);
 
+	/* Don't add relations which already exist in the graph, used when
+	 * relations are only rebuilt for a part of the graph.
+	 */
+	void set_check_unique_relations(bool check_unique_relations);
+
 	void build_scene(Main *bmain, Scene *scene);
 	void build_group(Main *bmain, Scene *scene, Object *object, Group *group);
 	void build_object(Main *bmain, Scene *scene, Object *ob);
@@ -222,6 +227,7 @@ struct DepsgraphRelationBuilder
 	void build_cachefile(CacheFile *cache_file);
 	void build_mask(Mask *mask);
 	void build_movieclip(MovieClip *clip);
+	void build_object_customdata_masks();
 
 	void add_collision_relations(const OperationKey &key, Scene *scene, Object *ob, Group *group, int layer, bool dupli, const char *name);
 	void add_forcefield_relations(const OperationKey &key, Scene *scene, Object *ob, ParticleSystem *psys, EffectorWeights *eff, bool add_absorption, const char *name);
@@ -253,6 +259,9 @@ protected:
 
 private:
 	Depsgraph *m_graph;
+	/* ID which relations are being built, see DepsRelation::owner_id. */
+	ID *m_owner_id;
+	bool m_check_unique_relations;
 };
 
 struct DepsNodeHandle
@@ -73,6 +73,8 @@ void DepsgraphRelationBuilder::build_scene(Main *bmain, Scene *scene)
 		build_scene(bmain, scene->set);
 	}
 
+	m_owner_id = &scene->id;
+
 	/* scene objects */
 	LINKLIST_FOREACH (Base *, base, &scene->base) {
 		Object *ob = base->object;
@@ -114,6 +116,14 @@ void DepsgraphRelationBuilder::build_scene(Main *bmain, Scene *scene)
 		build_movieclip(clip);
 	}
 
+	m_owner_id = NULL;
+
+	build_object_customdata_masks();
+}
+
+/* Accumulate customdata masks requested from object operations. */
+void DepsgraphRelationBuilder::build_object_customdata_masks()
+{
 	for (Depsgraph::OperationNodes::const_iterator it_op = m_graph->operations.begin();
 	     it_op != m_graph->operations.end();
 	     ++it_op)
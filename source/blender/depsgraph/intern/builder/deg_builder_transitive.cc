@@ -30,8 +30,14 @@
 
 #include "intern/builder/deg_builder_transitive.h"
 
+#include <algorithm>
+
 #include "MEM_guardedalloc.h"
 
+#include "BLI_utildefines.h"
+#include "BLI_stack.h"
+#include "BLI_task.h"
+
 #include "intern/nodes/deg_node.h"
 #include "intern/nodes/deg_node_component.h"
 #include "intern/nodes/deg_node_operation.h"
@@ -47,73 +53,230 @@ namespace DEG {
 /* Performs a transitive reduction to remove redundant relations.
  * https://en.wikipedia.org/wiki/Transitive_reduction
  *
- * XXX The current implementation is somewhat naive and has O(V*E) worst case
- * runtime.
- * A more optimized algorithm can be implemented later, e.g.
+ * Operations are sorted topologically first. A relation from a parent to the
+ * target is redundant when the parent can be reached going up from another
+ * parent of the target. Such path only goes through operations sorted after
+ * the parent, so going up stops at operations sorted before all the parents.
+ * This keeps the search close to the target, and targets are searched
+ * independently from each other in parallel.
  *
- *   http://www.sciencedirect.com/science/article/pii/0304397588900321/pdf?md5=3391e309b708b6f9cdedcd08f84f4afc&pid=1-s2.0-0304397588900321-main.pdf
+ * Cyclic relations are ignored and never removed. Operations which could not
+ * be sorted, because of cycles which were not solved, are left untouched.
  *
- * Care has to be taken to make sure the algorithm can handle the cyclic case
- * too! (unless we can to prevent this case early on).
+ * Removed relations are kept in the graph, see Depsgraph.reduced_relations.
  */
 
-enum {
-	OP_VISITED = 1,
-	OP_REACHABLE = 2,
-};
+/* Operations with fewer relations are searched without threads. */
+#define REDUCTION_THREADED_LIMIT 1024
+
+typedef struct ReductionData {
+	/* Sorted operations, the index of every operation in this array is
+	 * stored in its tag.
+	 */
+	vector<OperationDepsNode *> *order;
+	int num_ordered;
+	/* Redundant relations found by all threads. */
+	vector<DepsRelation *> *redundant;
+} ReductionData;
+
+typedef struct ReductionChunk {
+	/* Search of which target visited every operation, allocated on first use. */
+	int *visited;
+	BLI_Stack *stack;
+	BLI_Stack *redundant;
+} ReductionChunk;
 
-static void deg_graph_tag_paths_recursive(DepsNode *node)
+static bool relation_is_followed(const DepsRelation *rel)
 {
-	if (node->done & OP_VISITED) {
-		return;
+	return (rel->from->type == DEG_NODE_TYPE_OPERATION) &&
+	       (rel->flag & DEPSREL_FLAG_CYCLIC) == 0;
+}
+
+static bool relation_is_tagged(const DepsRelation *rel)
+{
+	return (rel->flag & DEPSREL_FLAG_TEMP_TAG) != 0;
+}
+
+/* Sort operations so they come after all operations they depend on, returns
+ * the number of sorted operations, the ones on cycles are put at the end.
+ */
+static int deg_graph_sort_operations(Depsgraph *graph,
+                                     vector<OperationDepsNode *> &order)
+{
+	foreach (OperationDepsNode *node, graph->operations) {
+		node->num_links_pending = 0;
+		foreach (DepsRelation *rel, node->inlinks) {
+			if (relation_is_followed(rel)) {
+				++node->num_links_pending;
+			}
+		}
+		if (node->num_links_pending == 0) {
+			order.push_back(node);
+		}
 	}
-	node->done |= OP_VISITED;
-	foreach (DepsRelation *rel, node->inlinks) {
-		deg_graph_tag_paths_recursive(rel->from);
-		/* Do this only in inlinks loop, so the target node does not get
-		 * flagged.
-		 */
-		rel->from->done |= OP_REACHABLE;
+	for (size_t i = 0; i < order.size(); ++i) {
+		OperationDepsNode *node = order[i];
+		node->tag = i;
+		foreach (DepsRelation *rel, node->outlinks) {
+			if (relation_is_followed(rel)) {
+				OperationDepsNode *to = (OperationDepsNode *)rel->to;
+				BLI_assert(to->num_links_pending > 0);
+				if (--to->num_links_pending == 0) {
+					order.push_back(to);
+				}
+			}
+		}
+	}
+	const int num_ordered = order.size();
+	foreach (OperationDepsNode *node, graph->operations) {
+		if (node->num_links_pending != 0) {
+			node->tag = order.size();
+			order.push_back(node);
+		}
 	}
+	return num_ordered;
 }
 
-void deg_graph_transitive_reduction(Depsgraph *graph)
+static void deg_graph_reduce_target(void *data_v,
+                                    void *chunk_v,
+                                    const int i,
+                                    const int UNUSED(thread_id))
 {
-	foreach (OperationDepsNode *target, graph->operations) {
-		/* Clear tags. */
-		foreach (OperationDepsNode *node, graph->operations) {
-			node->done = 0;
-		}
+	ReductionData *data = (ReductionData *)data_v;
+	ReductionChunk *chunk = (ReductionChunk *)chunk_v;
+	OperationDepsNode *target = (*data->order)[i];
+	const int search = i + 1;
 
-		/* mark nodes from which we can reach the target
-		 * start with children, so the target node and direct children are not
-		 * flagged.
-		 */
-		target->done |= OP_VISITED;
-		foreach (DepsRelation *rel, target->inlinks) {
-			deg_graph_tag_paths_recursive(rel->from);
+	/* Only sorted operations can be reached going up from the target, and all
+	 * of them are sorted before it.
+	 */
+	int num_parents = 0;
+	int min_order = i;
+	foreach (DepsRelation *rel, target->inlinks) {
+		if (relation_is_followed(rel)) {
+			++num_parents;
+			min_order = std::min(min_order, rel->from->tag);
 		}
+	}
+	if (num_parents < 2) {
+		return;
+	}
 
-		/* Remove redundant paths to the target. */
-		for (DepsNode::Relations::const_iterator it_rel = target->inlinks.begin();
-		     it_rel != target->inlinks.end();
-		     )
-		{
-			DepsRelation *rel = *it_rel;
-			/* Increment in advance, so we can safely remove the relation. */
-			++it_rel;
-
-			if (rel->from->type == DEG_NODE_TYPE_TIMESOURCE) {
-				/* HACK: time source nodes don't get "done" flag set/cleared. */
-				/* TODO: there will be other types in future, so iterators above
-				 * need modifying.
-				 */
+	if (chunk->visited == NULL) {
+		chunk->visited = (int *)MEM_callocN(sizeof(int) * data->num_ordered,
+		                                    "DEG reduction visited");
+		chunk->stack = BLI_stack_new(sizeof(OperationDepsNode *),
+		                             "DEG reduction stack");
+		chunk->redundant = BLI_stack_new(sizeof(DepsRelation *),
+		                                 "DEG reduction relations");
+	}
+
+	/* Start with the parents, so they only get visited when reachable from
+	 * another parent.
+	 */
+	foreach (DepsRelation *rel, target->inlinks) {
+		if (relation_is_followed(rel)) {
+			BLI_stack_push(chunk->stack, &rel->from);
+		}
+	}
+	while (!BLI_stack_is_empty(chunk->stack)) {
+		OperationDepsNode *node;
+		BLI_stack_pop(chunk->stack, &node);
+		foreach (DepsRelation *rel, node->inlinks) {
+			if (!relation_is_followed(rel)) {
+				continue;
 			}
-			else if (rel->from->done & OP_REACHABLE) {
-				OBJECT_GUARDED_DELETE(rel, DepsRelation);
+			OperationDepsNode *from = (OperationDepsNode *)rel->from;
+			if (from->tag >= min_order && chunk->visited[from->tag] != search) {
+				chunk->visited[from->tag] = search;
+				BLI_stack_push(chunk->stack, &from);
 			}
 		}
 	}
+
+	foreach (DepsRelation *rel, target->inlinks) {
+		if (relation_is_followed(rel) &&
+		    chunk->visited[rel->from->tag] == search)
+		{
+			BLI_stack_push(chunk->redundant, &rel);
+		}
+	}
+}
+
+static void deg_graph_reduce_finalize(void *data_v, void *chunk_v)
+{
+	ReductionData *data = (ReductionData *)data_v;
+	ReductionChunk *chunk = (ReductionChunk *)chunk_v;
+	if (chunk->visited == NULL) {
+		return;
+	}
+	while (!BLI_stack_is_empty(chunk->redundant)) {
+		DepsRelation *rel;
+		BLI_stack_pop(chunk->redundant, &rel);
+		data->redundant->push_back(rel);
+	}
+	MEM_freeN(chunk->visited);
+	BLI_stack_free(chunk->stack);
+	BLI_stack_free(chunk->redundant);
+}
+
+void deg_graph_transitive_reduction(Depsgraph *graph)
+{
+	vector<OperationDepsNode *> order;
+	vector<DepsRelation *> redundant;
+	order.reserve(graph->operations.size());
+
+	ReductionData data;
+	data.order = &order;
+	data.num_ordered = deg_graph_sort_operations(graph, order);
+	data.redundant = &redundant;
+
+	ReductionChunk chunk;
+	chunk.visited = NULL;
+	chunk.stack = NULL;
+	chunk.redundant = NULL;
+
+	/* Find redundant relations, graph is not modified here. */
+	BLI_task_parallel_range_finalize(0, data.num_ordered,
+	                                 &data,
+	                                 &chunk,
+	                                 sizeof(chunk),
+	                                 deg_graph_reduce_target,
+	                                 deg_graph_reduce_finalize,
+	                                 data.num_ordered > REDUCTION_THREADED_LIMIT,
+	                                 true);
+
+	if (redundant.empty()) {
+		return;
+	}
+
+	/* Remove them all at once, so every operation is only updated once. */
+	foreach (DepsRelation *rel, redundant) {
+		rel->flag |= DEPSREL_FLAG_TEMP_TAG;
+	}
+	foreach (OperationDepsNode *node, graph->operations) {
+		node->inlinks.erase(std::remove_if(node->inlinks.begin(),
+		                                   node->inlinks.end(),
+		                                   relation_is_tagged),
+		                    node->inlinks.end());
+		node->outlinks.erase(std::remove_if(node->outlinks.begin(),
+		                                    node->outlinks.end(),
+		                                    relation_is_tagged),
+		                     node->outlinks.end());
+	}
+	foreach (DepsRelation *rel, redundant) {
+		rel->flag &= ~DEPSREL_FLAG_TEMP_TAG;
+		graph->reduced_relations.push_back(rel);
+	}
+}
+
+void deg_graph_transitive_reduction_restore(Depsgraph *graph)
+{
+	foreach (DepsRelation *rel, graph->reduced_relations) {
+		rel->from->outlinks.push_back(rel);
+		rel->to->inlinks.push_back(rel);
+	}
+	graph->reduced_relations.clear();
 }
 
 }  // namespace DEG
@@ -37,4 +37,7 @@ struct Depsgraph;
 /* Performs a transitive reduction to remove redundant relations. */
 void deg_graph_transitive_reduction(Depsgraph *graph);
 
+/* Links relations removed by the reduction back to their nodes. */
+void deg_graph_transitive_reduction_restore(Depsgraph *graph);
+
 }  // namespace DEG
@@ -133,10 +133,19 @@ static int deg_debug_node_color_index(const DepsNode *node)
 #endif
 }
 
+/* Operations are filled with a color between these two depending on how long
+ * they took to evaluate, relative to the slowest one.
+ */
+static const unsigned char deg_debug_timing_color_fast[3] = {0xff, 0xff, 0xcc};
+static const unsigned char deg_debug_timing_color_slow[3] = {0xe3, 0x1a, 0x1c};
+
 struct DebugContext {
 	FILE *file;
 	bool show_tags;
 	bool show_eval_priority;
+	bool show_timings;
+	/* Evaluation time of the slowest operation. */
+	float max_eval_time;
 };
 
 static void deg_debug_fprintf(const DebugContext &ctx, const char *fmt, ...) ATTR_PRINTF_FORMAT(2, 3);
@@ -158,6 +167,17 @@ static void deg_debug_graphviz_legend_color(const DebugContext &ctx,
 	deg_debug_fprintf(ctx, "</TR>" NL);
 }
 
+static void deg_debug_graphviz_timing_color(float factor, char r_color[8])
+{
+	unsigned char rgb[3];
+	for (int i = 0; i < 3; i++) {
+		rgb[i] = (unsigned char)(deg_debug_timing_color_fast[i] +
+		                         (deg_debug_timing_color_slow[i] -
+		                          deg_debug_timing_color_fast[i]) * factor);
+	}
+	BLI_snprintf(r_color, 8, "#%02x%02x%02x", rgb[0], rgb[1], rgb[2]);
+}
+
 static void deg_debug_graphviz_legend(const DebugContext &ctx)
 {
 	deg_debug_fprintf(ctx, "{" NL);
@@ -174,6 +194,14 @@ static void deg_debug_graphviz_legend(const DebugContext &ctx)
 	deg_debug_graphviz_legend_color(ctx, "NOOP", colors[8]);
 #endif
 
+	if (ctx.show_timings) {
+		char color[8];
+		deg_debug_graphviz_timing_color(0.0f, color);
+		deg_debug_graphviz_legend_color(ctx, "Fast Operation", color);
+		deg_debug_graphviz_timing_color(1.0f, color);
+		deg_debug_graphviz_legend_color(ctx, "Slow Operation", color);
+	}
+
 #ifdef COLOR_SCHEME_NODE_TYPE
 	const int (*pair)[2];
 	for (pair = deg_debug_node_type_color_map; (*pair)[0] >= 0; ++pair) {
@@ -239,6 +267,18 @@ static void deg_debug_graphviz_node_fillcolor(const DebugContext &ctx,
 	const char *defaultcolor = "gainsboro";
 	int color_index = deg_debug_node_color_index(node);
 	const char *fillcolor = color_index < 0 ? defaultcolor : deg_debug_colors_light[color_index % deg_debug_max_colors];
+	if (ctx.show_timings && node->tclass == DEG_NODE_CLASS_OPERATION) {
+		OperationDepsNode *op_node = (OperationDepsNode *)node;
+		if (op_node->eval_thread_id != -1 && !op_node->is_noop()) {
+			char timing_color[8];
+			const float factor = (ctx.max_eval_time > 0.0f)
+			                     ? op_node->eval_time / ctx.max_eval_time
+			                     : 0.0f;
+			deg_debug_graphviz_timing_color(factor, timing_color);
+			deg_debug_fprintf(ctx, "\"%s\"", timing_color);
+			return;
+		}
+	}
 	deg_debug_fprintf(ctx, "\"%s\"", fillcolor);
 }
 
@@ -290,6 +330,16 @@ static void deg_debug_graphviz_node_single(const DebugContext &ctx,
 		BLI_snprintf(buf, sizeof(buf), " (Layers: %u)", id_node->layers);
 		name += buf;
 	}
+	if (ctx.show_timings && node->tclass == DEG_NODE_CLASS_OPERATION) {
+		OperationDepsNode *op_node = (OperationDepsNode *)node;
+		if (op_node->eval_thread_id != -1 && !op_node->is_noop()) {
+			char buf[256];
+			BLI_snprintf(buf, sizeof(buf), "<BR/>%.3f ms (thread %d)",
+			             op_node->eval_time * 1000.0f,
+			             op_node->eval_thread_id);
+			name += buf;
+		}
+	}
 	if (ctx.show_eval_priority && node->tclass == DEG_NODE_CLASS_OPERATION) {
 		priority = ((OperationDepsNode *)node)->eval_priority;
 	}
@@ -531,7 +581,8 @@ static void deg_debug_graphviz_graph_relations(const DebugContext &ctx,
 
 }  // namespace DEG
 
-void DEG_debug_graphviz(const Depsgraph *graph, FILE *f, const char *label, bool show_eval)
+void DEG_debug_graphviz(const Depsgraph *graph, FILE *f, const char *label,
+                        bool show_eval, bool show_timings)
 {
 	if (!graph) {
 		return;
@@ -543,6 +594,17 @@ void DEG_debug_graphviz(const Depsgraph *graph, FILE *f, const char *label, bool
 	ctx.file = f;
 	ctx.show_tags = show_eval;
 	ctx.show_eval_priority = show_eval;
+	ctx.show_timings = show_timings;
+	ctx.max_eval_time = 0.0f;
+	if (show_timings) {
+		foreach (DEG::OperationDepsNode *op_node, deg_graph->operations) {
+			if (op_node->eval_thread_id != -1 &&
+			    op_node->eval_time > ctx.max_eval_time)
+			{
+				ctx.max_eval_time = op_node->eval_time;
+			}
+		}
+	}
 
 	DEG::deg_debug_fprintf(ctx, "digraph depgraph {" NL);
 	DEG::deg_debug_fprintf(ctx, "rankdir=LR;" NL);
@@ -0,0 +1,311 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2017 Blender Foundation.
+ * All rights reserved.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/depsgraph/intern/debug/deg_debug_timings.cc
+ *  \ingroup depsgraph
+ *
+ * Report of the time spent evaluating the depsgraph, per data-block,
+ * component and operation.
+ */
+
+#include <algorithm>
+#include <set>
+
+#include "BLI_utildefines.h"
+#include "BLI_ghash.h"
+
+extern "C" {
+#include "DNA_listBase.h"
+}  /* extern "C" */
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_debug.h"
+
+#include "intern/eval/deg_eval_debug.h"
+#include "intern/depsgraph_intern.h"
+#include "util/deg_util_foreach.h"
+
+namespace DEG {
+
+/* Number of operations listed in the text report. */
+#define TIMINGS_NUM_SLOWEST_OPERATIONS 10
+
+struct TimingsComponent {
+	const ComponentDepsNode *comp;
+	string name;
+	DepsgraphStatsTimes times;
+	vector<const OperationDepsNode *> operations;
+};
+
+struct TimingsID {
+	const IDDepsNode *id_node;
+	DepsgraphStatsTimes times;
+	vector<TimingsComponent> components;
+};
+
+struct Timings {
+	DepsgraphStatsTimes times;
+	int num_threads;
+	vector<TimingsID> ids;
+	vector<const OperationDepsNode *> operations;
+};
+
+static void timings_clear(DepsgraphStatsTimes &times)
+{
+	times.duration_last = 0.0f;
+	times.wait_last = 0.0f;
+	times.num_operations_last = 0;
+}
+
+static void timings_add(DepsgraphStatsTimes &times, const OperationDepsNode *node)
+{
+	times.duration_last += node->eval_time;
+	times.wait_last += node->wait_time;
+	times.num_operations_last++;
+}
+
+static bool timings_operation_cmp(const OperationDepsNode *a,
+                                  const OperationDepsNode *b)
+{
+	return a->eval_time > b->eval_time;
+}
+
+static bool timings_component_cmp(const TimingsComponent &a,
+                                  const TimingsComponent &b)
+{
+	return a.times.duration_last > b.times.duration_last;
+}
+
+static bool timings_id_cmp(const TimingsID &a, const TimingsID &b)
+{
+	return a.times.duration_last > b.times.duration_last;
+}
+
+static string timings_component_name(const ComponentDepsNode *comp)
+{
+	DepsNodeFactory *factory = deg_get_node_factory(comp->type);
+	if (comp->name[0] == '\0') {
+		return string(factory->tname());
+	}
+	return string(factory->tname()) + " | " + comp->name;
+}
+
+/* Gather operations evaluated during the last update, sorted from the
+ * slowest to the fastest on every level.
+ */
+static void timings_gather(const Depsgraph *graph, Timings &timings)
+{
+	std::set<int> threads;
+
+	timings_clear(timings.times);
+
+	GHASH_FOREACH_BEGIN(const IDDepsNode *, id_node, graph->id_hash)
+	{
+		TimingsID id_timings;
+		id_timings.id_node = id_node;
+		timings_clear(id_timings.times);
+
+		GHASH_FOREACH_BEGIN(const ComponentDepsNode *, comp, id_node->components)
+		{
+			TimingsComponent comp_timings;
+			comp_timings.comp = comp;
+			timings_clear(comp_timings.times);
+
+			foreach (const OperationDepsNode *op_node, comp->operations) {
+				if (op_node->eval_thread_id == -1 || op_node->is_noop()) {
+					continue;
+				}
+				comp_timings.operations.push_back(op_node);
+				timings.operations.push_back(op_node);
+				timings_add(comp_timings.times, op_node);
+				timings_add(id_timings.times, op_node);
+				timings_add(timings.times, op_node);
+				threads.insert(op_node->eval_thread_id);
+			}
+
+			if (!comp_timings.operations.empty()) {
+				comp_timings.name = timings_component_name(comp);
+				std::sort(comp_timings.operations.begin(),
+				          comp_timings.operations.end(),
+				          timings_operation_cmp);
+				id_timings.components.push_back(comp_timings);
+			}
+		}
+		GHASH_FOREACH_END();
+
+		if (!id_timings.components.empty()) {
+			std::sort(id_timings.components.begin(),
+			          id_timings.components.end(),
+			          timings_component_cmp);
+			timings.ids.push_back(id_timings);
+		}
+	}
+	GHASH_FOREACH_END();
+
+	std::sort(timings.ids.begin(), timings.ids.end(), timings_id_cmp);
+	std::sort(timings.operations.begin(),
+	          timings.operations.end(),
+	          timings_operation_cmp);
+	timings.num_threads = threads.size();
+}
+
+/* Text Report -------------------------------------------------------- */
+
+static void timings_text_row(FILE *f,
+                             const DepsgraphStatsTimes &times,
+                             int indent,
+                             const char *name)
+{
+	fprintf(f, "%10.3f %10.3f %6d  %*s%s\n",
+	        times.duration_last * 1000.0f,
+	        times.wait_last * 1000.0f,
+	        times.num_operations_last,
+	        indent * 2, "",
+	        name);
+}
+
+static void timings_write_text(FILE *f, const Timings &timings, float duration)
+{
+	fprintf(f, "Depsgraph evaluation: %.3f ms, %.3f ms in %d operations on %d threads\n",
+	        duration * 1000.0f,
+	        timings.times.duration_last * 1000.0f,
+	        timings.times.num_operations_last,
+	        timings.num_threads);
+	if (timings.ids.empty()) {
+		return;
+	}
+
+	fprintf(f, "%10s %10s %6s  %s\n", "Time (ms)", "Wait (ms)", "Ops", "Data-block / Component");
+	foreach (const TimingsID &id_timings, timings.ids) {
+		timings_text_row(f, id_timings.times, 0, id_timings.id_node->name);
+		foreach (const TimingsComponent &comp_timings, id_timings.components) {
+			timings_text_row(f, comp_timings.times, 1, comp_timings.name.c_str());
+		}
+	}
+
+	fprintf(f, "%10s %10s %6s  %s\n", "Time (ms)", "Wait (ms)", "Thread", "Slowest Operations");
+	for (int i = 0;
+	     i < timings.operations.size() && i < TIMINGS_NUM_SLOWEST_OPERATIONS;
+	     i++)
+	{
+		const OperationDepsNode *op_node = timings.operations[i];
+		fprintf(f, "%10.3f %10.3f %6d  %s\n",
+		        op_node->eval_time * 1000.0f,
+		        op_node->wait_time * 1000.0f,
+		        op_node->eval_thread_id,
+		        op_node->full_identifier().c_str());
+	}
+}
+
+/* JSON Report -------------------------------------------------------- */
+
+static void timings_json_string(FILE *f, const char *str)
+{
+	fputc('"', f);
+	for (const char *c = str; *c != '\0'; c++) {
+		if (ELEM(*c, '"', '\\')) {
+			fputc('\\', f);
+			fputc(*c, f);
+		}
+		else if ((unsigned char)*c < 0x20) {
+			fprintf(f, "\\u%04x", (unsigned char)*c);
+		}
+		else {
+			fputc(*c, f);
+		}
+	}
+	fputc('"', f);
+}
+
+static void timings_json_times(FILE *f, const DepsgraphStatsTimes &times)
+{
+	fprintf(f, "\"time_ms\": %.6f, \"wait_ms\": %.6f, \"num_operations\": %d",
+	        times.duration_last * 1000.0f,
+	        times.wait_last * 1000.0f,
+	        times.num_operations_last);
+}
+
+static void timings_write_json(FILE *f, const Timings &timings, float duration)
+{
+	fprintf(f, "{\n");
+	fprintf(f, "  \"duration_ms\": %.6f,\n", duration * 1000.0f);
+	fprintf(f, "  \"num_threads\": %d,\n", timings.num_threads);
+	fprintf(f, "  ");
+	timings_json_times(f, timings.times);
+	fprintf(f, ",\n");
+	fprintf(f, "  \"ids\": [");
+	for (int i = 0; i < timings.ids.size(); i++) {
+		const TimingsID &id_timings = timings.ids[i];
+		fprintf(f, "%s\n    {\"name\": ", (i > 0) ? "," : "");
+		timings_json_string(f, id_timings.id_node->name);
+		fprintf(f, ", ");
+		timings_json_times(f, id_timings.times);
+		fprintf(f, ", \"components\": [");
+		for (int j = 0; j < id_timings.components.size(); j++) {
+			const TimingsComponent &comp_timings = id_timings.components[j];
+			fprintf(f, "%s\n      {\"name\": ", (j > 0) ? "," : "");
+			timings_json_string(f, comp_timings.name.c_str());
+			fprintf(f, ", ");
+			timings_json_times(f, comp_timings.times);
+			fprintf(f, ", \"operations\": [");
+			for (int k = 0; k < comp_timings.operations.size(); k++) {
+				const OperationDepsNode *op_node = comp_timings.operations[k];
+				fprintf(f, "%s\n        {\"name\": ", (k > 0) ? "," : "");
+				timings_json_string(f, op_node->identifier().c_str());
+				fprintf(f, ", \"time_ms\": %.6f, \"wait_ms\": %.6f, \"thread\": %d}",
+				        op_node->eval_time * 1000.0f,
+				        op_node->wait_time * 1000.0f,
+				        op_node->eval_thread_id);
+			}
+			fprintf(f, "]}");
+		}
+		fprintf(f, "]}");
+	}
+	fprintf(f, "\n  ]\n");
+	fprintf(f, "}\n");
+}
+
+}  // namespace DEG
+
+void DEG_debug_timings(const Depsgraph *graph, FILE *f, bool use_json)
+{
+	if (!graph) {
+		return;
+	}
+
+	const DEG::Depsgraph *deg_graph = reinterpret_cast<const DEG::Depsgraph *>(graph);
+	DepsgraphStats *stats = DEG::DepsgraphDebug::stats;
+	const float duration = (stats != NULL) ? stats->duration_last : 0.0f;
+
+	DEG::Timings timings;
+	DEG::timings_gather(deg_graph, timings);
+
+	if (use_json) {
+		DEG::timings_write_json(f, timings, duration);
+	}
+	else {
+		DEG::timings_write_text(f, timings, duration);
+	}
+}
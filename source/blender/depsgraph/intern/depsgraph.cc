@@ -76,6 +76,7 @@ Depsgraph::Depsgraph()
 	BLI_spin_init(&lock);
 	id_hash = BLI_ghash_ptr_new("Depsgraph id hash");
 	entry_tags = BLI_gset_ptr_new("Depsgraph entry_tags");
+	relations_tagged_ids = BLI_gset_ptr_new("Depsgraph relations_tagged_ids");
 }
 
 Depsgraph::~Depsgraph()
@@ -83,6 +84,7 @@ Depsgraph::~Depsgraph()
 	clear_id_nodes();
 	BLI_ghash_free(id_hash, NULL, NULL);
 	BLI_gset_free(entry_tags, NULL);
+	BLI_gset_free(relations_tagged_ids, NULL);
 	if (time_source != NULL) {
 		OBJECT_GUARDED_DELETE(time_source, TimeSourceDepsNode);
 	}
@@ -291,9 +293,19 @@ IDDepsNode *Depsgraph::add_id_node(ID *id, const char *name)
 	return id_node;
 }
 
+void Depsgraph::remove_id_node(const ID *id)
+{
+	BLI_ghash_remove(id_hash, id, NULL, id_node_deleter);
+}
+
 void Depsgraph::clear_id_nodes()
 {
 	BLI_ghash_clear(id_hash, NULL, id_node_deleter);
+	/* Relations removed from the nodes are not freed by them. */
+	foreach (DepsRelation *rel, reduced_relations) {
+		OBJECT_GUARDED_DELETE(rel, DepsRelation);
+	}
+	reduced_relations.clear();
 }
 
 /* Add new relationship between two nodes. */
@@ -338,7 +350,8 @@ DepsRelation::DepsRelation(DepsNode *from,
   : from(from),
     to(to),
     name(description),
-    flag(0)
+    flag(0),
+    owner_id(NULL)
 {
 #ifndef NDEBUG
 /*
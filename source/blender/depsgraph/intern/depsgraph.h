@@ -79,6 +79,11 @@ struct DepsRelation {
 
 	int flag;                     /* (eDepsRelation_Flag) */
 
+	/* Data-block which relations were being built when this relation was
+	 * added, used to know what to rebuild on partial relations update.
+	 */
+	ID *owner_id;
+
 	DepsRelation(DepsNode *from,
 	             DepsNode *to,
 	             const char *description);
@@ -112,6 +117,7 @@ struct Depsgraph {
 
 	IDDepsNode *find_id_node(const ID *id) const;
 	IDDepsNode *add_id_node(ID *id, const char *name = "");
+	void remove_id_node(const ID *id);
 	void clear_id_nodes();
 
 	/* Add new relationship between two nodes. */
@@ -141,6 +147,18 @@ struct Depsgraph {
 	/* Indicates whether relations needs to be updated. */
 	bool need_update;
 
+	/* IDs which relations needs to be updated, used when the whole graph
+	 * does not need to be rebuilt.
+	 */
+	GSet *relations_tagged_ids;
+
+	/* Relations removed by the transitive reduction. They are not linked to
+	 * the nodes any more, but kept to be restored before relations are
+	 * rebuilt incrementally, since builders of objects which aren't rebuilt
+	 * would not add them again.
+	 */
+	vector<DepsRelation *> reduced_relations;
+
 	/* Quick-Access Temp Data ............. */
 
 	/* Nodes which have been tagged as "directly modified". */
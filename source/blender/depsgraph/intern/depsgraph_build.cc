@@ -49,9 +49,11 @@ extern "C" {
 #include "DNA_object_force.h"
 
 #include "BKE_main.h"
+#include "BKE_animsys.h"
 #include "BKE_collision.h"
 #include "BKE_effect.h"
 #include "BKE_modifier.h"
+#include "BKE_playback_cache.h"
 } /* extern "C" */
 
 #include "DEG_depsgraph.h"
@@ -60,6 +62,7 @@ extern "C" {
 
 #include "builder/deg_builder.h"
 #include "builder/deg_builder_cycle.h"
+#include "builder/deg_builder_incremental.h"
 #include "builder/deg_builder_nodes.h"
 #include "builder/deg_builder_relations.h"
 #include "builder/deg_builder_transitive.h"
@@ -204,6 +207,7 @@ void DEG_graph_build_from_scene(Depsgraph *graph, Main *bmain, Scene *scene)
 #endif
 
 	DEG::Depsgraph *deg_graph = reinterpret_cast<DEG::Depsgraph *>(graph);
+	const int mem_category = MEM_category_begin(MEM_CATEGORY_DEPSGRAPH);
 
 	/* 1) Generate all the nodes in the graph first */
 	DEG::DepsgraphNodeBuilder node_builder(bmain, deg_graph);
@@ -225,9 +229,7 @@ void DEG_graph_build_from_scene(Depsgraph *graph, Main *bmain, Scene *scene)
 	/* TODO: it would be useful to have an option to disable this in cases where
 	 *       it is causing trouble.
 	 */
-	if (G.debug_value == 799) {
-		DEG::deg_graph_transitive_reduction(deg_graph);
-	}
+	DEG::deg_graph_transitive_reduction(deg_graph);
 
 	/* 4) Flush visibility layer and re-schedule nodes for update. */
 	DEG::deg_graph_build_finalize(deg_graph);
@@ -239,6 +241,8 @@ void DEG_graph_build_from_scene(Depsgraph *graph, Main *bmain, Scene *scene)
 	}
 #endif
 
+	MEM_category_end(mem_category);
+
 #ifdef DEBUG_TIME
 	TIMEIT_END(DEG_graph_build_from_scene);
 #endif
@@ -254,6 +258,8 @@ void DEG_graph_tag_relations_update(Depsgraph *graph)
 /* Tag all relations for update. */
 void DEG_relations_tag_update(Main *bmain)
 {
+	BKE_animsys_eval_cache_invalidate();
+	BKE_playback_cache_invalidate();
 	for (Scene *scene = (Scene *)bmain->scene.first;
 	     scene != NULL;
 	     scene = (Scene *)scene->id.next)
@@ -264,6 +270,34 @@ void DEG_relations_tag_update(Main *bmain)
 	}
 }
 
+void DEG_graph_tag_relations_update_id(Depsgraph *graph, ID *id)
+{
+	DEG::Depsgraph *deg_graph = reinterpret_cast<DEG::Depsgraph *>(graph);
+	if (deg_graph->need_update) {
+		/* Whole graph will be rebuilt anyway. */
+		return;
+	}
+	if (deg_graph->find_id_node(id) == NULL) {
+		/* ID is not used by the graph, its relations can't affect it. */
+		return;
+	}
+	BLI_gset_add(deg_graph->relations_tagged_ids, id);
+}
+
+void DEG_id_relations_tag_update(Main *bmain, ID *id)
+{
+	BKE_animsys_eval_cache_invalidate();
+	BKE_playback_cache_invalidate();
+	for (Scene *scene = (Scene *)bmain->scene.first;
+	     scene != NULL;
+	     scene = (Scene *)scene->id.next)
+	{
+		if (scene->depsgraph != NULL) {
+			DEG_graph_tag_relations_update_id(scene->depsgraph, id);
+		}
+	}
+}
+
 /* Create new graph if didn't exist yet,
  * or update relations if graph was tagged for update.
  */
@@ -278,14 +312,26 @@ void DEG_scene_relations_update(Main *bmain, Scene *scene)
 
 	DEG::Depsgraph *graph = reinterpret_cast<DEG::Depsgraph *>(scene->depsgraph);
 	if (!graph->need_update) {
-		/* Graph is up to date, nothing to do. */
-		return;
+		if (BLI_gset_size(graph->relations_tagged_ids) == 0) {
+			/* Graph is up to date, nothing to do. */
+			return;
+		}
+		/* Try to only rebuild the part of the graph around tagged IDs. */
+		const bool updated = DEG::deg_graph_build_incremental(graph, bmain, scene);
+		BLI_gset_clear(graph->relations_tagged_ids, NULL);
+		if (updated) {
+			if (G.debug & G_DEBUG_DEPSGRAPH) {
+				DEG_debug_scene_relations_validate(bmain, scene);
+			}
+			return;
+		}
 	}
 
 	/* Clear all previous nodes and operations. */
 	graph->clear_all_nodes();
 	graph->operations.clear();
 	BLI_gset_clear(graph->entry_tags, NULL);
+	BLI_gset_clear(graph->relations_tagged_ids, NULL);
 
 	/* Build new nodes and relations. */
 	DEG_graph_build_from_scene(reinterpret_cast< ::Depsgraph * >(graph),
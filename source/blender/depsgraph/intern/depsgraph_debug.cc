@@ -30,6 +30,9 @@
  * Implementation of tools for debugging the depsgraph
  */
 
+#include <algorithm>
+#include <iterator>
+
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
 
@@ -42,6 +45,9 @@ extern "C" {
 #include "DEG_depsgraph_build.h"
 
 #include "intern/eval/deg_eval_debug.h"
+#include "intern/nodes/deg_node.h"
+#include "intern/nodes/deg_node_component.h"
+#include "intern/nodes/deg_node_operation.h"
 #include "intern/depsgraph_intern.h"
 #include "util/deg_util_foreach.h"
 
@@ -65,6 +71,33 @@ DepsgraphStatsID *DEG_stats_id(ID *id)
 	return DEG::DepsgraphDebug::get_id_stats(id, false);
 }
 
+static std::string deg_debug_node_identifier(const DEG::DepsNode *node)
+{
+	if (node->type == DEG::DEG_NODE_TYPE_OPERATION) {
+		return ((const DEG::OperationDepsNode *)node)->full_identifier();
+	}
+	return node->identifier();
+}
+
+/* Sorted identifiers of all relations, duplicated relations are only
+ * listed once.
+ */
+static std::vector<std::string> deg_debug_relation_identifiers(const DEG::Depsgraph *graph)
+{
+	std::vector<std::string> identifiers;
+	foreach (DEG::OperationDepsNode *node, graph->operations) {
+		foreach (DEG::DepsRelation *rel, node->inlinks) {
+			identifiers.push_back(deg_debug_node_identifier(rel->from) + " -> " +
+			                      deg_debug_node_identifier(rel->to) + " (" +
+			                      rel->name + ")");
+		}
+	}
+	std::sort(identifiers.begin(), identifiers.end());
+	identifiers.erase(std::unique(identifiers.begin(), identifiers.end()),
+	                  identifiers.end());
+	return identifiers;
+}
+
 bool DEG_debug_compare(const struct Depsgraph *graph1,
                        const struct Depsgraph *graph2)
 {
@@ -75,13 +108,24 @@ bool DEG_debug_compare(const struct Depsgraph *graph1,
 	if (deg_graph1->operations.size() != deg_graph2->operations.size()) {
 		return false;
 	}
-	/* TODO(sergey): Currently we only do real stupid check,
-	 * which is fast but which isn't 100% reliable.
-	 *
-	 * Would be cool to make it more robust, but it's good enough
-	 * for now. Also, proper graph check is actually NP-complex
-	 * problem..
+	/* Operations are matched by their identifiers, which is not 100% reliable
+	 * when different data-blocks share the same name, but is good enough to
+	 * catch missing and extra relations. Proper graph check is actually
+	 * NP-complex problem..
 	 */
+	const std::vector<std::string> relations1 = deg_debug_relation_identifiers(deg_graph1);
+	const std::vector<std::string> relations2 = deg_debug_relation_identifiers(deg_graph2);
+	if (relations1 != relations2) {
+		std::vector<std::string> difference;
+		std::set_symmetric_difference(relations1.begin(), relations1.end(),
+		                              relations2.begin(), relations2.end(),
+		                              std::back_inserter(difference));
+		foreach (const std::string &identifier, difference) {
+			fprintf(stderr, "Relation only in one of the graphs: %s\n",
+			        identifier.c_str());
+		}
+		return false;
+	}
 	return true;
 }
 
@@ -45,10 +45,12 @@ extern "C" {
 #include "DNA_windowmanager_types.h"
 
 
+#include "BKE_animsys.h"
 #include "BKE_idcode.h"
 #include "BKE_library.h"
 #include "BKE_main.h"
 #include "BKE_node.h"
+#include "BKE_playback_cache.h"
 
 #define new new_
 #include "BKE_screen.h"
@@ -211,6 +213,8 @@ void DEG_id_tag_update_ex(Main *bmain, ID *id, short flag)
 	}
 	DEG_DEBUG_PRINTF("%s: id=%s flag=%d\n", __func__, id->name, flag);
 	lib_id_recalc_tag_flag(bmain, id, flag);
+	BKE_animsys_eval_cache_invalidate();
+	BKE_playback_cache_invalidate();
 	for (Scene *scene = (Scene *)bmain->scene.first;
 	     scene != NULL;
 	     scene = (Scene *)scene->id.next)
@@ -32,11 +32,14 @@
 
 #include "intern/eval/deg_eval.h"
 
+#include <algorithm>
+
 #include "PIL_time.h"
 
 #include "BLI_utildefines.h"
 #include "BLI_task.h"
 #include "BLI_ghash.h"
+#include "BLI_trace.h"
 
 extern "C" {
 #include "BKE_depsgraph.h"
@@ -56,45 +59,67 @@ extern "C" {
 #include "intern/depsgraph_intern.h"
 #include "util/deg_util_foreach.h"
 
-/* Unfinished and unused, and takes quite some pre-processing time. */
-#undef USE_EVAL_PRIORITY
+/* Schedule operations on the longest chains first, using the time each
+ * operation took in previous evaluations.
+ */
+#define USE_EVAL_PRIORITY
 
-/* Use integrated debugger to keep track how much each of the nodes was
- * evaluating.
+#ifdef USE_EVAL_PRIORITY
+/* Weight of the latest evaluation time in the running average of an
+ * operation's cost.
  */
-#undef USE_DEBUGGER
+#  define EVAL_COST_FACTOR 0.25f
+/* Cost of operations which were not evaluated yet, or are too cheap to
+ * measure, so longer chains of those still get a higher priority.
+ */
+#  define EVAL_COST_MIN 1e-6f
+#endif
+
+/* Maximum number of operations which are made ready to be evaluated at once,
+ * before they are pushed to the task pool.
+ */
+#define READY_QUEUE_SIZE 256
 
 namespace DEG {
 
 /* ********************** */
 /* Evaluation Entrypoints */
 
+/* Operations which became ready for evaluation, these are ordered by their
+ * priority before being pushed to the task pool.
+ */
+typedef struct ReadyQueue {
+	TaskPool *pool;
+	int thread_id;
+	/* The first pushed task goes to the thread's local queue and is the next
+	 * one to be evaluated by this thread.
+	 */
+	bool use_local_queue;
+	/* Note the time operations become ready, for the evaluation timings. */
+	bool do_timing;
+	int num_nodes;
+	OperationDepsNode *nodes[READY_QUEUE_SIZE];
+} ReadyQueue;
+
 /* Forward declarations. */
-static void schedule_children(TaskPool *pool,
+static void schedule_children(ReadyQueue *queue,
                               Depsgraph *graph,
                               OperationDepsNode *node,
-                              const unsigned int layers,
-                              const int thread_id);
+                              const unsigned int layers);
+static void schedule_ready_queue(ReadyQueue *queue);
 
 struct DepsgraphEvalState {
 	EvaluationContext *eval_ctx;
 	Depsgraph *graph;
 	unsigned int layers;
+	/* Record timings of every operation (--debug-depsgraph-time). */
+	bool do_timing;
 };
 
-static void deg_task_run_func(TaskPool *pool,
-                              void *taskdata,
-                              int thread_id)
+static void deg_task_evaluate_node(DepsgraphEvalState *state,
+                                   OperationDepsNode *node,
+                                   int thread_id)
 {
-	DepsgraphEvalState *state =
-	        reinterpret_cast<DepsgraphEvalState *>(BLI_task_pool_userdata(pool));
-	OperationDepsNode *node = reinterpret_cast<OperationDepsNode *>(taskdata);
-
-	BLI_assert(!node->is_noop() && "NOOP nodes should not actually be scheduled");
-
-	/* Should only be the case for NOOPs, which never get to this point. */
-	BLI_assert(node->evaluate);
-
 	/* Get context. */
 	/* TODO: Who initialises this? "Init" operations aren't able to
 	 * initialise it!!!
@@ -108,26 +133,106 @@ static void deg_task_run_func(TaskPool *pool,
 	 * but that's all fine, we'll just scheduler it's children.
 	 */
 	if (node->evaluate) {
-			/* Take note of current time. */
-#ifdef USE_DEBUGGER
-		double start_time = PIL_check_seconds_timer();
-		DepsgraphDebug::task_started(state->graph, node);
-#endif
+		/* Take note of current time. */
+		const double start_time = PIL_check_seconds_timer();
 
 		/* Perform operation. */
-		node->evaluate(state->eval_ctx);
-
-			/* Note how long this took. */
-#ifdef USE_DEBUGGER
-		double end_time = PIL_check_seconds_timer();
-		DepsgraphDebug::task_completed(state->graph,
-		                               node,
-		                               end_time - start_time);
+		if (BLI_trace_is_enabled()) {
+			const string identifier = node->full_identifier();
+			BLI_trace_zone_begin(identifier.c_str());
+			node->evaluate(state->eval_ctx);
+			BLI_trace_zone_end();
+		}
+		else {
+			node->evaluate(state->eval_ctx);
+		}
+
+		/* Note how long this took, only this thread evaluates the node so
+		 * there is no need for atomics.
+		 */
+		const float eval_time = (float)(PIL_check_seconds_timer() - start_time);
+#ifdef USE_EVAL_PRIORITY
+		if (node->eval_cost == 0.0f) {
+			node->eval_cost = eval_time;
+		}
+		else {
+			node->eval_cost += (eval_time - node->eval_cost) * EVAL_COST_FACTOR;
+		}
 #endif
+		if (state->do_timing) {
+			node->eval_time = eval_time;
+			node->wait_time = (float)(start_time - node->ready_time);
+			node->eval_thread_id = thread_id;
+		}
+	}
+	else if (state->do_timing) {
+		node->eval_thread_id = thread_id;
+	}
+}
+
+/* Get next operation of the chain if it is to be evaluated right after the
+ * given one, taking over its scheduling.
+ */
+static OperationDepsNode *deg_task_chain_next(OperationDepsNode *node,
+                                              const unsigned int layers)
+{
+	OperationDepsNode *next = node->chain_next;
+	if (next == NULL) {
+		return NULL;
+	}
+	if ((next->flag & DEPSOP_FLAG_NEEDS_UPDATE) == 0 ||
+	    (next->owner->owner->layers & layers) == 0)
+	{
+		return NULL;
+	}
+	/* The node is the only parent of the next one, so no other thread is
+	 * touching it and there is no need for atomics here.
+	 */
+	BLI_assert(next->num_links_pending == 1);
+	BLI_assert(!next->scheduled);
+	next->num_links_pending = 0;
+	next->scheduled = true;
+	return next;
+}
+
+static void deg_task_run_func(TaskPool *pool,
+                              void *taskdata,
+                              int thread_id)
+{
+	DepsgraphEvalState *state =
+	        reinterpret_cast<DepsgraphEvalState *>(BLI_task_pool_userdata(pool));
+	OperationDepsNode *node = reinterpret_cast<OperationDepsNode *>(taskdata);
+
+	BLI_assert(!node->is_noop() && "NOOP nodes should not actually be scheduled");
+
+	/* Should only be the case for NOOPs, which never get to this point. */
+	BLI_assert(node->evaluate);
+
+	/* Evaluate the whole chain of operations starting at this node, only the
+	 * children of the last one are going via the task pool.
+	 */
+	for (;;) {
+		deg_task_evaluate_node(state, node, thread_id);
+		OperationDepsNode *next = deg_task_chain_next(node, state->layers);
+		if (next == NULL) {
+			break;
+		}
+		if (state->do_timing) {
+			next->ready_time = PIL_check_seconds_timer();
+		}
+		node = next;
 	}
 
+	ReadyQueue queue;
+	queue.pool = pool;
+	queue.thread_id = thread_id;
+	queue.use_local_queue = true;
+	queue.do_timing = state->do_timing;
+	queue.num_nodes = 0;
+
 	BLI_task_pool_delayed_push_begin(pool, thread_id);
-	schedule_children(pool, state->graph, node, state->layers, thread_id);
+	schedule_children(&queue, state->graph, node, state->layers);
+	schedule_ready_queue(&queue);
 	BLI_task_pool_delayed_push_end(pool, thread_id);
 }
 
@@ -182,6 +287,9 @@ static void calculate_pending_parents(Depsgraph *graph, unsigned int layers)
 }
 
 #ifdef USE_EVAL_PRIORITY
+/* Priority is the cost of the critical path starting at the node: its own
+ * cost plus the most expensive chain of operations depending on it.
+ */
 static void calculate_eval_priority(OperationDepsNode *node)
 {
 	if (node->done) {
@@ -190,16 +298,19 @@ static void calculate_eval_priority(OperationDepsNode *node)
 	node->done = 1;
 
 	if (node->flag & DEPSOP_FLAG_NEEDS_UPDATE) {
-		/* XXX standard cost of a node, could be estimated somewhat later on */
-		const float cost = 1.0f;
-		/* NOOP nodes have no cost */
-		node->eval_priority = node->is_noop() ? cost : 0.0f;
+		float children_priority = 0.0f;
 
 		foreach (DepsRelation *rel, node->outlinks) {
 			OperationDepsNode *to = (OperationDepsNode *)rel->to;
 			BLI_assert(to->type == DEG_NODE_TYPE_OPERATION);
 			calculate_eval_priority(to);
-			node->eval_priority += to->eval_priority;
+			children_priority = std::max(children_priority, to->eval_priority);
+		}
+
+		/* NOOP nodes have no cost */
+		node->eval_priority = children_priority;
+		if (!node->is_noop()) {
+			node->eval_priority += std::max(node->eval_cost, EVAL_COST_MIN);
 		}
 	}
 	else {
@@ -212,9 +323,8 @@ static void calculate_eval_priority(OperationDepsNode *node)
  *   dec_parents: Decrement pending parents count, true when child nodes are
  *                scheduled after a task has been completed.
  */
-static void schedule_node(TaskPool *pool, Depsgraph *graph, unsigned int layers,
-                          OperationDepsNode *node, bool dec_parents,
-                          const int thread_id)
+static void schedule_node(ReadyQueue *queue, Depsgraph *graph, unsigned int layers,
+                          OperationDepsNode *node, bool dec_parents)
 {
 	unsigned int id_layers = node->owner->owner->layers;
 
@@ -232,36 +342,95 @@ static void schedule_node(TaskPool *pool, Depsgraph *graph, unsigned int layers,
 			if (!is_scheduled) {
 				if (node->is_noop()) {
 					/* skip NOOP node, schedule children right away */
-					schedule_children(pool, graph, node, layers, thread_id);
+					schedule_children(queue, graph, node, layers);
 				}
 				else {
 					/* children are scheduled once this task is completed */
-					BLI_task_pool_push_from_thread(pool,
-					                               deg_task_run_func,
-					                               node,
-					                               false,
-					                               TASK_PRIORITY_HIGH,
-					                               thread_id);
+					if (queue->num_nodes == READY_QUEUE_SIZE) {
+						schedule_ready_queue(queue);
+					}
+					if (queue->do_timing) {
+						node->ready_time = PIL_check_seconds_timer();
+					}
+					queue->nodes[queue->num_nodes++] = node;
 				}
 			}
 		}
 	}
 }
 
+#ifdef USE_EVAL_PRIORITY
+static bool operation_priority_cmp(const OperationDepsNode *a,
+                                   const OperationDepsNode *b)
+{
+	return a->eval_priority > b->eval_priority;
+}
+#endif
+
+/* Push all operations from the queue to the task pool, so the one with the
+ * highest priority is evaluated first.
+ */
+static void schedule_ready_queue(ReadyQueue *queue)
+{
+	int i = 0;
+
+	if (queue->num_nodes == 0) {
+		return;
+	}
+
+#ifdef USE_EVAL_PRIORITY
+	std::sort(queue->nodes,
+	          queue->nodes + queue->num_nodes,
+	          operation_priority_cmp);
+#endif
+
+	if (queue->use_local_queue) {
+		BLI_task_pool_push_from_thread(queue->pool,
+		                               deg_task_run_func,
+		                               queue->nodes[0],
+		                               false,
+		                               TASK_PRIORITY_HIGH,
+		                               queue->thread_id);
+		i = 1;
+	}
+
+	/* High priority tasks are taken from the head of the queue, so the most
+	 * important ones are pushed last.
+	 */
+	for (int j = queue->num_nodes - 1; j >= i; j--) {
+		BLI_task_pool_push_from_thread(queue->pool,
+		                               deg_task_run_func,
+		                               queue->nodes[j],
+		                               false,
+		                               TASK_PRIORITY_HIGH,
+		                               queue->thread_id);
+	}
+
+	queue->num_nodes = 0;
+}
+
 static void schedule_graph(TaskPool *pool,
                            Depsgraph *graph,
-                           const unsigned int layers)
+                           const unsigned int layers,
+                           const bool do_timing)
 {
+	ReadyQueue queue;
+	queue.pool = pool;
+	queue.thread_id = 0;
+	queue.use_local_queue = false;
+	queue.do_timing = do_timing;
+	queue.num_nodes = 0;
+
 	foreach (OperationDepsNode *node, graph->operations) {
-		schedule_node(pool, graph, layers, node, false, 0);
+		schedule_node(&queue, graph, layers, node, false);
 	}
+	schedule_ready_queue(&queue);
 }
 
-static void schedule_children(TaskPool *pool,
+static void schedule_children(ReadyQueue *queue,
                               Depsgraph *graph,
                               OperationDepsNode *node,
-                              const unsigned int layers,
-                              const int thread_id)
+                              const unsigned int layers)
 {
 	foreach (DepsRelation *rel, node->outlinks) {
 		OperationDepsNode *child = (OperationDepsNode *)rel->to;
@@ -270,12 +439,11 @@ static void schedule_children(TaskPool *pool,
 			/* Happens when having cyclic dependencies. */
 			continue;
 		}
-		schedule_node(pool,
+		schedule_node(queue,
 		              graph,
 		              layers,
 		              child,
-		              (rel->flag & DEPSREL_FLAG_CYCLIC) == 0,
-		              thread_id);
+		              (rel->flag & DEPSREL_FLAG_CYCLIC) == 0);
 	}
 }
 
@@ -312,6 +480,7 @@ void deg_evaluate_on_refresh(EvaluationContext *eval_ctx,
 	state.eval_ctx = eval_ctx;
 	state.graph = graph;
 	state.layers = layers;
+	state.do_timing = (G.debug & G_DEBUG_DEPSGRAPH_TIME) != 0;
 
 	TaskScheduler *task_scheduler;
 	bool need_free_scheduler;
@@ -332,6 +501,11 @@ void deg_evaluate_on_refresh(EvaluationContext *eval_ctx,
 	/* Clear tags. */
 	foreach (OperationDepsNode *node, graph->operations) {
 		node->done = 0;
+		if (state.do_timing) {
+			node->eval_time = 0.0f;
+			node->wait_time = 0.0f;
+			node->eval_thread_id = -1;
+		}
 	}
 
 	/* Calculate priority for operation nodes. */
@@ -342,12 +516,17 @@ void deg_evaluate_on_refresh(EvaluationContext *eval_ctx,
 #endif
 
 	DepsgraphDebug::eval_begin(eval_ctx);
+	const double start_time = PIL_check_seconds_timer();
 
-	schedule_graph(task_pool, graph, layers);
+	schedule_graph(task_pool, graph, layers, state.do_timing);
 
 	BLI_task_pool_work_and_wait(task_pool);
 	BLI_task_pool_free(task_pool);
 
+	if (state.do_timing) {
+		DepsgraphDebug::eval_timings_update(graph,
+		                                    PIL_check_seconds_timer() - start_time);
+	}
 	DepsgraphDebug::eval_end(eval_ctx);
 
 	/* Clear any uncleared tags - just in case. */
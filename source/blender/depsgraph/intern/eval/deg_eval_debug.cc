@@ -48,6 +48,7 @@ extern "C" {
 #include "intern/nodes/deg_node_component.h"
 #include "intern/nodes/deg_node_operation.h"
 #include "intern/depsgraph_intern.h"
+#include "util/deg_util_foreach.h"
 
 namespace DEG {
 
@@ -56,7 +57,7 @@ DepsgraphStats *DepsgraphDebug::stats = NULL;
 static string get_component_name(eDepsNode_Type type, const char *name = "")
 {
 	DepsNodeFactory *factory = deg_get_node_factory(type);
-	if (name[0] != '\0') {
+	if (name[0] == '\0') {
 		return string(factory->tname());
 	}
 	else {
@@ -67,11 +68,15 @@ static string get_component_name(eDepsNode_Type type, const char *name = "")
 static void times_clear(DepsgraphStatsTimes &times)
 {
 	times.duration_last = 0.0f;
+	times.wait_last = 0.0f;
+	times.num_operations_last = 0;
 }
 
-static void times_add(DepsgraphStatsTimes &times, float time)
+static void times_add(DepsgraphStatsTimes &times, const OperationDepsNode *node)
 {
-	times.duration_last += time;
+	times.duration_last += node->eval_time;
+	times.wait_last += node->wait_time;
+	times.num_operations_last++;
 }
 
 void DepsgraphDebug::eval_begin(const EvaluationContext *UNUSED(eval_ctx))
@@ -97,62 +102,50 @@ void DepsgraphDebug::eval_step(const EvaluationContext *UNUSED(eval_ctx),
 #endif
 }
 
-void DepsgraphDebug::task_started(Depsgraph *graph,
-                                  const OperationDepsNode *node)
+void DepsgraphDebug::eval_timings_update(const Depsgraph *graph, double time)
 {
-	if (stats) {
-		BLI_spin_lock(&graph->lock);
-
-		ComponentDepsNode *comp = node->owner;
-		ID *id = comp->owner->id;
-
-		DepsgraphStatsID *id_stats = get_id_stats(id, true);
-		times_clear(id_stats->times);
-
-		/* XXX TODO use something like: if (id->flag & ID_DEG_DETAILS) {...} */
-		if (0) {
-			/* XXX component name usage needs cleanup! currently mixes identifier
-			 * and description strings!
-			 */
-			DepsgraphStatsComponent *comp_stats =
-			        get_component_stats(id, get_component_name(comp->type,
-			                                                   comp->name).c_str(),
-			                            true);
-			times_clear(comp_stats->times);
-		}
+	verify_stats();
 
-		BLI_spin_unlock(&graph->lock);
-	}
-}
+	stats->duration_last = (float)time;
+	times_clear(stats->times);
 
-void DepsgraphDebug::task_completed(Depsgraph *graph,
-                                    const OperationDepsNode *node,
-                                    double time)
-{
-	if (stats) {
-		BLI_spin_lock(&graph->lock);
-
-		ComponentDepsNode *comp = node->owner;
-		ID *id = comp->owner->id;
-
-		DepsgraphStatsID *id_stats = get_id_stats(id, true);
-		times_add(id_stats->times, time);
-
-		/* XXX TODO use something like: if (id->flag & ID_DEG_DETAILS) {...} */
-		if (0) {
-			/* XXX component name usage needs cleanup! currently mixes identifier
-			 * and description strings!
-			 */
-			DepsgraphStatsComponent *comp_stats =
-			        get_component_stats(id,
-			                            get_component_name(comp->type,
-			                                               comp->name).c_str(),
-			                            true);
-			times_add(comp_stats->times, time);
+	GHASH_FOREACH_BEGIN(IDDepsNode *, id_node, graph->id_hash)
+	{
+		DepsgraphStatsID *id_stats = NULL;
+		GHASH_FOREACH_BEGIN(ComponentDepsNode *, comp, id_node->components)
+		{
+			DepsgraphStatsComponent *comp_stats = NULL;
+			foreach (OperationDepsNode *op_node, comp->operations) {
+				if (op_node->eval_thread_id == -1 || op_node->is_noop()) {
+					continue;
+				}
+				/* Only data-blocks which were evaluated get their stats
+				 * replaced, others keep the ones from their last update.
+				 */
+				if (id_stats == NULL) {
+					id_stats = get_id_stats(id_node->id, true);
+					times_clear(id_stats->times);
+				}
+				if (comp_stats == NULL) {
+					/* XXX component name usage needs cleanup! currently mixes
+					 * identifier and description strings!
+					 */
+					comp_stats = get_component_stats(
+					        id_stats,
+					        get_component_name(comp->type, comp->name).c_str(),
+					        true);
+					times_clear(comp_stats->times);
+				}
+				times_add(comp_stats->times, op_node);
+				times_add(id_stats->times, op_node);
+				times_add(stats->times, op_node);
+			}
 		}
-
-		BLI_spin_unlock(&graph->lock);
+		GHASH_FOREACH_END();
 	}
+	GHASH_FOREACH_END();
+
+	DEG_debug_timings(reinterpret_cast<const ::Depsgraph *>(graph), stdout, false);
 }
 
 /* ********** */
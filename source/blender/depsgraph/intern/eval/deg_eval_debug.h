@@ -43,7 +43,6 @@ namespace DEG {
 
 struct Depsgraph;
 struct DepsgraphSettings;
-struct OperationDepsNode;
 
 struct DepsgraphDebug {
 	static DepsgraphStats *stats;
@@ -59,10 +58,10 @@ struct DepsgraphDebug {
 	static void eval_step(const EvaluationContext *eval_ctx,
 	                      const char *message);
 
-	static void task_started(Depsgraph *graph, const OperationDepsNode *node);
-	static void task_completed(Depsgraph *graph,
-	                           const OperationDepsNode *node,
-	                           double time);
+	/* Gather timings recorded by the operations during the last evaluation
+	 * into the statistics, and print them.
+	 */
+	static void eval_timings_update(const Depsgraph *graph, double time);
 
 	static DepsgraphStatsID *get_id_stats(ID *id, bool create);
 	static DepsgraphStatsComponent *get_component_stats(DepsgraphStatsID *id_stats,
@@ -244,9 +244,10 @@ void ComponentDepsNode::set_exit_operation(OperationDepsNode *op_node)
 void ComponentDepsNode::clear_operations()
 {
 	if (operations_map != NULL) {
+		/* Operations are owned by the vector after the graph is built. */
 		BLI_ghash_clear(operations_map,
 		                comp_node_hash_key_free,
-		                comp_node_hash_value_free);
+		                operations.empty() ? comp_node_hash_value_free : NULL);
 	}
 	foreach (OperationDepsNode *op_node, operations) {
 		OBJECT_GUARDED_DELETE(op_node, OperationDepsNode);
@@ -264,7 +265,7 @@ void ComponentDepsNode::tag_update(Depsgraph *graph)
 		op_node->tag_update(graph);
 	}
 	// It is possible that tag happens before finalization.
-	if (operations_map != NULL) {
+	if (operations.empty() && operations_map != NULL) {
 		GHASH_FOREACH_BEGIN(OperationDepsNode *, op_node, operations_map)
 		{
 			op_node->tag_update(graph);
@@ -321,16 +322,14 @@ OperationDepsNode *ComponentDepsNode::get_exit_operation()
 
 void ComponentDepsNode::finalize_build()
 {
+	/* Might be called again after partial relations update. */
+	operations.clear();
 	operations.reserve(BLI_ghash_size(operations_map));
 	GHASH_FOREACH_BEGIN(OperationDepsNode *, op_node, operations_map)
 	{
 		operations.push_back(op_node);
 	}
 	GHASH_FOREACH_END();
-	BLI_ghash_free(operations_map,
-	               comp_node_hash_key_free,
-	               NULL);
-	operations_map = NULL;
 }
 
 /* Parameter Component Defines ============================ */
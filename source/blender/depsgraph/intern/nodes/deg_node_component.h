@@ -138,12 +138,14 @@ struct ComponentDepsNode : public DepsNode {
 	/* ** Inner nodes for this component ** */
 
 	/* Operations stored as a hash map, for faster build.
-	 * This hash map will be freed when graph is fully built.
+	 * It owns the operations until the graph is fully built, after that it is
+	 * only kept for lookups when relations are partially rebuilt.
 	 */
 	GHash *operations_map;
 
 	/* This is a "normal" list of operations, used by evaluation
 	 * and other routines after construction.
+	 * Owns the operations once the graph is built.
 	 */
 	vector<OperationDepsNode *> operations;
 
@@ -45,6 +45,12 @@ namespace DEG {
 
 OperationDepsNode::OperationDepsNode() :
     eval_priority(0.0f),
+    eval_cost(0.0f),
+    chain_next(NULL),
+    ready_time(0.0),
+    eval_time(0.0f),
+    wait_time(0.0f),
+    eval_thread_id(-1),
     flag(0),
     customdata_mask(0)
 {
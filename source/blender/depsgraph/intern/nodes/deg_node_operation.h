@@ -79,7 +79,24 @@ struct OperationDepsNode : public DepsNode {
 
 	/* How many inlinks are we still waiting on before we can be evaluated. */
 	uint32_t num_links_pending;
+	/* Longest evaluation time (in seconds) of a chain of operations starting at this one. */
 	float eval_priority;
+	/* Running average of the time (in seconds) this operation took to evaluate,
+	 * zero until it was evaluated once. */
+	float eval_cost;
+	/* Next operation of a linear chain: it depends on this operation only,
+	 * and nothing else depends on this operation. It is evaluated by the
+	 * same task right after this one, without going via the task pool.
+	 */
+	OperationDepsNode *chain_next;
+
+	/* Timings of the last evaluation, only recorded with --debug-depsgraph-time.
+	 * The thread is -1 when the operation was not evaluated.
+	 */
+	double ready_time;
+	float eval_time;
+	float wait_time;
+	int eval_thread_id;
 	bool scheduled;
 
 	/* Identifier for the operation being performed. */
@@ -41,6 +41,7 @@
 #include "BLI_path_util.h"
 #include "BLI_math.h"
 
+#include "BKE_animsys.h"
 #include "BKE_context.h"
 #include "BKE_depsgraph.h"
 #include "BKE_library.h"
@@ -1005,6 +1006,7 @@ static void mesh_add_verts(Mesh *mesh, int len)
 
 	/* set final vertex list size */
 	mesh->totvert = totvert;
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static void mesh_add_edges(Mesh *mesh, int len)
@@ -1035,6 +1037,7 @@ static void mesh_add_edges(Mesh *mesh, int len)
 		medge->flag = ME_EDGEDRAW | ME_EDGERENDER | SELECT;
 
 	mesh->totedge = totedge;
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static void mesh_add_tessfaces(Mesh *mesh, int len)
@@ -1065,6 +1068,7 @@ static void mesh_add_tessfaces(Mesh *mesh, int len)
 		mface->flag = ME_FACE_SEL;
 
 	mesh->totface = totface;
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static void mesh_add_loops(Mesh *mesh, int len)
@@ -1089,6 +1093,7 @@ static void mesh_add_loops(Mesh *mesh, int len)
 	BKE_mesh_update_customdata_pointers(mesh, true);
 
 	mesh->totloop = totloop;
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static void mesh_add_polys(Mesh *mesh, int len)
@@ -1119,6 +1124,7 @@ static void mesh_add_polys(Mesh *mesh, int len)
 		mpoly->flag = ME_FACE_SEL;
 
 	mesh->totpoly = totpoly;
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static void mesh_remove_verts(Mesh *mesh, int len)
@@ -1133,6 +1139,7 @@ static void mesh_remove_verts(Mesh *mesh, int len)
 
 	/* set final vertex list size */
 	mesh->totvert = totvert;
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static void mesh_remove_edges(Mesh *mesh, int len)
@@ -1146,6 +1153,7 @@ static void mesh_remove_edges(Mesh *mesh, int len)
 	CustomData_free_elem(&mesh->edata, totedge, len);
 
 	mesh->totedge = totedge;
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static void mesh_remove_faces(Mesh *mesh, int len)
@@ -1159,6 +1167,7 @@ static void mesh_remove_faces(Mesh *mesh, int len)
 	CustomData_free_elem(&mesh->fdata, totface, len);
 
 	mesh->totface = totface;
+	BKE_animsys_eval_cache_invalidate();
 }
 
 #if 0
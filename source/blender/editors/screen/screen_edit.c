@@ -48,6 +48,7 @@
 #include "BKE_library_remap.h"
 #include "BKE_main.h"
 #include "BKE_node.h"
+#include "BKE_playback_cache.h"
 #include "BKE_screen.h"
 #include "BKE_scene.h"
 
@@ -1329,8 +1330,10 @@ void ED_screen_exit(bContext *C, wmWindow *window, bScreen *screen)
 
 	CTX_wm_window_set(C, window);
 	
-	if (screen->animtimer)
+	if (screen->animtimer) {
 		WM_event_remove_timer(wm, window, screen->animtimer);
+		BKE_playback_cache_end();
+	}
 	screen->animtimer = NULL;
 	screen->scrubbing = false;
 
@@ -2047,10 +2050,13 @@ void ED_screen_animation_timer(bContext *C, int redraws, int refresh, int sync,
 	if (stopscreen) {
 		WM_event_remove_timer(wm, win, stopscreen->animtimer);
 		stopscreen->animtimer = NULL;
+		BKE_playback_cache_end();
 	}
 	
 	if (enable) {
 		ScreenAnimData *sad = MEM_callocN(sizeof(ScreenAnimData), "ScreenAnimData");
+
+		BKE_playback_cache_begin(scene);
 		
 		screen->animtimer = WM_event_add_timer(wm, win, TIMER0, (1.0 / FPS));
 		
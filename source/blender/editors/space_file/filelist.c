@@ -69,6 +69,7 @@
 #include "BKE_icons.h"
 #include "BKE_idcode.h"
 #include "BKE_main.h"
+#include "BLO_fileindex.h"
 #include "BLO_readfile.h"
 
 #include "DNA_space_types.h"
@@ -2242,6 +2243,7 @@ static int filelist_readjob_list_lib(const char *root, ListBase *entries, const
 	bool ok;
 
 	struct BlendHandle *libfiledata = NULL;
+	BlendFileIndex *index = NULL;
 
 	/* name test */
 	ok = BLO_library_path_explode(root, dir, &group, NULL);
@@ -2249,23 +2251,33 @@ static int filelist_readjob_list_lib(const char *root, ListBase *entries, const
 		return nbr_entries;
 	}
 
-	/* there we go */
-	libfiledata = BLO_blendhandle_from_file(dir, NULL);
-	if (libfiledata == NULL) {
-		return nbr_entries;
+	/* there we go, files with an index don't have to be read */
+	index = BLO_fileindex_read(dir);
+	if (index == NULL) {
+		libfiledata = BLO_blendhandle_from_file(dir, NULL);
+		if (libfiledata == NULL) {
+			return nbr_entries;
+		}
 	}
 
 	/* memory for strings is passed into filelist[i].entry->relpath and freed in filelist_entry_free. */
 	if (group) {
 		idcode = groupname_to_code(group);
-		names = BLO_blendhandle_get_datablock_names(libfiledata, idcode, &nnames);
+		names = index ? BLO_fileindex_get_datablock_names(index, idcode, &nnames) :
+		                BLO_blendhandle_get_datablock_names(libfiledata, idcode, &nnames);
 	}
 	else {
-		names = BLO_blendhandle_get_linkable_groups(libfiledata);
+		names = index ? BLO_fileindex_get_linkable_groups(index) :
+		                BLO_blendhandle_get_linkable_groups(libfiledata);
 		nnames = BLI_linklist_count(names);
 	}
 
-	BLO_blendhandle_close(libfiledata);
+	if (index) {
+		BLO_fileindex_free(index);
+	}
+	else {
+		BLO_blendhandle_close(libfiledata);
+	}
 
 	if (!skip_currpar) {
 		entry = MEM_callocN(sizeof(*entry), __func__);
@@ -44,6 +44,7 @@
 #include "BLI_string.h"
 #include "BLI_path_util.h"
 #include "BLI_fileops.h"
+#include "BLI_trace.h"
 
 #include "imbuf.h"
 #include "IMB_allocimbuf.h"
@@ -223,7 +224,9 @@ ImBuf *IMB_loadiffname(const char *filepath, int flags, char colorspace[IM_MAX_S
 	if (file == -1)
 		return NULL;
 
+	BLI_trace_zone_begin("Image load");
 	ibuf = IMB_loadifffile(file, filepath, flags, colorspace, filepath_tx);
+	BLI_trace_zone_end();
 
 	if (ibuf) {
 		BLI_strncpy(ibuf->name, filepath, sizeof(ibuf->name));
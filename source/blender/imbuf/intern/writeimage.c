@@ -38,6 +38,7 @@
 
 #include "BLI_utildefines.h"
 #include "BLI_path_util.h"
+#include "BLI_trace.h"
 
 #include "IMB_imbuf_types.h"
 #include "IMB_imbuf.h"
@@ -69,7 +70,9 @@ short IMB_saveiff(struct ImBuf *ibuf, const char *name, int flags)
 
 			write_ibuf = prepare_write_imbuf(type, ibuf);
 
+			BLI_trace_zone_begin("Image save");
 			result = type->save(write_ibuf, name, flags);
+			BLI_trace_zone_end();
 
 			if (write_ibuf != ibuf)
 				IMB_freeImBuf(write_ibuf);
@@ -339,6 +339,9 @@ enum {
 	/* RESET_AFTER_USE tag newly duplicated/copied IDs.
 	 * Also used internally in readfile.c to mark datablocks needing do_versions. */
 	LIB_TAG_NEW             = 1 << 8,
+	/* RESET_NEVER linked datablock whose heavy data has not been read from its library yet,
+	 * see BLO_library_lazy_data_ensure(). */
+	LIB_TAG_LAZY_DATA       = 1 << 9,
 	/* RESET_BEFORE_USE free test flag.
      * TODO make it a RESET_AFTER_USE too. */
 	LIB_TAG_DOIT            = 1 << 10,
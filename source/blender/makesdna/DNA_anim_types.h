@@ -413,6 +413,7 @@ typedef struct ChannelDriver {
 	 */
 	char expression[256];	/* expression to compile for evaluation */
 	void *expr_comp; 		/* PyObject - compiled expression, don't save this */
+	struct ExprPyLike_Parsed *expr_simple;	/* expression compiled for evaluation without Python, don't save this */
 	
 	float curval;		/* result of previous evaluation */
 	float influence;	/* influence of driver on result */ // XXX to be implemented... this is like the constraint influence setting
@@ -913,6 +914,9 @@ typedef struct AnimData {
 	short act_blendmode;    /* accumulation mode for active action */
 	short act_extendmode;   /* extrapolation mode for active action */
 	float act_influence;    /* influence for active action */
+
+		/* runtime: RNA paths of the active action resolved for evaluation (not saved in files) */
+	struct AnimEvalCache *eval_cache;
 } AnimData;
 
 /* Animation Data settings (mostly for NLA) */
@@ -2085,6 +2085,7 @@ typedef enum eVGroupSelect {
 #define SCE_DS_COLLAPSED		(1<<1)
 #define SCE_NLA_EDIT_ON			(1<<2)
 #define SCE_FRAME_DROP			(1<<3)
+#define SCE_PLAYBACK_CACHE		(1<<4)
 
 
 	/* return flag BKE_scene_base_iter_next functions */
@@ -747,36 +747,23 @@ static eSDNA_Type sdna_type_nr(const char *dna_type)
 }
 
 /**
- * Converts a value of one primitive type to another.
- * Note there is no optimization for the case where otype and ctype are the same:
+ * Converts an array of values of one primitive type to another.
+ * Note there is no optimization for the case where otypenr and ctypenr are the same:
  * assumption is that caller will handle this case.
  *
- * \param ctype  Name of type to convert to
- * \param otype  Name of type to convert from
- * \param name  Field name to extract array-size information
+ * \param ctypenr  Type to convert to
+ * \param otypenr  Type to convert from
+ * \param arrlen  Number of values
  * \param curdata  Where to put converted data
- * \param olddata  Data of type otype to convert
+ * \param olddata  Data of type otypenr to convert
  */
-static void cast_elem(
-        const char *ctype, const char *otype, const char *name,
+static void cast_primitive_type(
+        const eSDNA_Type ctypenr, const eSDNA_Type otypenr, int arrlen,
         char *curdata, const char *olddata)
 {
 	double val = 0.0;
-	int arrlen, curlen = 1, oldlen = 1;
-
-	eSDNA_Type ctypenr, otypenr;
-
-	arrlen = DNA_elem_array_size(name);
-
-	if ( (otypenr = sdna_type_nr(otype)) == -1 ||
-	     (ctypenr = sdna_type_nr(ctype)) == -1)
-	{
-		return;
-	}
-
-	/* define lengths */
-	oldlen = DNA_elem_type_size(otypenr);
-	curlen = DNA_elem_type_size(ctypenr);
+	const int oldlen = DNA_elem_type_size(otypenr);
+	const int curlen = DNA_elem_type_size(ctypenr);
 
 	while (arrlen > 0) {
 		switch (otypenr) {
@@ -836,16 +823,13 @@ static void cast_elem(
  *
  * \param curlen  Pointer length to conver to
  * \param oldlen  Length of pointers in olddata
- * \param name  Field name to extract array-size information
+ * \param arrlen  Number of pointers
  * \param curdata  Where to put converted data
  * \param olddata  Data to convert
  */
-static void cast_pointer(int curlen, int oldlen, const char *name, char *curdata, const char *olddata)
+static void cast_pointer(int curlen, int oldlen, int arrlen, char *curdata, const char *olddata)
 {
 	int64_t lval;
-	int arrlen;
-	
-	arrlen = DNA_elem_array_size(name);
 	
 	while (arrlen > 0) {
 	
@@ -892,27 +876,25 @@ static int elem_strcmp(const char *name, const char *oname)
 }
 
 /**
- * Returns the address of the data for the specified field within olddata
- * according to the struct format pointed to by old, or NULL if no such
+ * Returns the offset of the data for the specified field
+ * according to the struct format pointed to by old, or -1 if no such
  * field can be found.
  *
  * \param sdna  Old SDNA
  * \param type  Current field type name
  * \param name  Current field name
  * \param old  Pointer to struct information in sdna
- * \param olddata  Struct data
  * \param sppo  Optional place to return pointer to field info in sdna
- * \return Data address.
+ * \return Data offset.
  */
-static const char *find_elem(
+static int find_elem_offset(
         const SDNA *sdna,
         const char *type,
         const char *name,
         const short *old,
-        const char *olddata,
         const short **sppo)
 {
-	int a, elemcount, len;
+	int a, elemcount, len, offset = 0;
 	const char *otype, *oname;
 	
 	/* without arraypart, so names can differ: return old namenr and type */
@@ -930,37 +912,160 @@ static const char *find_elem(
 		if (elem_strcmp(name, oname) == 0) {  /* name equal */
 			if (strcmp(type, otype) == 0) {   /* type equal */
 				if (sppo) *sppo = old;
-				return olddata;
+				return offset;
 			}
 			
-			return NULL;
+			return -1;
 		}
 		
-		olddata += len;
+		offset += len;
 	}
-	return NULL;
+	return -1;
 }
 
 /**
- * Converts the contents of a single field of a struct, of a non-struct type,
+ * Returns the address of the data for the specified field within olddata
+ * according to the struct format pointed to by old, or NULL if no such
+ * field can be found.
+ */
+static const char *find_elem(
+        const SDNA *sdna,
+        const char *type,
+        const char *name,
+        const short *old,
+        const char *olddata,
+        const short **sppo)
+{
+	const int offset = find_elem_offset(sdna, type, name, old, sppo);
+	return (offset != -1) ? olddata + offset : NULL;
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Struct Reconstruction
+ *
+ * Converting a struct from the SDNA of a file to the current one is planned once per struct type,
+ * as a list of copies and casts at fixed offsets, see #DNA_reconstruct_info_create.
+ * Reading structs only runs these steps, instead of matching field names for every struct read.
+ * \{ */
+
+typedef enum eReconstructStepType {
+	RECONSTRUCT_STEP_MEMCPY,
+	/* char array which has been truncated, keep it null-terminated */
+	RECONSTRUCT_STEP_MEMCPY_STRING,
+	RECONSTRUCT_STEP_CAST_PRIMITIVE,
+	RECONSTRUCT_STEP_CAST_POINTER,
+} eReconstructStepType;
+
+typedef struct ReconstructStep {
+	eReconstructStepType type;
+	int old_offset, new_offset;
+	/* number of bytes to copy, or of values to cast */
+	int len;
+	/* casts: eSDNA_Type, or pointer sizes for RECONSTRUCT_STEP_CAST_POINTER */
+	short old_type, new_type;
+} ReconstructStep;
+
+typedef struct ReconstructPlan {
+	int new_struct_nr;
+	int steps_len, steps_alloc;
+	ReconstructStep *steps;
+} ReconstructPlan;
+
+typedef struct DNA_ReconstructInfo {
+	const SDNA *oldsdna, *newsdna;
+	/* indexed by old struct number */
+	ReconstructPlan *plans;
+} DNA_ReconstructInfo;
+
+static void reconstruct_plan_step_add(
+        ReconstructPlan *plan, const eReconstructStepType type,
+        const int old_offset, const int new_offset, const int len,
+        const short old_type, const short new_type)
+{
+	ReconstructStep *step;
+
+	if (len <= 0) {
+		return;
+	}
+
+	/* fields which were only moved are copied with a single memcpy */
+	if (type == RECONSTRUCT_STEP_MEMCPY && plan->steps_len) {
+		step = &plan->steps[plan->steps_len - 1];
+		if (step->type == RECONSTRUCT_STEP_MEMCPY &&
+		    step->old_offset + step->len == old_offset &&
+		    step->new_offset + step->len == new_offset)
+		{
+			step->len += len;
+			return;
+		}
+	}
+
+	if (plan->steps_len == plan->steps_alloc) {
+		plan->steps_alloc = plan->steps_alloc ? plan->steps_alloc * 2 : 16;
+		plan->steps = MEM_reallocN(plan->steps, sizeof(*plan->steps) * plan->steps_alloc);
+	}
+
+	step = &plan->steps[plan->steps_len++];
+	step->type = type;
+	step->old_offset = old_offset;
+	step->new_offset = new_offset;
+	step->len = len;
+	step->old_type = old_type;
+	step->new_type = new_type;
+}
+
+static void reconstruct_plan_pointer(
+        ReconstructPlan *plan, const SDNA *newsdna, const SDNA *oldsdna,
+        const int arrlen, const int old_offset, const int new_offset)
+{
+	if (newsdna->pointerlen == oldsdna->pointerlen) {
+		reconstruct_plan_step_add(
+		        plan, RECONSTRUCT_STEP_MEMCPY, old_offset, new_offset, arrlen * oldsdna->pointerlen, 0, 0);
+	}
+	else {
+		reconstruct_plan_step_add(
+		        plan, RECONSTRUCT_STEP_CAST_POINTER, old_offset, new_offset, arrlen,
+		        oldsdna->pointerlen, newsdna->pointerlen);
+	}
+}
+
+static void reconstruct_plan_cast(
+        ReconstructPlan *plan, const char *ctype, const char *otype,
+        const int arrlen, const int old_offset, const int new_offset)
+{
+	eSDNA_Type ctypenr, otypenr;
+
+	if ((otypenr = sdna_type_nr(otype)) == -1 ||
+	    (ctypenr = sdna_type_nr(ctype)) == -1)
+	{
+		return;
+	}
+
+	reconstruct_plan_step_add(
+	        plan, RECONSTRUCT_STEP_CAST_PRIMITIVE, old_offset, new_offset, arrlen, otypenr, ctypenr);
+}
+
+/**
+ * Plans the conversion of a single field of a struct, of a non-struct type,
  * from oldsdna to newsdna format.
  *
  * \param newsdna  SDNA of current Blender
  * \param oldsdna  SDNA of Blender that saved file
  * \param type  current field type name
  * \param name  current field name
- * \param curdata  put field data converted to newsdna here
+ * \param new_offset  offset of the field in the current struct
  * \param old  pointer to struct info in oldsdna
- * \param olddata  struct contents laid out according to oldsdna
+ * \param old_offset  offset of the old struct
  */
-static void reconstruct_elem(
+static void reconstruct_plan_elem(
+        ReconstructPlan *plan,
         const SDNA *newsdna,
         const SDNA *oldsdna,
         const char *type,
         const char *name,
-        char *curdata,
+        const int new_offset,
         const short *old,
-        const char *olddata)
+        int old_offset)
 {
 	/* rules: test for NAME:
 	 *      - name equal:
@@ -971,7 +1076,7 @@ static void reconstruct_elem(
 	 * (nzc 2-4-2001 I want the 'unsigned' bit to be parsed as well. Where
 	 * can I force this?)
 	 */
-	int a, elemcount, len, countpos, oldsize, cursize, mul;
+	int a, elemcount, len, countpos, oldsize, cursize, arrlen;
 	const char *otype, *oname, *cp;
 	
 	/* is 'name' an array? */
@@ -991,15 +1096,16 @@ static void reconstruct_elem(
 		len = elementsize(oldsdna, old[0], old[1]);
 		
 		if (strcmp(name, oname) == 0) { /* name equal */
-			
+			arrlen = DNA_elem_array_size(name);
+
 			if (ispointer(name)) {  /* pointer of functionpointer afhandelen */
-				cast_pointer(newsdna->pointerlen, oldsdna->pointerlen, name, curdata, olddata);
+				reconstruct_plan_pointer(plan, newsdna, oldsdna, arrlen, old_offset, new_offset);
 			}
 			else if (strcmp(type, otype) == 0) {    /* type equal */
-				memcpy(curdata, olddata, len);
+				reconstruct_plan_step_add(plan, RECONSTRUCT_STEP_MEMCPY, old_offset, new_offset, len, 0, 0);
 			}
 			else {
-				cast_elem(type, otype, name, curdata, olddata);
+				reconstruct_plan_cast(plan, type, otype, arrlen, old_offset, new_offset);
 			}
 
 			return;
@@ -1010,36 +1116,31 @@ static void reconstruct_elem(
 				
 				cursize = DNA_elem_array_size(name);
 				oldsize = DNA_elem_array_size(oname);
+				/* smaller of sizes of old and new arrays */
+				arrlen = MIN2(cursize, oldsize);
 
 				if (ispointer(name)) {  /* handle pointer or functionpointer */
-					cast_pointer(newsdna->pointerlen, oldsdna->pointerlen,
-					             cursize > oldsize ? oname : name,
-					             curdata, olddata);
+					reconstruct_plan_pointer(plan, newsdna, oldsdna, arrlen, old_offset, new_offset);
 				}
 				else if (strcmp(type, otype) == 0) {  /* type equal */
-					mul = len / oldsize; /* size of single old array element */
-					mul *= (cursize < oldsize) ? cursize : oldsize; /* smaller of sizes of old and new arrays */
-					memcpy(curdata, olddata, mul);
-					
-					if (oldsize > cursize && strcmp(type, "char") == 0) {
-						/* string had to be truncated, ensure it's still null-terminated */
-						curdata[mul - 1] = '\0';
-					}
+					/* string had to be truncated, ensure it's still null-terminated */
+					const bool is_string = (oldsize > cursize && strcmp(type, "char") == 0);
+					reconstruct_plan_step_add(
+					        plan, is_string ? RECONSTRUCT_STEP_MEMCPY_STRING : RECONSTRUCT_STEP_MEMCPY,
+					        old_offset, new_offset, (len / oldsize) * arrlen, 0, 0);
 				}
 				else {
-					cast_elem(type, otype,
-					          cursize > oldsize ? oname : name,
-					          curdata, olddata);
+					reconstruct_plan_cast(plan, type, otype, arrlen, old_offset, new_offset);
 				}
 				return;
 			}
 		}
-		olddata += len;
+		old_offset += len;
 	}
 }
 
 /**
- * Converts the contents of an entire struct from oldsdna to newsdna format.
+ * Plans the conversion of an entire struct from oldsdna to newsdna format.
  *
  * \param newsdna  SDNA of current Blender
  * \param oldsdna  SDNA of Blender that saved file
@@ -1047,29 +1148,29 @@ static void reconstruct_elem(
  *
  * Result from DNA_struct_get_compareflags to avoid needless conversions.
  * \param oldSDNAnr  Index of old struct definition in oldsdna
- * \param data  Struct contents laid out according to oldsdna
+ * \param old_offset  Offset of the struct in the old data
  * \param curSDNAnr  Index of current struct definition in newsdna
- * \param cur  Where to put converted struct contents
+ * \param new_offset  Offset of the struct in the converted data
  */
-static void reconstruct_struct(
+static void reconstruct_plan_struct(
+        ReconstructPlan *plan,
         const SDNA *newsdna,
         const SDNA *oldsdna,
         const char *compflags,
 
         int oldSDNAnr,
-        const char *data,
+        const int old_offset,
         int curSDNAnr,
-        char *cur)
+        const int new_offset)
 {
 	/* Recursive!
 	 * Per element from cur_struct, read data from old_struct.
 	 * If element is a struct, call recursive.
 	 */
 	int a, elemcount, elen, eleno, mul, mulo, firststructtypenr;
+	int cpo, cpc;
 	const short *spo, *spc, *sppo;
 	const char *type;
-	const char *cpo;
-	char *cpc;
 	const char *name, *nameo;
 
 	unsigned int oldsdna_index_last = UINT_MAX;
@@ -1083,7 +1184,7 @@ static void reconstruct_struct(
 		/* if recursive: test for equal */
 		spo = oldsdna->structs[oldSDNAnr];
 		elen = oldsdna->typelens[spo[0]];
-		memcpy(cur, data, elen);
+		reconstruct_plan_step_add(plan, RECONSTRUCT_STEP_MEMCPY, old_offset, new_offset, elen, 0, 0);
 		
 		return;
 	}
@@ -1096,7 +1197,7 @@ static void reconstruct_struct(
 	elemcount = spc[1];
 
 	spc += 2;
-	cpc = cur;
+	cpc = new_offset;
 	for (a = 0; a < elemcount; a++, spc += 2) {  /* convert each field */
 		type = newsdna->types[spc[0]];
 		name = newsdna->names[spc[1]];
@@ -1107,12 +1208,15 @@ static void reconstruct_struct(
 		if (spc[0] >= firststructtypenr && !ispointer(name)) {
 			/* struct field type */
 			/* where does the old struct data start (and is there an old one?) */
-			cpo = (char *)find_elem(oldsdna, type, name, spo, data, &sppo);
+			cpo = find_elem_offset(oldsdna, type, name, spo, &sppo);
 			
-			if (cpo) {
-				oldSDNAnr = DNA_struct_find_nr_ex(oldsdna, type, &oldsdna_index_last);
-				curSDNAnr = DNA_struct_find_nr_ex(newsdna, type, &cursdna_index_last);
-				
+			if (cpo != -1) {
+				const int oldSDNAnr_elem = DNA_struct_find_nr_ex(oldsdna, type, &oldsdna_index_last);
+				const int curSDNAnr_elem = DNA_struct_find_nr_ex(newsdna, type, &cursdna_index_last);
+				int cpc_elem = cpc;
+
+				cpo += old_offset;
+
 				/* array! */
 				mul = DNA_elem_array_size(name);
 				nameo = oldsdna->names[sppo[1]];
@@ -1124,27 +1228,106 @@ static void reconstruct_struct(
 				eleno /= mulo;
 				
 				while (mul--) {
-					reconstruct_struct(newsdna, oldsdna, compflags, oldSDNAnr, cpo, curSDNAnr, cpc);
+					reconstruct_plan_struct(
+					        plan, newsdna, oldsdna, compflags, oldSDNAnr_elem, cpo, curSDNAnr_elem, cpc_elem);
 					cpo += eleno;
-					cpc += elen;
+					cpc_elem += elen;
 					
 					/* new struct array larger than old */
 					mulo--;
 					if (mulo <= 0) break;
 				}
+
+				elen *= DNA_elem_array_size(name);
 			}
-			else {
-				cpc += elen;  /* skip field no longer present */
-			}
+			cpc += elen;  /* skip field no longer present */
 		}
 		else {
 			/* non-struct field type */
-			reconstruct_elem(newsdna, oldsdna, type, name, cpc, spo, data);
+			reconstruct_plan_elem(plan, newsdna, oldsdna, type, name, cpc, spo, old_offset);
 			cpc += elen;
 		}
 	}
 }
 
+/**
+ * Plans the conversion of all structs from \a oldsdna to \a newsdna,
+ * reconstructing is then thread-safe.
+ *
+ * \param compflags  Result from #DNA_struct_get_compareflags, must stay valid as long as the result is used.
+ */
+DNA_ReconstructInfo *DNA_reconstruct_info_create(
+        const SDNA *oldsdna, const SDNA *newsdna, const char *compflags)
+{
+	DNA_ReconstructInfo *reconstruct_info = MEM_callocN(sizeof(*reconstruct_info), __func__);
+	int a;
+
+	reconstruct_info->oldsdna = oldsdna;
+	reconstruct_info->newsdna = newsdna;
+	reconstruct_info->plans = MEM_callocN(sizeof(*reconstruct_info->plans) * oldsdna->nr_structs, __func__);
+
+	for (a = 0; a < oldsdna->nr_structs; a++) {
+		ReconstructPlan *plan = &reconstruct_info->plans[a];
+		const short *spo = oldsdna->structs[a];
+
+		plan->new_struct_nr = DNA_struct_find_nr(newsdna, oldsdna->types[spo[0]]);
+		if (plan->new_struct_nr != -1 && compflags[a] != SDNA_CMP_REMOVED) {
+			reconstruct_plan_struct(plan, newsdna, oldsdna, compflags, a, 0, plan->new_struct_nr, 0);
+		}
+	}
+
+	return reconstruct_info;
+}
+
+void DNA_reconstruct_info_free(DNA_ReconstructInfo *reconstruct_info)
+{
+	int a;
+
+	for (a = 0; a < reconstruct_info->oldsdna->nr_structs; a++) {
+		MEM_SAFE_FREE(reconstruct_info->plans[a].steps);
+	}
+	MEM_freeN(reconstruct_info->plans);
+	MEM_freeN(reconstruct_info);
+}
+
+/**
+ * Runs a single step for all blocks, so each loop only does one kind of conversion.
+ */
+static void reconstruct_step_run(
+        const ReconstructStep *step, const int blocks,
+        const int oldlen, const char *old_blocks, const int curlen, char *cur_blocks)
+{
+	const char *cpo = old_blocks + step->old_offset;
+	char *cpc = cur_blocks + step->new_offset;
+	int a;
+
+	switch (step->type) {
+		case RECONSTRUCT_STEP_MEMCPY:
+			for (a = 0; a < blocks; a++, cpo += oldlen, cpc += curlen) {
+				memcpy(cpc, cpo, step->len);
+			}
+			break;
+		case RECONSTRUCT_STEP_MEMCPY_STRING:
+			for (a = 0; a < blocks; a++, cpo += oldlen, cpc += curlen) {
+				memcpy(cpc, cpo, step->len);
+				cpc[step->len - 1] = '\0';
+			}
+			break;
+		case RECONSTRUCT_STEP_CAST_PRIMITIVE:
+			for (a = 0; a < blocks; a++, cpo += oldlen, cpc += curlen) {
+				cast_primitive_type(step->new_type, step->old_type, step->len, cpc, cpo);
+			}
+			break;
+		case RECONSTRUCT_STEP_CAST_POINTER:
+			for (a = 0; a < blocks; a++, cpo += oldlen, cpc += curlen) {
+				cast_pointer(step->new_type, step->old_type, step->len, cpc, cpo);
+			}
+			break;
+	}
+}
+
+/** \} */
+
 /**
  * Does endian swapping on the fields of a struct value.
  *
@@ -1234,48 +1417,35 @@ void DNA_struct_switch_endian(const SDNA *oldsdna, int oldSDNAnr, char *data)
 }
 
 /**
- * \param newsdna  SDNA of current Blender
- * \param oldsdna  SDNA of Blender that saved file
- * \param compflags
- *
- * Result from DNA_struct_get_compareflags to avoid needless conversions
+ * \param reconstruct_info  Result from #DNA_reconstruct_info_create
  * \param oldSDNAnr  Index of struct info within oldsdna
  * \param blocks  The number of array elements
  * \param data  Array of struct data
  * \return An allocated reconstructed struct
  */
 void *DNA_struct_reconstruct(
-        const SDNA *newsdna, const SDNA *oldsdna,
-        const char *compflags, int oldSDNAnr, int blocks, const void *data)
+        const DNA_ReconstructInfo *reconstruct_info, int oldSDNAnr, int blocks, const void *data)
 {
-	int a, curSDNAnr, curlen = 0, oldlen;
-	const short *spo, *spc;
-	char *cur, *cpc;
-	const char *cpo;
-	const char *type;
-	
-	/* oldSDNAnr == structnr, we're looking for the corresponding 'cur' number */
-	spo = oldsdna->structs[oldSDNAnr];
-	type = oldsdna->types[spo[0]];
-	oldlen = oldsdna->typelens[spo[0]];
-	curSDNAnr = DNA_struct_find_nr(newsdna, type);
+	const SDNA *oldsdna = reconstruct_info->oldsdna;
+	const SDNA *newsdna = reconstruct_info->newsdna;
+	const ReconstructPlan *plan = &reconstruct_info->plans[oldSDNAnr];
+	int a, curlen = 0, oldlen;
+	char *cur;
+
+	/* oldSDNAnr == structnr, the plan has the corresponding 'cur' number */
+	oldlen = oldsdna->typelens[oldsdna->structs[oldSDNAnr][0]];
 
 	/* init data and alloc */
-	if (curSDNAnr != -1) {
-		spc = newsdna->structs[curSDNAnr];
-		curlen = newsdna->typelens[spc[0]];
+	if (plan->new_struct_nr != -1) {
+		curlen = newsdna->typelens[newsdna->structs[plan->new_struct_nr][0]];
 	}
 	if (curlen == 0) {
 		return NULL;
 	}
 
 	cur = MEM_callocN(blocks * curlen, "reconstruct");
-	cpc = cur;
-	cpo = data;
-	for (a = 0; a < blocks; a++) {
-		reconstruct_struct(newsdna, oldsdna, compflags, oldSDNAnr, cpo, curSDNAnr, cpc);
-		cpc += curlen;
-		cpo += oldlen;
+	for (a = 0; a < plan->steps_len; a++) {
+		reconstruct_step_run(&plan->steps[a], blocks, oldlen, data, curlen, cur);
 	}
 
 	return cur;
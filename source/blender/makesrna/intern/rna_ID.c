@@ -433,6 +433,7 @@ static Material *rna_IDMaterials_pop_id(ID *id, Main *bmain, ReportList *reports
 	}
 
 	DAG_id_tag_update(id, OB_RECALC_DATA);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_OBJECT | ND_DRAW, id);
 	WM_main_add_notifier(NC_OBJECT | ND_OB_SHADING, id);
 
@@ -444,6 +445,7 @@ static void rna_IDMaterials_clear_id(ID *id, int remove_material_slot)
 	BKE_material_clear_id(G.main, id, remove_material_slot);
 
 	DAG_id_tag_update(id, OB_RECALC_DATA);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_OBJECT | ND_DRAW, id);
 	WM_main_add_notifier(NC_OBJECT | ND_OB_SHADING, id);
 }
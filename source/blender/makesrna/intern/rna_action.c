@@ -51,6 +51,7 @@
 
 #include "BLI_math_base.h"
 
+#include "BKE_animsys.h"
 #include "BKE_fcurve.h"
 
 #include "ED_keyframing.h"
@@ -99,6 +100,7 @@ static void rna_Action_groups_remove(bAction *act, ReportList *reports, PointerR
 	}
 
 	MEM_freeN(agrp);
+	BKE_animsys_eval_cache_invalidate();
 	RNA_POINTER_INVALIDATE(agrp_ptr);
 }
 
@@ -118,6 +120,7 @@ static FCurve *rna_Action_fcurve_new(bAction *act, ReportList *reports, const ch
 		            index, act->id.name + 2);
 		return NULL;
 	}
+	BKE_animsys_eval_cache_invalidate();
 	return verify_fcurve(act, group, NULL, data_path, index, 1);
 }
 
@@ -156,6 +159,7 @@ static void rna_Action_fcurve_remove(bAction *act, ReportList *reports, PointerR
 		free_fcurve(fcu);
 		RNA_POINTER_INVALIDATE(fcu_ptr);
 	}
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static TimeMarker *rna_Action_pose_markers_new(bAction *act, const char name[])
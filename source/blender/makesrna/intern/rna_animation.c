@@ -535,6 +535,7 @@ static void rna_NlaTrack_remove(AnimData *adt, bContext *C, ReportList *reports,
 
 	free_nlatrack(&adt->nla_tracks, track);
 	RNA_POINTER_INVALIDATE(track_ptr);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_event_add_notifier(C, NC_ANIMATION | ND_NLA | NA_REMOVED, NULL);
 }
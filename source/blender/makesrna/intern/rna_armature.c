@@ -43,6 +43,7 @@
 
 #ifdef RNA_RUNTIME
 
+#include "BKE_animsys.h"
 #include "BKE_context.h"
 #include "BKE_depsgraph.h"
 #include "BKE_idprop.h"
@@ -124,6 +125,7 @@ static void rna_Armature_edit_bone_remove(bArmature *arm, ReportList *reports, P
 	}
 
 	ED_armature_edit_bone_remove(arm, ebone);
+	BKE_animsys_eval_cache_invalidate();
 	RNA_POINTER_INVALIDATE(ebone_ptr);
 }
 
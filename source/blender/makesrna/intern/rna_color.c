@@ -52,6 +52,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BKE_animsys.h"
 #include "BKE_colortools.h"
 #include "BKE_depsgraph.h"
 #include "BKE_image.h"
@@ -370,6 +371,7 @@ static CBData *rna_ColorRampElement_new(struct ColorBand *coba, ReportList *repo
 
 	if (element == NULL)
 		BKE_reportf(reports, RPT_ERROR, "Unable to add element to colorband (limit %d)", MAXCOLORBAND);
+	BKE_animsys_eval_cache_invalidate();
 
 	return element;
 }
@@ -382,6 +384,7 @@ static void rna_ColorRampElement_remove(struct ColorBand *coba, ReportList *repo
 		BKE_report(reports, RPT_ERROR, "Element not found in element collection or last element");
 		return;
 	}
+	BKE_animsys_eval_cache_invalidate();
 
 	RNA_POINTER_INVALIDATE(element_ptr);
 }
@@ -393,6 +396,7 @@ static void rna_CurveMap_remove_point(CurveMap *cuma, ReportList *reports, Point
 		BKE_report(reports, RPT_ERROR, "Unable to remove curve point");
 		return;
 	}
+	BKE_animsys_eval_cache_invalidate();
 
 	RNA_POINTER_INVALIDATE(point_ptr);
 }
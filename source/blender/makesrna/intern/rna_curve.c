@@ -123,6 +123,7 @@ static const EnumPropertyItem curve2d_fill_mode_items[] = {
 
 #include "DNA_object_types.h"
 
+#include "BKE_animsys.h"
 #include "BKE_curve.h"
 #include "BKE_depsgraph.h"
 #include "BKE_main.h"
@@ -573,6 +574,7 @@ static void rna_Curve_spline_points_add(ID *id, Nurb *nu, ReportList *reports, i
 
 		rna_Curve_update_data_id(NULL, NULL, id);
 	}
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static void rna_Curve_spline_bezpoints_add(ID *id, Nurb *nu, ReportList *reports, int number)
@@ -591,6 +593,7 @@ static void rna_Curve_spline_bezpoints_add(ID *id, Nurb *nu, ReportList *reports
 
 		rna_Curve_update_data_id(NULL, NULL, id);
 	}
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static Nurb *rna_Curve_spline_new(Curve *cu, int type)
@@ -639,6 +642,7 @@ static void rna_Curve_spline_remove(Curve *cu, ReportList *reports, PointerRNA *
 	RNA_POINTER_INVALIDATE(nu_ptr);
 
 	DAG_id_tag_update(&cu->id, OB_RECALC_DATA);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_GEOM | ND_DATA, NULL);
 }
 
@@ -649,6 +653,7 @@ static void rna_Curve_spline_clear(Curve *cu)
 	BKE_nurbList_free(nurbs);
 
 	DAG_id_tag_update(&cu->id, OB_RECALC_DATA);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_GEOM | ND_DATA, NULL);
 }
 
@@ -44,17 +44,30 @@
 
 #include "DEG_depsgraph_debug.h"
 
-static void rna_Depsgraph_debug_graphviz(Depsgraph *graph, const char *filename)
+static void rna_Depsgraph_debug_graphviz(Depsgraph *graph, const char *filename, int show_timings)
 {
 	FILE *f = fopen(filename, "w");
 	if (f == NULL)
 		return;
 	
-	DEG_debug_graphviz(graph, f, "Depsgraph", false);
+	DEG_debug_graphviz(graph, f, "Depsgraph", false, show_timings != 0);
 	
 	fclose(f);
 }
 
+static void rna_Depsgraph_debug_timings(Depsgraph *graph, ReportList *reports, const char *filename, int format)
+{
+	FILE *f = fopen(filename, "w");
+	if (f == NULL) {
+		BKE_reportf(reports, RPT_ERROR, "Cannot open file '%s' for writing", filename);
+		return;
+	}
+
+	DEG_debug_timings(graph, f, format == 1);
+
+	fclose(f);
+}
+
 static void rna_Depsgraph_debug_rebuild(Depsgraph *UNUSED(graph), Main *bmain)
 {
 	Scene *sce;
@@ -87,6 +100,12 @@ static void rna_def_depsgraph(BlenderRNA *brna)
 	FunctionRNA *func;
 	PropertyRNA *parm;
 
+	static EnumPropertyItem timings_format_items[] = {
+		{0, "TEXT", 0, "Text", "Table of the slowest data-blocks and operations"},
+		{1, "JSON", 0, "JSON", "Timings of all evaluated operations"},
+		{0, NULL, 0, NULL, NULL}
+	};
+
 	srna = RNA_def_struct(brna, "Depsgraph", NULL);
 	RNA_def_struct_ui_text(srna, "Dependency Graph", "");
 	
@@ -94,6 +113,17 @@ static void rna_def_depsgraph(BlenderRNA *brna)
 	parm = RNA_def_string_file_path(func, "filename", NULL, FILE_MAX, "File Name",
 	                                "File in which to store graphviz debug output");
 	RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+	RNA_def_boolean(func, "show_timings", false, "Show Timings",
+	                "Color operations by the time they took during the last evaluation");
+
+	func = RNA_def_function(srna, "debug_timings", "rna_Depsgraph_debug_timings");
+	RNA_def_function_ui_description(func, "Write time spent evaluating every data-block, component and "
+	                                "operation during the last update (enable with bpy.app.debug_depsgraph_time)");
+	RNA_def_function_flag(func, FUNC_USE_REPORTS);
+	parm = RNA_def_string_file_path(func, "filename", NULL, FILE_MAX, "File Name",
+	                                "File in which to store the timings");
+	RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+	RNA_def_enum(func, "format", timings_format_items, 0, "Format", "");
 
 	func = RNA_def_function(srna, "debug_rebuild", "rna_Depsgraph_debug_rebuild");
 	RNA_def_function_flag(func, FUNC_USE_MAIN);
@@ -149,7 +149,7 @@ static void rna_ChannelDriver_update_expr(Main *bmain, Scene *scene, PointerRNA
 	ChannelDriver *driver = ptr->data;
 	
 	/* tag driver as needing to be recompiled */
-	driver->flag |= DRIVER_FLAG_RECOMPILE;
+	driver_invalidate_expression(driver, true, false);
 	
 	/* update_data() clears invalid flag and schedules for updates */
 	rna_ChannelDriver_update_data(bmain, scene, ptr);
@@ -179,11 +179,19 @@ static void rna_DriverTarget_update_data(Main *bmain, Scene *scene, PointerRNA *
 
 static void rna_DriverTarget_update_name(Main *bmain, Scene *scene, PointerRNA *ptr)
 {
-	ChannelDriver *driver = ptr->data;
-	rna_DriverTarget_update_data(bmain, scene, ptr);
+	DriverVar *dvar = ptr->data;
+	AnimData *adt = BKE_animdata_from_id(ptr->id.data);
+	FCurve *fcu;
 
-	driver->flag |= DRIVER_FLAG_RENAMEVAR;
+	rna_DriverTarget_update_data(bmain, scene, ptr);
 
+	/* find the driver using this variable, its compiled expression uses the old name */
+	for (fcu = adt->drivers.first; fcu; fcu = fcu->next) {
+		if (fcu->driver && BLI_findindex(&fcu->driver->variables, dvar) != -1) {
+			driver_invalidate_expression(fcu->driver, false, true);
+			break;
+		}
+	}
 }
 
 /* ----------- */
@@ -304,6 +312,7 @@ static void rna_Driver_remove_variable(ChannelDriver *driver, ReportList *report
 	}
 
 	driver_free_variable_ex(driver, dvar);
+	BKE_animsys_eval_cache_invalidate();
 	RNA_POINTER_INVALIDATE(dvar_ptr);
 }
 
@@ -386,6 +395,9 @@ static void rna_FCurve_RnaPath_set(PointerRNA *ptr, const char *value)
 	if (fcu->rna_path)
 		MEM_freeN(fcu->rna_path);
 	
+	/* new path might be allocated at the same address */
+	BKE_animsys_eval_cache_invalidate();
+	
 	if (value[0]) {
 		fcu->rna_path = BLI_strdup(value);
 		fcu->flag &= ~FCURVE_DISABLED;
@@ -507,6 +519,7 @@ static void rna_FCurve_modifiers_remove(FCurve *fcu, ReportList *reports, Pointe
 	}
 
 	remove_fmodifier(&fcu->modifiers, fcm);
+	BKE_animsys_eval_cache_invalidate();
 	RNA_POINTER_INVALIDATE(fcm_ptr);
 }
 
@@ -789,6 +802,7 @@ static void rna_FKeyframe_points_add(FCurve *fcu, int tot)
 			bezt++;
 		}
 	}
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static void rna_FKeyframe_points_remove(FCurve *fcu, ReportList *reports, PointerRNA *bezt_ptr, int do_fast)
@@ -801,6 +815,7 @@ static void rna_FKeyframe_points_remove(FCurve *fcu, ReportList *reports, Pointe
 	}
 
 	delete_fcurve_key(fcu, index, !do_fast);
+	BKE_animsys_eval_cache_invalidate();
 	RNA_POINTER_INVALIDATE(bezt_ptr);
 }
 
@@ -875,6 +890,7 @@ static void rna_FModifierEnvelope_points_remove(FModifier *fmod, ReportList *rep
 		}
 		env->totvert = 0;
 	}
+	BKE_animsys_eval_cache_invalidate();
 	RNA_POINTER_INVALIDATE(point);
 }
 
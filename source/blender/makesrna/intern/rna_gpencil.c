@@ -466,6 +466,7 @@ static void rna_GPencil_stroke_point_add(bGPDstroke *stroke, int count, float pr
 		
 		stroke->totpoints += count;
 	}
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static void rna_GPencil_stroke_point_pop(bGPDstroke *stroke, ReportList *reports, int index)
@@ -494,6 +495,7 @@ static void rna_GPencil_stroke_point_pop(bGPDstroke *stroke, ReportList *reports
 
 	/* free temp buffer */
 	MEM_freeN(pt_tmp);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_GPENCIL | NA_EDITED, NULL);
 }
@@ -521,6 +523,7 @@ static void rna_GPencil_stroke_remove(bGPDframe *frame, ReportList *reports, Poi
 
 	BLI_freelinkN(&frame->strokes, stroke);
 	RNA_POINTER_INVALIDATE(stroke_ptr);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_GPENCIL | NA_EDITED, NULL);
 }
@@ -572,6 +575,7 @@ static void rna_GPencil_frame_remove(bGPDlayer *layer, ReportList *reports, Poin
 
 	BKE_gpencil_layer_delframe(layer, frame);
 	RNA_POINTER_INVALIDATE(frame_ptr);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_GPENCIL | NA_EDITED, NULL);
 }
@@ -610,6 +614,7 @@ static void rna_GPencil_layer_remove(bGPdata *gpd, ReportList *reports, PointerR
 
 	BKE_gpencil_layer_delete(gpd, layer);
 	RNA_POINTER_INVALIDATE(layer_ptr);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_GPENCIL | ND_DATA | NA_EDITED, NULL);
 }
@@ -617,6 +622,7 @@ static void rna_GPencil_layer_remove(bGPdata *gpd, ReportList *reports, PointerR
 static void rna_GPencil_frame_clear(bGPDframe *frame)
 {
 	BKE_gpencil_free_strokes(frame);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_GPENCIL | ND_DATA | NA_EDITED, NULL);
 }
@@ -624,6 +630,7 @@ static void rna_GPencil_frame_clear(bGPDframe *frame)
 static void rna_GPencil_layer_clear(bGPDlayer *layer)
 {
 	BKE_gpencil_free_frames(layer);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_GPENCIL | ND_DATA | NA_EDITED, NULL);
 }
@@ -631,6 +638,7 @@ static void rna_GPencil_layer_clear(bGPDlayer *layer)
 static void rna_GPencil_clear(bGPdata *gpd)
 {
 	BKE_gpencil_free_layers(&gpd->layers);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_GPENCIL | ND_DATA | NA_EDITED, NULL);
 }
@@ -655,6 +663,7 @@ static void rna_GPencil_palette_remove(bGPdata *gpd, ReportList *reports, Pointe
 
 	BKE_gpencil_palette_delete(gpd, palette);
 	RNA_POINTER_INVALIDATE(palette_ptr);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_GPENCIL | ND_DATA | NA_EDITED, NULL);
 }
@@ -749,6 +758,7 @@ static void rna_GPencilPalette_color_remove(bGPDpalette *palette, ReportList *re
 
 	BKE_gpencil_palettecolor_delete(palette, color);
 	RNA_POINTER_INVALIDATE(color_ptr);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_GPENCIL | ND_DATA | NA_EDITED, NULL);
 }
@@ -99,6 +99,7 @@ EnumPropertyItem rna_enum_linestyle_geometry_modifier_type_items[] = {
 
 #ifdef RNA_RUNTIME
 
+#include "BKE_animsys.h"
 #include "BKE_linestyle.h"
 #include "BKE_texture.h"
 #include "BKE_depsgraph.h"
@@ -366,6 +367,7 @@ static void rna_LineStyle_color_modifier_remove(FreestyleLineStyle *linestyle, R
 	RNA_POINTER_INVALIDATE(modifier_ptr);
 
 	DAG_id_tag_update(&linestyle->id, 0);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_LINESTYLE, linestyle);
 }
 
@@ -398,6 +400,7 @@ static void rna_LineStyle_alpha_modifier_remove(FreestyleLineStyle *linestyle, R
 	RNA_POINTER_INVALIDATE(modifier_ptr);
 
 	DAG_id_tag_update(&linestyle->id, 0);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_LINESTYLE, linestyle);
 }
 
@@ -430,6 +433,7 @@ static void rna_LineStyle_thickness_modifier_remove(FreestyleLineStyle *linestyl
 	RNA_POINTER_INVALIDATE(modifier_ptr);
 
 	DAG_id_tag_update(&linestyle->id, 0);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_LINESTYLE, linestyle);
 }
 
@@ -462,6 +466,7 @@ static void rna_LineStyle_geometry_modifier_remove(FreestyleLineStyle *linestyle
 	RNA_POINTER_INVALIDATE(modifier_ptr);
 
 	DAG_id_tag_update(&linestyle->id, 0);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_LINESTYLE, linestyle);
 }
 
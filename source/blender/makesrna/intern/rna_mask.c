@@ -54,6 +54,7 @@
 
 #include "DNA_movieclip_types.h"
 
+#include "BKE_animsys.h"
 #include "BKE_depsgraph.h"
 #include "BKE_mask.h"
 
@@ -413,6 +414,7 @@ static void rna_Mask_layers_remove(Mask *mask, ReportList *reports, PointerRNA *
 
 	BKE_mask_layer_remove(mask, masklay);
 	RNA_POINTER_INVALIDATE(masklay_ptr);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_MASK | NA_EDITED, mask);
 }
@@ -420,6 +422,7 @@ static void rna_Mask_layers_remove(Mask *mask, ReportList *reports, PointerRNA *
 static void rna_Mask_layers_clear(Mask *mask)
 {
 	BKE_mask_layer_free_list(&mask->masklayers);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_MASK | NA_EDITED, mask);
 }
@@ -449,6 +452,7 @@ static void rna_MaskLayer_spline_remove(ID *id, MaskLayer *mask_layer, ReportLis
 	RNA_POINTER_INVALIDATE(spline_ptr);
 
 	DAG_id_tag_update(&mask->id, OB_RECALC_DATA);
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static void rna_Mask_start_frame_set(PointerRNA *ptr, int value)
@@ -523,6 +527,7 @@ static void rna_MaskSpline_points_add(ID *id, MaskSpline *spline, int count)
 
 	WM_main_add_notifier(NC_MASK | ND_DATA, mask);
 	DAG_id_tag_update(&mask->id, 0);
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static void rna_MaskSpline_point_remove(ID *id, MaskSpline *spline, ReportList *reports, PointerRNA *point_ptr)
@@ -583,6 +588,7 @@ static void rna_MaskSpline_point_remove(ID *id, MaskSpline *spline, ReportList *
 
 	WM_main_add_notifier(NC_MASK | ND_DATA, mask);
 	DAG_id_tag_update(&mask->id, 0);
+	BKE_animsys_eval_cache_invalidate();
 
 	RNA_POINTER_INVALIDATE(point_ptr);
 }
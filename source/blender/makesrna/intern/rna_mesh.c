@@ -66,8 +66,10 @@ EnumPropertyItem rna_enum_mesh_delimit_mode_items[] = {
 
 #include "BLI_math.h"
 
+#include "BKE_animsys.h"
 #include "BKE_customdata.h"
 #include "BKE_depsgraph.h"
+#include "BKE_global.h"
 #include "BKE_main.h"
 #include "BKE_mesh.h"
 #include "BKE_report.h"
@@ -88,28 +90,41 @@ static Mesh *rna_mesh(PointerRNA *ptr)
 	return me;
 }
 
+/* use when accessing the geometry, which may not have been read yet for linked meshes */
+static Mesh *rna_mesh_lazy_data(PointerRNA *ptr)
+{
+	Mesh *me = rna_mesh(ptr);
+	BKE_mesh_lazy_data_ensure(G.main, me);
+	return me;
+}
+
 static CustomData *rna_mesh_vdata_helper(Mesh *me)
 {
+	BKE_mesh_lazy_data_ensure(G.main, me);
 	return (me->edit_btmesh) ? &me->edit_btmesh->bm->vdata : &me->vdata;
 }
 
 static CustomData *rna_mesh_edata_helper(Mesh *me)
 {
+	BKE_mesh_lazy_data_ensure(G.main, me);
 	return (me->edit_btmesh) ? &me->edit_btmesh->bm->edata : &me->edata;
 }
 
 static CustomData *rna_mesh_pdata_helper(Mesh *me)
 {
+	BKE_mesh_lazy_data_ensure(G.main, me);
 	return (me->edit_btmesh) ? &me->edit_btmesh->bm->pdata : &me->pdata;
 }
 
 static CustomData *rna_mesh_ldata_helper(Mesh *me)
 {
+	BKE_mesh_lazy_data_ensure(G.main, me);
 	return (me->edit_btmesh) ? &me->edit_btmesh->bm->ldata : &me->ldata;
 }
 
 static CustomData *rna_mesh_fdata_helper(Mesh *me)
 {
+	BKE_mesh_lazy_data_ensure(G.main, me);
 	return (me->edit_btmesh) ? NULL : &me->fdata;
 }
 
@@ -1668,20 +1683,75 @@ void rna_MeshStringProperty_s_set(PointerRNA *ptr, const char *value)
 
 static int rna_Mesh_tot_vert_get(PointerRNA *ptr)
 {
-	Mesh *me = rna_mesh(ptr);
+	Mesh *me = rna_mesh_lazy_data(ptr);
 	return me->edit_btmesh ? me->edit_btmesh->bm->totvertsel : 0;
 }
 static int rna_Mesh_tot_edge_get(PointerRNA *ptr)
 {
-	Mesh *me = rna_mesh(ptr);
+	Mesh *me = rna_mesh_lazy_data(ptr);
 	return me->edit_btmesh ? me->edit_btmesh->bm->totedgesel : 0;
 }
 static int rna_Mesh_tot_face_get(PointerRNA *ptr)
 {
-	Mesh *me = rna_mesh(ptr);
+	Mesh *me = rna_mesh_lazy_data(ptr);
 	return me->edit_btmesh ? me->edit_btmesh->bm->totfacesel : 0;
 }
 
+static void rna_Mesh_vertices_begin(CollectionPropertyIterator *iter, PointerRNA *ptr)
+{
+	Mesh *me = rna_mesh_lazy_data(ptr);
+	rna_iterator_array_begin(iter, me->mvert, sizeof(MVert), me->totvert, false, NULL);
+}
+static int rna_Mesh_vertices_length(PointerRNA *ptr)
+{
+	Mesh *me = rna_mesh_lazy_data(ptr);
+	return me->totvert;
+}
+
+static void rna_Mesh_edges_begin(CollectionPropertyIterator *iter, PointerRNA *ptr)
+{
+	Mesh *me = rna_mesh_lazy_data(ptr);
+	rna_iterator_array_begin(iter, me->medge, sizeof(MEdge), me->totedge, false, NULL);
+}
+static int rna_Mesh_edges_length(PointerRNA *ptr)
+{
+	Mesh *me = rna_mesh_lazy_data(ptr);
+	return me->totedge;
+}
+
+static void rna_Mesh_tessfaces_begin(CollectionPropertyIterator *iter, PointerRNA *ptr)
+{
+	Mesh *me = rna_mesh_lazy_data(ptr);
+	rna_iterator_array_begin(iter, me->mface, sizeof(MFace), me->totface, false, NULL);
+}
+static int rna_Mesh_tessfaces_length(PointerRNA *ptr)
+{
+	Mesh *me = rna_mesh_lazy_data(ptr);
+	return me->totface;
+}
+
+static void rna_Mesh_loops_begin(CollectionPropertyIterator *iter, PointerRNA *ptr)
+{
+	Mesh *me = rna_mesh_lazy_data(ptr);
+	rna_iterator_array_begin(iter, me->mloop, sizeof(MLoop), me->totloop, false, NULL);
+}
+static int rna_Mesh_loops_length(PointerRNA *ptr)
+{
+	Mesh *me = rna_mesh_lazy_data(ptr);
+	return me->totloop;
+}
+
+static void rna_Mesh_polygons_begin(CollectionPropertyIterator *iter, PointerRNA *ptr)
+{
+	Mesh *me = rna_mesh_lazy_data(ptr);
+	rna_iterator_array_begin(iter, me->mpoly, sizeof(MPoly), me->totpoly, false, NULL);
+}
+static int rna_Mesh_polygons_length(PointerRNA *ptr)
+{
+	Mesh *me = rna_mesh_lazy_data(ptr);
+	return me->totpoly;
+}
+
 static PointerRNA rna_Mesh_vertex_color_new(struct Mesh *me, const char *name)
 {
 	PointerRNA ptr;
@@ -1695,6 +1765,7 @@ static PointerRNA rna_Mesh_vertex_color_new(struct Mesh *me, const char *name)
 	}
 
 	RNA_pointer_create(&me->id, &RNA_MeshLoopColorLayer, cdl, &ptr);
+	BKE_animsys_eval_cache_invalidate();
 	return ptr;
 }
 
@@ -1703,6 +1774,7 @@ static void rna_Mesh_vertex_color_remove(struct Mesh *me, ReportList *reports, C
 	if (ED_mesh_color_remove_named(me, layer->name) == false) {
 		BKE_reportf(reports, RPT_ERROR, "Vertex color '%s' not found", layer->name);
 	}
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static PointerRNA rna_Mesh_tessface_vertex_color_new(struct Mesh *me, ReportList *reports, const char *name)
@@ -1730,6 +1802,7 @@ static PointerRNA rna_Mesh_tessface_vertex_color_new(struct Mesh *me, ReportList
 	}
 
 	RNA_pointer_create(&me->id, &RNA_MeshColorLayer, cdl, &ptr);
+	BKE_animsys_eval_cache_invalidate();
 	return ptr;
 }
 
@@ -1770,6 +1843,7 @@ static PointerRNA rna_Mesh_uv_texture_new(struct Mesh *me, const char *name)
 	}
 
 	RNA_pointer_create(&me->id, &RNA_MeshTexturePolyLayer, cdl, &ptr);
+	BKE_animsys_eval_cache_invalidate();
 	return ptr;
 }
 
@@ -1778,6 +1852,7 @@ static void rna_Mesh_uv_texture_layers_remove(struct Mesh *me, ReportList *repor
 	if (ED_mesh_uv_texture_remove_named(me, layer->name) == false) {
 		BKE_reportf(reports, RPT_ERROR, "Texture layer '%s' not found", layer->name);
 	}
+	BKE_animsys_eval_cache_invalidate();
 }
 
 /* while this is supposed to be readonly,
@@ -1808,6 +1883,7 @@ static PointerRNA rna_Mesh_tessface_uv_texture_new(struct Mesh *me, ReportList *
 	}
 
 	RNA_pointer_create(&me->id, &RNA_MeshTextureFaceLayer, cdl, &ptr);
+	BKE_animsys_eval_cache_invalidate();
 	return ptr;
 }
 
@@ -3259,30 +3335,40 @@ static void rna_def_mesh(BlenderRNA *brna)
 
 	prop = RNA_def_property(srna, "vertices", PROP_COLLECTION, PROP_NONE);
 	RNA_def_property_collection_sdna(prop, NULL, "mvert", "totvert");
+	RNA_def_property_collection_funcs(prop, "rna_Mesh_vertices_begin", NULL, NULL, NULL,
+	                                  "rna_Mesh_vertices_length", NULL, NULL, NULL);
 	RNA_def_property_struct_type(prop, "MeshVertex");
 	RNA_def_property_ui_text(prop, "Vertices", "Vertices of the mesh");
 	rna_def_mesh_vertices(brna, prop);
 
 	prop = RNA_def_property(srna, "edges", PROP_COLLECTION, PROP_NONE);
 	RNA_def_property_collection_sdna(prop, NULL, "medge", "totedge");
+	RNA_def_property_collection_funcs(prop, "rna_Mesh_edges_begin", NULL, NULL, NULL,
+	                                  "rna_Mesh_edges_length", NULL, NULL, NULL);
 	RNA_def_property_struct_type(prop, "MeshEdge");
 	RNA_def_property_ui_text(prop, "Edges", "Edges of the mesh");
 	rna_def_mesh_edges(brna, prop);
 
 	prop = RNA_def_property(srna, "tessfaces", PROP_COLLECTION, PROP_NONE);
 	RNA_def_property_collection_sdna(prop, NULL, "mface", "totface");
+	RNA_def_property_collection_funcs(prop, "rna_Mesh_tessfaces_begin", NULL, NULL, NULL,
+	                                  "rna_Mesh_tessfaces_length", NULL, NULL, NULL);
 	RNA_def_property_struct_type(prop, "MeshTessFace");
 	RNA_def_property_ui_text(prop, "TessFaces", "Tessellated faces of the mesh (derived from polygons)");
 	rna_def_mesh_tessfaces(brna, prop);
 
 	prop = RNA_def_property(srna, "loops", PROP_COLLECTION, PROP_NONE);
 	RNA_def_property_collection_sdna(prop, NULL, "mloop", "totloop");
+	RNA_def_property_collection_funcs(prop, "rna_Mesh_loops_begin", NULL, NULL, NULL,
+	                                  "rna_Mesh_loops_length", NULL, NULL, NULL);
 	RNA_def_property_struct_type(prop, "MeshLoop");
 	RNA_def_property_ui_text(prop, "Loops", "Loops of the mesh (polygon corners)");
 	rna_def_mesh_loops(brna, prop);
 
 	prop = RNA_def_property(srna, "polygons", PROP_COLLECTION, PROP_NONE);
 	RNA_def_property_collection_sdna(prop, NULL, "mpoly", "totpoly");
+	RNA_def_property_collection_funcs(prop, "rna_Mesh_polygons_begin", NULL, NULL, NULL,
+	                                  "rna_Mesh_polygons_length", NULL, NULL, NULL);
 	RNA_def_property_struct_type(prop, "MeshPolygon");
 	RNA_def_property_ui_text(prop, "Polygons", "Polygons of the mesh");
 	rna_def_mesh_polygons(brna, prop);
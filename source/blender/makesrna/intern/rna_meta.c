@@ -46,6 +46,7 @@
 #include "DNA_scene_types.h"
 #include "DNA_object_types.h"
 
+#include "BKE_animsys.h"
 #include "BKE_mball.h"
 #include "BKE_depsgraph.h"
 #include "BKE_main.h"
@@ -145,6 +146,7 @@ static void rna_MetaBall_elements_remove(MetaBall *mb, ReportList *reports, Poin
 		DAG_id_tag_update(&mb->id, 0);
 		WM_main_add_notifier(NC_GEOM | ND_DATA, &mb->id);
 	}
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static void rna_MetaBall_elements_clear(MetaBall *mb)
@@ -156,6 +158,7 @@ static void rna_MetaBall_elements_clear(MetaBall *mb)
 		DAG_id_tag_update(&mb->id, 0);
 		WM_main_add_notifier(NC_GEOM | ND_DATA, &mb->id);
 	}
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static int rna_Meta_is_editmode_get(PointerRNA *ptr)
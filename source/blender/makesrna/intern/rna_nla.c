@@ -427,6 +427,7 @@ static void rna_NlaStrip_remove(NlaTrack *track, bContext *C, ReportList *report
 
 	free_nlastrip(&track->strips, strip);
 	RNA_POINTER_INVALIDATE(strip_ptr);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_event_add_notifier(C, NC_ANIMATION | ND_NLA | NA_REMOVED, NULL);
 }
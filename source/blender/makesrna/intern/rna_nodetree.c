@@ -717,6 +717,7 @@ static void rna_NodeTree_node_remove(bNodeTree *ntree, ReportList *reports, Poin
 	RNA_POINTER_INVALIDATE(node_ptr);
 
 	ntreeUpdateTree(G.main, ntree); /* update group node socket links */
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_NODE | NA_EDITED, ntree);
 }
 
@@ -739,6 +740,7 @@ static void rna_NodeTree_node_clear(bNodeTree *ntree, ReportList *reports)
 	}
 
 	ntreeUpdateTree(G.main, ntree);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_NODE | NA_EDITED, ntree);
 }
@@ -827,6 +829,7 @@ static void rna_NodeTree_link_remove(bNodeTree *ntree, ReportList *reports, Poin
 	RNA_POINTER_INVALIDATE(link_ptr);
 
 	ntreeUpdateTree(G.main, ntree);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_NODE | NA_EDITED, ntree);
 }
 
@@ -845,6 +848,7 @@ static void rna_NodeTree_link_clear(bNodeTree *ntree, ReportList *reports)
 		link = next_link;
 	}
 	ntreeUpdateTree(G.main, ntree);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_NODE | NA_EDITED, ntree);
 }
@@ -951,6 +955,7 @@ static void rna_NodeTree_socket_remove(bNodeTree *ntree, ReportList *reports, bN
 		ntreeUpdateTree(G.main, ntree);
 		WM_main_add_notifier(NC_NODE | NA_EDITED, ntree);
 	}
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static void rna_NodeTree_inputs_clear(bNodeTree *ntree, ReportList *reports)
@@ -966,6 +971,7 @@ static void rna_NodeTree_inputs_clear(bNodeTree *ntree, ReportList *reports)
 	}
 
 	ntreeUpdateTree(G.main, ntree);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_NODE | NA_EDITED, ntree);
 }
 
@@ -982,6 +988,7 @@ static void rna_NodeTree_outputs_clear(bNodeTree *ntree, ReportList *reports)
 	}
 
 	ntreeUpdateTree(G.main, ntree);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_NODE | NA_EDITED, ntree);
 }
 
@@ -1630,6 +1637,7 @@ static void rna_Node_socket_remove(ID *id, bNode *node, ReportList *reports, bNo
 		ntreeUpdateTree(G.main, ntree);
 		WM_main_add_notifier(NC_NODE | NA_EDITED, ntree);
 	}
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static void rna_Node_inputs_clear(ID *id, bNode *node)
@@ -1643,6 +1651,7 @@ static void rna_Node_inputs_clear(ID *id, bNode *node)
 	}
 
 	ntreeUpdateTree(G.main, ntree);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_NODE | NA_EDITED, ntree);
 }
 
@@ -1657,6 +1666,7 @@ static void rna_Node_outputs_clear(ID *id, bNode *node)
 	}
 
 	ntreeUpdateTree(G.main, ntree);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_NODE | NA_EDITED, ntree);
 }
 
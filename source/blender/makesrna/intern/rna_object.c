@@ -176,6 +176,7 @@ EnumPropertyItem rna_enum_object_axis_items[] = {
 #include "DNA_lattice_types.h"
 #include "DNA_node_types.h"
 
+#include "BKE_animsys.h"
 #include "BKE_armature.h"
 #include "BKE_bullet.h"
 #include "BKE_constraint.h"
@@ -1339,6 +1340,7 @@ static void rna_Object_constraints_remove(Object *object, ReportList *reports, P
 
 	ED_object_constraint_update(object);
 	ED_object_constraint_set_active(object, NULL);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_OBJECT | ND_CONSTRAINT | NA_REMOVED, object);
 }
 
@@ -1348,6 +1350,7 @@ static void rna_Object_constraints_clear(Object *object)
 
 	ED_object_constraint_update(object);
 	ED_object_constraint_set_active(object, NULL);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_OBJECT | ND_CONSTRAINT | NA_REMOVED, object);
 }
@@ -1367,6 +1370,7 @@ static void rna_Object_modifier_remove(Object *object, bContext *C, ReportList *
 	}
 
 	RNA_POINTER_INVALIDATE(md_ptr);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_OBJECT | ND_MODIFIER | NA_REMOVED, object);
 }
@@ -1374,6 +1378,7 @@ static void rna_Object_modifier_remove(Object *object, bContext *C, ReportList *
 static void rna_Object_modifier_clear(Object *object, bContext *C)
 {
 	ED_object_modifier_clear(CTX_data_main(C), object);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_OBJECT | ND_MODIFIER | NA_REMOVED, object);
 }
@@ -1410,6 +1415,7 @@ static void rna_Object_vgroup_remove(Object *ob, ReportList *reports, PointerRNA
 
 	BKE_object_defgroup_remove(ob, defgroup);
 	RNA_POINTER_INVALIDATE(defgroup_ptr);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_OBJECT | ND_DRAW, ob);
 }
@@ -1417,6 +1423,7 @@ static void rna_Object_vgroup_remove(Object *ob, ReportList *reports, PointerRNA
 static void rna_Object_vgroup_clear(Object *ob)
 {
 	BKE_object_defgroup_remove_all(ob);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_OBJECT | ND_DRAW, ob);
 }
@@ -1433,6 +1440,7 @@ static void rna_VertexGroup_vertex_add(ID *id, bDeformGroup *def, ReportList *re
 
 	while (index_len--)
 		ED_vgroup_vert_add(ob, def, *index++, weight, assignmode);  /* XXX, not efficient calling within loop*/
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_GEOM | ND_DATA, (ID *)ob->data);
 }
@@ -1448,6 +1456,7 @@ static void rna_VertexGroup_vertex_remove(ID *id, bDeformGroup *dg, ReportList *
 
 	while (index_len--)
 		ED_vgroup_vert_remove(ob, dg, *index++);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_GEOM | ND_DATA, (ID *)ob->data);
 }
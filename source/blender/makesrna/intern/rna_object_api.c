@@ -64,6 +64,7 @@ static EnumPropertyItem space_items[] = {
 #include "BLI_math.h"
 
 #include "BKE_anim.h"
+#include "BKE_animsys.h"
 #include "BKE_bvhutils.h"
 #include "BKE_cdderivedmesh.h"
 #include "BKE_constraint.h"
@@ -263,6 +264,7 @@ static void rna_Object_shape_key_remove(
 
 	DAG_id_tag_update(&ob->id, OB_RECALC_DATA);
 	WM_main_add_notifier(NC_OBJECT | ND_DRAW, ob);
+	BKE_animsys_eval_cache_invalidate();
 
 	RNA_POINTER_INVALIDATE(kb_ptr);
 }
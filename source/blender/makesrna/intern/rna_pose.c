@@ -104,6 +104,7 @@ EnumPropertyItem rna_enum_color_sets_items[] = {
 
 #include "BLI_ghash.h"
 
+#include "BKE_animsys.h"
 #include "BKE_context.h"
 #include "BKE_constraint.h"
 #include "BKE_depsgraph.h"
@@ -161,6 +162,7 @@ static void rna_bone_group_remove(ID *id, bPose *pose, ReportList *reports, Poin
 	}
 
 	BKE_pose_remove_group(pose, grp, grp_idx + 1);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_OBJECT | ND_POSE | NA_REMOVED, id);
 }
 
@@ -558,6 +560,7 @@ static void rna_PoseChannel_constraints_remove(ID *id, bPoseChannel *pchan, Repo
 	if (is_ik) {
 		BIK_clear_data(ob->pose);
 	}
+	BKE_animsys_eval_cache_invalidate();
 }
 
 static int rna_PoseChannel_proxy_editable(PointerRNA *ptr, const char **r_info)
@@ -518,6 +518,7 @@ static void rna_GPencil_brush_remove(ToolSettings *ts, ReportList *reports, Poin
 
 	BKE_gpencil_brush_delete(ts, brush);
 	RNA_POINTER_INVALIDATE(brush_ptr);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_GPENCIL | ND_DATA | NA_EDITED, NULL);
 }
@@ -1474,6 +1475,7 @@ static void rna_RenderLayer_remove(
 	RNA_POINTER_INVALIDATE(srl_ptr);
 
 	DAG_id_tag_update(&scene->id, 0);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_SCENE | ND_RENDER_OPTIONS, NULL);
 }
 
@@ -1537,6 +1539,7 @@ static void rna_RenderView_remove(
 	}
 
 	RNA_POINTER_INVALIDATE(srv_ptr);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_SCENE | ND_RENDER_OPTIONS, NULL);
 }
@@ -1935,6 +1938,7 @@ static void rna_TimeLine_remove(Scene *scene, ReportList *reports, PointerRNA *m
 
 	MEM_freeN(marker);
 	RNA_POINTER_INVALIDATE(marker_ptr);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_SCENE | ND_MARKERS, NULL);
 	WM_main_add_notifier(NC_ANIMATION | ND_MARKERS, NULL);
@@ -1943,6 +1947,7 @@ static void rna_TimeLine_remove(Scene *scene, ReportList *reports, PointerRNA *m
 static void rna_TimeLine_clear(Scene *scene)
 {
 	BLI_freelistN(&scene->markers);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_SCENE | ND_MARKERS, NULL);
 	WM_main_add_notifier(NC_ANIMATION | ND_MARKERS, NULL);
@@ -2106,6 +2111,7 @@ static void rna_FreestyleSettings_lineset_remove(
 	RNA_POINTER_INVALIDATE(lineset_ptr);
 
 	DAG_id_tag_update(&scene->id, 0);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_SCENE | ND_RENDER_OPTIONS, NULL);
 }
 
@@ -2165,6 +2171,7 @@ static void rna_FreestyleSettings_module_remove(
 	RNA_POINTER_INVALIDATE(module_ptr);
 
 	DAG_id_tag_update(&scene->id, 0);
+	BKE_animsys_eval_cache_invalidate();
 	WM_main_add_notifier(NC_SCENE | ND_RENDER_OPTIONS, NULL);
 }
 
@@ -7238,6 +7245,13 @@ void RNA_def_scene(BlenderRNA *brna)
 	RNA_def_property_ui_text(prop, "Frame Dropping", "Play back dropping frames if frame display is too slow");
 	RNA_def_property_update(prop, NC_SCENE, NULL);
 
+	prop = RNA_def_property(srna, "use_playback_cache", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", SCE_PLAYBACK_CACHE);
+	RNA_def_property_ui_text(prop, "Cache Playback",
+	                         "Keep evaluated meshes and poses during playback, to reuse them when looping over "
+	                         "the frame range (limited by the memory cache limit)");
+	RNA_def_property_update(prop, NC_SCENE, NULL);
+
 	prop = RNA_def_property(srna, "sync_mode", PROP_ENUM, PROP_NONE);
 	RNA_def_property_enum_funcs(prop, "rna_Scene_sync_mode_get", "rna_Scene_sync_mode_set", NULL);
 	RNA_def_property_enum_items(prop, sync_mode_items);
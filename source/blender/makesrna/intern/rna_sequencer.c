@@ -1067,6 +1067,7 @@ static void rna_Sequence_modifier_remove(Sequence *seq, bContext *C, ReportList
 
 	RNA_POINTER_INVALIDATE(smd_ptr);
 	BKE_sequence_invalidate_cache_for_modifier(scene, seq);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_SCENE | ND_SEQUENCER, NULL);
 }
@@ -1078,6 +1079,7 @@ static void rna_Sequence_modifier_clear(Sequence *seq, bContext *C)
 	BKE_sequence_modifier_clear(seq);
 
 	BKE_sequence_invalidate_cache_for_modifier(scene, seq);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_SCENE | ND_SEQUENCER, NULL);
 }
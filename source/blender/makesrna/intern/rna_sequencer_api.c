@@ -47,6 +47,7 @@
 
 #include "BLI_path_util.h" /* BLI_split_dirfile */
 
+#include "BKE_animsys.h"
 #include "BKE_image.h"
 #include "BKE_library.h" /* id_us_plus */
 #include "BKE_movieclip.h"
@@ -337,6 +338,7 @@ static void rna_Sequences_remove(ID *id, Editing *ed, ReportList *reports, Point
 
 	BKE_sequence_free(scene, seq);
 	RNA_POINTER_INVALIDATE(seq_ptr);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_SCENE | ND_SEQUENCER, scene);
 }
@@ -352,6 +354,7 @@ static StripElem *rna_SequenceElements_append(ID *id, Sequence *seq, const char
 	seq->len++;
 
 	BKE_sequence_calc_disp(scene, seq);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_SCENE | ND_SEQUENCER, scene);
 
@@ -392,6 +395,7 @@ static void rna_SequenceElements_pop(ID *id, Sequence *seq, ReportList *reports,
 	seq->strip->stripdata = new_seq;
 
 	BKE_sequence_calc_disp(scene, seq);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_SCENE | ND_SEQUENCER, scene);
 }
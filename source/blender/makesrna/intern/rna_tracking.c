@@ -48,6 +48,7 @@
 
 #ifdef RNA_RUNTIME
 
+#include "BKE_animsys.h"
 #include "BKE_depsgraph.h"
 #include "BKE_node.h"
 
@@ -700,6 +701,7 @@ static void rna_trackingObject_remove(MovieTracking *tracking, ReportList *repor
 	}
 
 	RNA_POINTER_INVALIDATE(object_ptr);
+	BKE_animsys_eval_cache_invalidate();
 
 	WM_main_add_notifier(NC_MOVIECLIP | NA_EDITED, NULL);
 }
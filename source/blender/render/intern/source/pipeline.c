@@ -3493,6 +3493,12 @@ static int do_write_image_or_movie(Render *re, Main *bmain, Scene *scene, bMovie
 	printf(" (Saving: %s)\n", name);
 	
 	fputc('\n', stdout);
+
+	if (G.debug & G_DEBUG_MEMORY_STATS) {
+		MEM_print_category_stats();
+		fputc('\n', stdout);
+	}
+
 	fflush(stdout); /* needed for renderd !! (not anymore... (ton)) */
 
 	return ok;
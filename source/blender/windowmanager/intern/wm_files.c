@@ -87,7 +87,9 @@
 #include "BKE_scene.h"
 #include "BKE_screen.h"
 
+#include "BLO_journalfile.h"
 #include "BLO_readfile.h"
+#include "BLO_undofile.h"
 #include "BLO_writefile.h"
 
 #include "RNA_access.h"
@@ -1150,6 +1152,7 @@ static int wm_file_write(bContext *C, const char *filepath, int fileflags, Repor
 		}
 
 		BKE_BIT_TEST_SET(G.fileflags, fileflags & G_FILE_COMPRESS, G_FILE_COMPRESS);
+		BKE_BIT_TEST_SET(G.fileflags, fileflags & G_FILE_COMPRESS_FAST, G_FILE_COMPRESS_FAST);
 		BKE_BIT_TEST_SET(G.fileflags, fileflags & G_FILE_AUTOPLAY, G_FILE_AUTOPLAY);
 
 		/* prevent background mode scripts from clobbering history */
@@ -1226,8 +1229,36 @@ void WM_autosave_init(wmWindowManager *wm)
 		wm->autosavetimer = WM_event_add_timer(wm, NULL, TIMERAUTOSAVE, U.savetime * 60.0);
 }
 
+typedef struct AutosaveJob {
+	/* shares the data of the undo step, which can be freed while writing */
+	MemFile memfile;
+	char filepath[FILE_MAX];
+} AutosaveJob;
+
+static void wm_autosave_startjob(void *customdata, short *UNUSED(stop), short *UNUSED(do_update), float *UNUSED(progress))
+{
+	AutosaveJob *aj = customdata;
+
+	if (!BLO_memfile_write_journal(&aj->memfile, aj->filepath)) {
+		fprintf(stderr, "Unable to save '%s': %s\n",
+		        aj->filepath, errno ? strerror(errno) : "Unknown error writing file");
+	}
+}
+
+/* called from the main thread, like everything changing the users of memfile chunks */
+static void wm_autosave_freejob(void *customdata)
+{
+	AutosaveJob *aj = customdata;
+
+	BLO_memfile_free(&aj->memfile);
+	MEM_freeN(aj);
+}
+
 void wm_autosave_timer(const bContext *C, wmWindowManager *wm, wmTimer *UNUSED(wt))
 {
+	AutosaveJob *aj;
+	wmJob *wm_job;
+	const MemFile *memfile_undo;
 	wmWindow *win;
 	wmEventHandler *handler;
 	char filepath[FILE_MAX];
@@ -1247,22 +1278,39 @@ void wm_autosave_timer(const bContext *C, wmWindowManager *wm, wmTimer *UNUSED(w
 		}
 	}
 
+	/* previous auto-save is still being written (slow disk), try again later as well */
+	if (WM_jobs_test(wm, wm, WM_JOB_TYPE_AUTOSAVE)) {
+		wm->autosavetimer = WM_event_add_timer(wm, NULL, TIMERAUTOSAVE, 10.0);
+		return;
+	}
+
 	wm_autosave_location(filepath);
 
-	if (U.uiflag & USER_GLOBALUNDO) {
-		/* fast save of last undobuffer, now with UI */
-		BKE_undo_save_file(filepath);
+	/* Take a snapshot in memory here, writing it to disk is done by a job
+	 * so the interface doesn't wait on the disk. */
+	aj = MEM_callocN(sizeof(*aj), __func__);
+	BLI_strncpy(aj->filepath, filepath, sizeof(aj->filepath));
+
+	memfile_undo = BKE_undo_memfile_get();
+	if (memfile_undo) {
+		/* last undobuffer, now with UI */
+		BLO_memfile_share(&aj->memfile, memfile_undo);
 	}
 	else {
-		/*  save as regular blend file */
 		int fileflags = G.fileflags & ~(G_FILE_COMPRESS | G_FILE_AUTOPLAY | G_FILE_HISTORY);
 
 		ED_editors_flush_edits(C, false);
 
-		/* Error reporting into console */
-		BLO_write_file(CTX_data_main(C), filepath, fileflags, NULL, NULL);
+		BLO_write_file_mem(CTX_data_main(C), NULL, &aj->memfile, fileflags);
 	}
-	/* do timer after file write, just in case file write takes a long time */
+
+	/* only what changed since the last auto-save is written */
+	wm_job = WM_jobs_get(wm, NULL, wm, "Auto-Save", 0, WM_JOB_TYPE_AUTOSAVE);
+	WM_jobs_customdata_set(wm_job, aj, wm_autosave_freejob);
+	WM_jobs_timer(wm_job, 0.5, 0, 0);
+	WM_jobs_callbacks(wm_job, wm_autosave_startjob, NULL, NULL, NULL);
+	WM_jobs_start(wm, wm_job);
+
 	wm->autosavetimer = WM_event_add_timer(wm, NULL, TIMERAUTOSAVE, U.savetime * 60.0);
 }
 
@@ -1284,8 +1332,9 @@ void wm_autosave_delete(void)
 		char str[FILE_MAX];
 		BLI_make_file_string("/", str, BKE_tempdir_base(), BLENDER_QUIT_FILE);
 
-		/* if global undo; remove tempsave, otherwise rename */
+		/* if global undo; remove tempsave, otherwise write it as a regular file */
 		if (U.uiflag & USER_GLOBALUNDO) BLI_delete(filename, false, false);
+		else if (BLO_journal_compact(filename, str)) BLI_delete(filename, false, false);
 		else BLI_rename(filename, str);
 	}
 }
@@ -1953,6 +2002,11 @@ static void wm_filepath_default(char *filepath)
 	}
 }
 
+enum {
+	FILE_COMPRESS_ZLIB = 0,
+	FILE_COMPRESS_LZO = 1,
+};
+
 static void save_set_compress(wmOperator *op)
 {
 	PropertyRNA *prop;
@@ -1966,6 +2020,28 @@ static void save_set_compress(wmOperator *op)
 			RNA_property_boolean_set(op->ptr, prop, (U.flag & USER_FILECOMPRESS) != 0);
 		}
 	}
+
+	prop = RNA_struct_find_property(op->ptr, "compress_type");
+	if (!RNA_property_is_set(op->ptr, prop)) {
+		/* keep the compression of an existing file, new files use zlib */
+		RNA_property_enum_set(op->ptr, prop,
+		                      (G.save_over && (G.fileflags & G_FILE_COMPRESS_FAST)) ?
+		                      FILE_COMPRESS_LZO : FILE_COMPRESS_ZLIB);
+	}
+}
+
+static void save_def_compress(wmOperatorType *ot)
+{
+	static EnumPropertyItem compress_type_items[] = {
+		{FILE_COMPRESS_ZLIB, "ZLIB", 0, "Zlib", "Smaller files, slower to save and load"},
+		{FILE_COMPRESS_LZO, "LZO", 0, "LZO",
+		 "Larger files, much faster to save and load (can't be opened by older versions of Blender)"},
+		{0, NULL, 0, NULL, NULL}
+	};
+
+	RNA_def_boolean(ot->srna, "compress", false, "Compress", "Write compressed .blend file");
+	RNA_def_enum(ot->srna, "compress_type", compress_type_items, FILE_COMPRESS_ZLIB, "Compression",
+	             "Compression method used when compressing the .blend file");
 }
 
 static void save_set_filepath(wmOperator *op)
@@ -2021,6 +2097,8 @@ static int wm_save_as_mainfile_exec(bContext *C, wmOperator *op)
 	/* set compression flag */
 	BKE_BIT_TEST_SET(fileflags, RNA_boolean_get(op->ptr, "compress"),
 	                 G_FILE_COMPRESS);
+	BKE_BIT_TEST_SET(fileflags, RNA_enum_get(op->ptr, "compress_type") == FILE_COMPRESS_LZO,
+	                 G_FILE_COMPRESS_FAST);
 	BKE_BIT_TEST_SET(fileflags, RNA_boolean_get(op->ptr, "relative_remap"),
 	                 G_FILE_RELATIVE_REMAP);
 	BKE_BIT_TEST_SET(fileflags,
@@ -2076,7 +2154,7 @@ void WM_OT_save_as_mainfile(wmOperatorType *ot)
 	WM_operator_properties_filesel(
 	        ot, FILE_TYPE_FOLDER | FILE_TYPE_BLENDER, FILE_BLENDER, FILE_SAVE,
 	        WM_FILESEL_FILEPATH, FILE_DEFAULTDISPLAY, FILE_SORT_ALPHA);
-	RNA_def_boolean(ot->srna, "compress", false, "Compress", "Write compressed .blend file");
+	save_def_compress(ot);
 	RNA_def_boolean(ot->srna, "relative_remap", true, "Remap Relative",
 	                "Remap relative paths when saving in a different directory");
 	prop = RNA_def_boolean(ot->srna, "copy", false, "Save Copy",
@@ -2142,7 +2220,7 @@ void WM_OT_save_mainfile(wmOperatorType *ot)
 	WM_operator_properties_filesel(
 	        ot, FILE_TYPE_FOLDER | FILE_TYPE_BLENDER, FILE_BLENDER, FILE_SAVE,
 	        WM_FILESEL_FILEPATH, FILE_DEFAULTDISPLAY, FILE_SORT_ALPHA);
-	RNA_def_boolean(ot->srna, "compress", false, "Compress", "Write compressed .blend file");
+	save_def_compress(ot);
 	RNA_def_boolean(ot->srna, "relative_remap", false, "Remap Relative",
 	                "Remap relative paths when saving in a different directory");
 }
@@ -269,6 +269,7 @@ int main(
 	 *       guarded allocator before any allocation happened.
 	 */
 	{
+		bool use_threadcache_alloc = false;
 		int i;
 		for (i = 0; i < argc; i++) {
 			if (STREQ(argv[i], "--debug") || STREQ(argv[i], "-d") ||
@@ -276,12 +277,20 @@ int main(
 			{
 				printf("Switching to fully guarded memory allocator.\n");
 				MEM_use_guarded_allocator();
+				use_threadcache_alloc = false;
 				break;
 			}
+			else if (STREQ(argv[i], "--enable-threadcache-alloc")) {
+				use_threadcache_alloc = true;
+			}
 			else if (STREQ(argv[i], "--")) {
 				break;
 			}
 		}
+		if (use_threadcache_alloc) {
+			printf("Switching to thread caching memory allocator.\n");
+			MEM_use_threadcache_allocator();
+		}
 	}
 
 #ifdef BUILD_DATE
@@ -43,7 +43,9 @@
 #include "BLI_path_util.h"
 #include "BLI_fileops.h"
 #include "BLI_mempool.h"
+#include "BLI_trace.h"
 
+#include "BKE_blender.h"
 #include "BKE_blender_version.h"
 #include "BKE_context.h"
 
@@ -546,16 +548,21 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
 	BLI_argsPrintArgDoc(ba, "--debug-cycles");
 #endif
 	BLI_argsPrintArgDoc(ba, "--debug-memory");
+	BLI_argsPrintArgDoc(ba, "--debug-memory-stats");
 	BLI_argsPrintArgDoc(ba, "--debug-jobs");
 	BLI_argsPrintArgDoc(ba, "--debug-python");
 	BLI_argsPrintArgDoc(ba, "--debug-depsgraph");
 	BLI_argsPrintArgDoc(ba, "--debug-depsgraph-no-threads");
+	BLI_argsPrintArgDoc(ba, "--debug-depsgraph-time");
 
 	BLI_argsPrintArgDoc(ba, "--debug-gpumem");
 	BLI_argsPrintArgDoc(ba, "--debug-wm");
 	BLI_argsPrintArgDoc(ba, "--debug-all");
 	BLI_argsPrintArgDoc(ba, "--debug-io");
 
+	printf("\n");
+	BLI_argsPrintArgDoc(ba, "--profile");
+
 	printf("\n");
 	BLI_argsPrintArgDoc(ba, "--debug-fpe");
 	BLI_argsPrintArgDoc(ba, "--disable-crash-handler");
@@ -589,6 +596,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
 	printf("Experimental Features:\n");
 	BLI_argsPrintArgDoc(ba, "--enable-new-depsgraph");
 	BLI_argsPrintArgDoc(ba, "--enable-new-basic-shader-glsl");
+	BLI_argsPrintArgDoc(ba, "--enable-threadcache-alloc");
 
 	/* Other options _must_ be last (anything not handled will show here) */
 	printf("\n");
@@ -748,8 +756,12 @@ static const char arg_handle_debug_mode_generic_set_doc_depsgraph[] =
 "\n\tEnable debug messages from dependency graph";
 static const char arg_handle_debug_mode_generic_set_doc_depsgraph_no_threads[] =
 "\n\tSwitch dependency graph to a single threaded evaluation";
+static const char arg_handle_debug_mode_generic_set_doc_depsgraph_time[] =
+"\n\tPrint time spent evaluating every data-block and component of the dependency graph";
 static const char arg_handle_debug_mode_generic_set_doc_gpumem[] =
 "\n\tEnable GPU memory stats in status bar";
+static const char arg_handle_debug_mode_generic_set_doc_memory_stats[] =
+"\n\tPrint memory usage per category (mesh, image, cache, depsgraph, undo) for every rendered frame";
 
 static int arg_handle_debug_mode_generic_set(int UNUSED(argc), const char **UNUSED(argv), void *data)
 {
@@ -836,6 +848,48 @@ static int arg_handle_debug_value_set(int argc, const char **argv, void *UNUSED(
 	}
 }
 
+static void callback_profile_write(void *user_data)
+{
+	char *filepath = user_data;
+	FILE *fp = BLI_fopen(filepath, "w");
+	bool ok = false;
+
+	if (fp) {
+		ok = BLI_trace_write_chrome_json(fp);
+		fclose(fp);
+	}
+
+	if (ok) {
+		printf("Profile written to '%s'\n", filepath);
+	}
+	else {
+		printf("\nError: could not write profile to '%s'.\n", filepath);
+	}
+	BLI_trace_free();
+
+	MEM_freeN(filepath);
+}
+
+static const char arg_handle_profile_set_doc[] =
+"<filepath>\n"
+"\tRecord a trace of the run and write it to <filepath> on exit,\n"
+"\tin the Chrome trace-event JSON format (open with chrome://tracing)\n"
+;
+static int arg_handle_profile_set(int argc, const char **argv, void *UNUSED(data))
+{
+	if (argc > 1) {
+		if (!BLI_trace_is_enabled()) {
+			BLI_trace_enable();
+			BKE_blender_atexit_register(callback_profile_write, BLI_strdup(argv[1]));
+		}
+		return 1;
+	}
+	else {
+		printf("\nError: you must specify a path after '--profile'.\n");
+		return 0;
+	}
+}
+
 static const char arg_handle_debug_fpe_set_doc[] =
 "\n\tEnable floating point exceptions"
 ;
@@ -1195,6 +1249,15 @@ static int arg_handle_depsgraph_use_new(int UNUSED(argc), const char **UNUSED(ar
 	return 0;
 }
 
+static const char arg_handle_threadcache_alloc_use_doc[] =
+"\n\tUse memory allocator which caches small blocks per thread (scales better with many threads)"
+;
+static int arg_handle_threadcache_alloc_use(int UNUSED(argc), const char **UNUSED(argv), void *UNUSED(data))
+{
+	/* Handled in main() already, the allocator has to be switched before any allocation. */
+	return 0;
+}
+
 static const char arg_handle_basic_shader_glsl_use_new_doc[] =
 "\n\tUse new GLSL basic shader"
 ;
@@ -1828,9 +1891,12 @@ void main_args_setup(bContext *C, bArgs *ba, SYS_SystemHandle *syshandle)
 	BLI_argsAdd(ba, 1, NULL, "--debug-cycles", CB(arg_handle_debug_mode_cycles), NULL);
 #endif
 	BLI_argsAdd(ba, 1, NULL, "--debug-memory", CB(arg_handle_debug_mode_memory_set), NULL);
+	BLI_argsAdd(ba, 1, NULL, "--debug-memory-stats",
+	            CB_EX(arg_handle_debug_mode_generic_set, memory_stats), (void *)G_DEBUG_MEMORY_STATS);
 
 	BLI_argsAdd(ba, 1, NULL, "--debug-value",
 	            CB(arg_handle_debug_value_set), NULL);
+	BLI_argsAdd(ba, 1, NULL, "--profile", CB(arg_handle_profile_set), NULL);
 	BLI_argsAdd(ba, 1, NULL, "--debug-jobs",
 	            CB_EX(arg_handle_debug_mode_generic_set, jobs), (void *)G_DEBUG_JOBS);
 	BLI_argsAdd(ba, 1, NULL, "--debug-gpu",
@@ -1839,11 +1905,14 @@ void main_args_setup(bContext *C, bArgs *ba, SYS_SystemHandle *syshandle)
 	            CB_EX(arg_handle_debug_mode_generic_set, depsgraph), (void *)G_DEBUG_DEPSGRAPH);
 	BLI_argsAdd(ba, 1, NULL, "--debug-depsgraph-no-threads",
 	            CB_EX(arg_handle_debug_mode_generic_set, depsgraph_no_threads), (void *)G_DEBUG_DEPSGRAPH_NO_THREADS);
+	BLI_argsAdd(ba, 1, NULL, "--debug-depsgraph-time",
+	            CB_EX(arg_handle_debug_mode_generic_set, depsgraph_time), (void *)G_DEBUG_DEPSGRAPH_TIME);
 	BLI_argsAdd(ba, 1, NULL, "--debug-gpumem",
 	            CB_EX(arg_handle_debug_mode_generic_set, gpumem), (void *)G_DEBUG_GPU_MEM);
 
 	BLI_argsAdd(ba, 1, NULL, "--enable-new-depsgraph", CB(arg_handle_depsgraph_use_new), NULL);
 	BLI_argsAdd(ba, 1, NULL, "--enable-new-basic-shader-glsl", CB(arg_handle_basic_shader_glsl_use_new), NULL);
+	BLI_argsAdd(ba, 1, NULL, "--enable-threadcache-alloc", CB(arg_handle_threadcache_alloc_use), NULL);
 
 	BLI_argsAdd(ba, 1, NULL, "--verbose", CB(arg_handle_verbosity_set), NULL);
 
@@ -0,0 +1,194 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <math.h>
+
+extern "C" {
+#include "BLI_expr_pylike_eval.h"
+#include "BLI_math_base.h"
+}
+
+static void expr_pylike_parse_fail_test(const char *str)
+{
+	ExprPyLike_Parsed *expr = BLI_expr_pylike_parse(str, NULL, 0);
+
+	EXPECT_FALSE(BLI_expr_pylike_is_valid(expr));
+
+	BLI_expr_pylike_free(expr);
+}
+
+static void expr_pylike_eval_test(const char *str, double expected, double x = 1.0)
+{
+	const char *names[1] = {"x"};
+	ExprPyLike_Parsed *expr = BLI_expr_pylike_parse(str, names, 1);
+	double result;
+
+	EXPECT_TRUE(BLI_expr_pylike_is_valid(expr)) << str;
+	EXPECT_EQ(BLI_expr_pylike_eval(expr, &x, 1, &result), EXPR_PYLIKE_SUCCESS) << str;
+	EXPECT_EQ(result, expected) << str;
+
+	BLI_expr_pylike_free(expr);
+}
+
+static void expr_pylike_error_test(const char *str, eExprPyLike_EvalStatus error, double x = 1.0)
+{
+	const char *names[1] = {"x"};
+	ExprPyLike_Parsed *expr = BLI_expr_pylike_parse(str, names, 1);
+	double result;
+
+	EXPECT_TRUE(BLI_expr_pylike_is_valid(expr)) << str;
+	EXPECT_EQ(BLI_expr_pylike_eval(expr, &x, 1, &result), error) << str;
+
+	BLI_expr_pylike_free(expr);
+}
+
+TEST(expr_pylike_eval, ParseFail)
+{
+	expr_pylike_parse_fail_test("");
+	expr_pylike_parse_fail_test("1 +");
+	expr_pylike_parse_fail_test("(1");
+	expr_pylike_parse_fail_test("1)");
+	expr_pylike_parse_fail_test("1 2");
+	expr_pylike_parse_fail_test("01");
+	expr_pylike_parse_fail_test("1e");
+	expr_pylike_parse_fail_test("1j");
+	expr_pylike_parse_fail_test("0x10");
+	expr_pylike_parse_fail_test("1.2.3");
+	expr_pylike_parse_fail_test("a");
+	expr_pylike_parse_fail_test("sin");
+	expr_pylike_parse_fail_test("sin()");
+	expr_pylike_parse_fail_test("sin(1, 2)");
+	expr_pylike_parse_fail_test("min(1)");
+	expr_pylike_parse_fail_test("pi()");
+	expr_pylike_parse_fail_test("1 < 2 < 3");
+	expr_pylike_parse_fail_test("1 + not 2");
+	expr_pylike_parse_fail_test("1 if 2");
+	expr_pylike_parse_fail_test("bpy.data");
+	expr_pylike_parse_fail_test("'text'");
+	expr_pylike_parse_fail_test("[1]");
+	expr_pylike_parse_fail_test("1 in 2");
+}
+
+TEST(expr_pylike_eval, ParseCallParameter)
+{
+	const char *names[1] = {"sin"};
+	ExprPyLike_Parsed *expr = BLI_expr_pylike_parse("sin(1)", names, 1);
+
+	EXPECT_FALSE(BLI_expr_pylike_is_valid(expr));
+
+	BLI_expr_pylike_free(expr);
+}
+
+TEST(expr_pylike_eval, ParameterLastNameWins)
+{
+	const char *names[2] = {"frame", "frame"};
+	const double values[2] = {1.0, 2.0};
+	ExprPyLike_Parsed *expr = BLI_expr_pylike_parse("frame", names, 2);
+	double result;
+
+	EXPECT_EQ(BLI_expr_pylike_eval(expr, values, 2, &result), EXPR_PYLIKE_SUCCESS);
+	EXPECT_EQ(result, 2.0);
+	EXPECT_EQ(BLI_expr_pylike_eval(expr, values, 1, &result), EXPR_PYLIKE_FATAL_ERROR);
+
+	BLI_expr_pylike_free(expr);
+}
+
+TEST(expr_pylike_eval, Arithmetic)
+{
+	expr_pylike_eval_test("1 + 2 * 3", 7.0);
+	expr_pylike_eval_test("(1 + 2) * 3", 9.0);
+	expr_pylike_eval_test("10 - 4 - 3", 3.0);
+	expr_pylike_eval_test("1 / 4", 0.25);
+	expr_pylike_eval_test("-x ** 2", -4.0, 2.0);
+	expr_pylike_eval_test("2 ** -1", 0.5);
+	expr_pylike_eval_test("2 ** 3 ** 2", 512.0);
+	expr_pylike_eval_test("+-+x", -3.0, 3.0);
+	expr_pylike_eval_test(".5 + 1. + 1e1 + 2.5E-1", 11.75);
+	expr_pylike_eval_test("0 + 00 + 0.0 + 01.5", 1.5);
+}
+
+TEST(expr_pylike_eval, FloorDivMod)
+{
+	expr_pylike_eval_test("7 // 2", 3.0);
+	expr_pylike_eval_test("-7 // 2", -4.0);
+	expr_pylike_eval_test("7 // -2", -4.0);
+	expr_pylike_eval_test("7 % 3", 1.0);
+	expr_pylike_eval_test("-7 % 3", 2.0);
+	expr_pylike_eval_test("7 % -3", -2.0);
+	expr_pylike_eval_test("-7.5 % 2", 0.5);
+}
+
+TEST(expr_pylike_eval, Functions)
+{
+	expr_pylike_eval_test("sin(x)", sin(0.5), 0.5);
+	expr_pylike_eval_test("atan2(x, 2)", atan2(0.5, 2.0), 0.5);
+	expr_pylike_eval_test("sqrt(x) + pow(x, 3)", 66.0, 4.0);
+	expr_pylike_eval_test("abs(x) + fabs(x)", 5.0, -2.5);
+	expr_pylike_eval_test("floor(x) + ceil(x)", -5.0, -2.5);
+	expr_pylike_eval_test("radians(180)", M_PI);
+	expr_pylike_eval_test("degrees(pi)", 180.0);
+	expr_pylike_eval_test("min(3, x, 2)", 1.0);
+	expr_pylike_eval_test("max(3, x, 2)", 3.0);
+	expr_pylike_eval_test("max(x, -x) * min(1, 2)", 4.0, -4.0);
+	expr_pylike_eval_test("e", M_E);
+}
+
+TEST(expr_pylike_eval, Logic)
+{
+	expr_pylike_eval_test("x > 1", 1.0, 2.0);
+	expr_pylike_eval_test("x <= 1", 0.0, 2.0);
+	expr_pylike_eval_test("x == 2 and x != 3", 1.0, 2.0);
+	expr_pylike_eval_test("not x", 0.0, 2.0);
+	expr_pylike_eval_test("not not x", 1.0, 2.0);
+	expr_pylike_eval_test("x or 3", 2.0, 2.0);
+	expr_pylike_eval_test("x or 3", 3.0, 0.0);
+	expr_pylike_eval_test("x and 3", 3.0, 2.0);
+	expr_pylike_eval_test("x and 3", 0.0, 0.0);
+	expr_pylike_eval_test("0 or x and 0 or 5", 5.0, 2.0);
+	expr_pylike_eval_test("True + True + False", 2.0);
+}
+
+TEST(expr_pylike_eval, Ternary)
+{
+	expr_pylike_eval_test("1 if x > 0 else 2", 1.0, 1.0);
+	expr_pylike_eval_test("1 if x > 0 else 2", 2.0, -1.0);
+	expr_pylike_eval_test("(x or 1) if x > 1 else (x and 2) if x else 3", 5.0, 5.0);
+	expr_pylike_eval_test("(x or 1) if x > 1 else (x and 2) if x else 3", 2.0, 0.5);
+	expr_pylike_eval_test("(x or 1) if x > 1 else (x and 2) if x else 3", 3.0, 0.0);
+	expr_pylike_eval_test("1 + (x if x else 4) * 2", 9.0, 0.0);
+}
+
+TEST(expr_pylike_eval, Lazy)
+{
+	/* only the branch Python evaluates may raise an error */
+	expr_pylike_eval_test("1 / x if x else 0", 0.0, 0.0);
+	expr_pylike_eval_test("x and 1 / x", 0.0, 0.0);
+	expr_pylike_eval_test("not x or 1 / x", 1.0, 0.0);
+}
+
+TEST(expr_pylike_eval, Errors)
+{
+	expr_pylike_error_test("1 / x", EXPR_PYLIKE_DIV_BY_ZERO, 0.0);
+	expr_pylike_error_test("1 // x", EXPR_PYLIKE_DIV_BY_ZERO, 0.0);
+	expr_pylike_error_test("1 % x", EXPR_PYLIKE_DIV_BY_ZERO, 0.0);
+	expr_pylike_error_test("x ** -1", EXPR_PYLIKE_DIV_BY_ZERO, 0.0);
+	expr_pylike_error_test("x ** 0.5", EXPR_PYLIKE_MATH_ERROR, -1.0);
+	expr_pylike_error_test("10.0 ** 400", EXPR_PYLIKE_MATH_ERROR);
+	expr_pylike_error_test("sqrt(x)", EXPR_PYLIKE_MATH_ERROR, -1.0);
+	expr_pylike_error_test("log(x)", EXPR_PYLIKE_MATH_ERROR, 0.0);
+	expr_pylike_error_test("asin(x)", EXPR_PYLIKE_MATH_ERROR, 2.0);
+	expr_pylike_error_test("exp(x)", EXPR_PYLIKE_MATH_ERROR, 1000.0);
+	expr_pylike_error_test("floor(x)", EXPR_PYLIKE_MATH_ERROR, INFINITY);
+}
+
+TEST(expr_pylike_eval, Invalid)
+{
+	ExprPyLike_Parsed *expr = BLI_expr_pylike_parse("1 +", NULL, 0);
+	double result = 1.0;
+
+	EXPECT_EQ(BLI_expr_pylike_eval(expr, NULL, 0, &result), EXPR_PYLIKE_INVALID);
+	EXPECT_EQ(result, 0.0);
+
+	BLI_expr_pylike_free(expr);
+}
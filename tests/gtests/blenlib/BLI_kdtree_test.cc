@@ -0,0 +1,120 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_compiler_attrs.h"
+#include "BLI_kdtree.h"
+#include "BLI_rand.h"
+#include "BLI_math_vector.h"
+#include "MEM_guardedalloc.h"
+}
+
+/* -------------------------------------------------------------------- */
+/* Helper Functions */
+
+static KDTree *kdtree_random_new(float (**r_points)[3], int points_len, int random_seed)
+{
+	struct RNG *rng = BLI_rng_new(random_seed);
+	KDTree *tree = BLI_kdtree_new(points_len);
+	float (*points)[3] = (float (*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+	for (int i = 0; i < points_len; i++) {
+		BLI_rng_get_float_unit_v3(rng, points[i]);
+		mul_v3_fl(points[i], BLI_rng_get_float(rng));
+		BLI_kdtree_insert(tree, i, points[i]);
+	}
+	BLI_kdtree_balance(tree);
+	BLI_rng_free(rng);
+	*r_points = points;
+	return tree;
+}
+
+/* -------------------------------------------------------------------- */
+/* Tests */
+
+TEST(kdtree, Empty)
+{
+	KDTree *tree = BLI_kdtree_new(0);
+	const float co[3] = {0.0f, 0.0f, 0.0f};
+	BLI_kdtree_balance(tree);
+	EXPECT_EQ(-1, BLI_kdtree_find_nearest(tree, co, NULL));
+	BLI_kdtree_free(tree);
+}
+
+/* Uses enough points for the balancing to run threaded. */
+static void find_nearest_points_test(int points_len, int random_seed)
+{
+	float (*points)[3];
+	KDTree *tree = kdtree_random_new(&points, points_len, random_seed);
+	for (int i = 0; i < points_len; i++) {
+		KDTreeNearest nearest;
+		const int j = BLI_kdtree_find_nearest(tree, points[i], &nearest);
+		EXPECT_GE(j, 0);
+		EXPECT_LT(j, points_len);
+		EXPECT_EQ_ARRAY(points[i], points[j], 3);
+		EXPECT_EQ(0.0f, nearest.dist);
+	}
+	BLI_kdtree_free(tree);
+	MEM_freeN(points);
+}
+
+TEST(kdtree, FindNearest_1)		{ find_nearest_points_test(1, 1234); }
+TEST(kdtree, FindNearest_500)		{ find_nearest_points_test(500, 12); }
+TEST(kdtree, FindNearest_100000)	{ find_nearest_points_test(100000, 123); }
+
+TEST(kdtree, FindNearestNArray)
+{
+	const int points_len = 5000;
+	const unsigned int n = 4;
+	float (*points)[3];
+	KDTree *tree = kdtree_random_new(&points, points_len, 42);
+
+	KDTreeNearest *nearest = (KDTreeNearest *)MEM_mallocN(sizeof(*nearest) * points_len * n, __func__);
+	int *nearest_len = (int *)MEM_mallocN(sizeof(int) * points_len, __func__);
+	BLI_kdtree_find_nearest_n_array(tree, points, points_len, nearest, nearest_len, n);
+
+	for (int i = 0; i < points_len; i += 97) {
+		KDTreeNearest nearest_single[n];
+		const int found = BLI_kdtree_find_nearest_n(tree, points[i], nearest_single, n);
+		EXPECT_EQ(found, nearest_len[i]);
+		for (int j = 0; j < found; j++) {
+			EXPECT_EQ(nearest_single[j].dist, nearest[i * n + j].dist);
+		}
+	}
+
+	MEM_freeN(nearest);
+	MEM_freeN(nearest_len);
+	BLI_kdtree_free(tree);
+	MEM_freeN(points);
+}
+
+TEST(kdtree, CalcDuplicates)
+{
+	const float points[][3] = {
+		{0.0f, 0.0f, 0.0f},
+		{1.0f, 0.0f, 0.0f},
+		{0.0f, 0.0f, 0.001f},
+		{1.0f, 0.001f, 0.0f},
+		{0.0f, 0.001f, 0.0f},
+		{5.0f, 0.0f, 0.0f},
+	};
+	const int points_len = ARRAY_SIZE(points);
+	int duplicates[ARRAY_SIZE(points)];
+
+	KDTree *tree = BLI_kdtree_new(points_len);
+	for (int i = 0; i < points_len; i++) {
+		BLI_kdtree_insert(tree, i, points[i]);
+		duplicates[i] = -1;
+	}
+	BLI_kdtree_balance(tree);
+
+	EXPECT_EQ(3, BLI_kdtree_calc_duplicates_fast(tree, 0.01f, true, duplicates));
+	EXPECT_EQ(0, duplicates[0]);
+	EXPECT_EQ(1, duplicates[1]);
+	EXPECT_EQ(0, duplicates[2]);
+	EXPECT_EQ(1, duplicates[3]);
+	EXPECT_EQ(0, duplicates[4]);
+	EXPECT_EQ(-1, duplicates[5]);
+
+	BLI_kdtree_free(tree);
+}
@@ -0,0 +1,88 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_math.h"
+
+/* Reference product, written out the same way as the scalar code in math_matrix.c. */
+static void mul_m4_m4m4_reference(float r[4][4], float a[4][4], float b[4][4])
+{
+	for (int j = 0; j < 4; j++) {
+		for (int k = 0; k < 4; k++) {
+			r[j][k] = b[j][0] * a[0][k] + b[j][1] * a[1][k] + b[j][2] * a[2][k] + b[j][3] * a[3][k];
+		}
+	}
+}
+
+static void math_matrix_test_init(float a[4][4], float b[4][4])
+{
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			a[i][j] = 0.1f * (float)(i * 4 + j) - 0.7f;
+			b[i][j] = 1.0f / (float)(i + 2 * j + 1);
+		}
+	}
+}
+
+TEST(math_matrix, MulM4M4M4Exact)
+{
+	float a[4][4], b[4][4], r[4][4], r_ref[4][4];
+	math_matrix_test_init(a, b);
+
+	mul_m4_m4m4(r, a, b);
+	mul_m4_m4m4_reference(r_ref, a, b);
+
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			EXPECT_EQ(r_ref[i][j], r[i][j]);
+		}
+	}
+}
+
+TEST(math_matrix, MulM4M4M4Aliased)
+{
+	float a[4][4], b[4][4], r[4][4], r_ref[4][4];
+
+	/* result written over the first operand */
+	math_matrix_test_init(a, b);
+	mul_m4_m4m4_reference(r_ref, a, b);
+	copy_m4_m4(r, a);
+	mul_m4_m4m4(r, r, b);
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			EXPECT_EQ(r_ref[i][j], r[i][j]);
+		}
+	}
+
+	/* result written over the second operand */
+	mul_m4_m4m4_reference(r_ref, a, b);
+	copy_m4_m4(r, b);
+	mul_m4_m4m4(r, a, r);
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			EXPECT_EQ(r_ref[i][j], r[i][j]);
+		}
+	}
+
+	/* square of a matrix in place */
+	mul_m4_m4m4_reference(r_ref, a, a);
+	copy_m4_m4(r, a);
+	mul_m4_m4m4(r, r, r);
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			EXPECT_EQ(r_ref[i][j], r[i][j]);
+		}
+	}
+}
+
+TEST(math_matrix, MulM4M4M4Unit)
+{
+	float a[4][4], b[4][4], unit[4][4], r[4][4];
+	math_matrix_test_init(a, b);
+	unit_m4(unit);
+
+	mul_m4_m4m4(r, a, unit);
+	EXPECT_TRUE(equals_m4m4(a, r));
+	mul_m4_m4m4(r, unit, a);
+	EXPECT_TRUE(equals_m4m4(a, r));
+}
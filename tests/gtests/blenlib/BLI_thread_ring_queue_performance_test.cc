@@ -0,0 +1,164 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_threads.h"
+#include "PIL_time_utildefines.h"
+}
+
+/* Compare the mutex based ThreadQueue with the lock-free ThreadRingQueue,
+ * for various numbers of producer and consumer threads. */
+
+#define QUEUE_SIZE 1024
+#define ITEMS_TOTAL 4000000
+
+typedef struct BenchData {
+	ThreadQueue *queue;
+	ThreadRingQueue *ring_queue;
+	int first, items;
+	size_t count;
+} BenchData;
+
+static void *queue_producer(void *data_v)
+{
+	BenchData *data = (BenchData *)data_v;
+	intptr_t i;
+
+	/* unique values, ThreadQueue skips an item equal to the one at its head */
+	for (i = data->first; i < data->first + data->items; i++) {
+		BLI_thread_queue_push(data->queue, (void *)i);
+	}
+	return NULL;
+}
+
+static void *queue_consumer(void *data_v)
+{
+	BenchData *data = (BenchData *)data_v;
+
+	while (BLI_thread_queue_pop(data->queue)) {
+		data->count++;
+	}
+	return NULL;
+}
+
+static void *ring_queue_producer(void *data_v)
+{
+	BenchData *data = (BenchData *)data_v;
+	intptr_t i;
+
+	for (i = data->first; i < data->first + data->items; i++) {
+		while (!BLI_thread_ring_queue_push(data->ring_queue, (void *)i)) {
+			/* full, let consumers catch up */
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static void *ring_queue_consumer(void *data_v)
+{
+	BenchData *data = (BenchData *)data_v;
+
+	while (BLI_thread_ring_queue_pop(data->ring_queue)) {
+		data->count++;
+	}
+	return NULL;
+}
+
+static void queue_bench(const int producers_num, const int consumers_num, const bool use_ring)
+{
+	pthread_t *producers = new pthread_t[producers_num];
+	pthread_t *consumers = new pthread_t[consumers_num];
+	BenchData *producer_data = new BenchData[producers_num];
+	BenchData *consumer_data = new BenchData[consumers_num];
+	BenchData data;
+	size_t count = 0;
+	int i;
+
+	data.queue = use_ring ? NULL : BLI_thread_queue_init();
+	data.ring_queue = use_ring ? BLI_thread_ring_queue_init(QUEUE_SIZE) : NULL;
+	data.items = ITEMS_TOTAL / producers_num;
+	data.first = 1;
+	data.count = 0;
+
+	printf("%s, %d producers, %d consumers:\n",
+	       use_ring ? "ThreadRingQueue" : "ThreadQueue", producers_num, consumers_num);
+
+	TIMEIT_START(queue_push_pop);
+
+	for (i = 0; i < consumers_num; i++) {
+		consumer_data[i] = data;
+		pthread_create(&consumers[i], NULL, use_ring ? ring_queue_consumer : queue_consumer, &consumer_data[i]);
+	}
+	for (i = 0; i < producers_num; i++) {
+		producer_data[i] = data;
+		producer_data[i].first = 1 + i * data.items;
+		pthread_create(&producers[i], NULL, use_ring ? ring_queue_producer : queue_producer, &producer_data[i]);
+	}
+	for (i = 0; i < producers_num; i++) {
+		pthread_join(producers[i], NULL);
+	}
+
+	if (use_ring) {
+		BLI_thread_ring_queue_nowait(data.ring_queue);
+	}
+	else {
+		BLI_thread_queue_nowait(data.queue);
+	}
+
+	for (i = 0; i < consumers_num; i++) {
+		pthread_join(consumers[i], NULL);
+		count += consumer_data[i].count;
+	}
+
+	TIMEIT_END(queue_push_pop);
+
+	EXPECT_EQ((size_t)data.items * producers_num, count);
+
+	if (use_ring) {
+		BLI_thread_ring_queue_free(data.ring_queue);
+	}
+	else {
+		BLI_thread_queue_free(data.queue);
+	}
+
+	delete[] producers;
+	delete[] consumers;
+	delete[] producer_data;
+	delete[] consumer_data;
+}
+
+TEST(ring_queue, ThreadQueue_1x1)
+{
+	queue_bench(1, 1, false);
+}
+
+TEST(ring_queue, RingQueue_1x1)
+{
+	queue_bench(1, 1, true);
+}
+
+TEST(ring_queue, ThreadQueue_4x4)
+{
+	queue_bench(4, 4, false);
+}
+
+TEST(ring_queue, RingQueue_4x4)
+{
+	queue_bench(4, 4, true);
+}
+
+TEST(ring_queue, ThreadQueue_1x8)
+{
+	queue_bench(1, 8, false);
+}
+
+TEST(ring_queue, RingQueue_1x8)
+{
+	queue_bench(1, 8, true);
+}
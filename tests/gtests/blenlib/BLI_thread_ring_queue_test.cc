@@ -0,0 +1,178 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_threads.h"
+}
+
+#define SIZE 1024
+
+/* Number of items pushed by each producer in threaded tests. */
+#define THREAD_ITEMS 100000
+#define THREAD_PRODUCERS 4
+#define THREAD_CONSUMERS 4
+
+TEST(ring_queue, Empty)
+{
+	ThreadRingQueue *queue = BLI_thread_ring_queue_init(SIZE);
+	void *work;
+
+	EXPECT_TRUE(BLI_thread_ring_queue_is_empty(queue));
+	EXPECT_EQ(0, BLI_thread_ring_queue_size(queue));
+	EXPECT_FALSE(BLI_thread_ring_queue_try_pop(queue, &work));
+
+	BLI_thread_ring_queue_free(queue);
+}
+
+TEST(ring_queue, PushPop)
+{
+	ThreadRingQueue *queue = BLI_thread_ring_queue_init(SIZE);
+	void *work;
+	intptr_t i;
+
+	for (i = 0; i < SIZE; i++) {
+		EXPECT_TRUE(BLI_thread_ring_queue_push(queue, (void *)(i + 1)));
+	}
+	EXPECT_EQ(SIZE, BLI_thread_ring_queue_size(queue));
+
+	/* first in, first out */
+	for (i = 0; i < SIZE; i++) {
+		EXPECT_TRUE(BLI_thread_ring_queue_try_pop(queue, &work));
+		EXPECT_EQ((void *)(i + 1), work);
+	}
+	EXPECT_TRUE(BLI_thread_ring_queue_is_empty(queue));
+
+	BLI_thread_ring_queue_free(queue);
+}
+
+TEST(ring_queue, Full)
+{
+	/* rounded up to a power of two */
+	ThreadRingQueue *queue = BLI_thread_ring_queue_init(SIZE - 1);
+	void *work;
+	intptr_t i;
+
+	for (i = 0; i < SIZE; i++) {
+		EXPECT_TRUE(BLI_thread_ring_queue_push(queue, (void *)i));
+	}
+	EXPECT_FALSE(BLI_thread_ring_queue_push(queue, (void *)i));
+
+	/* making room allows pushing again */
+	EXPECT_TRUE(BLI_thread_ring_queue_try_pop(queue, &work));
+	EXPECT_EQ((void *)0, work);
+	EXPECT_TRUE(BLI_thread_ring_queue_push(queue, (void *)i));
+	EXPECT_FALSE(BLI_thread_ring_queue_push(queue, (void *)i));
+
+	BLI_thread_ring_queue_free(queue);
+}
+
+TEST(ring_queue, WrapAround)
+{
+	ThreadRingQueue *queue = BLI_thread_ring_queue_init(8);
+	void *work;
+	intptr_t i;
+
+	/* many laps over a small buffer */
+	for (i = 0; i < SIZE * 8; i++) {
+		EXPECT_TRUE(BLI_thread_ring_queue_push(queue, (void *)i));
+		EXPECT_TRUE(BLI_thread_ring_queue_push(queue, (void *)(i + 1)));
+		EXPECT_TRUE(BLI_thread_ring_queue_try_pop(queue, &work));
+		EXPECT_EQ((void *)i, work);
+		EXPECT_TRUE(BLI_thread_ring_queue_try_pop(queue, &work));
+		EXPECT_EQ((void *)(i + 1), work);
+	}
+	EXPECT_TRUE(BLI_thread_ring_queue_is_empty(queue));
+
+	BLI_thread_ring_queue_free(queue);
+}
+
+TEST(ring_queue, NoWait)
+{
+	ThreadRingQueue *queue = BLI_thread_ring_queue_init(SIZE);
+
+	BLI_thread_ring_queue_push(queue, (void *)1);
+	BLI_thread_ring_queue_nowait(queue);
+
+	/* remaining work is still returned, then the blocking pop gives up */
+	EXPECT_EQ((void *)1, BLI_thread_ring_queue_pop(queue));
+	EXPECT_EQ(NULL, BLI_thread_ring_queue_pop(queue));
+
+	BLI_thread_ring_queue_free(queue);
+}
+
+typedef struct ThreadData {
+	ThreadRingQueue *queue;
+	size_t sum;
+	size_t count;
+} ThreadData;
+
+static void *producer_thread(void *data_v)
+{
+	ThreadData *data = (ThreadData *)data_v;
+	intptr_t i;
+
+	for (i = 1; i <= THREAD_ITEMS; i++) {
+		while (!BLI_thread_ring_queue_push(data->queue, (void *)i)) {
+			/* full, let consumers catch up */
+			sched_yield();
+		}
+	}
+
+	return NULL;
+}
+
+static void *consumer_thread(void *data_v)
+{
+	ThreadData *data = (ThreadData *)data_v;
+	void *work;
+
+	while ((work = BLI_thread_ring_queue_pop(data->queue))) {
+		data->sum += (size_t)work;
+		data->count++;
+	}
+
+	return NULL;
+}
+
+TEST(ring_queue, Threaded)
+{
+	ThreadRingQueue *queue = BLI_thread_ring_queue_init(SIZE);
+	pthread_t producers[THREAD_PRODUCERS], consumers[THREAD_CONSUMERS];
+	ThreadData consumer_data[THREAD_CONSUMERS];
+	ThreadData producer_data = {queue, 0, 0};
+	size_t sum = 0, count = 0;
+	int i;
+
+	for (i = 0; i < THREAD_CONSUMERS; i++) {
+		consumer_data[i].queue = queue;
+		consumer_data[i].sum = 0;
+		consumer_data[i].count = 0;
+		pthread_create(&consumers[i], NULL, consumer_thread, &consumer_data[i]);
+	}
+	for (i = 0; i < THREAD_PRODUCERS; i++) {
+		pthread_create(&producers[i], NULL, producer_thread, &producer_data);
+	}
+
+	for (i = 0; i < THREAD_PRODUCERS; i++) {
+		pthread_join(producers[i], NULL);
+	}
+	/* consumers drain what is left, then return */
+	BLI_thread_ring_queue_nowait(queue);
+	for (i = 0; i < THREAD_CONSUMERS; i++) {
+		pthread_join(consumers[i], NULL);
+		sum += consumer_data[i].sum;
+		count += consumer_data[i].count;
+	}
+
+	/* every item popped exactly once */
+	EXPECT_EQ((size_t)THREAD_PRODUCERS * THREAD_ITEMS, count);
+	EXPECT_EQ((size_t)THREAD_PRODUCERS * ((size_t)THREAD_ITEMS * (THREAD_ITEMS + 1) / 2), sum);
+	EXPECT_TRUE(BLI_thread_ring_queue_is_empty(queue));
+
+	BLI_thread_ring_queue_free(queue);
+}
@@ -0,0 +1,68 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <stdio.h>
+#include <string>
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_trace.h"
+}
+
+static std::string trace_write_read(void)
+{
+	const char *filepath = "BLI_trace_test.json";
+	std::string text;
+	char buf[1024];
+	size_t len;
+	FILE *fp;
+
+	fp = fopen(filepath, "w+");
+	EXPECT_TRUE(fp != NULL);
+	EXPECT_TRUE(BLI_trace_write_chrome_json(fp));
+
+	rewind(fp);
+	while ((len = fread(buf, 1, sizeof(buf), fp)) > 0) {
+		text.append(buf, len);
+	}
+	fclose(fp);
+	remove(filepath);
+
+	return text;
+}
+
+TEST(trace, Disabled)
+{
+	EXPECT_FALSE(BLI_trace_is_enabled());
+
+	/* no-op, nothing to write */
+	BLI_trace_zone_begin("zone");
+	BLI_trace_zone_end();
+	EXPECT_FALSE(BLI_trace_write_chrome_json(stdout));
+}
+
+TEST(trace, NestedZones)
+{
+	std::string text;
+
+	BLI_trace_enable();
+	EXPECT_TRUE(BLI_trace_is_enabled());
+
+	BLI_trace_zone_begin("outer");
+	BLI_trace_zone_begin("inner \"quoted\"");
+	BLI_trace_zone_end();
+	BLI_trace_zone_end();
+	/* unbalanced end is ignored */
+	BLI_trace_zone_end();
+
+	text = trace_write_read();
+	BLI_trace_free();
+
+	EXPECT_FALSE(BLI_trace_is_enabled());
+	EXPECT_NE(std::string::npos, text.find("\"traceEvents\""));
+	EXPECT_NE(std::string::npos, text.find("\"name\": \"outer\", \"ph\": \"X\""));
+	EXPECT_NE(std::string::npos, text.find("\"name\": \"inner \\\"quoted\\\"\""));
+	/* inner zone ends first */
+	EXPECT_LT(text.find("inner"), text.find("outer"));
+}
@@ -0,0 +1,175 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <fcntl.h>
+#include <string>
+#include <vector>
+
+#ifndef WIN32
+#  include <unistd.h>
+#else
+#  include <io.h>
+#endif
+
+extern "C" {
+#include "BLI_fileops.h"
+#include "BLI_utildefines.h"
+
+#include "BLO_blend_defs.h"
+#include "BLO_lzofile.h"
+}
+
+static std::string lzofile_test_path(const char *name)
+{
+	return testing::internal::TempDir() + name;
+}
+
+/* alternate compressible and random data, so chunks of both kinds are written */
+static std::vector<unsigned char> lzofile_test_data(size_t len)
+{
+	std::vector<unsigned char> data(len);
+	unsigned int seed = 1;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		if ((i / 100000) % 2) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = (unsigned char)(seed >> 16);
+		}
+		else {
+			data[i] = (unsigned char)(i % 7);
+		}
+	}
+	return data;
+}
+
+static bool lzofile_write(const char *filepath, const std::vector<unsigned char> &data, size_t step)
+{
+	BlendLZOWriter *lw = BLO_lzo_writer_open(filepath);
+	size_t written = 0;
+	bool ok = true;
+
+	EXPECT_TRUE(lw != NULL);
+	if (lw == NULL) {
+		return false;
+	}
+
+	while (written < data.size()) {
+		const size_t len = MIN2(step, data.size() - written);
+		ok &= BLO_lzo_writer_write(lw, &data[written], len);
+		written += len;
+	}
+	ok &= BLO_lzo_writer_close(lw);
+
+	return ok;
+}
+
+static std::vector<unsigned char> lzofile_read(const char *filepath, size_t step)
+{
+	std::vector<unsigned char> data;
+	std::vector<unsigned char> buf(step);
+	BlendLZOReader *lr;
+	size_t len;
+	int file;
+
+	file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+	EXPECT_NE(file, -1);
+	EXPECT_TRUE(BLO_lzo_is_file(file));
+
+	lr = BLO_lzo_reader_open(file);
+	EXPECT_TRUE(lr != NULL);
+	if (lr) {
+		while ((len = BLO_lzo_reader_read(lr, &buf[0], step)) != 0) {
+			data.insert(data.end(), buf.begin(), buf.begin() + len);
+		}
+		BLO_lzo_reader_free(lr);
+	}
+	close(file);
+
+	return data;
+}
+
+TEST(lzofile, RoundTrip)
+{
+	const std::string filepath = lzofile_test_path("BLO_lzofile_test_round_trip.blend");
+	/* several batches of chunks, the last one partially filled */
+	const std::vector<unsigned char> data = lzofile_test_data(BLEND_LZO_CHUNK_SIZE * 33 + 12345);
+
+	EXPECT_TRUE(lzofile_write(filepath.c_str(), data, 100003));
+	EXPECT_TRUE(lzofile_read(filepath.c_str(), 4099) == data);
+
+	BLI_delete(filepath.c_str(), false, false);
+}
+
+TEST(lzofile, RoundTripLargeWrites)
+{
+	const std::string filepath = lzofile_test_path("BLO_lzofile_test_large_writes.blend");
+	const std::vector<unsigned char> data = lzofile_test_data(BLEND_LZO_CHUNK_SIZE * 3);
+
+	EXPECT_TRUE(lzofile_write(filepath.c_str(), data, data.size()));
+	EXPECT_TRUE(lzofile_read(filepath.c_str(), BLEND_LZO_CHUNK_SIZE * 2) == data);
+
+	BLI_delete(filepath.c_str(), false, false);
+}
+
+TEST(lzofile, Empty)
+{
+	const std::string filepath = lzofile_test_path("BLO_lzofile_test_empty.blend");
+	const std::vector<unsigned char> data;
+
+	EXPECT_TRUE(lzofile_write(filepath.c_str(), data, 1));
+	EXPECT_TRUE(lzofile_read(filepath.c_str(), 1).empty());
+
+	BLI_delete(filepath.c_str(), false, false);
+}
+
+TEST(lzofile, CorruptFooter)
+{
+	const std::string filepath = lzofile_test_path("BLO_lzofile_test_corrupt.blend");
+	const std::vector<unsigned char> data = lzofile_test_data(1000);
+	int file;
+
+	EXPECT_TRUE(lzofile_write(filepath.c_str(), data, data.size()));
+
+	/* overwrite the magic at the end of the footer */
+	file = BLI_open(filepath.c_str(), O_BINARY | O_RDWR, 0);
+	EXPECT_NE(file, -1);
+	EXPECT_NE(lseek(file, -BLEND_LZO_MAGIC_LEN, SEEK_END), -1);
+	EXPECT_EQ(write(file, "XXXXXXXX", BLEND_LZO_MAGIC_LEN), BLEND_LZO_MAGIC_LEN);
+	EXPECT_TRUE(BLO_lzo_is_file(file));
+	EXPECT_TRUE(BLO_lzo_reader_open(file) == NULL);
+	close(file);
+
+	BLI_delete(filepath.c_str(), false, false);
+}
+
+TEST(lzofile, CorruptChunk)
+{
+	const std::string filepath = lzofile_test_path("BLO_lzofile_test_corrupt_chunk.blend");
+	const std::vector<unsigned char> data = lzofile_test_data(BLEND_LZO_CHUNK_SIZE * 3);
+	const unsigned char zero_len[4] = {0};
+	std::vector<unsigned char> buf(1000);
+	BlendLZOReader *lr;
+	int file;
+
+	EXPECT_TRUE(lzofile_write(filepath.c_str(), data, data.size()));
+
+	/* the uncompressed size of the first chunk, smaller than its compressed size is invalid */
+	file = BLI_open(filepath.c_str(), O_BINARY | O_RDWR, 0);
+	EXPECT_NE(file, -1);
+	EXPECT_EQ(lseek(file, BLEND_LZO_MAGIC_LEN + 4, SEEK_SET), BLEND_LZO_MAGIC_LEN + 4);
+	EXPECT_EQ(write(file, zero_len, sizeof(zero_len)), (ssize_t)sizeof(zero_len));
+
+	lr = BLO_lzo_reader_open(file);
+	EXPECT_TRUE(lr != NULL);
+	if (lr) {
+		/* failing again on the next read, not returning data of chunks that weren't loaded */
+		EXPECT_EQ(BLO_lzo_reader_read(lr, &buf[0], buf.size()), 0);
+		EXPECT_EQ(BLO_lzo_reader_read(lr, &buf[0], buf.size()), 0);
+		BLO_lzo_reader_free(lr);
+	}
+	close(file);
+
+	BLI_delete(filepath.c_str(), false, false);
+}
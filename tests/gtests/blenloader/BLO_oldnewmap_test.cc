@@ -0,0 +1,82 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_path_util.h"
+
+#include "DNA_sdna_types.h"
+
+#include "BLO_readfile.h"
+
+#include "readfile.h"
+}
+
+/* Fake addresses, they are never dereferenced. Scattered, since consecutive addresses are
+ * spread evenly over the map and would hardly ever collide. */
+static uintptr_t oldnewmap_test_addr(int i)
+{
+	unsigned int x = (unsigned int)i * 2246822519u + 374761393u;
+	x ^= x >> 15;
+	x *= 668265263u;
+	x ^= x >> 13;
+	return ((uintptr_t)x + 1) * 8;
+}
+
+#define OLD_ADDR(i) ((const void *)oldnewmap_test_addr(i))
+#define NEW_ADDR(i, round) ((void *)(oldnewmap_test_addr(i) | ((uintptr_t)(round) << 40)))
+
+static void oldnewmap_test_round(OldNewMap *onm, int first, int num, int round)
+{
+	int i;
+
+	for (i = first; i < first + num; i++) {
+		blo_do_versions_oldnewmap_insert(onm, OLD_ADDR(i), NEW_ADDR(i, round), 0);
+	}
+	/* insert every third address again, lookups must find the last one */
+	for (i = first; i < first + num; i += 3) {
+		blo_do_versions_oldnewmap_insert(onm, OLD_ADDR(i), NEW_ADDR(i, round + 1), 0);
+	}
+
+	for (i = first; i < first + num; i++) {
+		const int expected_round = ((i - first) % 3 == 0) ? round + 1 : round;
+		EXPECT_EQ(blo_oldnewmap_lookup(onm, OLD_ADDR(i)), NEW_ADDR(i, expected_round));
+	}
+	EXPECT_EQ(blo_oldnewmap_lookup(onm, OLD_ADDR(first + num)), (void *)NULL);
+
+	blo_oldnewmap_clear(onm);
+	EXPECT_EQ(blo_oldnewmap_map_used(onm), 0);
+
+	for (i = first; i < first + num + 1; i++) {
+		EXPECT_EQ(blo_oldnewmap_lookup(onm, OLD_ADDR(i)), (void *)NULL);
+	}
+}
+
+TEST(oldnewmap, DuplicatesAcrossClears)
+{
+	OldNewMap *onm = blo_oldnewmap_new();
+	int round;
+
+	/* overlapping address ranges, as when reading the same undo step again,
+	 * few entries (only the used slots are reset) and many (the whole map is reset) */
+	for (round = 0; round < 200; round++) {
+		oldnewmap_test_round(onm, (round * 37) % 500, (round % 10 == 0) ? 600 : 180, round * 2);
+	}
+
+	blo_oldnewmap_free(onm);
+}
+
+TEST(oldnewmap, DuplicatesAcrossGrowth)
+{
+	OldNewMap *onm = blo_oldnewmap_new();
+	int round;
+
+	/* grow the map past its initial size, then keep reusing it with few entries */
+	oldnewmap_test_round(onm, 0, 5000, 0);
+	for (round = 1; round < 100; round++) {
+		oldnewmap_test_round(onm, (round * 131) % 4000, 300, round * 2);
+	}
+
+	blo_oldnewmap_free(onm);
+}
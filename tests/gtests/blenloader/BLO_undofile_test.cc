@@ -0,0 +1,88 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_genfile.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_library.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+
+#include "BLO_undofile.h"
+#include "BLO_writefile.h"
+}
+
+/* enough data per mesh to fill several chunks when flushing at a fixed size */
+#define MESH_VERTS_NUM 1000
+#define MESH_NUM 50
+
+static void undofile_test_mesh_add(Main *bmain, const char *name, int seed)
+{
+	Mesh *me = BKE_mesh_add(bmain, name);
+	int i;
+
+	me->totvert = MESH_VERTS_NUM;
+	me->mvert = (MVert *)CustomData_add_layer(&me->vdata, CD_MVERT, CD_CALLOC, NULL, me->totvert);
+	for (i = 0; i < me->totvert; i++) {
+		/* different data for every mesh, so chunks can only be shared when they line up */
+		me->mvert[i].co[0] = (float)seed;
+		me->mvert[i].co[1] = (float)i;
+	}
+}
+
+static size_t undofile_test_unshared_size(const MemFile *memfile)
+{
+	size_t size = 0;
+
+	for (MemFileChunk *chunk = (MemFileChunk *)memfile->chunks.first; chunk; chunk = (MemFileChunk *)chunk->next) {
+		if (chunk->ident == 0) {
+			size += chunk->size;
+		}
+	}
+	return size;
+}
+
+TEST(undofile, InsertIDSharesLaterChunks)
+{
+	MemFile memfile_a = {{NULL}}, memfile_b = {{NULL}};
+	const size_t mesh_size = sizeof(MVert) * MESH_VERTS_NUM;
+	char name[MAX_NAME];
+	Main *bmain;
+	int i;
+
+	DNA_sdna_current_init();
+	bmain = BKE_main_new();
+
+	for (i = 1; i <= MESH_NUM; i++) {
+		BLI_snprintf(name, sizeof(name), "Mesh.%03d", i);
+		undofile_test_mesh_add(bmain, name, i);
+	}
+	EXPECT_TRUE(BLO_write_file_mem(bmain, NULL, &memfile_a, 0));
+	EXPECT_GT(undofile_test_unshared_size(&memfile_a), mesh_size * MESH_NUM);
+
+	/* sorted by name, this mesh is written before all others */
+	undofile_test_mesh_add(bmain, "Mesh.000", 0);
+	EXPECT_STREQ(((ID *)bmain->mesh.first)->name + 2, "Mesh.000");
+
+	EXPECT_TRUE(BLO_write_file_mem(bmain, &memfile_a, &memfile_b, 0));
+
+	/* only the new mesh and the one after it (its ID.prev changed) are written again,
+	 * everything after them is shared */
+	EXPECT_LT(undofile_test_unshared_size(&memfile_b), mesh_size * 3);
+	EXPECT_EQ(undofile_test_unshared_size(&memfile_b), memfile_b.size);
+
+	BLO_memfile_free(&memfile_a);
+	BLO_memfile_free(&memfile_b);
+	BKE_main_free(bmain);
+	DNA_sdna_current_free();
+}
@@ -1,9 +1,16 @@
 #include "testing/testing.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "BLI_utildefines.h"
 #include "bmesh.h"
 #include "BLI_math.h"
 
+extern "C" {
+#include "BLI_rand.h"
+}
+
 TEST(bmesh_core, BMVertCreate) {
 	BMesh *bm;
 	BMVert *bv1, *bv2, *bv3;
@@ -37,3 +44,64 @@ TEST(bmesh_core, BMVertCreate) {
 	EXPECT_EQ(BM_mesh_elem_count(bm, BM_VERT), 3);
 	BM_mesh_free(bm);
 }
+
+/* Without keep_verts, merge targets must match the greedy search in order of
+ * the coordinate sums which remove doubles has always used. */
+TEST(bmesh_core, FindDoublesTargets) {
+	const float dist = 0.05f;
+	BMesh *bm;
+	BMOperator op;
+	RNG *rng = BLI_rng_new(0);
+	std::vector<BMVert *> verts;
+
+	BMeshCreateParams bm_params;
+	bm_params.use_toolflags = true;
+	bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+	for (int i = 0; i < 2000; i++) {
+		float co[3];
+		co[0] = BLI_rng_get_float(rng) * 0.5f;
+		co[1] = BLI_rng_get_float(rng) * 0.5f;
+		co[2] = BLI_rng_get_float(rng) * 0.5f;
+		verts.push_back(BM_vert_create(bm, co, NULL, BM_CREATE_NOP));
+	}
+	BLI_rng_free(rng);
+
+	/* Reference targets (by index into verts), each vertex which
+	 * isn't merged yet claims the following ones in range. */
+	std::vector<int> order(verts.size());
+	std::vector<int> targets(verts.size(), -1);
+	int doubles_len = 0;
+	for (size_t i = 0; i < verts.size(); i++) {
+		order[i] = (int)i;
+	}
+	std::sort(order.begin(), order.end(), [&verts](int a, int b) {
+		const float *co_a = verts[a]->co, *co_b = verts[b]->co;
+		return (co_a[0] + co_a[1] + co_a[2]) < (co_b[0] + co_b[1] + co_b[2]);
+	});
+	for (size_t i = 0; i < order.size(); i++) {
+		if (targets[order[i]] != -1) {
+			continue;
+		}
+		for (size_t j = i + 1; j < order.size(); j++) {
+			if (targets[order[j]] == -1 &&
+			    len_squared_v3v3(verts[order[i]]->co, verts[order[j]]->co) <= dist * dist)
+			{
+				targets[order[j]] = order[i];
+				doubles_len++;
+			}
+		}
+	}
+	EXPECT_GT(doubles_len, 0);
+
+	BMO_op_initf(bm, &op, BMO_FLAG_DEFAULTS, "find_doubles verts=%av dist=%f", dist);
+	BMO_op_exec(bm, &op);
+	BMOpSlot *slot_targetmap = BMO_slot_get(op.slots_out, "targetmap.out");
+	EXPECT_EQ(doubles_len, BMO_slot_map_count(op.slots_out, "targetmap.out"));
+	for (size_t i = 0; i < verts.size(); i++) {
+		BMVert *v_target = (targets[i] != -1) ? verts[targets[i]] : NULL;
+		EXPECT_EQ(v_target, BMO_slot_map_elem_get(slot_targetmap, verts[i]));
+	}
+	BMO_op_finish(bm, &op);
+
+	BM_mesh_free(bm);
+}
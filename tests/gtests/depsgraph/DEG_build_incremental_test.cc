@@ -0,0 +1,122 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_constraint_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_constraint.h"
+#include "BKE_global.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_debug.h"
+
+#include "IMB_imbuf.h"
+}
+
+class DepsgraphIncrementalTest : public ::testing::Test {
+protected:
+	Main *bmain;
+	Scene *scene;
+
+	virtual void SetUp()
+	{
+		/* Color management settings of new scenes. */
+		IMB_init();
+		DEG_register_node_types();
+		bmain = BKE_main_new();
+		G.main = bmain;
+		scene = BKE_scene_add(bmain, "Scene");
+	}
+
+	virtual void TearDown()
+	{
+		BKE_main_free(bmain);
+		G.main = NULL;
+		DEG_free_node_types();
+		IMB_exit();
+	}
+
+	Object *object_add(const char *name)
+	{
+		Object *ob = BKE_object_add_only_object(bmain, OB_EMPTY, name);
+		ob->lay = scene->lay;
+		BKE_scene_base_add(scene, ob);
+		return ob;
+	}
+
+	/* Copy location, so the constraints of ob depend on the transform of target. */
+	bConstraint *constraint_add(Object *ob, Object *target)
+	{
+		bConstraint *con = BKE_constraint_add_for_object(ob, NULL, CONSTRAINT_TYPE_LOCLIKE);
+		((bLocateLikeConstraint *)con->data)->tar = target;
+		return con;
+	}
+
+	/* Rebuild relations of the tagged object, and compare with a full build. */
+	bool relations_update_validate(Object *ob)
+	{
+		DEG_id_relations_tag_update(bmain, &ob->id);
+		DEG_scene_relations_update(bmain, scene);
+		return DEG_debug_scene_relations_validate(bmain, scene);
+	}
+};
+
+/* X -> A -> B -> Y, and X -> Y which is redundant and owned by Y. Y is not
+ * rebuilt when A changes, so X -> Y has to survive the reduction of the full
+ * build to be there once A no longer depends on X.
+ */
+TEST_F(DepsgraphIncrementalTest, ReducedRelationOfObjectNotRebuilt)
+{
+	Object *ob_x = object_add("X");
+	Object *ob_a = object_add("A");
+	Object *ob_b = object_add("B");
+	Object *ob_y = object_add("Y");
+	bConstraint *con_a = constraint_add(ob_a, ob_x);
+	constraint_add(ob_b, ob_a);
+	constraint_add(ob_y, ob_b);
+	constraint_add(ob_y, ob_x);
+
+	DEG_scene_relations_update(bmain, scene);
+	ASSERT_TRUE(scene->depsgraph != NULL);
+
+	BKE_constraint_remove(&ob_a->constraints, con_a);
+	EXPECT_TRUE(relations_update_validate(ob_a));
+
+	/* Adding it back makes X -> Y redundant again. */
+	constraint_add(ob_a, ob_x);
+	EXPECT_TRUE(relations_update_validate(ob_a));
+}
+
+/* X -> A -> B, and X -> B which is redundant and owned by B. B is rebuilt
+ * with A, since it owns the relation from A.
+ */
+TEST_F(DepsgraphIncrementalTest, ReducedRelationOfNeighbour)
+{
+	Object *ob_x = object_add("X");
+	Object *ob_a = object_add("A");
+	Object *ob_b = object_add("B");
+	bConstraint *con_a = constraint_add(ob_a, ob_x);
+	constraint_add(ob_b, ob_a);
+	constraint_add(ob_b, ob_x);
+
+	DEG_scene_relations_update(bmain, scene);
+	ASSERT_TRUE(scene->depsgraph != NULL);
+
+	BKE_constraint_remove(&ob_a->constraints, con_a);
+	EXPECT_TRUE(relations_update_validate(ob_a));
+
+	/* Tagging an object which relations did not change keeps the graph as it was. */
+	EXPECT_TRUE(relations_update_validate(ob_b));
+}
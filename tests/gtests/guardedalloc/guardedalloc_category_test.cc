@@ -0,0 +1,60 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+}
+
+#include "MEM_guardedalloc.h"
+
+namespace {
+
+void DoCategoryChecks()
+{
+	if (sizeof(size_t) < 8) {
+		/* Categories are not tracked on 32 bit systems. */
+		return;
+	}
+
+	const size_t mem_in_use = MEM_get_memory_in_use();
+	const size_t mesh_in_use = MEM_get_category_memory_in_use(MEM_CATEGORY_MESH);
+
+	const int category_prev = MEM_category_begin(MEM_CATEGORY_MESH);
+	EXPECT_EQ(MEM_CATEGORY_NONE, category_prev);
+	void *mesh_block = MEM_mallocN(1000, __func__);
+	void *mesh_block_aligned = MEM_mallocN_aligned(1000, 16, __func__);
+	MEM_category_end(category_prev);
+
+	void *other_block = MEM_callocN(500, __func__);
+	EXPECT_EQ(1000, MEM_allocN_len(mesh_block));
+
+	EXPECT_EQ(mesh_in_use + 2000, MEM_get_category_memory_in_use(MEM_CATEGORY_MESH));
+	EXPECT_EQ(2, MEM_get_category_blocks_in_use(MEM_CATEGORY_MESH));
+	EXPECT_EQ(mem_in_use + 500, MEM_get_category_memory_in_use(MEM_CATEGORY_NONE));
+
+	/* Freeing is counted in the category of the block, not the active one. */
+	MEM_category_begin(MEM_CATEGORY_UNDO);
+	MEM_freeN(mesh_block);
+	MEM_freeN(mesh_block_aligned);
+	MEM_category_end(category_prev);
+	MEM_freeN(other_block);
+
+	EXPECT_EQ(mesh_in_use, MEM_get_category_memory_in_use(MEM_CATEGORY_MESH));
+	EXPECT_EQ(0, MEM_get_category_memory_in_use(MEM_CATEGORY_UNDO));
+	EXPECT_LE(mesh_in_use + 2000, MEM_get_category_peak_memory(MEM_CATEGORY_MESH));
+	EXPECT_EQ(mem_in_use, MEM_get_memory_in_use());
+}
+
+}  // namespace
+
+TEST(guardedalloc, LockfreeCategories)
+{
+	DoCategoryChecks();
+}
+
+TEST(guardedalloc, GuardedCategories)
+{
+	MEM_use_guarded_allocator();
+	DoCategoryChecks();
+}
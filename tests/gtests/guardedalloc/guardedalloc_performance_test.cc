@@ -0,0 +1,96 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <pthread.h>
+#include <sys/time.h>
+
+extern "C" {
+#include "BLI_utildefines.h"
+}
+
+#include "MEM_guardedalloc.h"
+
+/* Allocation throughput of the allocator backends, with small blocks
+ * of mixed sizes allocated and freed from many threads at once. */
+
+#define THREADS_NUM_MAX 16
+#define ITER_NUM 200000
+#define BLOCKS_LIVE_NUM 256
+
+namespace {
+
+double time_seconds()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec * 1e-6;
+}
+
+void *alloc_thread_func(void *arg)
+{
+	void *blocks[BLOCKS_LIVE_NUM] = {NULL};
+	unsigned int seed = (unsigned int)(intptr_t)arg;
+
+	for (int i = 0; i < ITER_NUM; i++) {
+		const int slot = i % BLOCKS_LIVE_NUM;
+		if (blocks[slot]) {
+			MEM_freeN(blocks[slot]);
+		}
+		seed = seed * 1103515245u + 12345u;
+		blocks[slot] = MEM_mallocN((seed >> 16) % 512 + 8, __func__);
+	}
+	for (int i = 0; i < BLOCKS_LIVE_NUM; i++) {
+		if (blocks[i]) {
+			MEM_freeN(blocks[i]);
+		}
+	}
+	return NULL;
+}
+
+void alloc_throughput_test(const char *id)
+{
+	printf("\n========== STARTING %s ==========\n", id);
+
+	for (int threads_num = 1; threads_num <= THREADS_NUM_MAX; threads_num *= 2) {
+		pthread_t threads[THREADS_NUM_MAX];
+		const double time_start = time_seconds();
+
+		for (int i = 0; i < threads_num; i++) {
+			pthread_create(&threads[i], NULL, alloc_thread_func, (void *)(intptr_t)(i + 1));
+		}
+		for (int i = 0; i < threads_num; i++) {
+			pthread_join(threads[i], NULL);
+		}
+
+		const double time_elapsed = time_seconds() - time_start;
+		printf("%2d threads: %8.3f ms, %6.2f M allocations/s\n",
+		       threads_num, time_elapsed * 1000.0,
+		       (double)threads_num * ITER_NUM / time_elapsed * 1e-6);
+	}
+
+	EXPECT_EQ(0, MEM_get_memory_blocks_in_use());
+
+	printf("========== ENDED %s ==========\n\n", id);
+}
+
+}  // namespace
+
+/* Each test runs in order, the allocator can only be switched while no blocks are in use. */
+
+TEST(guardedalloc, LockfreeThroughput)
+{
+	alloc_throughput_test("Lockfree allocator throughput");
+}
+
+TEST(guardedalloc, ThreadcacheThroughput)
+{
+	MEM_use_threadcache_allocator();
+	alloc_throughput_test("Threadcache allocator throughput");
+}
+
+TEST(guardedalloc, GuardedThroughput)
+{
+	MEM_use_guarded_allocator();
+	alloc_throughput_test("Guarded allocator throughput");
+}
@@ -0,0 +1,164 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <pthread.h>
+#include <string.h>
+
+extern "C" {
+#include "BLI_utildefines.h"
+}
+
+#include "MEM_guardedalloc.h"
+
+/* Declared in the internal header, which needs the atomic ops includes. */
+extern "C" size_t MEM_threadcache_get_slab_memory_in_use(void);
+
+#define CHECK_ALIGNMENT(ptr, align) EXPECT_EQ((size_t)ptr % align, 0)
+
+#define THREADS_NUM 8
+#define BLOCKS_NUM 1000
+
+namespace {
+
+class ThreadCacheTest : public ::testing::Test {
+protected:
+	static void SetUpTestCase()
+	{
+		MEM_use_threadcache_allocator();
+	}
+};
+
+void *alloc_free_thread_func(void *UNUSED(arg))
+{
+	void *blocks[BLOCKS_NUM];
+	for (int i = 0; i < BLOCKS_NUM; i++) {
+		blocks[i] = MEM_mallocN((size_t)(i * 37) % 40000 + 1, __func__);
+		memset(blocks[i], i & 0xff, MEM_allocN_len(blocks[i]));
+	}
+	for (int i = 0; i < BLOCKS_NUM; i++) {
+		EXPECT_EQ(((unsigned char *)blocks[i])[0], i & 0xff);
+		MEM_freeN(blocks[i]);
+	}
+	return NULL;
+}
+
+/* Blocks are allocated on one thread and freed on another. */
+void *free_thread_func(void *arg)
+{
+	void **blocks = (void **)arg;
+	for (int i = 0; i < BLOCKS_NUM; i++) {
+		MEM_freeN(blocks[i]);
+	}
+	return NULL;
+}
+
+/* Many blocks of a single size class, so they fill a number of slabs. */
+void *alloc_many_thread_func(void *UNUSED(arg))
+{
+	const int blocks_num = 20 * BLOCKS_NUM;
+	void **blocks = (void **)malloc(sizeof(void *) * blocks_num);
+	for (int i = 0; i < blocks_num; i++) {
+		blocks[i] = MEM_mallocN(200, __func__);
+	}
+	for (int i = 0; i < blocks_num; i++) {
+		MEM_freeN(blocks[i]);
+	}
+	free(blocks);
+	return NULL;
+}
+
+}  // namespace
+
+TEST_F(ThreadCacheTest, SizeClasses)
+{
+	const size_t mem_in_use = MEM_get_memory_in_use();
+	const unsigned int blocks_in_use = MEM_get_memory_blocks_in_use();
+
+	/* Go over all size classes and some sizes handled by the system allocator. */
+	for (size_t len = 1; len < 70000; len += 13) {
+		char *block = (char *)MEM_mallocN(len, __func__);
+		CHECK_ALIGNMENT(block, 8);
+		EXPECT_GE(MEM_allocN_len(block), len);
+		memset(block, 1, len);
+		EXPECT_EQ(blocks_in_use + 1, MEM_get_memory_blocks_in_use());
+		MEM_freeN(block);
+	}
+
+	EXPECT_EQ(mem_in_use, MEM_get_memory_in_use());
+	EXPECT_EQ(blocks_in_use, MEM_get_memory_blocks_in_use());
+}
+
+TEST_F(ThreadCacheTest, CallocRealloc)
+{
+	unsigned char *block = (unsigned char *)MEM_callocN(100, __func__);
+	for (int i = 0; i < 100; i++) {
+		EXPECT_EQ(0, block[i]);
+		block[i] = (unsigned char)i;
+	}
+
+	/* Same size class. */
+	block = (unsigned char *)MEM_reallocN(block, 104);
+	EXPECT_EQ(104, MEM_allocN_len(block));
+	/* Growing into another size class and the system allocator. */
+	block = (unsigned char *)MEM_reallocN(block, 1000);
+	block = (unsigned char *)MEM_recallocN(block, 50000);
+	for (int i = 0; i < 100; i++) {
+		EXPECT_EQ(i, block[i]);
+	}
+	EXPECT_EQ(0, block[49999]);
+
+	MEM_freeN(block);
+}
+
+TEST_F(ThreadCacheTest, AlignedAlloc)
+{
+	int *foo = (int *)MEM_mallocN_aligned(sizeof(int) * 10, 16, "test");
+	CHECK_ALIGNMENT(foo, 16);
+
+	int *bar = (int *)MEM_dupallocN(foo);
+	CHECK_ALIGNMENT(bar, 16);
+	MEM_freeN(bar);
+
+	foo = (int *)MEM_reallocN(foo, sizeof(int) * 5);
+	CHECK_ALIGNMENT(foo, 16);
+	MEM_freeN(foo);
+}
+
+TEST_F(ThreadCacheTest, Threads)
+{
+	const size_t mem_in_use = MEM_get_memory_in_use();
+	const unsigned int blocks_in_use = MEM_get_memory_blocks_in_use();
+	pthread_t threads[THREADS_NUM];
+
+	for (int i = 0; i < THREADS_NUM; i++) {
+		pthread_create(&threads[i], NULL, alloc_free_thread_func, NULL);
+	}
+	for (int i = 0; i < THREADS_NUM; i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	void *blocks[BLOCKS_NUM];
+	for (int i = 0; i < BLOCKS_NUM; i++) {
+		blocks[i] = MEM_mallocN(64, __func__);
+	}
+	pthread_create(&threads[0], NULL, free_thread_func, blocks);
+	pthread_join(threads[0], NULL);
+
+	EXPECT_EQ(mem_in_use, MEM_get_memory_in_use());
+	EXPECT_EQ(blocks_in_use, MEM_get_memory_blocks_in_use());
+}
+
+TEST_F(ThreadCacheTest, ThreadExitReleasesSlabs)
+{
+	const size_t slab_mem = MEM_threadcache_get_slab_memory_in_use();
+	pthread_t thread;
+
+	/* Short lived threads must not keep the slabs they filled. */
+	for (int i = 0; i < THREADS_NUM; i++) {
+		pthread_create(&thread, NULL, alloc_many_thread_func, NULL);
+		pthread_join(thread, NULL);
+		/* Only a spare slab of the size class may be kept. */
+		EXPECT_LE(MEM_threadcache_get_slab_memory_in_use(), slab_mem + 64 * 1024);
+	}
+}
@@ -0,0 +1,181 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+
+#include "DNA_genfile.h"
+}
+
+/* Basic types in #eSDNA_Type order, followed by the structs used in the tests. */
+static const char *test_types[] = {
+	"char", "uchar", "short", "ushort", "int", "long", "ulong", "float", "double", "void", "int64_t", "uint64_t",
+	"ListBase", "Inner", "Outer",
+};
+static const short test_typelens[] = {1, 1, 2, 2, 4, 4, 4, 4, 8, 0, 8, 8};
+
+enum {
+	TYPE_INT = 4,
+	TYPE_VOID = 9,
+	TYPE_LISTBASE = 12,
+	TYPE_INNER = 13,
+	TYPE_OUTER = 14,
+};
+
+typedef struct Inner {
+	int x, y;
+} Inner;
+
+static void sdna_append_code(std::string &data, const char *code)
+{
+	data.append(code, 4);
+}
+
+static void sdna_append_int(std::string &data, int value)
+{
+	data.append((const char *)&value, sizeof(value));
+}
+
+static void sdna_append_short(std::string &data, short value)
+{
+	data.append((const char *)&value, sizeof(value));
+}
+
+static void sdna_pad_4(std::string &data)
+{
+	while (data.size() % 4) {
+		data.push_back('\0');
+	}
+}
+
+/**
+ * Encode an SDNA block with the structs ListBase, Inner (two ints) and
+ * Outer (an array of Inner followed by an int), in the layout #DNA_sdna_from_data reads.
+ */
+static std::string sdna_encode(int outer_array_len)
+{
+	const std::string arr_name = "arr[" + std::to_string(outer_array_len) + "]";
+	const char *names[] = {"*first", "*last", "x", "y", arr_name.c_str(), "after"};
+	const int types_len = ARRAY_SIZE(test_types);
+	std::string data;
+
+	sdna_append_code(data, "SDNA");
+
+	sdna_append_code(data, "NAME");
+	sdna_append_int(data, ARRAY_SIZE(names));
+	for (int i = 0; i < ARRAY_SIZE(names); i++) {
+		data.append(names[i], strlen(names[i]) + 1);
+	}
+	sdna_pad_4(data);
+
+	sdna_append_code(data, "TYPE");
+	sdna_append_int(data, types_len);
+	for (int i = 0; i < types_len; i++) {
+		data.append(test_types[i], strlen(test_types[i]) + 1);
+	}
+	sdna_pad_4(data);
+
+	sdna_append_code(data, "TLEN");
+	for (int i = 0; i < ARRAY_SIZE(test_typelens); i++) {
+		sdna_append_short(data, test_typelens[i]);
+	}
+	sdna_append_short(data, 2 * sizeof(void *));
+	sdna_append_short(data, sizeof(Inner));
+	sdna_append_short(data, sizeof(Inner) * outer_array_len + sizeof(int));
+	sdna_pad_4(data);
+
+	sdna_append_code(data, "STRC");
+	sdna_append_int(data, 3);
+	/* ListBase {void *first, *last;} */
+	sdna_append_short(data, TYPE_LISTBASE);
+	sdna_append_short(data, 2);
+	sdna_append_short(data, TYPE_VOID);
+	sdna_append_short(data, 0);
+	sdna_append_short(data, TYPE_VOID);
+	sdna_append_short(data, 1);
+	/* Inner {int x, y;} */
+	sdna_append_short(data, TYPE_INNER);
+	sdna_append_short(data, 2);
+	sdna_append_short(data, TYPE_INT);
+	sdna_append_short(data, 2);
+	sdna_append_short(data, TYPE_INT);
+	sdna_append_short(data, 3);
+	/* Outer {Inner arr[n]; int after;} */
+	sdna_append_short(data, TYPE_OUTER);
+	sdna_append_short(data, 2);
+	sdna_append_short(data, TYPE_INNER);
+	sdna_append_short(data, 4);
+	sdna_append_short(data, TYPE_INT);
+	sdna_append_short(data, 5);
+
+	return data;
+}
+
+/* Reconstruct an Outer with an \a old_len array written by a file into the current \a new_len layout. */
+static void reconstruct_outer_test(const int old_len, const int new_len)
+{
+	const std::string old_data = sdna_encode(old_len);
+	const std::string new_data = sdna_encode(new_len);
+	SDNA *oldsdna = DNA_sdna_from_data(old_data.data(), old_data.size(), false, true, NULL);
+	SDNA *newsdna = DNA_sdna_from_data(new_data.data(), new_data.size(), false, true, NULL);
+	ASSERT_TRUE(oldsdna != NULL);
+	ASSERT_TRUE(newsdna != NULL);
+
+	const char *compflags = DNA_struct_get_compareflags(oldsdna, newsdna);
+	DNA_ReconstructInfo *reconstruct_info = DNA_reconstruct_info_create(oldsdna, newsdna, compflags);
+	const int old_nr = DNA_struct_find_nr(oldsdna, "Outer");
+	EXPECT_EQ(SDNA_CMP_EQUAL, compflags[DNA_struct_find_nr(oldsdna, "Inner")]);
+	EXPECT_EQ(SDNA_CMP_NOT_EQUAL, compflags[old_nr]);
+
+	/* Two blocks, so a wrong old or new struct length shows up too. */
+	const int blocks = 2;
+	std::vector<int> old_outer(blocks * (old_len * 2 + 1));
+	for (int b = 0, i = 0; b < blocks; b++) {
+		for (int a = 0; a < old_len; a++) {
+			old_outer[i++] = b * 100 + a * 2 + 1;
+			old_outer[i++] = b * 100 + a * 2 + 2;
+		}
+		old_outer[i++] = b * 100 + 42;
+	}
+
+	const int *new_outer = (const int *)DNA_struct_reconstruct(reconstruct_info, old_nr, blocks, old_outer.data());
+	ASSERT_TRUE(new_outer != NULL);
+	for (int b = 0, i = 0; b < blocks; b++) {
+		for (int a = 0; a < new_len; a++, i += 2) {
+			if (a < old_len) {
+				EXPECT_EQ(b * 100 + a * 2 + 1, new_outer[i]);
+				EXPECT_EQ(b * 100 + a * 2 + 2, new_outer[i + 1]);
+			}
+			else {
+				/* Elements the old file didn't have stay zeroed. */
+				EXPECT_EQ(0, new_outer[i]);
+				EXPECT_EQ(0, new_outer[i + 1]);
+			}
+		}
+		/* The field after the array is placed after the complete current array. */
+		EXPECT_EQ(b * 100 + 42, new_outer[i++]);
+	}
+
+	MEM_freeN((void *)new_outer);
+	DNA_reconstruct_info_free(reconstruct_info);
+	MEM_freeN((void *)compflags);
+	DNA_sdna_free(oldsdna);
+	DNA_sdna_free(newsdna);
+}
+
+TEST(dna_genfile, ReconstructStructArrayGrown)
+{
+	reconstruct_outer_test(2, 4);
+}
+
+TEST(dna_genfile, ReconstructStructArrayShrunk)
+{
+	reconstruct_outer_test(4, 2);
+}